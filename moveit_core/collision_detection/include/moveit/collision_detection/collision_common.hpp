@@ -239,9 +239,16 @@ struct DistanceRequest
   const AllowedCollisionMatrix* acm = nullptr;
 
   /// Only calculate distances for objects within this threshold to each other.
-  /// If set, this can significantly reduce the number of queries.
+  /// If set, this can significantly reduce the number of queries: objects whose bounding boxes are farther away
+  /// are skipped by the broadphase without computing their distance.
   double distance_threshold = std::numeric_limits<double>::max();
 
+  /// If non-zero, only report distances to this many world objects nearest to the robot (k-nearest query).
+  /// Once that many objects are found, farther objects are skipped like those beyond \e distance_threshold, so only
+  /// pairs closer than the farthest of the nearest objects are reported.
+  /// Only honored by the FCL collision environment; other collision detectors ignore it.
+  std::size_t max_nearest_objects = 0;
+
   /// Log debug information
   bool verbose = false;
 
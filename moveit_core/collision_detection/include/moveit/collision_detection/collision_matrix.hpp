@@ -39,7 +39,10 @@
 #include <moveit/collision_detection/collision_common.hpp>
 #include <moveit/macros/class_forward.hpp>
 #include <moveit_msgs/msg/allowed_collision_matrix.hpp>
+#include <atomic>
+#include <cstdint>
 #include <iostream>
+#include <limits>
 #include <vector>
 #include <string>
 #include <map>
@@ -71,6 +74,7 @@ enum Type
 using DecideContactFn = std::function<bool(collision_detection::Contact&)>;
 
 MOVEIT_CLASS_FORWARD(AllowedCollisionMatrix);  // Defines AllowedCollisionMatrixPtr, ConstPtr, WeakPtr... etc
+MOVEIT_CLASS_FORWARD(CompiledAllowedCollisionMatrix);
 
 /** @class AllowedCollisionMatrix
  *  @brief Definition of a structure for the allowed collision matrix. All elements in the collision world are referred
@@ -93,11 +97,11 @@ public:
   /** @brief Construct the structure from a message representation */
   AllowedCollisionMatrix(const moveit_msgs::msg::AllowedCollisionMatrix& msg);
 
-  /** @brief Copy constructor */
-  AllowedCollisionMatrix(const AllowedCollisionMatrix& acm) = default;
+  /** @brief Copy constructor. Runs in constant time: the entries are shared until either matrix is modified. */
+  AllowedCollisionMatrix(const AllowedCollisionMatrix& acm);
 
   /** @brief Copy assignment */
-  AllowedCollisionMatrix& operator=(const AllowedCollisionMatrix&) = default;
+  AllowedCollisionMatrix& operator=(const AllowedCollisionMatrix& acm);
 
   /** @brief Get the type of the allowed collision between two elements.
    *  Return true if the entry is included in the collision matrix. Return false if the entry is not found.
@@ -198,7 +202,7 @@ public:
   /** @brief Get the size of the allowed collision matrix (number of specified entries) */
   std::size_t getSize() const
   {
-    return entries_.size();
+    return data_->entries_.size();
   }
 
   /** @brief Set the default value for entries that include \e name but are not set explicitly with setEntry().
@@ -243,17 +247,147 @@ public:
   bool getAllowedCollision(const std::string& name1, const std::string& name2,
                            AllowedCollision::Type& allowed_collision) const;
 
+  /** @brief Get a dense, index-based snapshot of the allowed collision types, for the collision checking hot path.
+   *  The snapshot is compiled on the first call after the matrix was modified and shared until the next
+   *  modification. Setting or removing the entry of a pair of names the snapshot already knows patches it instead,
+   *  without a recompile. Modifications do not affect snapshots that were already handed out. */
+  CompiledAllowedCollisionMatrixConstPtr getCompiled() const;
+
   /** @brief Print the allowed collision matrix */
   void print(std::ostream& out) const;
 
 private:
+  friend class CompiledAllowedCollisionMatrix;
+
   bool getDefaultEntry(const std::string& name1, const std::string& name2,
                        AllowedCollision::Type& allowed_collision) const;
 
-  std::map<std::string, std::map<std::string, AllowedCollision::Type> > entries_;
-  std::map<std::string, std::map<std::string, DecideContactFn> > allowed_contacts_;
+  /** @brief The entries of the matrix, shared between copies until one of them is modified */
+  struct Data
+  {
+    std::map<std::string, std::map<std::string, AllowedCollision::Type> > entries_;
+    std::map<std::string, std::map<std::string, DecideContactFn> > allowed_contacts_;
+
+    std::map<std::string, AllowedCollision::Type> default_entries_;
+    std::map<std::string, DecideContactFn> default_allowed_contacts_;
+  };
+
+  /** @brief Get the entries for modification, copying them first if they are shared with other matrices.
+   *  Also drops the compiled snapshot, unless \e keep_compiled is set and the caller updates it with
+   *  updateCompiled(). */
+  Data& getDataForWriting(bool keep_compiled = false);
+
+  /** @brief Patch the compiled snapshot after the entry between \e name1 and \e name2 changed. The snapshot is
+   *  copied first if it was handed out, and dropped if it does not know both names. */
+  void updateCompiled(const std::string& name1, const std::string& name2);
+
+  std::shared_ptr<Data> data_ = std::make_shared<Data>();
+
+  /** @brief Snapshot returned by getCompiled(), accessed atomically */
+  mutable CompiledAllowedCollisionMatrixPtr compiled_;
+};
+
+/** @class CompiledAllowedCollisionMatrix
+ *  @brief Dense, index-based snapshot of an AllowedCollisionMatrix.
+ *
+ *  Every name of the matrix is assigned an integer index, and the result of
+ *  AllowedCollisionMatrix::getAllowedCollision() for every pair of indices is stored as a 2-bit code in a dense
+ *  bit matrix. Names unknown to the matrix map to NO_INDEX; pairs involving them still honor default entries. */
+class CompiledAllowedCollisionMatrix
+{
+public:
+  static constexpr std::uint32_t NO_INDEX = std::numeric_limits<std::uint32_t>::max();
+
+  explicit CompiledAllowedCollisionMatrix(const AllowedCollisionMatrix& acm);
+
+  /** @brief Get an identifier that is unique to this snapshot (and never 0), for caching indices */
+  std::uint32_t getId() const
+  {
+    return id_;
+  }
+
+  /** @brief Get the number of names in the snapshot */
+  std::size_t getSize() const
+  {
+    return names_.size();
+  }
+
+  /** @brief Get the index of an element by name, or NO_INDEX if the element is not in the matrix */
+  std::uint32_t getIndex(const std::string& name) const;
+
+  /** @brief Get the type of the allowed collision between two elements given by index.
+   *  Return true if the entry is included in the collision matrix or if specified defaults were found.
+   *  Return false if the entry is not found. */
+  bool getAllowedCollision(std::uint32_t index1, std::uint32_t index2,
+                           AllowedCollision::Type& allowed_collision) const
+  {
+    unsigned int code;
+    if (index1 != NO_INDEX && index2 != NO_INDEX)
+    {
+      const std::size_t bit = 2 * (static_cast<std::size_t>(index1) * names_.size() + index2);
+      code = (bits_[bit / 64] >> (bit % 64)) & 3u;
+    }
+    else if (index1 != NO_INDEX)
+      code = default_codes_[index1];
+    else if (index2 != NO_INDEX)
+      code = default_codes_[index2];
+    else
+      return false;
+
+    if (code == 0)
+      return false;
+    allowed_collision = static_cast<AllowedCollision::Type>(code - 1);
+    return true;
+  }
+
+private:
+  friend class AllowedCollisionMatrix;
+
+  /** @brief Assign a new unique id, for a copy that is about to be patched */
+  void renewId();
 
-  std::map<std::string, AllowedCollision::Type> default_entries_;
-  std::map<std::string, DecideContactFn> default_allowed_contacts_;
+  /** @brief Store the code of a pair: 0 = no entry, otherwise AllowedCollision::Type + 1 */
+  void setCode(std::size_t index1, std::size_t index2, std::uint64_t code);
+
+  std::uint32_t id_;
+  std::vector<std::string> names_;           // sorted
+  std::vector<std::uint64_t> bits_;          // 2 bits per pair: 0 = no entry, otherwise AllowedCollision::Type + 1
+  std::vector<std::uint8_t> default_codes_;  // code of each element paired with an unknown element
+};
+
+/** @class AllowedCollisionIndexCache
+ *  @brief Caches the index of a collision body in the last CompiledAllowedCollisionMatrix it was looked up in.
+ *
+ *  Collision checkers keep one per body, so that names are only resolved once per snapshot. Lookups are safe to run
+ *  concurrently. Copies start out empty. */
+class AllowedCollisionIndexCache
+{
+public:
+  AllowedCollisionIndexCache() = default;
+
+  AllowedCollisionIndexCache(const AllowedCollisionIndexCache& /*other*/)
+  {
+  }
+
+  AllowedCollisionIndexCache& operator=(const AllowedCollisionIndexCache& /*other*/)
+  {
+    entry_.store(0, std::memory_order_relaxed);
+    return *this;
+  }
+
+  /** @brief Get the index of \e name in \e acm */
+  std::uint32_t getIndex(const CompiledAllowedCollisionMatrix& acm, const std::string& name) const
+  {
+    const std::uint64_t entry = entry_.load(std::memory_order_relaxed);
+    if (static_cast<std::uint32_t>(entry >> 32) == acm.getId())
+      return static_cast<std::uint32_t>(entry);
+    const std::uint32_t index = acm.getIndex(name);
+    entry_.store((static_cast<std::uint64_t>(acm.getId()) << 32) | index, std::memory_order_relaxed);
+    return index;
+  }
+
+private:
+  /** @brief Snapshot id in the upper, index in the lower 32 bits */
+  mutable std::atomic<std::uint64_t> entry_{ 0 };
 };
 }  // namespace collision_detection
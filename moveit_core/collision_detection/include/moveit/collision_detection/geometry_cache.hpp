@@ -0,0 +1,191 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include <geometric_shapes/shapes.h>
+
+namespace collision_detection
+{
+/** \brief Compute a hash of the geometry of \e shape: its type, dimensions and, for meshes, vertices and triangles.
+ *  Shapes with the same geometry hash to the same value wherever they are stored. Returns false for shape types that
+ *  have no fixed geometry (octrees). */
+bool computeShapeHash(const shapes::Shape& shape, std::uint64_t& hash);
+
+/** \brief Vertex and triangle counts of a mesh, zero for other shapes. GeometryCache stores them with every entry and
+ *  compares them on each hit, so that two meshes whose hashes collide are not mistaken for each other. */
+struct ShapeCounts
+{
+  std::uint64_t vertex_count = 0;
+  std::uint64_t triangle_count = 0;
+
+  bool operator==(const ShapeCounts& other) const
+  {
+    return vertex_count == other.vertex_count && triangle_count == other.triangle_count;
+  }
+};
+
+/** \brief Compute the hash of \e shape like computeShapeHash(shape, hash), and its \e counts */
+bool computeShapeHash(const shapes::Shape& shape, std::uint64_t& hash, ShapeCounts& counts);
+
+/** \brief Process-wide cache of data derived from shape geometry, such as bounding volume hierarchies or convex hulls.
+ *
+ *  Entries are identified by a \e kind, naming the conversion that produced them, and the hash of the source shape
+ *  (see computeShapeHash()), so identical geometry is converted only once no matter how many shape instances,
+ *  threads or collision environments use it. Entries are reference counted: once the memory budget is exceeded, the
+ *  least recently used entries that are not held outside of the cache are evicted.
+ *
+ *  Optionally, conversions that provide a Serializer are also stored in a directory on disk and read back from there
+ *  instead of being computed again, e.g. when a process is restarted. */
+class GeometryCache
+{
+public:
+  /** \brief Functions to write an entry to and read it back from the on-disk store */
+  template <typename T>
+  struct Serializer
+  {
+    std::function<bool(const T&, std::ostream&)> write;
+    std::function<std::shared_ptr<const T>(std::istream&)> read;
+  };
+
+  /** \brief The memory budget used unless setMemoryBudget() is called: 256 MiB */
+  static const std::size_t DEFAULT_MEMORY_BUDGET;
+
+  /** \brief Get the cache shared by the whole process */
+  static GeometryCache& getInstance();
+
+  GeometryCache();
+  GeometryCache(const GeometryCache&) = delete;
+  GeometryCache& operator=(const GeometryCache&) = delete;
+
+  /** \brief Get the entry of type \e kind for the shape with hash \e hash. If there is none, it is read from the
+   *  on-disk store or computed by \e build, whose result is accounted with the size returned by \e size. If several
+   *  threads request the same missing entry, only one of them builds it while the others wait for the result.
+   *  Returns nullptr if \e build does; such results are not cached. */
+  template <typename T>
+  std::shared_ptr<const T> get(const std::string& kind, std::uint64_t hash,
+                               const std::function<std::shared_ptr<const T>()>& build,
+                               const std::function<std::size_t(const T&)>& size,
+                               const Serializer<T>* serializer = nullptr)
+  {
+    return get<T>(kind, hash, ShapeCounts(), build, size, serializer);
+  }
+
+  /** \brief Like get(kind, hash, build, size, serializer), but the entry also records the \e counts of the source
+   *  shape. If a cached or stored entry with the same hash has different counts, the hashes collided: the result of
+   *  \e build is returned without caching it. */
+  template <typename T>
+  std::shared_ptr<const T> get(const std::string& kind, std::uint64_t hash, const ShapeCounts& counts,
+                               const std::function<std::shared_ptr<const T>()>& build,
+                               const std::function<std::size_t(const T&)>& size,
+                               const Serializer<T>* serializer = nullptr)
+  {
+    ErasedSerializer erased_serializer;
+    if (serializer)
+    {
+      erased_serializer.write = [serializer](const void* value, std::ostream& out) {
+        return serializer->write(*static_cast<const T*>(value), out);
+      };
+      erased_serializer.read = [serializer](std::istream& in) {
+        return std::shared_ptr<const void>(serializer->read(in));
+      };
+    }
+    return std::static_pointer_cast<const T>(getErased(
+        kind, hash, counts, [&build] { return std::shared_ptr<const void>(build()); },
+        [&size](const void* value) { return size(*static_cast<const T*>(value)); },
+        serializer ? &erased_serializer : nullptr));
+  }
+
+  /** \brief Set the number of bytes the cache may hold before evicting entries */
+  void setMemoryBudget(std::size_t bytes);
+
+  /** \brief Get the number of bytes the cache may hold before evicting entries */
+  std::size_t getMemoryBudget() const;
+
+  /** \brief Get the number of bytes held by the cache, as reported by the \e size functions of its entries */
+  std::size_t getMemoryUsage() const;
+
+  /** \brief Get the number of entries in the cache */
+  std::size_t size() const;
+
+  /** \brief Set the directory in which serializable entries are stored. An empty string (the default) disables the
+   *  on-disk store. Returns false if the directory does not exist and cannot be created. */
+  bool setStorageDirectory(const std::string& directory);
+
+  /** \brief Get the directory in which serializable entries are stored; empty if the on-disk store is disabled */
+  std::string getStorageDirectory() const;
+
+  /** \brief Remove all entries from memory. Entries held outside of the cache stay valid. */
+  void clear();
+
+private:
+  using Key = std::pair<std::string, std::uint64_t>;
+  using Value = std::shared_ptr<const void>;
+
+  struct ErasedSerializer
+  {
+    std::function<bool(const void*, std::ostream&)> write;
+    std::function<Value(std::istream&)> read;
+  };
+
+  struct Entry;
+
+  Value getErased(const std::string& kind, std::uint64_t hash, const ShapeCounts& counts,
+                  const std::function<Value()>& build, const std::function<std::size_t(const void*)>& size,
+                  const ErasedSerializer* serializer);
+
+  /** \brief Evict unused entries, least recently used first, until the memory budget is met. Expects mutex_ held. */
+  void evict();
+
+  std::string getStoragePath(const Key& key) const;
+
+  mutable std::mutex mutex_;
+  std::map<Key, std::shared_ptr<Entry>> entries_;
+  /** \brief Keys of the entries, most recently used first */
+  std::list<Key> lru_;
+  std::size_t memory_usage_;
+  std::size_t memory_budget_;
+  std::string storage_directory_;
+};
+}  // namespace collision_detection
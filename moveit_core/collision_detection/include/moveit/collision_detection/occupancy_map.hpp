@@ -98,6 +98,15 @@ public:
     return WriteLock(tree_mutex_);
   }
 
+  /** @brief Check whether any leaf was modified since the last call and reset the change tracking. Change detection
+   *  must be enabled (see octomap::OcTree::enableChangeDetection()); the caller must hold the write lock. */
+  bool consumeChanges()
+  {
+    const bool changed = changedKeysBegin() != changedKeysEnd();
+    resetChangeDetection();
+    return changed;
+  }
+
   void triggerUpdateCallback()
   {
     if (update_callback_)
@@ -63,7 +63,8 @@ public:
 
   /** \brief A copy constructor.
    * \e other should not be changed while the copy constructor is running
-   * This does copy on write and should be quick. */
+   * This does copy on write and runs in constant time: the object index is shared until either world changes, and
+   * objects are only copied once they are modified. */
   World(const World& other);
 
   virtual ~World();
@@ -127,22 +128,22 @@ public:
   /** iterator pointing to first change */
   const_iterator begin() const
   {
-    return objects_.begin();
+    return objects_->begin();
   }
   /** iterator pointing to end of changes */
   const_iterator end() const
   {
-    return objects_.end();
+    return objects_->end();
   }
   /** number of changes stored */
   std::size_t size() const
   {
-    return objects_.size();
+    return objects_->size();
   }
   /** find changes for a named object */
   const_iterator find(const std::string& object_id) const
   {
-    return objects_.find(object_id);
+    return objects_->find(object_id);
   }
 
   /** \brief Check if a particular object exists in the collision world*/
@@ -212,11 +213,54 @@ public:
                 EigenSTL::vector_Isometry3d{ shape_pose });
   }
 
+  /** \brief Add several fully specified objects at once.
+   * Each object must have its id, pose, shapes, shape poses and subframes set; the global poses are computed here.
+   * An object replaces any object with the same id in the world, which is reported as a DESTROY of the old object
+   * followed by a CREATE of the new one. Observers registered with a batch callback receive all changes in a single
+   * call, so that they can update their derived data in one pass. */
+  void addObjects(const std::vector<ObjectPtr>& objects);
+
+  /** \brief Start collecting changes instead of notifying observers about each of them.
+   * The objects are still updated right away, but observers (e.g. collision environments) only learn about the
+   * changes in commitTransaction(). Several changes to the same object are merged into one. Transactions nest, only
+   * the outermost commit notifies the observers. */
+  void beginTransaction();
+
+  /** \brief Notify observers about all changes collected since the matching beginTransaction().
+   * Observers registered with a batch callback receive all changes in a single call. */
+  void commitTransaction();
+
+  /** \brief Begins a transaction on construction and commits it on destruction, also when an exception is thrown
+   * in between, so that the world never stays in a transaction and keeps holding back notifications. */
+  class ScopedTransaction
+  {
+  public:
+    explicit ScopedTransaction(World& world) : world_(world)
+    {
+      world_.beginTransaction();
+    }
+    ~ScopedTransaction()
+    {
+      world_.commitTransaction();
+    }
+    ScopedTransaction(const ScopedTransaction&) = delete;
+    ScopedTransaction& operator=(const ScopedTransaction&) = delete;
+
+  private:
+    World& world_;
+  };
+
   /** \brief Update the pose of a shape in an object. Shape equality is
    * verified by comparing pointers. Returns true on success. */
   bool moveShapeInObject(const std::string& object_id, const shapes::ShapeConstPtr& shape,
                          const Eigen::Isometry3d& shape_pose);
 
+  /** \brief Notify observers that the content of a shape in an object was modified in place (e.g. voxels of an octree
+   * were updated by a sensor). The shape and its pose are kept, so observers may refresh their derived data
+   * incrementally instead of rebuilding it. Shape equality is verified by comparing pointers.
+   * Returns true on success. */
+  bool updateShapeInObject(const std::string& object_id, const shapes::ShapeConstPtr& shape);
+
   /** \brief Update the pose of all shapes in an object. Shape size is verified. Returns true on success. */
   bool moveShapesInObject(const std::string& object_id, const EigenSTL::vector_Isometry3d& shape_poses);
 
@@ -259,6 +303,7 @@ public:
     MOVE_SHAPE = 4,    /** one or more shapes in object were moved */
     ADD_SHAPE = 8,     /** shape(s) were added to object */
     REMOVE_SHAPE = 16, /** shape(s) were removed from object */
+    UPDATE_SHAPE = 32, /** content of shape(s) in object was modified in place */
   };
 
   /** \brief Represents an action that occurred on an object in the world.
@@ -303,12 +348,21 @@ public:
 
   using ObserverCallbackFn = std::function<void(const ObjectConstPtr&, Action)>;
 
+  /** \brief Changes to several objects, in the order in which they occurred */
+  using ObjectChanges = std::vector<std::pair<ObjectConstPtr, Action>>;
+  using ObserverBatchCallbackFn = std::function<void(const ObjectChanges&)>;
+
   /** \brief register a callback function for notification of changes.
    * \e callback will be called right after any change occurs to any Object.
    * \e observer is the object which is requesting the changes.  It is only
    * used for identifying the callback in removeObserver(). */
   ObserverHandle addObserver(const ObserverCallbackFn& callback);
 
+  /** \brief register callback functions for notification of changes.
+   * Changes made together, e.g. by addObjects(), are passed to \e batch_callback in a single call.
+   * All other changes are passed to \e callback. */
+  ObserverHandle addObserver(const ObserverCallbackFn& callback, const ObserverBatchCallbackFn& batch_callback);
+
   /** \brief remove a notifier callback */
   void removeObserver(const ObserverHandle observer_handle);
 
@@ -320,6 +374,21 @@ private:
   /** notify all observers of a change */
   void notify(const ObjectConstPtr& /*obj*/, Action /*action*/);
 
+  /** notify all observers of changes made together. Observers without a batch callback are notified per object. */
+  void notify(const ObjectChanges& changes);
+
+  /** merge a change into the changes of the current transaction */
+  void recordChange(const ObjectConstPtr& obj, Action action);
+
+  /** A change collected during a transaction. Objects that still exist are looked up on commit, as references held
+   * here would make ensureUnique() copy the objects on their next change. */
+  struct TransactionChange
+  {
+    std::string id;
+    ObjectConstPtr destroyed_object;  // only set for DESTROY, the object is not in the world anymore
+    Action action;
+  };
+
   /** send notification of change to all objects. */
   void notifyAll(Action action);
 
@@ -328,6 +397,10 @@ private:
    * clone is made so that it can be safely modified later on. */
   void ensureUnique(ObjectPtr& obj);
 
+  /** \brief Get the object index for modification, copying it first if it is shared with other worlds.
+   * Must be called before any object is modified, so that ensureUnique() sees the references held by other worlds. */
+  std::map<std::string, ObjectPtr>& getObjectsForWriting();
+
   /* Add a shape with no checking */
   virtual void addToObjectInternal(const ObjectPtr& obj, const shapes::ShapeConstPtr& shape,
                                    const Eigen::Isometry3d& shape_pose);
@@ -335,20 +408,31 @@ private:
   /** \brief Updates the global shape and subframe poses. */
   void updateGlobalPosesInternal(ObjectPtr& obj, bool update_shape_poses = true, bool update_subframe_poses = true);
 
-  /** The objects maintained in the world */
-  std::map<std::string, ObjectPtr> objects_;
+  /** The objects maintained in the world, shared with copies of this world until either is modified */
+  std::shared_ptr<std::map<std::string, ObjectPtr>> objects_;
 
   /** Wrapper for a callback function to call when something changes in the world */
   class Observer
   {
   public:
-    Observer(const ObserverCallbackFn& callback) : callback_(callback)
+    Observer(const ObserverCallbackFn& callback, const ObserverBatchCallbackFn& batch_callback)
+      : callback_(callback), batch_callback_(batch_callback)
     {
     }
     ObserverCallbackFn callback_;
+    ObserverBatchCallbackFn batch_callback_;
   };
 
   /// All registered observers of this world representation
   std::vector<Observer*> observers_;
+
+  /// Nesting depth of beginTransaction() calls
+  unsigned int transaction_depth_ = 0;
+
+  /// Changes collected during the current transaction, at most one per object unless it was destroyed and recreated
+  std::vector<TransactionChange> transaction_changes_;
+
+  /// Index of the latest entry of each object in transaction_changes_
+  std::map<std::string, std::size_t> transaction_change_index_;
 };
 }  // namespace collision_detection
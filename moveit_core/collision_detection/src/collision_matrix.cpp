@@ -37,8 +37,10 @@
 #include <moveit/collision_detection/collision_matrix.hpp>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
+#include <algorithm>
 #include <functional>
 #include <iomanip>
+#include <memory>
 #include <moveit/utils/logger.hpp>
 
 namespace collision_detection
@@ -49,12 +51,41 @@ rclcpp::Logger getLogger()
 {
   return moveit::getLogger("moveit.core.collision_detection_matrix");
 }
+
+std::atomic<std::uint32_t> next_compiled_id{ 1 };
+
+// combine the codes of two default entries like AllowedCollisionMatrix::getDefaultEntry() combines their types
+std::uint8_t combineDefaultCodes(std::uint8_t code1, std::uint8_t code2)
+{
+  if (code1 == 0 || code2 == 0)
+    return std::max(code1, code2);
+  if (code1 == AllowedCollision::NEVER + 1 || code2 == AllowedCollision::NEVER + 1)
+    return AllowedCollision::NEVER + 1;
+  if (code1 == AllowedCollision::CONDITIONAL + 1 || code2 == AllowedCollision::CONDITIONAL + 1)
+    return AllowedCollision::CONDITIONAL + 1;
+  return AllowedCollision::ALWAYS + 1;
+}
 }  // namespace
 
 AllowedCollisionMatrix::AllowedCollisionMatrix()
 {
 }
 
+AllowedCollisionMatrix::AllowedCollisionMatrix(const AllowedCollisionMatrix& acm)
+  : data_(acm.data_), compiled_(std::atomic_load(&acm.compiled_))
+{
+}
+
+AllowedCollisionMatrix& AllowedCollisionMatrix::operator=(const AllowedCollisionMatrix& acm)
+{
+  if (this != &acm)
+  {
+    data_ = acm.data_;
+    std::atomic_store(&compiled_, std::atomic_load(&acm.compiled_));
+  }
+  return *this;
+}
+
 AllowedCollisionMatrix::AllowedCollisionMatrix(const std::vector<std::string>& names, const bool allowed)
 {
   for (std::size_t i = 0; i < names.size(); ++i)
@@ -114,8 +145,8 @@ AllowedCollisionMatrix::AllowedCollisionMatrix(const moveit_msgs::msg::AllowedCo
 
 bool AllowedCollisionMatrix::getEntry(const std::string& name1, const std::string& name2, DecideContactFn& fn) const
 {
-  const auto it1 = allowed_contacts_.find(name1);
-  if (it1 == allowed_contacts_.end())
+  const auto it1 = data_->allowed_contacts_.find(name1);
+  if (it1 == data_->allowed_contacts_.end())
     return false;
   const auto it2 = it1->second.find(name2);
   if (it2 == it1->second.end())
@@ -127,8 +158,8 @@ bool AllowedCollisionMatrix::getEntry(const std::string& name1, const std::strin
 bool AllowedCollisionMatrix::getEntry(const std::string& name1, const std::string& name2,
                                       AllowedCollision::Type& allowed_collision) const
 {
-  const auto it1 = entries_.find(name1);
-  if (it1 == entries_.end())
+  const auto it1 = data_->entries_.find(name1);
+  if (it1 == data_->entries_.end())
     return false;
   auto it2 = it1->second.find(name2);
   if (it2 == it1->second.end())
@@ -139,13 +170,13 @@ bool AllowedCollisionMatrix::getEntry(const std::string& name1, const std::strin
 
 bool AllowedCollisionMatrix::hasEntry(const std::string& name) const
 {
-  return entries_.find(name) != entries_.end();
+  return data_->entries_.find(name) != data_->entries_.end();
 }
 
 bool AllowedCollisionMatrix::hasEntry(const std::string& name1, const std::string& name2) const
 {
-  const auto it1 = entries_.find(name1);
-  if (it1 == entries_.end())
+  const auto it1 = data_->entries_.find(name1);
+  if (it1 == data_->entries_.end())
     return false;
   const auto it2 = it1->second.find(name2);
   return it2 != it1->second.end();
@@ -153,73 +184,80 @@ bool AllowedCollisionMatrix::hasEntry(const std::string& name1, const std::strin
 
 void AllowedCollisionMatrix::setEntry(const std::string& name1, const std::string& name2, const bool allowed)
 {
+  Data& data = getDataForWriting(true);
   const AllowedCollision::Type v = allowed ? AllowedCollision::ALWAYS : AllowedCollision::NEVER;
-  entries_[name1][name2] = entries_[name2][name1] = v;
+  data.entries_[name1][name2] = data.entries_[name2][name1] = v;
 
   // remove function pointers, if any
-  auto it = allowed_contacts_.find(name1);
-  if (it != allowed_contacts_.end())
+  auto it = data.allowed_contacts_.find(name1);
+  if (it != data.allowed_contacts_.end())
   {
     auto jt = it->second.find(name2);
     if (jt != it->second.end())
       it->second.erase(jt);
   }
-  it = allowed_contacts_.find(name2);
-  if (it != allowed_contacts_.end())
+  it = data.allowed_contacts_.find(name2);
+  if (it != data.allowed_contacts_.end())
   {
     auto jt = it->second.find(name1);
     if (jt != it->second.end())
       it->second.erase(jt);
   }
+  updateCompiled(name1, name2);
 }
 
 void AllowedCollisionMatrix::setEntry(const std::string& name1, const std::string& name2, DecideContactFn& fn)
 {
-  entries_[name1][name2] = entries_[name2][name1] = AllowedCollision::CONDITIONAL;
-  allowed_contacts_[name1][name2] = allowed_contacts_[name2][name1] = fn;
+  Data& data = getDataForWriting(true);
+  data.entries_[name1][name2] = data.entries_[name2][name1] = AllowedCollision::CONDITIONAL;
+  data.allowed_contacts_[name1][name2] = data.allowed_contacts_[name2][name1] = fn;
+  updateCompiled(name1, name2);
 }
 
 void AllowedCollisionMatrix::removeEntry(const std::string& name)
 {
-  entries_.erase(name);
-  allowed_contacts_.erase(name);
-  for (auto& entry : entries_)
+  Data& data = getDataForWriting();
+  data.entries_.erase(name);
+  data.allowed_contacts_.erase(name);
+  for (auto& entry : data.entries_)
     entry.second.erase(name);
-  for (auto& allowed_contact : allowed_contacts_)
+  for (auto& allowed_contact : data.allowed_contacts_)
     allowed_contact.second.erase(name);
 }
 
 void AllowedCollisionMatrix::removeEntry(const std::string& name1, const std::string& name2)
 {
-  auto jt = entries_.find(name1);
-  if (jt != entries_.end())
+  Data& data = getDataForWriting(true);
+  auto jt = data.entries_.find(name1);
+  if (jt != data.entries_.end())
   {
     auto it = jt->second.find(name2);
     if (it != jt->second.end())
       jt->second.erase(it);
   }
-  jt = entries_.find(name2);
-  if (jt != entries_.end())
+  jt = data.entries_.find(name2);
+  if (jt != data.entries_.end())
   {
     auto it = jt->second.find(name1);
     if (it != jt->second.end())
       jt->second.erase(it);
   }
 
-  auto it = allowed_contacts_.find(name1);
-  if (it != allowed_contacts_.end())
+  auto it = data.allowed_contacts_.find(name1);
+  if (it != data.allowed_contacts_.end())
   {
     auto jt = it->second.find(name2);
     if (jt != it->second.end())
       it->second.erase(jt);
   }
-  it = allowed_contacts_.find(name2);
-  if (it != allowed_contacts_.end())
+  it = data.allowed_contacts_.find(name2);
+  if (it != data.allowed_contacts_.end())
   {
     auto jt = it->second.find(name1);
     if (jt != it->second.end())
       it->second.erase(jt);
   }
+  updateCompiled(name1, name2);
 }
 
 void AllowedCollisionMatrix::setEntry(const std::string& name, const std::vector<std::string>& other_names,
@@ -241,8 +279,10 @@ void AllowedCollisionMatrix::setEntry(const std::vector<std::string>& names1, co
 
 void AllowedCollisionMatrix::setEntry(const std::string& name, const bool allowed)
 {
+  // every pair is set through setEntry(name1, name2, allowed), which updates the compiled snapshot
+  Data& data = getDataForWriting(true);
   std::string last = name;
-  for (auto& entry : entries_)
+  for (auto& entry : data.entries_)
   {
     if (name != entry.first && last != entry.first)
     {
@@ -254,8 +294,9 @@ void AllowedCollisionMatrix::setEntry(const std::string& name, const bool allowe
 
 void AllowedCollisionMatrix::setEntry(const bool allowed)
 {
+  Data& data = getDataForWriting();
   const AllowedCollision::Type v = allowed ? AllowedCollision::ALWAYS : AllowedCollision::NEVER;
-  for (auto& entry : entries_)
+  for (auto& entry : data.entries_)
   {
     for (auto& it2 : entry.second)
       it2.second = v;
@@ -264,21 +305,23 @@ void AllowedCollisionMatrix::setEntry(const bool allowed)
 
 void AllowedCollisionMatrix::setDefaultEntry(const std::string& name, const bool allowed)
 {
+  Data& data = getDataForWriting();
   const AllowedCollision::Type v = allowed ? AllowedCollision::ALWAYS : AllowedCollision::NEVER;
-  default_entries_[name] = v;
-  default_allowed_contacts_.erase(name);
+  data.default_entries_[name] = v;
+  data.default_allowed_contacts_.erase(name);
 }
 
 void AllowedCollisionMatrix::setDefaultEntry(const std::string& name, DecideContactFn& fn)
 {
-  default_entries_[name] = AllowedCollision::CONDITIONAL;
-  default_allowed_contacts_[name] = fn;
+  Data& data = getDataForWriting();
+  data.default_entries_[name] = AllowedCollision::CONDITIONAL;
+  data.default_allowed_contacts_[name] = fn;
 }
 
 bool AllowedCollisionMatrix::getDefaultEntry(const std::string& name, AllowedCollision::Type& allowed_collision) const
 {
-  auto it = default_entries_.find(name);
-  if (it == default_entries_.end())
+  auto it = data_->default_entries_.find(name);
+  if (it == data_->default_entries_.end())
     return false;
   allowed_collision = it->second;
   return true;
@@ -286,8 +329,8 @@ bool AllowedCollisionMatrix::getDefaultEntry(const std::string& name, AllowedCol
 
 bool AllowedCollisionMatrix::getDefaultEntry(const std::string& name, DecideContactFn& fn) const
 {
-  auto it = default_allowed_contacts_.find(name);
-  if (it == default_allowed_contacts_.end())
+  auto it = data_->default_allowed_contacts_.find(name);
+  if (it == data_->default_allowed_contacts_.end())
     return false;
   fn = it->second;
   return true;
@@ -371,19 +414,73 @@ bool AllowedCollisionMatrix::getAllowedCollision(const std::string& name1, const
 
 void AllowedCollisionMatrix::clear()
 {
-  entries_.clear();
-  allowed_contacts_.clear();
-  default_entries_.clear();
-  default_allowed_contacts_.clear();
+  Data& data = getDataForWriting();
+  data.entries_.clear();
+  data.allowed_contacts_.clear();
+  data.default_entries_.clear();
+  data.default_allowed_contacts_.clear();
+}
+
+AllowedCollisionMatrix::Data& AllowedCollisionMatrix::getDataForWriting(bool keep_compiled)
+{
+  if (!keep_compiled)
+    std::atomic_store(&compiled_, CompiledAllowedCollisionMatrixPtr());
+  if (data_.use_count() != 1)
+    data_ = std::make_shared<Data>(*data_);
+  return *data_;
+}
+
+void AllowedCollisionMatrix::updateCompiled(const std::string& name1, const std::string& name2)
+{
+  CompiledAllowedCollisionMatrixPtr compiled = std::atomic_load(&compiled_);
+  if (!compiled)
+    return;
+  const std::uint32_t index1 = compiled->getIndex(name1);
+  const std::uint32_t index2 = compiled->getIndex(name2);
+  if (index1 == CompiledAllowedCollisionMatrix::NO_INDEX || index2 == CompiledAllowedCollisionMatrix::NO_INDEX)
+  {
+    // new names need new indices, so recompile on the next call to getCompiled()
+    std::atomic_store(&compiled_, CompiledAllowedCollisionMatrixPtr());
+    return;
+  }
+
+  // snapshots that were handed out, or are shared with copies of this matrix, must not change
+  if (compiled.use_count() > 2)
+  {
+    compiled = std::make_shared<CompiledAllowedCollisionMatrix>(*compiled);
+    compiled->renewId();
+  }
+
+  AllowedCollision::Type type;
+  std::uint64_t code;
+  if (getEntry(name1, name2, type))
+    code = type + 1;
+  else
+    code = combineDefaultCodes(compiled->default_codes_[index1], compiled->default_codes_[index2]);
+  compiled->setCode(index1, index2, code);
+  compiled->setCode(index2, index1, code);
+  std::atomic_store(&compiled_, compiled);
+}
+
+CompiledAllowedCollisionMatrixConstPtr AllowedCollisionMatrix::getCompiled() const
+{
+  CompiledAllowedCollisionMatrixPtr compiled = std::atomic_load(&compiled_);
+  if (!compiled)
+  {
+    // concurrent callers may both compile, which is harmless as the snapshots are equivalent
+    compiled = std::make_shared<CompiledAllowedCollisionMatrix>(*this);
+    std::atomic_store(&compiled_, compiled);
+  }
+  return compiled;
 }
 
 void AllowedCollisionMatrix::getAllEntryNames(std::vector<std::string>& names) const
 {
   names.clear();
-  for (const auto& entry : entries_)
+  for (const auto& entry : data_->entries_)
     names.push_back(entry.first);
 
-  for (const auto& item : default_entries_)
+  for (const auto& item : data_->default_entries_)
   {
     auto it = std::lower_bound(names.begin(), names.end(), item.first);
     if (it != names.end() && *it != item.first)
@@ -490,4 +587,66 @@ void AllowedCollisionMatrix::print(std::ostream& out) const
   }
 }
 
+CompiledAllowedCollisionMatrix::CompiledAllowedCollisionMatrix(const AllowedCollisionMatrix& acm)
+{
+  renewId();
+
+  for (const auto& entry : acm.data_->entries_)
+  {
+    names_.push_back(entry.first);
+    for (const auto& other : entry.second)
+      names_.push_back(other.first);
+  }
+  for (const auto& default_entry : acm.data_->default_entries_)
+    names_.push_back(default_entry.first);
+  std::sort(names_.begin(), names_.end());
+  names_.erase(std::unique(names_.begin(), names_.end()), names_.end());
+
+  const std::size_t size = names_.size();
+  bits_.assign((2 * size * size + 63) / 64, 0);
+
+  // pairs without an entry use the defaults of both elements
+  default_codes_.assign(size, 0);
+  for (const auto& default_entry : acm.data_->default_entries_)
+    default_codes_[getIndex(default_entry.first)] = default_entry.second + 1;
+  if (!acm.data_->default_entries_.empty())
+  {
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      for (std::size_t j = 0; j < size; ++j)
+        setCode(i, j, combineDefaultCodes(default_codes_[i], default_codes_[j]));
+    }
+  }
+
+  for (const auto& entry : acm.data_->entries_)
+  {
+    const std::uint32_t index1 = getIndex(entry.first);
+    for (const auto& other : entry.second)
+      setCode(index1, getIndex(other.first), other.second + 1);
+  }
+}
+
+void CompiledAllowedCollisionMatrix::renewId()
+{
+  // 0 marks an empty index cache
+  do
+  {
+    id_ = next_compiled_id.fetch_add(1, std::memory_order_relaxed);
+  } while (id_ == 0);
+}
+
+void CompiledAllowedCollisionMatrix::setCode(std::size_t index1, std::size_t index2, std::uint64_t code)
+{
+  const std::size_t bit = 2 * (index1 * names_.size() + index2);
+  bits_[bit / 64] = (bits_[bit / 64] & ~(std::uint64_t{ 3 } << (bit % 64))) | (code << (bit % 64));
+}
+
+std::uint32_t CompiledAllowedCollisionMatrix::getIndex(const std::string& name) const
+{
+  const auto it = std::lower_bound(names_.begin(), names_.end(), name);
+  if (it == names_.end() || *it != name)
+    return NO_INDEX;
+  return static_cast<std::uint32_t>(it - names_.begin());
+}
+
 }  // end of namespace collision_detection
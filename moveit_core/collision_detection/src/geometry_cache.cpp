@@ -0,0 +1,370 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/collision_detection/geometry_cache.hpp>
+#include <moveit/utils/logger.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <rclcpp/logging.hpp>
+#include <string>
+
+namespace collision_detection
+{
+namespace
+{
+rclcpp::Logger getLogger()
+{
+  return moveit::getLogger("moveit.core.collision_detection.geometry_cache");
+}
+
+// 64 bit FNV-1a
+class Hasher
+{
+public:
+  void add(const void* data, std::size_t bytes)
+  {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < bytes; ++i)
+    {
+      hash_ ^= p[i];
+      hash_ *= 1099511628211ull;
+    }
+  }
+
+  template <typename T>
+  void add(const T& value)
+  {
+    add(&value, sizeof(T));
+  }
+
+  std::uint64_t get() const
+  {
+    return hash_;
+  }
+
+private:
+  std::uint64_t hash_ = 14695981039346656037ull;
+};
+}  // namespace
+
+bool computeShapeHash(const shapes::Shape& shape, std::uint64_t& hash, ShapeCounts& counts)
+{
+  counts = ShapeCounts();
+  if (shape.type == shapes::MESH)
+  {
+    counts.vertex_count = static_cast<const shapes::Mesh&>(shape).vertex_count;
+    counts.triangle_count = static_cast<const shapes::Mesh&>(shape).triangle_count;
+  }
+  return computeShapeHash(shape, hash);
+}
+
+bool computeShapeHash(const shapes::Shape& shape, std::uint64_t& hash)
+{
+  Hasher hasher;
+  hasher.add(static_cast<int>(shape.type));
+  switch (shape.type)
+  {
+    case shapes::SPHERE:
+      hasher.add(static_cast<const shapes::Sphere&>(shape).radius);
+      break;
+    case shapes::CYLINDER:
+      hasher.add(static_cast<const shapes::Cylinder&>(shape).radius);
+      hasher.add(static_cast<const shapes::Cylinder&>(shape).length);
+      break;
+    case shapes::CONE:
+      hasher.add(static_cast<const shapes::Cone&>(shape).radius);
+      hasher.add(static_cast<const shapes::Cone&>(shape).length);
+      break;
+    case shapes::BOX:
+      hasher.add(static_cast<const shapes::Box&>(shape).size, 3 * sizeof(double));
+      break;
+    case shapes::PLANE:
+    {
+      const shapes::Plane& plane = static_cast<const shapes::Plane&>(shape);
+      hasher.add(plane.a);
+      hasher.add(plane.b);
+      hasher.add(plane.c);
+      hasher.add(plane.d);
+    }
+    break;
+    case shapes::MESH:
+    {
+      const shapes::Mesh& mesh = static_cast<const shapes::Mesh&>(shape);
+      hasher.add(mesh.vertex_count);
+      hasher.add(mesh.triangle_count);
+      if (mesh.vertex_count > 0)
+        hasher.add(mesh.vertices, 3 * mesh.vertex_count * sizeof(double));
+      if (mesh.triangle_count > 0)
+        hasher.add(mesh.triangles, 3 * mesh.triangle_count * sizeof(unsigned int));
+    }
+    break;
+    default:
+      return false;
+  }
+  hash = hasher.get();
+  return true;
+}
+
+struct GeometryCache::Entry
+{
+  /** \brief Set while the value is being read or built */
+  std::shared_future<Value> pending;
+  Value value;
+  std::size_t bytes = 0;
+  ShapeCounts counts;
+  std::list<Key>::iterator lru;
+};
+
+const std::size_t GeometryCache::DEFAULT_MEMORY_BUDGET = 256 * 1024 * 1024;
+
+GeometryCache& GeometryCache::getInstance()
+{
+  static GeometryCache cache;
+  return cache;
+}
+
+GeometryCache::GeometryCache() : memory_usage_(0), memory_budget_(DEFAULT_MEMORY_BUDGET)
+{
+}
+
+GeometryCache::Value GeometryCache::getErased(const std::string& kind, std::uint64_t hash, const ShapeCounts& counts,
+                                              const std::function<Value()>& build,
+                                              const std::function<std::size_t(const void*)>& size,
+                                              const ErasedSerializer* serializer)
+{
+  const Key key(kind, hash);
+  std::promise<Value> promise;
+  std::shared_future<Value> pending;
+  std::shared_ptr<Entry> entry;
+  std::string path;
+  {
+    std::scoped_lock lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end() && !(it->second->counts == counts))
+    {
+      // a different shape with the same hash, which keeps the cached entry
+      RCLCPP_WARN(getLogger(), "Hash collision in geometry cache '%s', converting the shape without caching",
+                  kind.c_str());
+    }
+    else if (it != entries_.end())
+    {
+      lru_.splice(lru_.begin(), lru_, it->second->lru);
+      if (it->second->value)
+        return it->second->value;
+      pending = it->second->pending;
+    }
+    else
+    {
+      entry = std::make_shared<Entry>();
+      entry->counts = counts;
+      entry->pending = promise.get_future().share();
+      lru_.push_front(key);
+      entry->lru = lru_.begin();
+      entries_[key] = entry;
+      if (serializer && !storage_directory_.empty())
+        path = getStoragePath(key);
+    }
+  }
+
+  // another thread is already producing this entry
+  if (pending.valid())
+    return pending.get();
+  if (!entry)
+    return build();
+
+  Value value;
+  try
+  {
+    if (!path.empty())
+    {
+      std::ifstream in(path, std::ios::binary);
+      if (in)
+      {
+        // files of colliding shapes, or without counts, are rebuilt
+        ShapeCounts stored_counts;
+        in.read(reinterpret_cast<char*>(&stored_counts.vertex_count), sizeof(stored_counts.vertex_count));
+        in.read(reinterpret_cast<char*>(&stored_counts.triangle_count), sizeof(stored_counts.triangle_count));
+        if (in && stored_counts == counts)
+          value = serializer->read(in);
+        if (!value)
+          RCLCPP_WARN(getLogger(), "Ignoring unreadable cache file '%s'", path.c_str());
+      }
+    }
+    if (!value)
+    {
+      value = build();
+      if (value && !path.empty())
+      {
+        // write to a temporary file first, so concurrent readers never see a partial entry
+        const std::string tmp_path = path + ".tmp" + std::to_string(reinterpret_cast<std::uintptr_t>(entry.get()));
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&counts.vertex_count), sizeof(counts.vertex_count));
+        out.write(reinterpret_cast<const char*>(&counts.triangle_count), sizeof(counts.triangle_count));
+        bool written = out && serializer->write(value.get(), out);
+        out.close();
+        std::error_code ec;
+        if (written && out)
+          std::filesystem::rename(tmp_path, path, ec);
+        if (!written || !out || ec)
+        {
+          RCLCPP_WARN(getLogger(), "Could not write cache file '%s'", path.c_str());
+          std::filesystem::remove(tmp_path, ec);
+        }
+      }
+    }
+  }
+  catch (...)
+  {
+    {
+      std::scoped_lock lock(mutex_);
+      auto it = entries_.find(key);
+      if (it != entries_.end() && it->second == entry)
+      {
+        lru_.erase(entry->lru);
+        entries_.erase(it);
+      }
+    }
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+
+  {
+    std::scoped_lock lock(mutex_);
+    auto it = entries_.find(key);
+    // the entry may have been removed by clear() in the meantime
+    if (it != entries_.end() && it->second == entry)
+    {
+      if (value)
+      {
+        entry->value = value;
+        entry->bytes = size(value.get());
+        entry->pending = std::shared_future<Value>();
+        memory_usage_ += entry->bytes;
+        evict();
+      }
+      else
+      {
+        // failed conversions are not cached, so they are attempted again next time
+        lru_.erase(entry->lru);
+        entries_.erase(it);
+      }
+    }
+  }
+  promise.set_value(value);
+  return value;
+}
+
+void GeometryCache::evict()
+{
+  for (auto it = lru_.end(); memory_usage_ > memory_budget_ && it != lru_.begin();)
+  {
+    --it;
+    auto entry_it = entries_.find(*it);
+    const Entry& entry = *entry_it->second;
+    // entries still in use elsewhere would not release any memory
+    if (entry.value && entry.value.use_count() == 1)
+    {
+      memory_usage_ -= entry.bytes;
+      entries_.erase(entry_it);
+      it = lru_.erase(it);
+    }
+  }
+}
+
+void GeometryCache::setMemoryBudget(std::size_t bytes)
+{
+  std::scoped_lock lock(mutex_);
+  memory_budget_ = bytes;
+  evict();
+}
+
+std::size_t GeometryCache::getMemoryBudget() const
+{
+  std::scoped_lock lock(mutex_);
+  return memory_budget_;
+}
+
+std::size_t GeometryCache::getMemoryUsage() const
+{
+  std::scoped_lock lock(mutex_);
+  return memory_usage_;
+}
+
+std::size_t GeometryCache::size() const
+{
+  std::scoped_lock lock(mutex_);
+  return entries_.size();
+}
+
+bool GeometryCache::setStorageDirectory(const std::string& directory)
+{
+  if (!directory.empty())
+  {
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (!std::filesystem::is_directory(directory, ec))
+    {
+      RCLCPP_ERROR(getLogger(), "Cannot use '%s' as geometry cache directory", directory.c_str());
+      return false;
+    }
+  }
+  std::scoped_lock lock(mutex_);
+  storage_directory_ = directory;
+  return true;
+}
+
+std::string GeometryCache::getStorageDirectory() const
+{
+  std::scoped_lock lock(mutex_);
+  return storage_directory_;
+}
+
+void GeometryCache::clear()
+{
+  std::scoped_lock lock(mutex_);
+  entries_.clear();
+  lru_.clear();
+  memory_usage_ = 0;
+}
+
+std::string GeometryCache::getStoragePath(const Key& key) const
+{
+  char hash[17];
+  std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(key.second));
+  return (std::filesystem::path(storage_directory_) / (key.first + '_' + hash + ".bin")).string();
+}
+}  // namespace collision_detection
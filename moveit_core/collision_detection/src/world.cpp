@@ -40,6 +40,8 @@
 #include <rclcpp/logging.hpp>
 #include <moveit/utils/logger.hpp>
 
+#include <algorithm>
+
 namespace collision_detection
 {
 namespace
@@ -50,13 +52,12 @@ rclcpp::Logger getLogger()
 }
 }  // namespace
 
-World::World()
+World::World() : objects_(std::make_shared<std::map<std::string, ObjectPtr>>())
 {
 }
 
-World::World(const World& other)
+World::World(const World& other) : objects_(other.objects_)
 {
-  objects_ = other.objects_;
 }
 
 World::~World()
@@ -90,7 +91,8 @@ void World::addToObject(const std::string& object_id, const Eigen::Isometry3d& p
 
   int action = ADD_SHAPE;
 
-  ObjectPtr& obj = objects_[object_id];
+  std::map<std::string, ObjectPtr>& objects = getObjectsForWriting();
+  ObjectPtr& obj = objects[object_id];
   if (!obj)
   {
     obj = std::make_shared<Object>(object_id);
@@ -106,19 +108,51 @@ void World::addToObject(const std::string& object_id, const Eigen::Isometry3d& p
   notify(obj, Action(action));
 }
 
+void World::addObjects(const std::vector<ObjectPtr>& objects)
+{
+  ObjectChanges changes;
+  changes.reserve(objects.size());
+  std::map<std::string, ObjectPtr>& world_objects = getObjectsForWriting();
+  for (const ObjectPtr& obj : objects)
+  {
+    if (obj->shapes_.size() != obj->shape_poses_.size())
+    {
+      RCLCPP_ERROR(getLogger(), "Number of shapes and number of poses of object '%s' do not match. Not adding it to "
+                                "collision world.",
+                   obj->id_.c_str());
+      continue;
+    }
+    if (obj->shapes_.empty())
+      continue;
+
+    ASSERT_ISOMETRY(obj->pose_)  // unsanitized input, could contain a non-isometry
+    obj->global_shape_poses_.resize(obj->shape_poses_.size());
+    obj->global_subframe_poses_ = obj->subframe_poses_;
+    ObjectPtr& slot = world_objects[obj->id_];
+    if (slot)
+      changes.emplace_back(slot, DESTROY);
+    slot = obj;
+    updateGlobalPosesInternal(slot);
+    changes.emplace_back(obj, Action(CREATE | ADD_SHAPE));
+  }
+
+  if (!changes.empty())
+    notify(changes);
+}
+
 std::vector<std::string> World::getObjectIds() const
 {
   std::vector<std::string> ids;
-  ids.reserve(objects_.size());
-  for (const auto& object : objects_)
+  ids.reserve(objects_->size());
+  for (const auto& object : *objects_)
     ids.push_back(object.first);
   return ids;
 }
 
 World::ObjectConstPtr World::getObject(const std::string& object_id) const
 {
-  const auto it = objects_.find(object_id);
-  if (it == objects_.end())
+  const auto it = objects_->find(object_id);
+  if (it == objects_->end())
   {
     return ObjectConstPtr();
   }
@@ -134,22 +168,29 @@ void World::ensureUnique(ObjectPtr& obj)
     obj = std::make_shared<Object>(*obj);
 }
 
+std::map<std::string, World::ObjectPtr>& World::getObjectsForWriting()
+{
+  if (objects_.use_count() != 1)
+    objects_ = std::make_shared<std::map<std::string, ObjectPtr>>(*objects_);
+  return *objects_;
+}
+
 bool World::hasObject(const std::string& object_id) const
 {
-  return objects_.find(object_id) != objects_.end();
+  return objects_->find(object_id) != objects_->end();
 }
 
 bool World::knowsTransform(const std::string& name) const
 {
   // Check object names first
-  const std::map<std::string, ObjectPtr>::const_iterator it = objects_.find(name);
-  if (it != objects_.end())
+  const std::map<std::string, ObjectPtr>::const_iterator it = objects_->find(name);
+  if (it != objects_->end())
   {
     return true;
   }
   else  // Then objects' subframes
   {
-    for (const std::pair<const std::string, ObjectPtr>& object : objects_)
+    for (const std::pair<const std::string, ObjectPtr>& object : *objects_)
     {
       // if "object name/" matches start of object_id, we found the matching object
       // rfind searches name for object.first in the first index (returns 0 if found)
@@ -177,14 +218,14 @@ const Eigen::Isometry3d& World::getTransform(const std::string& name, bool& fram
   // assume found
   frame_found = true;
 
-  const std::map<std::string, ObjectPtr>::const_iterator it = objects_.find(name);
-  if (it != objects_.end())
+  const std::map<std::string, ObjectPtr>::const_iterator it = objects_->find(name);
+  if (it != objects_->end())
   {
     return it->second->pose_;
   }
   else  // Search within subframes
   {
-    for (const std::pair<const std::string, ObjectPtr>& object : objects_)
+    for (const std::pair<const std::string, ObjectPtr>& object : *objects_)
     {
       // if "object name/" matches start of object_id, we found the matching object
       // rfind searches name for object.first in the first index (returns 0 if found)
@@ -207,8 +248,8 @@ const Eigen::Isometry3d& World::getTransform(const std::string& name, bool& fram
 
 const Eigen::Isometry3d& World::getGlobalShapeTransform(const std::string& object_id, const int shape_index) const
 {
-  const auto it = objects_.find(object_id);
-  if (it != objects_.end())
+  const auto it = objects_->find(object_id);
+  if (it != objects_->end())
   {
     return it->second->global_shape_poses_[shape_index];
   }
@@ -222,8 +263,8 @@ const Eigen::Isometry3d& World::getGlobalShapeTransform(const std::string& objec
 
 const EigenSTL::vector_Isometry3d& World::getGlobalShapeTransforms(const std::string& object_id) const
 {
-  const auto it = objects_.find(object_id);
-  if (it != objects_.end())
+  const auto it = objects_->find(object_id);
+  if (it != objects_->end())
   {
     return it->second->global_shape_poses_;
   }
@@ -238,8 +279,9 @@ const EigenSTL::vector_Isometry3d& World::getGlobalShapeTransforms(const std::st
 bool World::moveShapeInObject(const std::string& object_id, const shapes::ShapeConstPtr& shape,
                               const Eigen::Isometry3d& shape_pose)
 {
-  const auto it = objects_.find(object_id);
-  if (it != objects_.end())
+  std::map<std::string, ObjectPtr>& objects = getObjectsForWriting();
+  const auto it = objects.find(object_id);
+  if (it != objects.end())
   {
     const unsigned int n = it->second->shapes_.size();
     for (unsigned int i = 0; i < n; ++i)
@@ -259,13 +301,29 @@ bool World::moveShapeInObject(const std::string& object_id, const shapes::ShapeC
   return false;
 }
 
+bool World::updateShapeInObject(const std::string& object_id, const shapes::ShapeConstPtr& shape)
+{
+  const auto it = objects_->find(object_id);
+  if (it != objects_->end())
+  {
+    if (std::find(it->second->shapes_.begin(), it->second->shapes_.end(), shape) != it->second->shapes_.end())
+    {
+      notify(it->second, UPDATE_SHAPE);
+      return true;
+    }
+  }
+  return false;
+}
+
 bool World::moveShapesInObject(const std::string& object_id, const EigenSTL::vector_Isometry3d& shape_poses)
 {
-  auto it = objects_.find(object_id);
-  if (it != objects_.end())
+  std::map<std::string, ObjectPtr>& objects = getObjectsForWriting();
+  auto it = objects.find(object_id);
+  if (it != objects.end())
   {
     if (shape_poses.size() == it->second->shapes_.size())
     {
+      ensureUnique(it->second);
       for (std::size_t i = 0; i < shape_poses.size(); ++i)
       {
         ASSERT_ISOMETRY(shape_poses[i])  // unsanitized input, could contain a non-isometry
@@ -281,8 +339,8 @@ bool World::moveShapesInObject(const std::string& object_id, const EigenSTL::vec
 
 bool World::moveObject(const std::string& object_id, const Eigen::Isometry3d& transform)
 {
-  const auto it = objects_.find(object_id);
-  if (it == objects_.end())
+  const auto it = objects_->find(object_id);
+  if (it == objects_->end())
     return false;
   if (transform.isApprox(Eigen::Isometry3d::Identity()))
     return true;  // object already at correct location
@@ -294,7 +352,8 @@ bool World::moveObject(const std::string& object_id, const Eigen::Isometry3d& tr
 bool World::setObjectPose(const std::string& object_id, const Eigen::Isometry3d& pose)
 {
   ASSERT_ISOMETRY(pose);  // unsanitized input, could contain a non-isometry
-  ObjectPtr& obj = objects_[object_id];
+  std::map<std::string, ObjectPtr>& objects = getObjectsForWriting();
+  ObjectPtr& obj = objects[object_id];
   int action;
   if (!obj)
   {
@@ -315,8 +374,9 @@ bool World::setObjectPose(const std::string& object_id, const Eigen::Isometry3d&
 
 bool World::removeShapeFromObject(const std::string& object_id, const shapes::ShapeConstPtr& shape)
 {
-  const auto it = objects_.find(object_id);
-  if (it != objects_.end())
+  std::map<std::string, ObjectPtr>& objects = getObjectsForWriting();
+  const auto it = objects.find(object_id);
+  if (it != objects.end())
   {
     const unsigned int n = it->second->shapes_.size();
     for (unsigned int i = 0; i < n; ++i)
@@ -331,7 +391,7 @@ bool World::removeShapeFromObject(const std::string& object_id, const shapes::Sh
         if (it->second->shapes_.empty())
         {
           notify(it->second, DESTROY);
-          objects_.erase(it);
+          objects.erase(it);
         }
         else
         {
@@ -346,11 +406,12 @@ bool World::removeShapeFromObject(const std::string& object_id, const shapes::Sh
 
 bool World::removeObject(const std::string& object_id)
 {
-  const auto it = objects_.find(object_id);
-  if (it != objects_.end())
+  std::map<std::string, ObjectPtr>& objects = getObjectsForWriting();
+  const auto it = objects.find(object_id);
+  if (it != objects.end())
   {
     notify(it->second, DESTROY);
-    objects_.erase(it);
+    objects.erase(it);
     return true;
   }
   return false;
@@ -359,13 +420,15 @@ bool World::removeObject(const std::string& object_id)
 void World::clearObjects()
 {
   notifyAll(DESTROY);
-  objects_.clear();
+  // a new index leaves copies of this world untouched
+  objects_ = std::make_shared<std::map<std::string, ObjectPtr>>();
 }
 
 bool World::setSubframesOfObject(const std::string& object_id, const moveit::core::FixedTransformsMap& subframe_poses)
 {
-  const auto obj_pair = objects_.find(object_id);
-  if (obj_pair == objects_.end())
+  std::map<std::string, ObjectPtr>& objects = getObjectsForWriting();
+  const auto obj_pair = objects.find(object_id);
+  if (obj_pair == objects.end())
   {
     return false;
   }
@@ -373,6 +436,7 @@ bool World::setSubframesOfObject(const std::string& object_id, const moveit::cor
   {
     ASSERT_ISOMETRY(t.second)  // unsanitized input, could contain a non-isometry
   }
+  ensureUnique(obj_pair->second);
   obj_pair->second->subframe_poses_ = subframe_poses;
   obj_pair->second->global_subframe_poses_ = subframe_poses;
   updateGlobalPosesInternal(obj_pair->second, false, true);
@@ -402,7 +466,13 @@ void World::updateGlobalPosesInternal(ObjectPtr& obj, bool update_shape_poses, b
 
 World::ObserverHandle World::addObserver(const ObserverCallbackFn& callback)
 {
-  const auto o = new Observer(callback);
+  return addObserver(callback, ObserverBatchCallbackFn());
+}
+
+World::ObserverHandle World::addObserver(const ObserverCallbackFn& callback,
+                                         const ObserverBatchCallbackFn& batch_callback)
+{
+  const auto o = new Observer(callback, batch_callback);
   observers_.push_back(o);
   return ObserverHandle(o);
 }
@@ -420,18 +490,100 @@ void World::removeObserver(ObserverHandle observer_handle)
   }
 }
 
+void World::beginTransaction()
+{
+  ++transaction_depth_;
+}
+
+void World::commitTransaction()
+{
+  if (transaction_depth_ == 0)
+  {
+    RCLCPP_ERROR(getLogger(), "commitTransaction() called without a matching beginTransaction()");
+    return;
+  }
+  if (--transaction_depth_ > 0)
+    return;
+
+  std::vector<TransactionChange> recorded_changes;
+  recorded_changes.swap(transaction_changes_);
+  transaction_change_index_.clear();
+
+  ObjectChanges changes;
+  changes.reserve(recorded_changes.size());
+  for (TransactionChange& change : recorded_changes)
+  {
+    if (change.action == DESTROY)
+    {
+      changes.emplace_back(std::move(change.destroyed_object), DESTROY);
+      continue;
+    }
+    const auto it = objects_->find(change.id);
+    if (it != objects_->end())
+      changes.emplace_back(it->second, change.action);
+  }
+  if (!changes.empty())
+    notify(changes);
+}
+
+void World::recordChange(const ObjectConstPtr& obj, Action action)
+{
+  const auto it = transaction_change_index_.find(obj->id_);
+  if (it != transaction_change_index_.end())
+  {
+    TransactionChange& change = transaction_changes_[it->second];
+    // an object that was destroyed and created again is reported twice, so that the DESTROY bit stays exclusive
+    if (action == DESTROY || change.action != DESTROY)
+    {
+      change.action = action == DESTROY ? Action(DESTROY) : Action(change.action | action);
+      if (action == DESTROY)
+        change.destroyed_object = obj;
+      return;
+    }
+  }
+  transaction_change_index_[obj->id_] = transaction_changes_.size();
+  transaction_changes_.push_back({ obj->id_, action == DESTROY ? obj : nullptr, action });
+}
+
 void World::notifyAll(Action action)
 {
-  for (std::map<std::string, ObjectPtr>::const_iterator it = objects_.begin(); it != objects_.end(); ++it)
+  for (std::map<std::string, ObjectPtr>::const_iterator it = objects_->begin(); it != objects_->end(); ++it)
     notify(it->second, action);
 }
 
 void World::notify(const ObjectConstPtr& obj, Action action)
 {
+  if (transaction_depth_ > 0)
+  {
+    recordChange(obj, action);
+    return;
+  }
   for (Observer* observer : observers_)
     observer->callback_(obj, action);
 }
 
+void World::notify(const ObjectChanges& changes)
+{
+  if (transaction_depth_ > 0)
+  {
+    for (const std::pair<ObjectConstPtr, Action>& change : changes)
+      recordChange(change.first, change.second);
+    return;
+  }
+  for (Observer* observer : observers_)
+  {
+    if (observer->batch_callback_)
+    {
+      observer->batch_callback_(changes);
+    }
+    else
+    {
+      for (const std::pair<ObjectConstPtr, Action>& change : changes)
+        observer->callback_(change.first, change.second);
+    }
+  }
+}
+
 void World::notifyObserverAllObjects(const ObserverHandle observer_handle, Action action) const
 {
   for (auto observer : observers_)
@@ -439,7 +591,7 @@ void World::notifyObserverAllObjects(const ObserverHandle observer_handle, Actio
     if (observer == observer_handle.observer_)
     {
       // call the callback for each object
-      for (const auto& object : objects_)
+      for (const auto& object : *objects_)
         observer->callback_(object.second, action);
       break;
     }
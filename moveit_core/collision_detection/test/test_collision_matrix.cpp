@@ -0,0 +1,191 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+#include <moveit/collision_detection/collision_matrix.hpp>
+
+namespace
+{
+const std::vector<std::string> NAMES = { "a", "b", "c", "d", "unknown" };
+
+// the compiled matrix must agree with the map-based lookup for every pair of names
+void expectSameAllowedCollisions(const collision_detection::AllowedCollisionMatrix& acm)
+{
+  const collision_detection::CompiledAllowedCollisionMatrixConstPtr compiled = acm.getCompiled();
+  for (const std::string& name1 : NAMES)
+  {
+    for (const std::string& name2 : NAMES)
+    {
+      collision_detection::AllowedCollision::Type expected, actual;
+      const bool expected_found = acm.getAllowedCollision(name1, name2, expected);
+      const bool found = compiled->getAllowedCollision(compiled->getIndex(name1), compiled->getIndex(name2), actual);
+      EXPECT_EQ(expected_found, found) << name1 << " " << name2;
+      if (expected_found && found)
+      {
+        EXPECT_EQ(expected, actual) << name1 << " " << name2;
+      }
+    }
+  }
+}
+}  // namespace
+
+TEST(CompiledAllowedCollisionMatrix, MatchesEntries)
+{
+  collision_detection::AllowedCollisionMatrix acm;
+  acm.setEntry("a", "b", true);
+  acm.setEntry("a", "c", false);
+  collision_detection::DecideContactFn fn = [](collision_detection::Contact& /*contact*/) { return true; };
+  acm.setEntry("b", "d", fn);
+  expectSameAllowedCollisions(acm);
+
+  const collision_detection::CompiledAllowedCollisionMatrixConstPtr compiled = acm.getCompiled();
+  EXPECT_EQ(compiled->getSize(), 4u);
+  EXPECT_EQ(compiled->getIndex("unknown"), collision_detection::CompiledAllowedCollisionMatrix::NO_INDEX);
+}
+
+TEST(CompiledAllowedCollisionMatrix, MatchesDefaults)
+{
+  collision_detection::AllowedCollisionMatrix acm;
+  acm.setEntry("a", "b", false);
+  acm.setDefaultEntry("a", true);
+  acm.setDefaultEntry("d", false);
+  expectSameAllowedCollisions(acm);
+
+  acm.setDefaultEntry("c", true);
+  acm.removeEntry("a", "b");
+  expectSameAllowedCollisions(acm);
+}
+
+TEST(CompiledAllowedCollisionMatrix, RecompilesAfterChanges)
+{
+  collision_detection::AllowedCollisionMatrix acm;
+  acm.setEntry("a", "b", true);
+  const collision_detection::CompiledAllowedCollisionMatrixConstPtr compiled = acm.getCompiled();
+  EXPECT_EQ(compiled, acm.getCompiled());
+
+  acm.setEntry("a", "b", false);
+  const collision_detection::CompiledAllowedCollisionMatrixConstPtr recompiled = acm.getCompiled();
+  EXPECT_NE(compiled, recompiled);
+  EXPECT_NE(compiled->getId(), recompiled->getId());
+  expectSameAllowedCollisions(acm);
+
+  // snapshots handed out before a change are not modified
+  collision_detection::AllowedCollision::Type type;
+  ASSERT_TRUE(compiled->getAllowedCollision(compiled->getIndex("a"), compiled->getIndex("b"), type));
+  EXPECT_EQ(type, collision_detection::AllowedCollision::ALWAYS);
+
+  // copies share the snapshot until either is changed
+  collision_detection::AllowedCollisionMatrix copy(acm);
+  EXPECT_EQ(copy.getCompiled(), recompiled);
+  copy.clear();
+  EXPECT_NE(copy.getCompiled(), recompiled);
+  EXPECT_EQ(acm.getCompiled(), recompiled);
+}
+
+TEST(CompiledAllowedCollisionMatrix, PatchesKnownPairs)
+{
+  collision_detection::AllowedCollisionMatrix acm;
+  acm.setEntry("a", "b", true);
+  acm.setEntry("c", "d", false);
+  acm.setDefaultEntry("a", true);
+  const std::uint32_t id = acm.getCompiled()->getId();
+
+  // pairs of known names are patched in place while the snapshot is not handed out
+  acm.setEntry("a", "c", true);
+  acm.removeEntry("a", "b");
+  collision_detection::DecideContactFn fn = [](collision_detection::Contact& /*contact*/) { return true; };
+  acm.setEntry("b", "d", fn);
+  EXPECT_EQ(acm.getCompiled()->getId(), id);
+  expectSameAllowedCollisions(acm);
+
+  // a handed out snapshot is copied before it is patched
+  const collision_detection::CompiledAllowedCollisionMatrixConstPtr compiled = acm.getCompiled();
+  acm.setEntry("a", "d", false);
+  EXPECT_NE(acm.getCompiled(), compiled);
+  EXPECT_NE(acm.getCompiled()->getId(), id);
+  collision_detection::AllowedCollision::Type type;
+  EXPECT_TRUE(compiled->getAllowedCollision(compiled->getIndex("a"), compiled->getIndex("d"), type));
+  EXPECT_EQ(type, collision_detection::AllowedCollision::ALWAYS);
+  expectSameAllowedCollisions(acm);
+
+  // new names are only known after a recompile
+  acm.setEntry("a", "unknown", true);
+  EXPECT_EQ(acm.getCompiled()->getSize(), 5u);
+  expectSameAllowedCollisions(acm);
+}
+
+TEST(AllowedCollisionMatrix, CopyOnWrite)
+{
+  collision_detection::AllowedCollisionMatrix acm;
+  acm.setEntry("a", "b", true);
+  acm.setDefaultEntry("c", true);
+
+  collision_detection::AllowedCollisionMatrix copy(acm);
+  copy.setEntry("a", "b", false);
+  copy.setDefaultEntry("c", false);
+  copy.setEntry("a", "d", true);
+
+  collision_detection::AllowedCollision::Type type;
+  ASSERT_TRUE(acm.getEntry("a", "b", type));
+  EXPECT_EQ(type, collision_detection::AllowedCollision::ALWAYS);
+  ASSERT_TRUE(acm.getDefaultEntry("c", type));
+  EXPECT_EQ(type, collision_detection::AllowedCollision::ALWAYS);
+  EXPECT_FALSE(acm.hasEntry("d"));
+
+  ASSERT_TRUE(copy.getEntry("a", "b", type));
+  EXPECT_EQ(type, collision_detection::AllowedCollision::NEVER);
+  EXPECT_TRUE(copy.hasEntry("a", "d"));
+
+  acm = copy;
+  EXPECT_TRUE(acm.hasEntry("a", "d"));
+  acm.clear();
+  EXPECT_TRUE(copy.hasEntry("a", "d"));
+}
+
+TEST(CompiledAllowedCollisionMatrix, IndexCache)
+{
+  collision_detection::AllowedCollisionMatrix acm;
+  acm.setEntry("a", "b", true);
+  collision_detection::AllowedCollisionIndexCache cache;
+  EXPECT_EQ(cache.getIndex(*acm.getCompiled(), "b"), 1u);
+
+  acm.setEntry("0", "b", true);
+  EXPECT_EQ(cache.getIndex(*acm.getCompiled(), "b"), 2u);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
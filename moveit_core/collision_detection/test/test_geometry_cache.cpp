@@ -0,0 +1,226 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+#include <moveit/collision_detection/geometry_cache.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <istream>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using collision_detection::GeometryCache;
+
+std::shared_ptr<shapes::Mesh> makeTriangle(double scale)
+{
+  auto mesh = std::make_shared<shapes::Mesh>(3, 1);
+  const double vertices[] = { 0.0, 0.0, 0.0, scale, 0.0, 0.0, 0.0, scale, 0.0 };
+  std::copy(std::begin(vertices), std::end(vertices), mesh->vertices);
+  mesh->triangles[0] = 0;
+  mesh->triangles[1] = 1;
+  mesh->triangles[2] = 2;
+  return mesh;
+}
+
+std::function<std::size_t(const double&)> sizeOfDouble()
+{
+  return [](const double&) { return sizeof(double); };
+}
+}  // namespace
+
+TEST(GeometryCache, ShapeHash)
+{
+  std::uint64_t a, b, c;
+  ASSERT_TRUE(collision_detection::computeShapeHash(*makeTriangle(1.0), a));
+  ASSERT_TRUE(collision_detection::computeShapeHash(*makeTriangle(1.0), b));
+  ASSERT_TRUE(collision_detection::computeShapeHash(*makeTriangle(2.0), c));
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+
+  ASSERT_TRUE(collision_detection::computeShapeHash(shapes::Box(1.0, 2.0, 3.0), a));
+  ASSERT_TRUE(collision_detection::computeShapeHash(shapes::Box(1.0, 2.0, 3.0), b));
+  ASSERT_TRUE(collision_detection::computeShapeHash(shapes::Box(3.0, 2.0, 1.0), c));
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+
+  // same dimensions, different type
+  ASSERT_TRUE(collision_detection::computeShapeHash(shapes::Cylinder(1.0, 2.0), a));
+  ASSERT_TRUE(collision_detection::computeShapeHash(shapes::Cone(1.0, 2.0), b));
+  EXPECT_NE(a, b);
+}
+
+TEST(GeometryCache, BuildsOnce)
+{
+  GeometryCache cache;
+  int builds = 0;
+  auto build = [&builds] {
+    ++builds;
+    return std::make_shared<const double>(1.0);
+  };
+
+  std::shared_ptr<const double> first = cache.get<double>("test", 1, build, sizeOfDouble());
+  std::shared_ptr<const double> second = cache.get<double>("test", 1, build, sizeOfDouble());
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(builds, 1);
+  EXPECT_EQ(cache.size(), 1u);
+  EXPECT_EQ(cache.getMemoryUsage(), sizeof(double));
+
+  // the kind is part of the key
+  cache.get<double>("other", 1, build, sizeOfDouble());
+  EXPECT_EQ(builds, 2);
+
+  // failed builds are not cached
+  auto fail = [] { return std::shared_ptr<const double>(); };
+  EXPECT_FALSE(cache.get<double>("test", 2, fail, sizeOfDouble()));
+  EXPECT_EQ(cache.size(), 2u);
+
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0u);
+  EXPECT_EQ(*first, 1.0);
+}
+
+TEST(GeometryCache, DetectsHashCollisions)
+{
+  GeometryCache cache;
+  collision_detection::ShapeCounts counts;
+  std::uint64_t hash;
+  ASSERT_TRUE(collision_detection::computeShapeHash(*makeTriangle(1.0), hash, counts));
+  EXPECT_EQ(counts.vertex_count, 3u);
+  EXPECT_EQ(counts.triangle_count, 1u);
+
+  auto build = [](double value) { return [value] { return std::make_shared<const double>(value); }; };
+  std::shared_ptr<const double> cached = cache.get<double>("test", 1, counts, build(1.0), sizeOfDouble());
+
+  // a shape with other counts but the same hash gets its own, uncached result
+  collision_detection::ShapeCounts other_counts = counts;
+  ++other_counts.vertex_count;
+  EXPECT_EQ(*cache.get<double>("test", 1, other_counts, build(2.0), sizeOfDouble()), 2.0);
+  EXPECT_EQ(cache.get<double>("test", 1, counts, build(3.0), sizeOfDouble()), cached);
+  EXPECT_EQ(cache.size(), 1u);
+}
+
+TEST(GeometryCache, ConcurrentRequestsShareOneBuild)
+{
+  GeometryCache cache;
+  std::atomic<int> builds(0);
+  auto build = [&builds] {
+    ++builds;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    return std::make_shared<const double>(2.0);
+  };
+
+  std::vector<std::shared_ptr<const double>> results(8);
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < results.size(); ++i)
+  {
+    threads.emplace_back(
+        [&cache, &build, &results, i] { results[i] = cache.get<double>("test", 1, build, sizeOfDouble()); });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(builds.load(), 1);
+  for (const std::shared_ptr<const double>& result : results)
+    EXPECT_EQ(result, results.front());
+}
+
+TEST(GeometryCache, EvictsUnusedEntries)
+{
+  GeometryCache cache;
+  cache.setMemoryBudget(2 * sizeof(double));
+  auto build = [] { return std::make_shared<const double>(3.0); };
+
+  std::shared_ptr<const double> held = cache.get<double>("test", 1, build, sizeOfDouble());
+  cache.get<double>("test", 2, build, sizeOfDouble());
+  cache.get<double>("test", 3, build, sizeOfDouble());
+  // entry 2 is the least recently used one that is not held elsewhere
+  EXPECT_EQ(cache.size(), 2u);
+  EXPECT_EQ(cache.getMemoryUsage(), 2 * sizeof(double));
+  EXPECT_EQ(cache.get<double>("test", 1, build, sizeOfDouble()), held);
+
+  held.reset();
+  cache.setMemoryBudget(0);
+  EXPECT_EQ(cache.size(), 0u);
+  EXPECT_EQ(cache.getMemoryUsage(), 0u);
+}
+
+TEST(GeometryCache, StorageDirectory)
+{
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / "moveit_test_geometry_cache";
+  std::filesystem::remove_all(directory);
+
+  GeometryCache::Serializer<double> serializer;
+  serializer.write = [](const double& value, std::ostream& out) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    return static_cast<bool>(out);
+  };
+  serializer.read = [](std::istream& in) {
+    double value;
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return in ? std::make_shared<const double>(value) : std::shared_ptr<const double>();
+  };
+
+  int builds = 0;
+  auto build = [&builds] {
+    ++builds;
+    return std::make_shared<const double>(4.0);
+  };
+
+  {
+    GeometryCache cache;
+    ASSERT_TRUE(cache.setStorageDirectory(directory.string()));
+    EXPECT_EQ(*cache.get<double>("test", 1, build, sizeOfDouble(), &serializer), 4.0);
+  }
+  {
+    // a new cache reads the entry back instead of building it
+    GeometryCache cache;
+    ASSERT_TRUE(cache.setStorageDirectory(directory.string()));
+    EXPECT_EQ(*cache.get<double>("test", 1, build, sizeOfDouble(), &serializer), 4.0);
+  }
+  EXPECT_EQ(builds, 1);
+
+  std::filesystem::remove_all(directory);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -38,6 +38,7 @@
 #include <moveit/collision_detection/world.hpp>
 #include <geometric_shapes/shapes.h>
 #include <functional>
+#include <stdexcept>
 
 using namespace collision_detection;
 
@@ -372,6 +373,41 @@ TEST(World, TrackChanges)
   EXPECT_EQ(4, ta3.cnt_);
 }
 
+TEST(World, UpdateShapeInPlace)
+{
+  World world;
+
+  TestAction ta;
+  World::ObserverHandle observer_ta;
+  observer_ta = world.addObserver([&ta](const World::ObjectConstPtr& object, World::Action action) {
+    return trackChangesNotify(ta, object, action);
+  });
+
+  shapes::ShapePtr ball = std::make_shared<shapes::Sphere>(1.0);
+  shapes::ShapePtr box = std::make_shared<shapes::Box>(1, 2, 3);
+
+  world.addToObject("obj1", ball, Eigen::Isometry3d(Eigen::Translation3d(0, 0, 1)));
+  EXPECT_EQ(1, ta.cnt_);
+  ta.reset();
+
+  // unknown object or shape does not notify
+  EXPECT_FALSE(world.updateShapeInObject("xyz", ball));
+  EXPECT_FALSE(world.updateShapeInObject("obj1", box));
+  EXPECT_EQ(1, ta.cnt_);
+
+  EXPECT_TRUE(world.updateShapeInObject("obj1", ball));
+  EXPECT_EQ(2, ta.cnt_);
+  EXPECT_EQ("obj1", ta.obj_.id_);
+  EXPECT_EQ(World::UPDATE_SHAPE, ta.action_);
+
+  // shape and pose are kept
+  ASSERT_EQ(1u, ta.obj_.shapes_.size());
+  EXPECT_EQ(ball, ta.obj_.shapes_[0]);
+  EXPECT_TRUE(ta.obj_.shape_poses_[0].isApprox(Eigen::Isometry3d(Eigen::Translation3d(0, 0, 1))));
+
+  world.removeObserver(observer_ta);
+}
+
 TEST(World, ObjectPoseAndSubframes)
 {
   World world;
@@ -458,6 +494,183 @@ TEST(World, ObjectPoseAndSubframes)
   EXPECT_EQ(1.0, pose(2, 3));  // z
 }
 
+TEST(World, CopyOnWrite)
+{
+  World world;
+
+  shapes::ShapePtr ball = std::make_shared<shapes::Sphere>(1.0);
+  shapes::ShapePtr box = std::make_shared<shapes::Box>(1, 2, 3);
+  world.addToObject("ball", ball, Eigen::Isometry3d::Identity());
+  world.addToObject("box", box, Eigen::Isometry3d::Identity());
+
+  // copies share all objects
+  World copy(world);
+  EXPECT_EQ(world.getObject("ball"), copy.getObject("ball"));
+  EXPECT_EQ(world.getObject("box"), copy.getObject("box"));
+
+  // only the modified object is copied
+  EXPECT_TRUE(copy.moveShapesInObject("ball", { Eigen::Isometry3d(Eigen::Translation3d(0, 0, 1)) }));
+  EXPECT_NE(world.getObject("ball"), copy.getObject("ball"));
+  EXPECT_EQ(world.getObject("box"), copy.getObject("box"));
+  EXPECT_EQ(0.0, world.getGlobalShapeTransform("ball", 0)(2, 3));
+  EXPECT_EQ(1.0, copy.getGlobalShapeTransform("ball", 0)(2, 3));
+
+  moveit::core::FixedTransformsMap subframes;
+  subframes["tip"] = Eigen::Isometry3d(Eigen::Translation3d(0, 0, 2));
+  EXPECT_TRUE(copy.setSubframesOfObject("box", subframes));
+  EXPECT_FALSE(world.knowsTransform("box/tip"));
+  EXPECT_TRUE(copy.knowsTransform("box/tip"));
+
+  // adding and removing objects does not affect the original
+  copy.removeObject("box");
+  copy.addToObject("cyl", std::make_shared<shapes::Cylinder>(4, 5), Eigen::Isometry3d::Identity());
+  EXPECT_TRUE(world.hasObject("box"));
+  EXPECT_FALSE(world.hasObject("cyl"));
+  EXPECT_EQ(2u, world.size());
+
+  world.clearObjects();
+  EXPECT_EQ(0u, world.size());
+  EXPECT_EQ(2u, copy.size());
+}
+
+TEST(World, AddObjects)
+{
+  World world;
+  shapes::ShapePtr ball = std::make_shared<shapes::Sphere>(1.0);
+  world.addToObject("ball", ball, Eigen::Isometry3d::Identity());
+
+  World::ObjectChanges batch_changes;
+  int batch_cnt = 0;
+  world.addObserver([](const World::ObjectConstPtr& /*object*/, World::Action /*action*/) { FAIL(); },
+                    [&batch_changes, &batch_cnt](const World::ObjectChanges& changes) {
+                      batch_changes = changes;
+                      ++batch_cnt;
+                    });
+  TestAction ta;
+  world.addObserver([&ta](const World::ObjectConstPtr& object, World::Action action) {
+    return trackChangesNotify(ta, object, action);
+  });
+
+  auto box = std::make_shared<World::Object>("box");
+  box->pose_ = Eigen::Isometry3d(Eigen::Translation3d(0, 0, 1));
+  box->shapes_.push_back(std::make_shared<shapes::Box>(1, 2, 3));
+  box->shape_poses_.push_back(Eigen::Isometry3d(Eigen::Translation3d(1, 0, 0)));
+  box->subframe_poses_["top"] = Eigen::Isometry3d(Eigen::Translation3d(0, 0, 1.5));
+  auto new_ball = std::make_shared<World::Object>("ball");
+  new_ball->pose_ = Eigen::Isometry3d::Identity();
+  new_ball->shapes_.push_back(std::make_shared<shapes::Sphere>(2.0));
+  new_ball->shape_poses_.push_back(Eigen::Isometry3d::Identity());
+  world.addObjects({ box, new_ball });
+
+  // observers with a batch callback are notified once, the others once per change
+  EXPECT_EQ(1, batch_cnt);
+  ASSERT_EQ(3u, batch_changes.size());
+  EXPECT_EQ("box", batch_changes[0].first->id_);
+  EXPECT_EQ(World::CREATE | World::ADD_SHAPE, batch_changes[0].second);
+  EXPECT_EQ("ball", batch_changes[1].first->id_);
+  EXPECT_EQ(World::DESTROY, batch_changes[1].second);
+  EXPECT_EQ(new_ball, batch_changes[2].first);
+  EXPECT_EQ(World::CREATE | World::ADD_SHAPE, batch_changes[2].second);
+  EXPECT_EQ(3, ta.cnt_);
+
+  // global poses are computed by the world, and the existing object is replaced
+  EXPECT_EQ(2u, world.size());
+  EXPECT_EQ(1.0, world.getGlobalShapeTransform("box", 0)(0, 3));
+  EXPECT_EQ(1.0, world.getGlobalShapeTransform("box", 0)(2, 3));
+  EXPECT_EQ(2.5, world.getTransform("box/top")(2, 3));
+  EXPECT_EQ(new_ball, world.getObject("ball"));
+}
+
+TEST(World, Transaction)
+{
+  World world;
+  shapes::ShapePtr ball = std::make_shared<shapes::Sphere>(1.0);
+  shapes::ShapePtr box = std::make_shared<shapes::Box>(1, 2, 3);
+  world.addToObject("ball", ball, Eigen::Isometry3d::Identity());
+  world.addToObject("box", box, Eigen::Isometry3d::Identity());
+
+  std::vector<World::ObjectChanges> batches;
+  world.addObserver([](const World::ObjectConstPtr& /*object*/, World::Action /*action*/) { FAIL(); },
+                    [&batches](const World::ObjectChanges& changes) { batches.push_back(changes); });
+  TestAction ta;
+  world.addObserver([&ta](const World::ObjectConstPtr& object, World::Action action) {
+    return trackChangesNotify(ta, object, action);
+  });
+
+  world.beginTransaction();
+  world.beginTransaction();
+  EXPECT_TRUE(world.moveObject("ball", Eigen::Isometry3d(Eigen::Translation3d(0, 0, 1))));
+  EXPECT_TRUE(world.moveObject("ball", Eigen::Isometry3d(Eigen::Translation3d(0, 0, 1))));
+  world.addToObject("ball", box, Eigen::Isometry3d::Identity());
+  EXPECT_TRUE(world.removeObject("box"));
+  world.addToObject("box", ball, Eigen::Isometry3d::Identity());
+  world.commitTransaction();
+
+  // the world is updated right away, only the notifications wait for the outermost commit
+  EXPECT_EQ(2.0, world.getTransform("ball")(2, 3));
+  EXPECT_TRUE(batches.empty());
+  EXPECT_EQ(0, ta.cnt_);
+  world.commitTransaction();
+
+  // changes to the same object are merged, unless the object was destroyed in between
+  ASSERT_EQ(1u, batches.size());
+  const World::ObjectChanges& changes = batches.front();
+  ASSERT_EQ(3u, changes.size());
+  EXPECT_EQ("ball", changes[0].first->id_);
+  EXPECT_EQ(World::MOVE_SHAPE | World::ADD_SHAPE, changes[0].second);
+  EXPECT_EQ(2u, changes[0].first->shapes_.size());
+  EXPECT_EQ("box", changes[1].first->id_);
+  EXPECT_EQ(World::DESTROY, changes[1].second);
+  EXPECT_EQ("box", changes[2].first->id_);
+  EXPECT_EQ(World::CREATE | World::ADD_SHAPE, changes[2].second);
+  EXPECT_EQ(ball, changes[2].first->shapes_[0]);
+  EXPECT_EQ(3, ta.cnt_);
+}
+
+TEST(World, TransactionKeepsObjects)
+{
+  World world;
+  world.addToObject("ball", std::make_shared<shapes::Sphere>(1.0), Eigen::Isometry3d::Identity());
+  const World::Object* ball = world.getObject("ball").get();
+
+  std::vector<World::ObjectChanges> batches;
+  int single_changes = 0;
+  world.addObserver(
+      [&single_changes](const World::ObjectConstPtr& /*object*/, World::Action /*action*/) { ++single_changes; },
+      [&batches](const World::ObjectChanges& changes) { batches.push_back(changes); });
+
+  // the transaction does not hold references to changed objects, so they are not copied on their next change
+  {
+    World::ScopedTransaction transaction(world);
+    EXPECT_TRUE(world.moveObject("ball", Eigen::Isometry3d(Eigen::Translation3d(0, 0, 1))));
+    EXPECT_TRUE(world.moveObject("ball", Eigen::Isometry3d(Eigen::Translation3d(0, 0, 1))));
+    EXPECT_EQ(ball, world.getObject("ball").get());
+  }
+  ASSERT_EQ(1u, batches.size());
+  ASSERT_EQ(1u, batches.front().size());
+  EXPECT_EQ(ball, batches.front().front().first.get());
+  batches.clear();
+
+  // the transaction is committed when an exception leaves its scope
+  try
+  {
+    World::ScopedTransaction transaction(world);
+    EXPECT_TRUE(world.removeObject("ball"));
+    throw std::runtime_error("failure while the transaction is open");
+  }
+  catch (const std::runtime_error&)
+  {
+  }
+  ASSERT_EQ(1u, batches.size());
+  ASSERT_EQ(1u, batches.front().size());
+  EXPECT_EQ(World::DESTROY, batches.front().front().second);
+  EXPECT_EQ("ball", batches.front().front().first->id_);
+
+  // later changes are notified right away again
+  world.addToObject("box", std::make_shared<shapes::Box>(1, 2, 3), Eigen::Isometry3d::Identity());
+  EXPECT_EQ(1, single_changes);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
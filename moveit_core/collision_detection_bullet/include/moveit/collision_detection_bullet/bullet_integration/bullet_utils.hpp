@@ -61,6 +61,10 @@ MOVEIT_CLASS_FORWARD(CollisionObjectWrapper);
 bool acmCheck(const std::string& body_1, const std::string& body_2,
               const collision_detection::AllowedCollisionMatrix* acm);
 
+/** \brief Allowed = true, looks the pair up by index in a compiled allowed collision matrix */
+bool acmCheck(const CollisionObjectWrapper* cow0, const CollisionObjectWrapper* cow1,
+              const collision_detection::CompiledAllowedCollisionMatrix* acm);
+
 /** \brief Converts eigen vector to bullet vector */
 inline btVector3 convertEigenToBt(const Eigen::Vector3d& v)
 {
@@ -152,6 +156,12 @@ public:
     return type_id_;
   }
 
+  /** @brief Get the index of the collision object in a compiled allowed collision matrix */
+  std::uint32_t getACMIndex(const collision_detection::CompiledAllowedCollisionMatrix& acm) const
+  {
+    return acm_index_.getIndex(acm, name_);
+  }
+
   /** \brief Check if two CollisionObjectWrapper objects point to the same source object
    *  \return True if same objects, false otherwise */
   bool sameObject(const CollisionObjectWrapper& other) const
@@ -231,6 +241,9 @@ protected:
 
   /** @brief Manages the collision shape pointer so they get destroyed */
   std::vector<std::shared_ptr<void>> data_;
+
+  /** @brief Caches the index returned by getACMIndex() */
+  collision_detection::AllowedCollisionIndexCache acm_index_;
 };
 
 /** @brief Casted collision shape used for checking if an object is collision free between two discrete poses
@@ -533,6 +546,9 @@ struct BroadphaseContactResultCallback
   double contact_distance_;
   const collision_detection::AllowedCollisionMatrix* acm_{ nullptr };
 
+  /** \brief Dense snapshot of \e acm_ used by needsCollision() */
+  collision_detection::CompiledAllowedCollisionMatrixConstPtr compiled_acm_;
+
   /** \brief Indicates if the callback is used for only self-collision checking */
   bool self_;
 
@@ -541,7 +557,12 @@ struct BroadphaseContactResultCallback
 
   BroadphaseContactResultCallback(ContactTestData& collisions, double contact_distance,
                                   const collision_detection::AllowedCollisionMatrix* acm, bool self, bool cast = false)
-    : collisions_(collisions), contact_distance_(contact_distance), acm_(acm), self_(self), cast_(cast)
+    : collisions_(collisions)
+    , contact_distance_(contact_distance)
+    , acm_(acm)
+    , compiled_acm_(acm ? acm->getCompiled() : nullptr)
+    , self_(self)
+    , cast_(cast)
   {
   }
 
@@ -554,12 +575,12 @@ struct BroadphaseContactResultCallback
   {
     if (cast_)
     {
-      return !collisions_.done && !isOnlyKinematic(cow0, cow1) && !acmCheck(cow0->getName(), cow1->getName(), acm_);
+      return !collisions_.done && !isOnlyKinematic(cow0, cow1) && !acmCheck(cow0, cow1, compiled_acm_.get());
     }
     else
     {
       return !collisions_.done && (self_ ? isOnlyKinematic(cow0, cow1) : !isOnlyKinematic(cow0, cow1)) &&
-             !acmCheck(cow0->getName(), cow1->getName(), acm_);
+             !acmCheck(cow0, cow1, compiled_acm_.get());
     }
   }
 
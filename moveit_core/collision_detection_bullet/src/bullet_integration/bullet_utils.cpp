@@ -38,7 +38,11 @@
 #include <BulletCollision/CollisionShapes/btShapeHull.h>
 #include <BulletCollision/Gimpact/btGImpactShape.h>
 #include <geometric_shapes/shapes.h>
+#include <cstring>
+#include <istream>
 #include <memory>
+#include <moveit/collision_detection/geometry_cache.hpp>
+#include <ostream>
 #include <octomap/octomap.h>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
@@ -81,6 +85,17 @@ bool acmCheck(const std::string& body_1, const std::string& body_2,
   }
 }
 
+bool acmCheck(const CollisionObjectWrapper* cow0, const CollisionObjectWrapper* cow1,
+              const collision_detection::CompiledAllowedCollisionMatrix* acm)
+{
+  collision_detection::AllowedCollision::Type allowed_type;
+  if (acm != nullptr && acm->getAllowedCollision(cow0->getACMIndex(*acm), cow1->getACMIndex(*acm), allowed_type))
+  {
+    return allowed_type != collision_detection::AllowedCollision::Type::NEVER;
+  }
+  return false;
+}
+
 btCollisionShape* createShapePrimitive(const shapes::Box* geom, const CollisionObjectType& collision_object_type)
 {
   static_cast<void>(collision_object_type);
@@ -118,6 +133,61 @@ btCollisionShape* createShapePrimitive(const shapes::Cone* geom, const Collision
   return (new btConeShapeZ(r, l));
 }
 
+namespace
+{
+/** \brief Compute the vertices of the convex hull of a mesh; nullptr on failure */
+std::shared_ptr<const AlignedVector<Eigen::Vector3d>> computeConvexHullVertices(const shapes::Mesh& geom)
+{
+  AlignedVector<Eigen::Vector3d> input;
+  auto vertices = std::make_shared<AlignedVector<Eigen::Vector3d>>();
+  std::vector<int> faces;
+
+  input.reserve(geom.vertex_count);
+  for (unsigned int i = 0; i < geom.vertex_count; ++i)
+    input.push_back(Eigen::Vector3d(geom.vertices[3 * i], geom.vertices[3 * i + 1], geom.vertices[3 * i + 2]));
+
+  if (createConvexHull(*vertices, faces, input) < 0)
+    return nullptr;
+  return vertices;
+}
+
+const char CONVEX_HULL_MAGIC[4] = { 'M', 'V', 'C', 'H' };
+// increase whenever the layout changes, so old files are rebuilt
+const std::uint32_t CONVEX_HULL_VERSION = 1;
+
+/** \brief Stores convex hulls as a magic and version header, their vertex count and the vertex coordinates */
+const collision_detection::GeometryCache::Serializer<AlignedVector<Eigen::Vector3d>> CONVEX_HULL_SERIALIZER{
+  [](const AlignedVector<Eigen::Vector3d>& vertices, std::ostream& out) {
+    const std::uint64_t count = vertices.size();
+    out.write(CONVEX_HULL_MAGIC, sizeof(CONVEX_HULL_MAGIC));
+    out.write(reinterpret_cast<const char*>(&CONVEX_HULL_VERSION), sizeof(CONVEX_HULL_VERSION));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const Eigen::Vector3d& v : vertices)
+      out.write(reinterpret_cast<const char*>(v.data()), 3 * sizeof(double));
+    return static_cast<bool>(out);
+  },
+  [](std::istream& in) -> std::shared_ptr<const AlignedVector<Eigen::Vector3d>> {
+    char magic[sizeof(CONVEX_HULL_MAGIC)];
+    std::uint32_t version;
+    std::uint64_t count;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!in || std::memcmp(magic, CONVEX_HULL_MAGIC, sizeof(magic)) != 0 || version != CONVEX_HULL_VERSION)
+      return nullptr;
+    auto vertices = std::make_shared<AlignedVector<Eigen::Vector3d>>();
+    for (std::uint64_t i = 0; i < count; ++i)
+    {
+      Eigen::Vector3d v;
+      if (!in.read(reinterpret_cast<char*>(v.data()), 3 * sizeof(double)))
+        return nullptr;
+      vertices->push_back(v);
+    }
+    return vertices;
+  }
+};
+}  // namespace
+
 btCollisionShape* createShapePrimitive(const shapes::Mesh* geom, const CollisionObjectType& collision_object_type,
                                        CollisionObjectWrapper* cow)
 {
@@ -133,19 +203,23 @@ btCollisionShape* createShapePrimitive(const shapes::Mesh* geom, const Collision
       case CollisionObjectType::CONVEX_HULL:
       {
         // Create a convex hull shape to approximate Trimesh
-        collision_detection_bullet::AlignedVector<Eigen::Vector3d> input;
-        collision_detection_bullet::AlignedVector<Eigen::Vector3d> vertices;
-        std::vector<int> faces;
-
-        input.reserve(geom->vertex_count);
-        for (unsigned int i = 0; i < geom->vertex_count; ++i)
-          input.push_back(Eigen::Vector3d(geom->vertices[3 * i], geom->vertices[3 * i + 1], geom->vertices[3 * i + 2]));
-
-        if (collision_detection_bullet::createConvexHull(vertices, faces, input) < 0)
+        std::shared_ptr<const AlignedVector<Eigen::Vector3d>> hull;
+        std::uint64_t hash;
+        collision_detection::ShapeCounts counts;
+        if (collision_detection::computeShapeHash(*geom, hash, counts))
+        {
+          hull = collision_detection::GeometryCache::getInstance().get<AlignedVector<Eigen::Vector3d>>(
+              "bullet_convex_hull", hash, counts, [geom] { return computeConvexHullVertices(*geom); },
+              [](const AlignedVector<Eigen::Vector3d>& vertices) { return vertices.size() * sizeof(Eigen::Vector3d); },
+              &CONVEX_HULL_SERIALIZER);
+        }
+        else
+          hull = computeConvexHullVertices(*geom);
+        if (!hull)
           return nullptr;
 
         btConvexHullShape* subshape = new btConvexHullShape();
-        for (const Eigen::Vector3d& v : vertices)
+        for (const Eigen::Vector3d& v : *hull)
         {
           subshape->addPoint(
               btVector3(static_cast<btScalar>(v[0]), static_cast<btScalar>(v[1]), static_cast<btScalar>(v[2])));
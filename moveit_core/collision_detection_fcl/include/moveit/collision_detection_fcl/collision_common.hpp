@@ -118,6 +118,13 @@ struct CollisionGeometryData
     return type == other.type && ptr.raw == other.ptr.raw;
   }
 
+  /** \brief Returns the index of this body in a compiled allowed collision matrix, resolving the name only once per
+   *  snapshot. */
+  std::uint32_t getACMIndex(const CompiledAllowedCollisionMatrix& acm) const
+  {
+    return acm_index.getIndex(acm, getID());
+  }
+
   /** \brief Indicates the body type of the object. */
   BodyType type;
 
@@ -135,6 +142,9 @@ struct CollisionGeometryData
     const World::Object* obj;
     const void* raw;
   } ptr;
+
+  /** \brief Caches the index returned by getACMIndex(). */
+  AllowedCollisionIndexCache acm_index;
 };
 
 /** \brief Data structure which is passed to the collision callback function of the collision manager. */
@@ -145,7 +155,12 @@ struct CollisionData
   }
 
   CollisionData(const CollisionRequest* req, CollisionResult* res, const AllowedCollisionMatrix* acm)
-    : req_(req), active_components_only_(nullptr), res_(res), acm_(acm), done_(false)
+    : req_(req)
+    , active_components_only_(nullptr)
+    , res_(res)
+    , acm_(acm)
+    , compiled_acm_(acm ? acm->getCompiled() : nullptr)
+    , done_(false)
   {
   }
 
@@ -171,6 +186,9 @@ struct CollisionData
   /** \brief The user-specified collision matrix (may be nullptr). */
   const AllowedCollisionMatrix* acm_;
 
+  /** \brief Dense snapshot of \e acm_, used to look up the allowed collision type of a pair of bodies. */
+  CompiledAllowedCollisionMatrixConstPtr compiled_acm_;
+
   /** \brief Flag indicating whether collision checking is complete. */
   bool done_;
 };
@@ -178,7 +196,8 @@ struct CollisionData
 /** \brief Data structure which is passed to the distance callback function of the collision manager. */
 struct DistanceData
 {
-  DistanceData(const DistanceRequest* req, DistanceResult* res) : req(req), res(res), done(false)
+  DistanceData(const DistanceRequest* req, DistanceResult* res)
+    : req(req), res(res), compiled_acm(req->acm ? req->acm->getCompiled() : nullptr), done(false)
   {
   }
   ~DistanceData()
@@ -191,8 +210,15 @@ struct DistanceData
   /** \brief Distance query results information. */
   DistanceResult* res;
 
+  /** \brief Dense snapshot of the allowed collision matrix of \e req. */
+  CompiledAllowedCollisionMatrixConstPtr compiled_acm;
+
   /** \brief Indicates if distance query is finished. */
   bool done;
+
+  /** \brief The world objects nearest to the robot found so far, sorted by distance.
+   *   Only maintained if \e req->max_nearest_objects is set. */
+  std::vector<std::pair<double, std::string>> nearest_objects;
 };
 
 MOVEIT_STRUCT_FORWARD(FCLGeometry);
@@ -45,7 +45,9 @@
 #include <fcl/broadphase/broadphase.h>
 #endif
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 
 namespace collision_detection
 {
@@ -145,8 +147,17 @@ protected:
   /** \brief Vector of shared pointers to the FCL collision objects which make up the robot */
   std::vector<FCLCollisionObjectConstPtr> robot_fcl_objs_;
 
-  /// FCL collision manager which handles the collision checking process
-  std::unique_ptr<fcl::BroadPhaseCollisionManagerd> manager_;
+  /** \brief Get the FCL collision manager of the world objects, building it on first use after a copy.
+   *
+   *   Copies of an environment share the FCL objects of the world with the original, and only build their own
+   *   broadphase structure once they are queried, so that copying is cheap. The structure is also dropped and rebuilt
+   *   here after a batch of changes that touches a large share of the world objects. */
+  fcl::BroadPhaseCollisionManagerd* getManager() const;
+
+  /// FCL collision manager which handles the collision checking process, only valid if \m manager_built_ is set
+  mutable std::unique_ptr<fcl::BroadPhaseCollisionManagerd> manager_;
+  mutable std::atomic<bool> manager_built_{ false };
+  mutable std::mutex manager_mutex_;
 
   std::map<std::string, FCLObject> fcl_objs_;
 
@@ -154,6 +165,23 @@ private:
   /** \brief Callback function executed for each change to the world environment */
   void notifyObjectChange(const ObjectConstPtr& obj, World::Action action);
 
+  /** \brief Callback function executed for changes made to several world objects together, e.g. in a transaction.
+   *   The FCL geometry of created or reshaped objects is built in parallel, and when many objects moved, the
+   *   broadphase structure is refit once instead of reinserting each of them. */
+  void notifyObjectChanges(const World::ObjectChanges& changes);
+
+  /** \brief Apply the new shape poses of a moved world object to its FCL object.
+   *   With \e defer_broadphase_update, the broadphase entry is left to a later manager_->update() if possible.
+   *   Returns true if such an update is needed. */
+  bool moveFCLObject(const ObjectConstPtr& obj, bool defer_broadphase_update);
+
+  /** \brief Check whether the collision geometry data of \e fcl_obj refers to the world object instance \e obj. */
+  static bool isBoundTo(const FCLObject& fcl_obj, const World::Object* obj);
+
+  /** \brief Check whether the FCL geometry of an object reflects in-place modifications of its shapes without being
+   *   rebuilt (true for octrees, which are referenced by fcl::OcTree instead of being copied) */
+  static bool isUpdatedInPlace(const ObjectConstPtr& obj);
+
   World::ObserverHandle observer_handle_;
 };
 }  // namespace collision_detection
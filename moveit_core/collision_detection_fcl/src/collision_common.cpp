@@ -35,6 +35,7 @@
 /* Author: Ioan Sucan, Jia Pan */
 
 #include <moveit/collision_detection_fcl/collision_common.hpp>
+#include <moveit/collision_detection/geometry_cache.hpp>
 #include <geometric_shapes/shapes.h>
 #include <moveit/collision_detection_fcl/fcl_compat.hpp>
 #include <rclcpp/logger.hpp>
@@ -50,8 +51,11 @@
 #include <fcl/octree.h>
 #endif
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <type_traits>
+#include <typeinfo>
 #include <mutex>
 
 namespace collision_detection
@@ -62,6 +66,51 @@ rclcpp::Logger getLogger()
 {
   return moveit::getLogger("moveit.core.moveit_collision_detection_fcl");
 }
+
+// Distances at or beyond this bound cannot change the result of the query anymore
+double getDistanceBound(const DistanceData& data)
+{
+  double bound = data.req->distance_threshold;
+  if (data.req->type == DistanceRequestType::GLOBAL)
+    bound = std::min(bound, data.res->minimum_distance.distance);
+  if (data.req->max_nearest_objects > 0 && data.nearest_objects.size() >= data.req->max_nearest_objects)
+    bound = std::min(bound, data.nearest_objects.back().first);
+  return bound;
+}
+
+// The broadphase skips all objects whose bounding boxes are at least this far apart. Bounding boxes of penetrating
+// objects overlap, so a negative (signed) distance bound must not prune them.
+double getBroadphaseBound(double distance_bound)
+{
+  return std::max(distance_bound, std::numeric_limits<double>::epsilon());
+}
+
+// Keep track of the world objects nearest to the robot
+void updateNearestObjects(DistanceData& data, const std::string& id, double distance)
+{
+  std::vector<std::pair<double, std::string>>& nearest = data.nearest_objects;
+  auto it = std::find_if(nearest.begin(), nearest.end(),
+                         [&id](const std::pair<double, std::string>& object) { return object.second == id; });
+  if (it != nearest.end())
+  {
+    if (distance >= it->first)
+      return;
+    it->first = distance;
+  }
+  else if (nearest.size() < data.req->max_nearest_objects)
+  {
+    nearest.emplace_back(distance, id);
+  }
+  else if (distance < nearest.back().first)
+  {
+    nearest.back() = std::make_pair(distance, id);
+  }
+  else
+  {
+    return;
+  }
+  std::sort(nearest.begin(), nearest.end());
+}
 }  // namespace
 
 bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data)
@@ -97,10 +146,11 @@ bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, voi
   // use the collision matrix (if any) to avoid certain collision checks
   DecideContactFn dcf;
   bool always_allow_collision = false;
-  if (cdata->acm_)
+  if (cdata->compiled_acm_)
   {
     AllowedCollision::Type type;
-    bool found = cdata->acm_->getAllowedCollision(cd1->getID(), cd2->getID(), type);
+    bool found = cdata->compiled_acm_->getAllowedCollision(cd1->getACMIndex(*cdata->compiled_acm_),
+                                                           cd2->getACMIndex(*cdata->compiled_acm_), type);
     if (found)
     {
       // if we have an entry in the collision matrix, we read it
@@ -468,10 +518,12 @@ struct FCLShapeCache
   unsigned int clean_count_;
 };
 
-bool distanceCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data, double& /*min_dist*/)
+bool distanceCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data, double& min_dist)
 {
   DistanceData* cdata = reinterpret_cast<DistanceData*>(data);
 
+  min_dist = getBroadphaseBound(getDistanceBound(*cdata));
+
   const CollisionGeometryData* cd1 = static_cast<const CollisionGeometryData*>(o1->collisionGeometry()->getUserData());
   const CollisionGeometryData* cd2 = static_cast<const CollisionGeometryData*>(o2->collisionGeometry()->getUserData());
 
@@ -501,10 +553,11 @@ bool distanceCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void
 
   // use the collision matrix (if any) to avoid certain distance checks
   bool always_allow_collision = false;
-  if (cdata->req->acm)
+  if (cdata->compiled_acm)
   {
     AllowedCollision::Type type;
-    bool found = cdata->req->acm->getAllowedCollision(cd1->getID(), cd2->getID(), type);
+    bool found = cdata->compiled_acm->getAllowedCollision(cd1->getACMIndex(*cdata->compiled_acm),
+                                                          cd2->getACMIndex(*cdata->compiled_acm), type);
     if (found)
     {
       // if we have an entry in the collision matrix, we read it
@@ -560,7 +613,7 @@ bool distanceCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void
                  cd2->getID().c_str());
   }
 
-  double dist_threshold = cdata->req->distance_threshold;
+  double dist_threshold = getDistanceBound(*cdata);
 
   const std::pair<const std::string&, const std::string&> pc =
       cd1->getID() < cd2->getID() ? std::make_pair(std::cref(cd1->getID()), std::cref(cd2->getID())) :
@@ -568,13 +621,10 @@ bool distanceCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void
 
   DistanceMap::iterator it = cdata->res->distances.find(pc);
 
-  // GLOBAL search: for efficiency, distance_threshold starts at the smallest distance between any pairs found so far
-  if (cdata->req->type == DistanceRequestType::GLOBAL)
-  {
-    dist_threshold = cdata->res->minimum_distance.distance;
-  }
-  // Check if a distance between this pair has been found yet. Decrease threshold_distance if so, to narrow the search
-  else if (it != cdata->res->distances.end())
+  // GLOBAL search: for efficiency, the threshold includes the smallest distance between any pairs found so far (see
+  // getDistanceBound()). Otherwise, check if a distance between this pair has been found yet. Decrease
+  // threshold_distance if so, to narrow the search
+  if (cdata->req->type != DistanceRequestType::GLOBAL && it != cdata->res->distances.end())
   {
     if (cdata->req->type == DistanceRequestType::LIMITED)
     {
@@ -586,7 +636,7 @@ bool distanceCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void
     }
     else if (cdata->req->type == DistanceRequestType::SINGLE)
     {
-      dist_threshold = it->second[0].distance;
+      dist_threshold = std::min(dist_threshold, it->second[0].distance);
     }
   }
 
@@ -729,10 +779,23 @@ bool distanceCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void
       }
     }
 
+    if (cdata->req->max_nearest_objects > 0)
+    {
+      if (dist_result.body_types[0] == BodyTypes::WORLD_OBJECT)
+      {
+        updateNearestObjects(*cdata, dist_result.link_names[0], dist_result.distance);
+      }
+      else if (dist_result.body_types[1] == BodyTypes::WORLD_OBJECT)
+      {
+        updateNearestObjects(*cdata, dist_result.link_names[1], dist_result.distance);
+      }
+    }
+
     if (!cdata->req->enable_signed_distance && cdata->res->collision)
     {
       cdata->done = true;
     }
+    min_dist = getBroadphaseBound(getDistanceBound(*cdata));
   }
 
   return cdata->done;
@@ -757,6 +820,28 @@ FCLShapeCache& getShapeCache()
   return cache;
 }
 
+/** \brief Build the bounding volume hierarchy of a mesh */
+template <typename BV>
+std::unique_ptr<fcl::BVHModel<BV>> buildBVHModel(const shapes::Mesh& mesh)
+{
+  auto g = std::make_unique<fcl::BVHModel<BV>>();
+  if (mesh.vertex_count > 0 && mesh.triangle_count > 0)
+  {
+    std::vector<fcl::Triangle> tri_indices(mesh.triangle_count);
+    for (unsigned int i = 0; i < mesh.triangle_count; ++i)
+      tri_indices[i] = fcl::Triangle(mesh.triangles[3 * i], mesh.triangles[3 * i + 1], mesh.triangles[3 * i + 2]);
+
+    std::vector<fcl::Vector3d> points(mesh.vertex_count);
+    for (unsigned int i = 0; i < mesh.vertex_count; ++i)
+      points[i] = fcl::Vector3d(mesh.vertices[3 * i], mesh.vertices[3 * i + 1], mesh.vertices[3 * i + 2]);
+
+    g->beginModel();
+    g->addSubModel(points, tri_indices);
+    g->endModel();
+  }
+  return g;
+}
+
 /** \brief Templated helper function creating new collision geometry out of general object using an arbitrary bounding
  *  volume (BV).
  *
@@ -899,26 +984,20 @@ FCLGeometryConstPtr createCollisionGeometry(const shapes::ShapeConstPtr& shape,
     break;
     case shapes::MESH:
     {
-      auto g = new fcl::BVHModel<BV>();
       const shapes::Mesh* mesh = static_cast<const shapes::Mesh*>(shape.get());
-      if (mesh->vertex_count > 0 && mesh->triangle_count > 0)
+      std::uint64_t hash;
+      ShapeCounts counts;
+      if (mesh->vertex_count > 0 && mesh->triangle_count > 0 && computeShapeHash(*mesh, hash, counts))
       {
-        std::vector<fcl::Triangle> tri_indices(mesh->triangle_count);
-        for (unsigned int i = 0; i < mesh->triangle_count; ++i)
-        {
-          tri_indices[i] =
-              fcl::Triangle(mesh->triangles[3 * i], mesh->triangles[3 * i + 1], mesh->triangles[3 * i + 2]);
-        }
-
-        std::vector<fcl::Vector3d> points(mesh->vertex_count);
-        for (unsigned int i = 0; i < mesh->vertex_count; ++i)
-          points[i] = fcl::Vector3d(mesh->vertices[3 * i], mesh->vertices[3 * i + 1], mesh->vertices[3 * i + 2]);
-
-        g->beginModel();
-        g->addSubModel(points, tri_indices);
-        g->endModel();
+        // building the hierarchy is expensive, so a built one is shared by all identical meshes in the process.
+        // Each geometry still gets its own copy, as it carries the user data of the object it belongs to.
+        std::shared_ptr<const fcl::BVHModel<BV>> bvh = GeometryCache::getInstance().get<fcl::BVHModel<BV>>(
+            std::string("fcl_bvh_") + typeid(BV).name(), hash, counts, [mesh] { return buildBVHModel<BV>(*mesh); },
+            [](const fcl::BVHModel<BV>& model) { return static_cast<std::size_t>(model.memUsage(0)); });
+        cg_g = new fcl::BVHModel<BV>(*bvh);
       }
-      cg_g = g;
+      else
+        cg_g = buildBVHModel<BV>(*mesh).release();
     }
     break;
     case shapes::OCTREE:
@@ -42,6 +42,10 @@
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
 #include <moveit/utils/logger.hpp>
+#include <moveit/utils/parallel_for.hpp>
+
+#include <algorithm>
+#include <set>
 
 #if (MOVEIT_FCL_VERSION >= FCL_VERSION_CHECK(0, 6, 0))
 #include <fcl/broadphase/broadphase_dynamic_AABB_tree.h>
@@ -113,10 +117,12 @@ CollisionEnvFCL::CollisionEnvFCL(const moveit::core::RobotModelConstPtr& model,
   }
 
   manager_ = std::make_unique<fcl::DynamicAABBTreeCollisionManagerd>();
+  manager_built_ = true;
 
   // request notifications about changes to new world
   observer_handle_ = getWorld()->addObserver(
-      [this](const World::ObjectConstPtr& object, World::Action action) { notifyObjectChange(object, action); });
+      [this](const World::ObjectConstPtr& object, World::Action action) { notifyObjectChange(object, action); },
+      [this](const World::ObjectChanges& changes) { notifyObjectChanges(changes); });
 }
 
 CollisionEnvFCL::CollisionEnvFCL(const moveit::core::RobotModelConstPtr& model, const WorldPtr& world, double padding,
@@ -151,10 +157,12 @@ CollisionEnvFCL::CollisionEnvFCL(const moveit::core::RobotModelConstPtr& model,
   }
 
   manager_ = std::make_unique<fcl::DynamicAABBTreeCollisionManagerd>();
+  manager_built_ = true;
 
   // request notifications about changes to new world
   observer_handle_ = getWorld()->addObserver(
-      [this](const World::ObjectConstPtr& object, World::Action action) { notifyObjectChange(object, action); });
+      [this](const World::ObjectConstPtr& object, World::Action action) { notifyObjectChange(object, action); },
+      [this](const World::ObjectChanges& changes) { notifyObjectChanges(changes); });
   getWorld()->notifyObserverAllObjects(observer_handle_, World::CREATE);
 }
 
@@ -168,16 +176,36 @@ CollisionEnvFCL::CollisionEnvFCL(const CollisionEnvFCL& other, const WorldPtr& w
   robot_geoms_ = other.robot_geoms_;
   robot_fcl_objs_ = other.robot_fcl_objs_;
 
-  manager_ = std::make_unique<fcl::DynamicAABBTreeCollisionManagerd>();
-
+  // the broadphase manager is built on first use, see getManager()
   fcl_objs_ = other.fcl_objs_;
-  for (auto& fcl_obj : fcl_objs_)
-    fcl_obj.second.registerTo(manager_.get());
-  // manager_->update();
 
   // request notifications about changes to new world
   observer_handle_ = getWorld()->addObserver(
-      [this](const World::ObjectConstPtr& object, World::Action action) { notifyObjectChange(object, action); });
+      [this](const World::ObjectConstPtr& object, World::Action action) { notifyObjectChange(object, action); },
+      [this](const World::ObjectChanges& changes) { notifyObjectChanges(changes); });
+}
+
+fcl::BroadPhaseCollisionManagerd* CollisionEnvFCL::getManager() const
+{
+  if (!manager_built_.load(std::memory_order_acquire))
+  {
+    std::lock_guard<std::mutex> lock(manager_mutex_);
+    if (!manager_built_.load(std::memory_order_relaxed))
+    {
+      // registering all objects at once lets the tree be built balanced in one pass
+      std::vector<fcl::CollisionObjectd*> collision_objects;
+      for (const auto& fcl_obj : fcl_objs_)
+      {
+        for (const auto& collision_object : fcl_obj.second.collision_objects_)
+          collision_objects.push_back(collision_object.get());
+      }
+      manager_ = std::make_unique<fcl::DynamicAABBTreeCollisionManagerd>();
+      if (!collision_objects.empty())
+        manager_->registerObjects(collision_objects);
+      manager_built_.store(true, std::memory_order_release);
+    }
+  }
+  return manager_.get();
 }
 
 void CollisionEnvFCL::getAttachedBodyObjects(const moveit::core::AttachedBody* ab,
@@ -335,7 +363,7 @@ void CollisionEnvFCL::checkRobotCollisionHelper(const CollisionRequest& req, Col
   CollisionData cd(&req, &res, acm);
   cd.enableGroup(getRobotModel());
   for (std::size_t i = 0; !cd.done_ && i < fcl_obj.collision_objects_.size(); ++i)
-    manager_->collide(fcl_obj.collision_objects_[i].get(), &cd, &collisionCallback);
+    getManager()->collide(fcl_obj.collision_objects_[i].get(), &cd, &collisionCallback);
 
   if (req.distance)
   {
@@ -376,7 +404,29 @@ void CollisionEnvFCL::distanceRobot(const DistanceRequest& req, DistanceResult&
 
   DistanceData drd(&req, &res);
   for (std::size_t i = 0; !drd.done && i < fcl_obj.collision_objects_.size(); ++i)
-    manager_->distance(fcl_obj.collision_objects_[i].get(), &drd, &distanceCallback);
+    getManager()->distance(fcl_obj.collision_objects_[i].get(), &drd, &distanceCallback);
+
+  // pairs with world objects found before the nearest ones were known may involve objects farther away
+  if (req.max_nearest_objects > 0)
+  {
+    const auto is_nearest = [&drd](const std::string& id) {
+      return std::any_of(drd.nearest_objects.begin(), drd.nearest_objects.end(),
+                         [&id](const std::pair<double, std::string>& object) { return object.second == id; });
+    };
+    for (auto it = res.distances.begin(); it != res.distances.end();)
+    {
+      const DistanceResultsData& data = it->second.front();
+      if ((data.body_types[0] == BodyTypes::WORLD_OBJECT && !is_nearest(data.link_names[0])) ||
+          (data.body_types[1] == BodyTypes::WORLD_OBJECT && !is_nearest(data.link_names[1])))
+      {
+        it = res.distances.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
 }
 
 void CollisionEnvFCL::updateFCLObject(const std::string& id)
@@ -385,7 +435,8 @@ void CollisionEnvFCL::updateFCLObject(const std::string& id)
   auto jt = fcl_objs_.find(id);
   if (jt != fcl_objs_.end())
   {
-    jt->second.unregisterFrom(manager_.get());
+    if (manager_built_)
+      jt->second.unregisterFrom(manager_.get());
     jt->second.clear();
   }
 
@@ -397,12 +448,14 @@ void CollisionEnvFCL::updateFCLObject(const std::string& id)
     if (jt != fcl_objs_.end())
     {
       constructFCLObjectWorld(it->second.get(), jt->second);
-      jt->second.registerTo(manager_.get());
+      if (manager_built_)
+        jt->second.registerTo(manager_.get());
     }
     else
     {
       constructFCLObjectWorld(it->second.get(), fcl_objs_[id]);
-      fcl_objs_[id].registerTo(manager_.get());
+      if (manager_built_)
+        fcl_objs_[id].registerTo(manager_.get());
     }
   }
   else
@@ -423,7 +476,8 @@ void CollisionEnvFCL::setWorld(const WorldPtr& world)
   getWorld()->removeObserver(observer_handle_);
 
   // clear out objects from old world
-  manager_->clear();
+  if (manager_built_)
+    manager_->clear();
   fcl_objs_.clear();
   cleanCollisionGeometryCache();
 
@@ -431,7 +485,8 @@ void CollisionEnvFCL::setWorld(const WorldPtr& world)
 
   // request notifications about changes to new world
   observer_handle_ = getWorld()->addObserver(
-      [this](const World::ObjectConstPtr& object, World::Action action) { notifyObjectChange(object, action); });
+      [this](const World::ObjectConstPtr& object, World::Action action) { notifyObjectChange(object, action); },
+      [this](const World::ObjectChanges& changes) { notifyObjectChanges(changes); });
 
   // get notifications any objects already in the new world
   getWorld()->notifyObserverAllObjects(observer_handle_, World::CREATE);
@@ -444,7 +499,8 @@ void CollisionEnvFCL::notifyObjectChange(const ObjectConstPtr& obj, World::Actio
     auto it = fcl_objs_.find(obj->id_);
     if (it != fcl_objs_.end())
     {
-      it->second.unregisterFrom(manager_.get());
+      if (manager_built_)
+        it->second.unregisterFrom(manager_.get());
       it->second.clear();
       fcl_objs_.erase(it);
     }
@@ -452,35 +508,30 @@ void CollisionEnvFCL::notifyObjectChange(const ObjectConstPtr& obj, World::Actio
   }
   else if (action == World::MOVE_SHAPE)
   {
+    moveFCLObject(obj, false);
+  }
+  else if (action == World::UPDATE_SHAPE && isUpdatedInPlace(obj))
+  {
+    // fcl::OcTree references the octomap directly, so modified voxels are already visible to the narrow phase.
+    // Only the broadphase entry needs to be refreshed; the collision geometry is kept.
     auto it = fcl_objs_.find(obj->id_);
-    if (it == fcl_objs_.end())
+    if (it == fcl_objs_.end() || !isBoundTo(it->second, obj.get()))
     {
-      RCLCPP_ERROR(getLogger(), "Cannot move shapes of unknown FCL object: '%s'", obj->id_.c_str());
-      return;
-    }
-
-    if (obj->global_shape_poses_.size() != it->second.collision_objects_.size())
-    {
-      RCLCPP_ERROR(getLogger(),
-                   "Cannot move shapes, shape size mismatch between FCL object and world object: '%s'. Respectively "
-                   "%zu and %zu.",
-                   obj->id_.c_str(), it->second.collision_objects_.size(), it->second.collision_objects_.size());
+      updateFCLObject(obj->id_);
       return;
     }
 
+    if (manager_built_)
+      it->second.unregisterFrom(manager_.get());
     for (std::size_t i = 0; i < it->second.collision_objects_.size(); ++i)
     {
-      it->second.collision_objects_[i]->setTransform(transform2fcl(obj->global_shape_poses_[i]));
-
-      // compute AABB, order matters
+      if (it->second.collision_objects_[i].use_count() != 1)
+        it->second.collision_objects_[i] = std::make_shared<fcl::CollisionObjectd>(*it->second.collision_objects_[i]);
       it->second.collision_geometry_[i]->collision_geometry_->computeLocalAABB();
       it->second.collision_objects_[i]->computeAABB();
     }
-
-    // update AABB in the FCL broadphase manager tree
-    // see https://github.com/moveit/moveit/pull/3601 for benchmarks
-    it->second.unregisterFrom(manager_.get());
-    it->second.registerTo(manager_.get());
+    if (manager_built_)
+      it->second.registerTo(manager_.get());
   }
   else
   {
@@ -490,6 +541,166 @@ void CollisionEnvFCL::notifyObjectChange(const ObjectConstPtr& obj, World::Actio
   }
 }
 
+bool CollisionEnvFCL::isBoundTo(const FCLObject& fcl_obj, const World::Object* obj)
+{
+  return std::all_of(fcl_obj.collision_geometry_.begin(), fcl_obj.collision_geometry_.end(),
+                     [obj](const FCLGeometryConstPtr& geometry) {
+                       return geometry->collision_geometry_data_->ptr.obj == obj;
+                     });
+}
+
+bool CollisionEnvFCL::moveFCLObject(const ObjectConstPtr& obj, bool defer_broadphase_update)
+{
+  auto it = fcl_objs_.find(obj->id_);
+  if (it == fcl_objs_.end())
+  {
+    RCLCPP_ERROR(getLogger(), "Cannot move shapes of unknown FCL object: '%s'", obj->id_.c_str());
+    return false;
+  }
+
+  // the world copies objects that are shared with other worlds before changing them, the collision geometry data
+  // must not keep pointing to the previous instance, which may be destroyed together with the other world
+  if (!isBoundTo(it->second, obj.get()))
+  {
+    updateFCLObject(obj->id_);
+    return false;
+  }
+
+  if (obj->global_shape_poses_.size() != it->second.collision_objects_.size())
+  {
+    RCLCPP_ERROR(getLogger(),
+                 "Cannot move shapes, shape size mismatch between FCL object and world object: '%s'. Respectively "
+                 "%zu and %zu.",
+                 obj->id_.c_str(), it->second.collision_objects_.size(), obj->global_shape_poses_.size());
+    return false;
+  }
+
+  // collision objects may be shared with copies of this environment and are copied before they are moved,
+  // the broadphase manager has to be told about such replaced objects right away
+  const bool shared =
+      std::any_of(it->second.collision_objects_.begin(), it->second.collision_objects_.end(),
+                  [](const FCLCollisionObjectPtr& collision_object) { return collision_object.use_count() != 1; });
+  const bool reregister = manager_built_ && (shared || !defer_broadphase_update);
+
+  // update AABB in the FCL broadphase manager tree
+  // see https://github.com/moveit/moveit/pull/3601 for benchmarks
+  if (reregister)
+    it->second.unregisterFrom(manager_.get());
+
+  for (std::size_t i = 0; i < it->second.collision_objects_.size(); ++i)
+  {
+    if (it->second.collision_objects_[i].use_count() != 1)
+      it->second.collision_objects_[i] = std::make_shared<fcl::CollisionObjectd>(*it->second.collision_objects_[i]);
+    it->second.collision_objects_[i]->setTransform(transform2fcl(obj->global_shape_poses_[i]));
+
+    // compute AABB, order matters
+    it->second.collision_geometry_[i]->collision_geometry_->computeLocalAABB();
+    it->second.collision_objects_[i]->computeAABB();
+  }
+
+  if (reregister)
+    it->second.registerTo(manager_.get());
+  return manager_built_ && !reregister;
+}
+
+void CollisionEnvFCL::notifyObjectChanges(const World::ObjectChanges& changes)
+{
+  std::size_t rebuilt_count = 0;
+  std::size_t moved_count = 0;
+  for (const std::pair<World::ObjectConstPtr, World::Action>& change : changes)
+  {
+    if (change.second == World::MOVE_SHAPE)
+      ++moved_count;
+    else if (change.second != World::DESTROY)
+      ++rebuilt_count;
+  }
+
+  // a balanced tree built once from all objects beats inserting a large share of them one by one
+  if (manager_built_ && 4 * rebuilt_count >= fcl_objs_.size())
+  {
+    manager_.reset();
+    manager_built_ = false;
+  }
+  // likewise, a single refit of the tree beats reinserting a large share of the objects
+  const bool defer_broadphase_update = 4 * moved_count >= fcl_objs_.size();
+  bool refit = false;
+
+  // removals and moves are applied right away, objects that need new FCL geometry are collected and built together
+  std::set<std::string> rebuilt_ids;
+  for (const std::pair<World::ObjectConstPtr, World::Action>& change : changes)
+  {
+    const World::ObjectConstPtr& obj = change.first;
+    const World::Action action = change.second;
+    if (action == World::DESTROY)
+    {
+      notifyObjectChange(obj, action);
+    }
+    else if (rebuilt_ids.find(obj->id_) != rebuilt_ids.end())
+    {
+      // objects collected for rebuilding pick up the new poses from the world
+      continue;
+    }
+    else if (action == World::MOVE_SHAPE)
+    {
+      refit |= moveFCLObject(obj, defer_broadphase_update);
+    }
+    else if (action == World::UPDATE_SHAPE && isUpdatedInPlace(obj))
+    {
+      notifyObjectChange(obj, action);
+    }
+    else
+    {
+      rebuilt_ids.insert(obj->id_);
+    }
+  }
+  if (refit && manager_built_)
+    manager_->update();
+
+  std::vector<World::ObjectConstPtr> objects;
+  objects.reserve(rebuilt_ids.size());
+  for (const std::string& id : rebuilt_ids)
+  {
+    auto it = getWorld()->find(id);
+    if (it != getWorld()->end())
+    {
+      objects.push_back(it->second);
+      continue;
+    }
+
+    // the object was removed again within the same batch
+    auto jt = fcl_objs_.find(id);
+    if (jt != fcl_objs_.end())
+    {
+      if (manager_built_)
+        jt->second.unregisterFrom(manager_.get());
+      fcl_objs_.erase(jt);
+    }
+  }
+
+  // mesh and octree conversions dominate, and are independent for each object
+  std::vector<FCLObject> built_objects(objects.size());
+  moveit::core::parallelFor(objects.size(), [this, &objects, &built_objects](std::size_t i) {
+    constructFCLObjectWorld(objects[i].get(), built_objects[i]);
+  });
+
+  for (std::size_t i = 0; i < objects.size(); ++i)
+  {
+    FCLObject& fcl_obj = fcl_objs_[objects[i]->id_];
+    if (manager_built_)
+      fcl_obj.unregisterFrom(manager_.get());
+    fcl_obj = std::move(built_objects[i]);
+    if (manager_built_)
+      fcl_obj.registerTo(manager_.get());
+  }
+  cleanCollisionGeometryCache();
+}
+
+bool CollisionEnvFCL::isUpdatedInPlace(const ObjectConstPtr& obj)
+{
+  return std::all_of(obj->shapes_.begin(), obj->shapes_.end(),
+                     [](const shapes::ShapeConstPtr& shape) { return shape->type == shapes::OCTREE; });
+}
+
 void CollisionEnvFCL::updatedPaddingOrScaling(const std::vector<std::string>& links)
 {
   std::size_t index;
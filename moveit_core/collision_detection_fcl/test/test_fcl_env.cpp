@@ -49,6 +49,8 @@
 #include <urdf_parser/urdf_parser.h>
 #include <geometric_shapes/shape_operations.h>
 
+#include <set>
+
 /** \brief Brings the panda robot in user defined home position */
 inline void setToHome(moveit::core::RobotState& panda_state)
 {
@@ -195,6 +197,136 @@ TEST_F(CollisionDetectionEnvTest, RobotWorldCollision_2)
   res.clear();
 }
 
+/** \brief Changes made in a world transaction reach the environment together, on commit. */
+TEST_F(CollisionDetectionEnvTest, WorldTransaction)
+{
+  collision_detection::CollisionRequest req;
+  collision_detection::CollisionResult res;
+  const collision_detection::WorldPtr& world = c_env_->getWorld();
+
+  for (int i = 0; i < 20; ++i)
+  {
+    Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+    pose.translation().x() = 2.0 + 0.2 * i;
+    world->addToObject("box" + std::to_string(i), std::make_shared<shapes::Box>(.1, .1, .1), pose);
+  }
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  ASSERT_FALSE(res.collision);
+  res.clear();
+
+  // move all boxes next to the robot base, one of them into it
+  world->beginTransaction();
+  for (int i = 0; i < 20; ++i)
+  {
+    Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+    pose.translation().y() = 0.5 + 0.2 * i;
+    world->setObjectPose("box" + std::to_string(i), pose);
+  }
+  world->setObjectPose("box0", Eigen::Isometry3d(Eigen::Translation3d(0.0, 0.0, 0.3)));
+
+  // the environment is only updated on commit
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_FALSE(res.collision);
+  res.clear();
+  world->commitTransaction();
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_TRUE(res.collision);
+  res.clear();
+
+  // objects that are replaced within a transaction are rebuilt from the latest state
+  world->beginTransaction();
+  world->removeObject("box0");
+  world->addToObject("box0", std::make_shared<shapes::Box>(.1, .1, .1),
+                     Eigen::Isometry3d(Eigen::Translation3d(0.0, 2.0, 0.3)));
+  world->setObjectPose("box1", Eigen::Isometry3d(Eigen::Translation3d(0.0, 0.0, 0.3)));
+  world->removeObject("box1");
+  world->commitTransaction();
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_FALSE(res.collision);
+}
+
+/** \brief Tests that objects which are copied on their first change in a world are still checked correctly after the
+ *   world they were shared with is gone. */
+TEST_F(CollisionDetectionEnvTest, MoveSharedWorldObject)
+{
+  collision_detection::CollisionRequest req;
+  collision_detection::CollisionResult res;
+  const collision_detection::WorldPtr& world = c_env_->getWorld();
+  world->addToObject("box", std::make_shared<shapes::Box>(.1, .1, .1),
+                     Eigen::Isometry3d(Eigen::Translation3d(0.0, 2.0, 0.3)));
+
+  // the copied world shares the object until it is moved below
+  auto other_world = std::make_shared<collision_detection::World>(*world);
+  {
+    collision_detection::World::ScopedTransaction transaction(*world);
+    world->setObjectPose("box", Eigen::Isometry3d(Eigen::Translation3d(0.0, 1.0, 0.3)));
+    world->moveShapesInObject("box", { Eigen::Isometry3d::Identity() });
+    world->setObjectPose("box", Eigen::Isometry3d(Eigen::Translation3d(0.0, 0.0, 0.3)));
+  }
+  other_world.reset();
+
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_TRUE(res.collision);
+
+  collision_detection::DistanceRequest dreq;
+  dreq.acm = acm_.get();
+  collision_detection::DistanceResult dres;
+  c_env_->distanceRobot(dreq, dres, *robot_state_);
+  EXPECT_LE(dres.minimum_distance.distance, 0.0);
+}
+
+/** \brief Tests that distance queries are bounded by the distance threshold and the number of nearest objects. */
+TEST_F(CollisionDetectionEnvTest, DistanceNearestObjects)
+{
+  const collision_detection::WorldPtr& world = c_env_->getWorld();
+  for (int i = 0; i < 10; ++i)
+  {
+    Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+    pose.translation().y() = 1.0 + 0.5 * i;
+    world->addToObject("box" + std::to_string(i), std::make_shared<shapes::Box>(.1, .1, .1), pose);
+  }
+
+  const auto world_objects = [](const collision_detection::DistanceResult& res) {
+    std::set<std::string> objects;
+    for (const auto& distance : res.distances)
+    {
+      const collision_detection::DistanceResultsData& data = distance.second.front();
+      for (std::size_t i = 0; i < 2; ++i)
+      {
+        if (data.body_types[i] == collision_detection::BodyTypes::WORLD_OBJECT)
+          objects.insert(data.link_names[i]);
+      }
+    }
+    return objects;
+  };
+
+  collision_detection::DistanceRequest req;
+  req.type = collision_detection::DistanceRequestType::SINGLE;
+  req.acm = acm_.get();
+  collision_detection::DistanceResult res;
+  c_env_->distanceRobot(req, res, *robot_state_);
+  EXPECT_EQ(world_objects(res).size(), 10u);
+  const double minimum_distance = res.minimum_distance.distance;
+  res.clear();
+
+  // only the two nearest boxes are reported, without changing the minimum distance
+  req.max_nearest_objects = 2;
+  c_env_->distanceRobot(req, res, *robot_state_);
+  EXPECT_EQ(world_objects(res), std::set<std::string>({ "box0", "box1" }));
+  EXPECT_NEAR(res.minimum_distance.distance, minimum_distance, 1e-6);
+  res.clear();
+
+  // boxes farther away than the threshold are not reported
+  req.max_nearest_objects = 0;
+  req.distance_threshold = minimum_distance + 1.2;
+  c_env_->distanceRobot(req, res, *robot_state_);
+  std::set<std::string> objects = world_objects(res);
+  EXPECT_TRUE(objects.count("box0"));
+  EXPECT_FALSE(objects.count("box9"));
+  for (const auto& distance : res.distances)
+    EXPECT_LT(distance.second.front().distance, req.distance_threshold);
+}
+
 /** \brief Tests the padding through expanding the link geometry in such a way that a collision occurs. */
 TEST_F(CollisionDetectionEnvTest, PaddingTest)
 {
@@ -1714,7 +1714,7 @@ void CollisionEnvDistanceField::notifyObjectChange(const ObjectConstPtr& obj, Wo
   {
     distance_field_cache_entry_world_->distance_field_->removePointsFromField(subtract_points);
   }
-  else if (action & (World::MOVE_SHAPE | World::REMOVE_SHAPE))
+  else if (action & (World::MOVE_SHAPE | World::REMOVE_SHAPE | World::UPDATE_SHAPE))
   {
     distance_field_cache_entry_world_->distance_field_->removePointsFromField(subtract_points);
     distance_field_cache_entry_world_->distance_field_->addPointsToField(add_points);
@@ -247,6 +247,20 @@ public:
    */
   virtual const std::string& getName() const = 0;
 
+  /**
+   * \brief Create an independent copy of this sampler, so samples can be drawn from another thread.
+   *
+   * The copy samples the same constraints, but owns its random number generator and any
+   * other state that is not safe to share between threads. The group state validity
+   * callback is not copied.
+   *
+   * \return The copy, or an empty pointer if this sampler cannot be copied
+   */
+  virtual ConstraintSamplerPtr clone() const
+  {
+    return ConstraintSamplerPtr();
+  }
+
 protected:
   /**
    * \brief Clears all data from the constraint.
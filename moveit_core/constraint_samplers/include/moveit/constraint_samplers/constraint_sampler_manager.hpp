@@ -37,6 +37,7 @@
 #pragma once
 
 #include <moveit/constraint_samplers/constraint_sampler_allocator.hpp>
+#include <moveit/constraint_samplers/reachability_map.hpp>
 #include <moveit/macros/class_forward.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <rclcpp/clock.hpp>
@@ -75,6 +76,23 @@ public:
   {
     sampler_alloc_.push_back(sa);
   }
+
+  /**
+   * \brief Registers a reachability map for the IK constraint samplers of its group and link
+   *
+   * Samplers produced by \ref selectSampler, including those inside a
+   * UnionConstraintSampler, use the map registered for their group and
+   * constrained link, if any. See IKConstraintSampler::setReachabilityMap().
+   * Maps that do not fit the robot model of a sampler are skipped. The
+   * ConstraintSamplerManagerLoader registers the maps listed in the
+   * "reachability_maps" parameter.
+   *
+   * @param map The reachability map
+   */
+  void registerReachabilityMap(const ReachabilityMapConstPtr& map)
+  {
+    reachability_maps_.push_back(map);
+  }
   /**
    * \brief Selects among the potential sampler allocators.
    *
@@ -144,5 +162,6 @@ public:
 private:
   std::vector<ConstraintSamplerAllocatorPtr>
       sampler_alloc_; /**< \brief Holds the constraint sampler allocators, which will be tested in order  */
+  std::vector<ReachabilityMapConstPtr> reachability_maps_; /**< \brief Maps handed to IK constraint samplers */
 };
 }  // namespace constraint_samplers
@@ -37,6 +37,7 @@
 #pragma once
 
 #include <moveit/constraint_samplers/constraint_sampler.hpp>
+#include <moveit/constraint_samplers/reachability_map.hpp>
 #include <moveit/macros/class_forward.hpp>
 #include <random_numbers/random_numbers.h>
 #include <rclcpp/rclcpp.hpp>
@@ -174,6 +175,11 @@ public:
     return SAMPLER_NAME;
   }
 
+  /**
+   * \brief Create an independent copy of this sampler, so samples can be drawn from another thread
+   */
+  ConstraintSamplerPtr clone() const override;
+
 protected:
   /// \brief An internal structure used for maintaining constraints on a particular joint
   struct JointInfo
@@ -418,6 +424,33 @@ public:
     ik_timeout_ = timeout;
   }
 
+  /**
+   * \brief Sets a reachability map used to bias pose sampling and to seed IK
+   *
+   * The map is only used if it was generated for the group of this
+   * sampler and the constrained link. Sampled poses are then accepted with
+   * the probability the map assigns to them (but at least
+   * MIN_REACHABILITY_ACCEPTANCE, as the map is an approximation), and IK is
+   * seeded with the configuration the map stores for the pose instead of a
+   * random one.
+   *
+   * A map that does not fit the group (see ReachabilityMap::isCompatible())
+   * is rejected, and the sampler then uses no map.
+   *
+   * @param map The map, or an empty pointer to stop using a map
+   *
+   * @return False if the map was rejected
+   */
+  bool setReachabilityMap(const ReachabilityMapConstPtr& map);
+
+  /**
+   * \brief Gets the reachability map set for this sampler, if any
+   */
+  const ReachabilityMapConstPtr& getReachabilityMap() const
+  {
+    return reachability_map_;
+  }
+
   /**
    * \brief Gets the position constraint associated with this sampler.
    *
@@ -486,6 +519,9 @@ public:
   bool sample(moveit::core::RobotState& state, const moveit::core::RobotState& reference_state,
               unsigned int max_attempts) override;
 
+  /** \brief The lowest probability with which a sampled pose is accepted when a reachability map is used */
+  static constexpr double MIN_REACHABILITY_ACCEPTANCE = 0.05;
+
   /**
    * \brief Returns a pose that falls within the constraint regions.
    *
@@ -522,6 +558,14 @@ public:
     return SAMPLER_NAME;
   }
 
+  /**
+   * \brief Create an independent copy of this sampler, so samples can be drawn from another thread
+   *
+   * The copy needs a kinematics solver of its own, so this fails if the
+   * group's solver allocator only hands out the shared instance
+   */
+  ConstraintSamplerPtr clone() const override;
+
 protected:
   void clear() override;
 
@@ -548,6 +592,17 @@ protected:
               moveit::core::RobotState& state, bool use_as_seed);
   bool sampleHelper(moveit::core::RobotState& state, const moveit::core::RobotState& reference_state,
                     unsigned int max_attempts);
+
+  /**
+   * \brief Calls \ref samplePose until the reachability map accepts a pose
+   *
+   * The draws share one budget of max_attempts for sampling the constraint region, so the cost stays linear in
+   * max_attempts.
+   *
+   * @param [out] map_pose The accepted pose, in the frame of the reachability map
+   */
+  bool sampleReachablePose(Eigen::Vector3d& pos, Eigen::Quaterniond& quat, Eigen::Isometry3d& map_pose,
+                           const moveit::core::RobotState& ks, unsigned int max_attempts);
   bool validate(moveit::core::RobotState& state) const;
 
   random_numbers::RandomNumberGenerator random_number_generator_; /**< \brief Random generator used by the sampler */
@@ -560,5 +615,6 @@ protected:
   bool need_eef_to_ik_tip_transform_; /**< \brief True if the tip frame of the inverse kinematic is different than the
                                         frame of the end effector */
   Eigen::Isometry3d eef_to_ik_tip_transform_; /**< \brief Holds the transformation from end effector to IK tip frame */
+  ReachabilityMapConstPtr reachability_map_;  /**< \brief Optional map to bias sampling and seed IK with */
 };
 }  // namespace constraint_samplers
@@ -0,0 +1,199 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <moveit/macros/class_forward.hpp>
+#include <moveit/robot_state/robot_state.hpp>
+#include <random_numbers/random_numbers.h>
+#include <Eigen/Geometry>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace constraint_samplers
+{
+MOVEIT_CLASS_FORWARD(ReachabilityMap);  // Defines ReachabilityMapPtr, ConstPtr, WeakPtr... etc
+
+/**
+ * \brief A precomputed map of the poses a link of a joint model group can reach.
+ *
+ * The workspace is divided into cubic voxels, and the orientations in each
+ * voxel into bins of the direction of the link's z axis (a cube map with
+ * getOrientationDivisions() squared bins on each face). Each non-empty cell
+ * stores an estimate of how likely IK is to succeed for poses in it, and
+ * the joint values of a configuration that reaches it, for use as IK seed.
+ *
+ * Maps are generated offline by forward kinematics of random
+ * configurations of the group, and are expressed in the frame of the
+ * group's base link (the parent link of its common root joint), so they
+ * stay valid as joints outside of the group move.
+ */
+class ReachabilityMap
+{
+public:
+  ReachabilityMap();
+
+  /**
+   * \brief Generate the map by sampling random configurations of a group
+   *
+   * Joints outside the group keep their values in \e reference_state.
+   *
+   * @param reference_state The state to take the values of other joints from
+   * @param group The group to generate the map for
+   * @param tip_link The link whose poses to record
+   * @param resolution The edge length of a voxel, in meters
+   * @param samples The number of configurations to sample
+   * @param seed The seed of the random number generator, for reproducible maps
+   * @param orientation_divisions The number of orientation bins along each edge of a cube map face
+   *
+   * @return True if the map was generated
+   */
+  bool generate(const moveit::core::RobotState& reference_state, const moveit::core::JointModelGroup* group,
+                const moveit::core::LinkModel* tip_link, double resolution, std::size_t samples, std::uint32_t seed,
+                unsigned int orientation_divisions = 2);
+
+  /**
+   * \brief Save the map to a file
+   *
+   * @return True on success
+   */
+  bool save(const std::string& filename) const;
+
+  /**
+   * \brief Load a map previously written with save()
+   *
+   * @return True on success. On failure, the map is left empty.
+   */
+  bool load(const std::string& filename);
+
+  /**
+   * \brief Estimate the probability of IK succeeding for a pose of the tip link
+   *
+   * @param pose The pose of the tip link, expressed in the frame of the base link
+   *
+   * @return A value in [0, 1]; 0 if the pose was never reached while generating the map
+   */
+  double getReachability(const Eigen::Isometry3d& pose) const;
+
+  /**
+   * \brief Get the joint values of a configuration reaching a pose's cell
+   *
+   * @param pose The pose of the tip link, expressed in the frame of the base link
+   * @param [out] values The values of the group's variables, in group order
+   *
+   * @return True if the cell was reached while generating the map
+   */
+  bool getSeed(const Eigen::Isometry3d& pose, std::vector<double>& values) const;
+
+  /**
+   * \brief Check that the map fits a group of a robot model
+   *
+   * The map must have been generated for a group of the same name and
+   * number of variables, and its base and tip links must exist in the
+   * group's robot model. Maps loaded from a file for a different robot
+   * fail this check. The reason is logged.
+   *
+   * @return True if the map can be used with the group
+   */
+  bool isCompatible(const moveit::core::JointModelGroup* group) const;
+
+  /**
+   * \brief Get the transform from the model frame to the frame of the map in a given state
+   *
+   * The base link must exist in the state's robot model, see isCompatible().
+   */
+  Eigen::Isometry3d getBaseTransform(const moveit::core::RobotState& state) const;
+
+  bool empty() const
+  {
+    return keys_.empty();
+  }
+
+  std::size_t getCellCount() const
+  {
+    return keys_.size();
+  }
+
+  const std::string& getGroupName() const
+  {
+    return group_name_;
+  }
+
+  const std::string& getBaseLinkName() const
+  {
+    return base_link_name_;
+  }
+
+  const std::string& getTipLinkName() const
+  {
+    return tip_link_name_;
+  }
+
+  std::size_t getVariableCount() const
+  {
+    return variable_count_;
+  }
+
+  double getResolution() const
+  {
+    return resolution_;
+  }
+
+  unsigned int getOrientationDivisions() const
+  {
+    return orientation_divisions_;
+  }
+
+private:
+  void clear();
+
+  /** \brief Key of the cell of a pose; all bits set if the pose is outside the representable range */
+  std::uint64_t cellKey(const Eigen::Isometry3d& pose) const;
+
+  /** \brief Index of the cell with a given key, or -1 */
+  std::ptrdiff_t findCell(std::uint64_t key) const;
+
+  std::string group_name_;
+  std::string base_link_name_; /**< \brief Empty if the map is expressed in the model frame */
+  std::string tip_link_name_;
+  double resolution_;
+  unsigned int orientation_divisions_;
+  std::size_t variable_count_;
+
+  std::vector<std::uint64_t> keys_;       /**< \brief Sorted keys of the non-empty cells */
+  std::vector<std::uint8_t> probability_; /**< \brief Success probability of each cell, scaled to [0, 255] */
+  std::vector<float> seeds_;              /**< \brief variable_count_ seed values for each cell */
+};
+}  // namespace constraint_samplers
@@ -163,6 +163,12 @@ public:
     return SAMPLER_NAME;
   }
 
+  /**
+   * \brief Create an independent copy of this sampler by cloning every
+   * internal sampler; fails if any of them cannot be cloned
+   */
+  ConstraintSamplerPtr clone() const override;
+
 protected:
   std::vector<ConstraintSamplerPtr> samplers_; /**< \brief Holder for sorted internal list of samplers*/
 };
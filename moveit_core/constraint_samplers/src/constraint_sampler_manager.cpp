@@ -39,6 +39,7 @@
 #include <moveit/constraint_samplers/union_constraint_sampler.hpp>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
+#include <algorithm>
 #include <sstream>
 #include <moveit/utils/logger.hpp>
 
@@ -50,20 +51,44 @@ rclcpp::Logger getLogger()
 {
   return moveit::getLogger("moveit.core.constraint_sampler_manager");
 }
+
+void attachReachabilityMaps(const ConstraintSamplerPtr& sampler, const std::vector<ReachabilityMapConstPtr>& maps)
+{
+  if (!sampler || !sampler->isValid())
+    return;
+  if (IKConstraintSamplerPtr ik_sampler = std::dynamic_pointer_cast<IKConstraintSampler>(sampler))
+  {
+    for (const ReachabilityMapConstPtr& map : maps)
+    {
+      if (map->getGroupName() == ik_sampler->getGroupName() && map->getTipLinkName() == ik_sampler->getLinkName() &&
+          ik_sampler->setReachabilityMap(map))
+        break;
+    }
+  }
+  else if (auto union_sampler = std::dynamic_pointer_cast<UnionConstraintSampler>(sampler))
+  {
+    for (const ConstraintSamplerPtr& member : union_sampler->getSamplers())
+      attachReachabilityMaps(member, maps);
+  }
+}
 }  // namespace
 
 ConstraintSamplerPtr ConstraintSamplerManager::selectSampler(const planning_scene::PlanningSceneConstPtr& scene,
                                                              const std::string& group_name,
                                                              const moveit_msgs::msg::Constraints& constr) const
 {
-  for (const ConstraintSamplerAllocatorPtr& sampler : sampler_alloc_)
-  {
-    if (sampler->canService(scene, group_name, constr))
-      return sampler->alloc(scene, group_name, constr);
-  }
+  const auto allocator = std::find_if(sampler_alloc_.begin(), sampler_alloc_.end(),
+                                      [&](const ConstraintSamplerAllocatorPtr& sampler) {
+                                        return sampler->canService(scene, group_name, constr);
+                                      });
+
+  // if no allocator can service the constraints, try a default sampler
+  ConstraintSamplerPtr result = allocator != sampler_alloc_.end() ? (*allocator)->alloc(scene, group_name, constr) :
+                                                                    selectDefaultSampler(scene, group_name, constr);
 
-  // if no default sampler was used, try a default one
-  return selectDefaultSampler(scene, group_name, constr);
+  if (!reachability_maps_.empty())
+    attachReachabilityMaps(result, reachability_maps_);
+  return result;
 }
 
 ConstraintSamplerPtr ConstraintSamplerManager::selectDefaultSampler(const planning_scene::PlanningSceneConstPtr& scene,
@@ -37,7 +37,9 @@
 #include <moveit/constraint_samplers/default_constraint_samplers.hpp>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <functional>
 #include <moveit/utils/logger.hpp>
 
@@ -205,6 +207,19 @@ void JointConstraintSampler::clear()
   values_.clear();
 }
 
+ConstraintSamplerPtr JointConstraintSampler::clone() const
+{
+  auto sampler = std::make_shared<JointConstraintSampler>(scene_, jmg_->getName());
+  sampler->is_valid_ = is_valid_;
+  sampler->frame_depends_ = frame_depends_;
+  sampler->verbose_ = verbose_;
+  sampler->bounds_ = bounds_;
+  sampler->unbounded_ = unbounded_;
+  sampler->uindex_ = uindex_;
+  sampler->values_ = values_;
+  return sampler;
+}
+
 IKSamplingPose::IKSamplingPose()
 {
 }
@@ -292,6 +307,33 @@ bool IKConstraintSampler::configure(const IKSamplingPose& sp)
   return is_valid_;
 }
 
+ConstraintSamplerPtr IKConstraintSampler::clone() const
+{
+  if (!is_valid_)
+    return ConstraintSamplerPtr();
+
+  // kinematics solvers are not thread-safe, so the copy needs an instance of its own
+  const moveit::core::SolverAllocatorFn& allocator = jmg_->getGroupKinematics().first.allocator_;
+  kinematics::KinematicsBaseConstPtr kb = allocator ? allocator(jmg_) : kinematics::KinematicsBasePtr();
+  if (!kb || kb == kb_)
+  {
+    RCLCPP_DEBUG(getLogger(), "Unable to allocate a separate IK solver for group '%s'", jmg_->getName().c_str());
+    return ConstraintSamplerPtr();
+  }
+
+  auto sampler = std::make_shared<IKConstraintSampler>(scene_, jmg_->getName());
+  sampler->verbose_ = verbose_;
+  sampler->sampling_pose_ = sampling_pose_;
+  sampler->ik_timeout_ = ik_timeout_;
+  sampler->frame_depends_ = frame_depends_;
+  sampler->reachability_map_ = reachability_map_;
+  sampler->kb_ = kb;
+  if (!sampler->loadIKSolver())
+    return ConstraintSamplerPtr();
+  sampler->is_valid_ = true;
+  return sampler;
+}
+
 bool IKConstraintSampler::configure(const moveit_msgs::msg::Constraints& constr)
 {
   for (std::size_t p = 0; p < constr.position_constraints.size(); ++p)
@@ -602,18 +644,32 @@ bool IKConstraintSampler::sampleHelper(moveit::core::RobotState& state, const mo
     };
   }
 
+  const bool use_map = reachability_map_ && reachability_map_->getGroupName() == jmg_->getName() &&
+                       reachability_map_->getTipLinkName() == getLinkName();
+  std::vector<double> map_seed;
+
   for (unsigned int a = 0; a < max_attempts; ++a)
   {
     // sample a point in the constraint region
     Eigen::Vector3d point;
     Eigen::Quaterniond quat;  // quat is normalized by contract
-    if (!samplePose(point, quat, reference_state, max_attempts))
+    Eigen::Isometry3d map_pose;
+    if (use_map ? !sampleReachablePose(point, quat, map_pose, reference_state, max_attempts) :
+                  !samplePose(point, quat, reference_state, max_attempts))
     {
       if (verbose_)
         RCLCPP_INFO(getLogger(), "IK constraint sampler was unable to produce a pose to run IK for");
       return false;
     }
 
+    // instead of a random seed, use a configuration known to reach close to the pose
+    bool use_as_seed = a == 0;
+    if (!use_as_seed && use_map && reachability_map_->getSeed(map_pose, map_seed))
+    {
+      state.setJointGroupPositions(jmg_, map_seed);
+      use_as_seed = true;
+    }
+
     // we now have the transform we wish to perform IK for, in the planning frame
     if (transform_ik_)
     {
@@ -644,12 +700,59 @@ bool IKConstraintSampler::sampleHelper(moveit::core::RobotState& state, const mo
     ik_query.orientation.z = quat.z();
     ik_query.orientation.w = quat.w();
 
-    if (callIK(ik_query, adapted_ik_validity_callback, ik_timeout_, state, a == 0))
+    if (callIK(ik_query, adapted_ik_validity_callback, ik_timeout_, state, use_as_seed))
       return true;
   }
   return false;
 }
 
+bool IKConstraintSampler::setReachabilityMap(const ReachabilityMapConstPtr& map)
+{
+  if (map && !map->isCompatible(jmg_))
+  {
+    reachability_map_.reset();
+    return false;
+  }
+  reachability_map_ = map;
+  return true;
+}
+
+bool IKConstraintSampler::sampleReachablePose(Eigen::Vector3d& pos, Eigen::Quaterniond& quat,
+                                              Eigen::Isometry3d& map_pose, const moveit::core::RobotState& ks,
+                                              unsigned int max_attempts)
+{
+  // All draws share one budget of max_attempts for sampling the constraint region. Since every pose is accepted with
+  // a probability of at least MIN_REACHABILITY_ACCEPTANCE, more draws than 1 / MIN_REACHABILITY_ACCEPTANCE rarely help.
+  const unsigned int max_draws =
+      std::max(1u, std::min(max_attempts, static_cast<unsigned int>(std::ceil(1.0 / MIN_REACHABILITY_ACCEPTANCE))));
+  const unsigned int attempts_per_draw = std::max(1u, max_attempts / max_draws);
+  Eigen::Vector3d last_pos;
+  Eigen::Quaterniond last_quat;
+  bool sampled = false;
+  for (unsigned int a = 0; a < max_draws; ++a)
+  {
+    if (!samplePose(pos, quat, ks, attempts_per_draw))
+      break;
+    sampled = true;
+    last_pos = pos;
+    last_quat = quat;
+
+    // the map is for the pose of the link itself, in the frame of the group's base link
+    map_pose = reachability_map_->getBaseTransform(ks).inverse() * (Eigen::Translation3d(pos) * quat);
+    const double acceptance = std::max(reachability_map_->getReachability(map_pose), MIN_REACHABILITY_ACCEPTANCE);
+    if (random_number_generator_.uniform01() < acceptance)
+      return true;
+  }
+  if (!sampled)
+    return false;
+
+  // the region is mostly unreachable according to the map, try the last pose regardless
+  pos = last_pos;
+  quat = last_quat;
+  map_pose = reachability_map_->getBaseTransform(ks).inverse() * (Eigen::Translation3d(pos) * quat);
+  return true;
+}
+
 bool IKConstraintSampler::validate(moveit::core::RobotState& state) const
 {
   state.update();
@@ -0,0 +1,382 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/constraint_samplers/reachability_map.hpp>
+#include <moveit/utils/logger.hpp>
+#include <rclcpp/logger.hpp>
+#include <rclcpp/logging.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+
+namespace constraint_samplers
+{
+namespace
+{
+rclcpp::Logger getLogger()
+{
+  return moveit::getLogger("moveit.core.reachability_map");
+}
+
+const char FILE_MAGIC[8] = { 'M', 'V', 'R', 'C', 'H', 'M', 'A', 'P' };
+const std::uint32_t FILE_VERSION = 1;
+
+// Cell keys pack three 18 bit voxel coordinates and a 10 bit orientation bin
+const int COORDINATE_BITS = 18;
+const int BIN_BITS = 10;
+const std::int64_t COORDINATE_OFFSET = std::int64_t(1) << (COORDINATE_BITS - 1);
+const std::uint64_t INVALID_KEY = std::numeric_limits<std::uint64_t>::max();
+// 6 * 13^2 bins still fit in BIN_BITS
+const unsigned int MAX_ORIENTATION_DIVISIONS = 13;
+
+struct FileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t variable_count;
+  double resolution;
+  std::uint32_t orientation_divisions;
+  std::uint32_t reserved;
+  std::uint64_t cell_count;
+};
+
+void writeString(std::ofstream& out, const std::string& s)
+{
+  const std::uint32_t length = s.size();
+  out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+  out.write(s.data(), length);
+}
+
+bool readString(std::ifstream& in, std::string& s)
+{
+  std::uint32_t length = 0;
+  if (!in.read(reinterpret_cast<char*>(&length), sizeof(length)) || length > 4096)
+    return false;
+  s.resize(length);
+  return static_cast<bool>(in.read(&s[0], length));
+}
+}  // namespace
+
+ReachabilityMap::ReachabilityMap() : resolution_(0.0), orientation_divisions_(0), variable_count_(0)
+{
+}
+
+void ReachabilityMap::clear()
+{
+  group_name_.clear();
+  base_link_name_.clear();
+  tip_link_name_.clear();
+  resolution_ = 0.0;
+  orientation_divisions_ = 0;
+  variable_count_ = 0;
+  keys_.clear();
+  probability_.clear();
+  seeds_.clear();
+}
+
+std::uint64_t ReachabilityMap::cellKey(const Eigen::Isometry3d& pose) const
+{
+  std::uint64_t key = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    const double voxel = std::floor(pose.translation()[i] / resolution_);
+    if (!(voxel >= -COORDINATE_OFFSET && voxel < COORDINATE_OFFSET))
+      return INVALID_KEY;
+    key = (key << COORDINATE_BITS) | static_cast<std::uint64_t>(static_cast<std::int64_t>(voxel) + COORDINATE_OFFSET);
+  }
+
+  // cube map of the direction of the z axis
+  const Eigen::Vector3d z = pose.linear().col(2);
+  Eigen::Index axis;
+  const double major = z.cwiseAbs().maxCoeff(&axis);
+  if (!(major > 0.0))
+    return INVALID_KEY;
+  const unsigned int face = 2 * static_cast<unsigned int>(axis) + (z[axis] < 0.0 ? 1 : 0);
+  const unsigned int n = orientation_divisions_;
+  const auto subdivision = [n, major](double coordinate) {
+    return std::min(n - 1, static_cast<unsigned int>((coordinate / major + 1.0) * 0.5 * n));
+  };
+  const unsigned int bin = (face * n + subdivision(z[(axis + 1) % 3])) * n + subdivision(z[(axis + 2) % 3]);
+  return (key << BIN_BITS) | bin;
+}
+
+std::ptrdiff_t ReachabilityMap::findCell(std::uint64_t key) const
+{
+  if (key == INVALID_KEY)
+    return -1;
+  const auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+  return it != keys_.end() && *it == key ? it - keys_.begin() : -1;
+}
+
+bool ReachabilityMap::generate(const moveit::core::RobotState& reference_state,
+                               const moveit::core::JointModelGroup* group, const moveit::core::LinkModel* tip_link,
+                               double resolution, std::size_t samples, std::uint32_t seed,
+                               unsigned int orientation_divisions)
+{
+  clear();
+  if (!group || !tip_link)
+  {
+    RCLCPP_ERROR(getLogger(), "A group and a tip link are needed to generate a reachability map");
+    return false;
+  }
+  if (!(resolution > 0.0) || orientation_divisions == 0 || orientation_divisions > MAX_ORIENTATION_DIVISIONS)
+  {
+    RCLCPP_ERROR(getLogger(),
+                 "Invalid reachability map resolution %f or orientation divisions %u (must be between 1 and %u)",
+                 resolution, orientation_divisions, MAX_ORIENTATION_DIVISIONS);
+    return false;
+  }
+
+  const moveit::core::JointModel* root = group->getCommonRoot();
+  const moveit::core::LinkModel* base_link = root ? root->getParentLinkModel() : nullptr;
+
+  group_name_ = group->getName();
+  base_link_name_ = base_link ? base_link->getName() : std::string();
+  tip_link_name_ = tip_link->getName();
+  resolution_ = resolution;
+  orientation_divisions_ = orientation_divisions;
+  variable_count_ = group->getVariableCount();
+
+  struct Cell
+  {
+    std::size_t hits = 0;
+    double distance = std::numeric_limits<double>::infinity();
+    std::vector<float> seed;
+  };
+  std::unordered_map<std::uint64_t, Cell> cells;
+
+  random_numbers::RandomNumberGenerator rng(seed);
+  moveit::core::RobotState state(reference_state);
+  std::vector<double> values;
+  for (std::size_t i = 0; i < samples; ++i)
+  {
+    group->getVariableRandomPositions(rng, values);
+    state.setJointGroupPositions(group, values);
+    state.updateLinkTransforms();
+
+    Eigen::Isometry3d pose = state.getGlobalLinkTransform(tip_link);
+    if (base_link)
+      pose = state.getGlobalLinkTransform(base_link).inverse() * pose;
+    const std::uint64_t key = cellKey(pose);
+    if (key == INVALID_KEY)
+      continue;
+
+    // keep the configuration closest to the center of the voxel as seed
+    const Eigen::Vector3d center =
+        ((pose.translation() / resolution_).array().floor() + 0.5).matrix() * resolution_;
+    const double distance = (pose.translation() - center).squaredNorm();
+    Cell& cell = cells[key];
+    ++cell.hits;
+    if (distance < cell.distance)
+    {
+      cell.distance = distance;
+      cell.seed.assign(values.begin(), values.end());
+    }
+  }
+
+  if (cells.empty())
+  {
+    RCLCPP_ERROR(getLogger(), "No reachable poses found for link '%s' of group '%s'", tip_link_name_.c_str(),
+                 group_name_.c_str());
+    clear();
+    return false;
+  }
+
+  // Cells reached at least as often as the median cell are taken to be reachable for sure; rarely reached cells, at
+  // the boundary of the workspace or near singularities, proportionally less so
+  std::vector<std::size_t> hits;
+  hits.reserve(cells.size());
+  keys_.reserve(cells.size());
+  for (const std::pair<const std::uint64_t, Cell>& cell : cells)
+  {
+    keys_.push_back(cell.first);
+    hits.push_back(cell.second.hits);
+  }
+  std::nth_element(hits.begin(), hits.begin() + hits.size() / 2, hits.end());
+  const double median_hits = hits[hits.size() / 2];
+
+  std::sort(keys_.begin(), keys_.end());
+  probability_.reserve(keys_.size());
+  seeds_.reserve(keys_.size() * variable_count_);
+  for (std::uint64_t key : keys_)
+  {
+    const Cell& cell = cells[key];
+    const double p = std::min(1.0, cell.hits / median_hits);
+    probability_.push_back(std::max<std::uint8_t>(1, static_cast<std::uint8_t>(std::lround(p * 255.0))));
+    seeds_.insert(seeds_.end(), cell.seed.begin(), cell.seed.end());
+  }
+
+  RCLCPP_DEBUG(getLogger(), "Generated a reachability map with %zu cells for link '%s' of group '%s'", keys_.size(),
+               tip_link_name_.c_str(), group_name_.c_str());
+  return true;
+}
+
+bool ReachabilityMap::save(const std::string& filename) const
+{
+  std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+  if (!out)
+  {
+    RCLCPP_ERROR(getLogger(), "Unable to open '%s' for writing the reachability map", filename.c_str());
+    return false;
+  }
+
+  FileHeader header;
+  std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+  header.version = FILE_VERSION;
+  header.variable_count = variable_count_;
+  header.resolution = resolution_;
+  header.orientation_divisions = orientation_divisions_;
+  header.reserved = 0;
+  header.cell_count = keys_.size();
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  writeString(out, group_name_);
+  writeString(out, base_link_name_);
+  writeString(out, tip_link_name_);
+  out.write(reinterpret_cast<const char*>(keys_.data()), keys_.size() * sizeof(std::uint64_t));
+  out.write(reinterpret_cast<const char*>(probability_.data()), probability_.size() * sizeof(std::uint8_t));
+  out.write(reinterpret_cast<const char*>(seeds_.data()), seeds_.size() * sizeof(float));
+
+  if (!out)
+  {
+    RCLCPP_ERROR(getLogger(), "Unable to write the reachability map to '%s'", filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool ReachabilityMap::load(const std::string& filename)
+{
+  clear();
+  std::ifstream in(filename, std::ios::binary);
+  if (!in)
+  {
+    RCLCPP_ERROR(getLogger(), "Unable to open reachability map '%s'", filename.c_str());
+    return false;
+  }
+
+  FileHeader header;
+  if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 || header.version != FILE_VERSION ||
+      !(header.resolution > 0.0) || header.orientation_divisions == 0 ||
+      header.orientation_divisions > MAX_ORIENTATION_DIVISIONS)
+  {
+    RCLCPP_ERROR(getLogger(), "'%s' is not a valid reachability map", filename.c_str());
+    return false;
+  }
+
+  // reject sizes the file cannot hold before allocating for them
+  const std::streampos data_begin = in.tellg();
+  in.seekg(0, std::ios::end);
+  const std::uint64_t data_size = static_cast<std::uint64_t>(in.tellg() - data_begin);
+  in.seekg(data_begin);
+  if (header.cell_count > data_size / (sizeof(std::uint64_t) + sizeof(std::uint8_t) +
+                                       static_cast<std::uint64_t>(header.variable_count) * sizeof(float)))
+  {
+    RCLCPP_ERROR(getLogger(), "Reachability map '%s' is truncated or corrupt", filename.c_str());
+    return false;
+  }
+
+  keys_.resize(header.cell_count);
+  probability_.resize(header.cell_count);
+  seeds_.resize(header.cell_count * header.variable_count);
+  if (!readString(in, group_name_) || !readString(in, base_link_name_) || !readString(in, tip_link_name_) ||
+      !in.read(reinterpret_cast<char*>(keys_.data()), keys_.size() * sizeof(std::uint64_t)) ||
+      !in.read(reinterpret_cast<char*>(probability_.data()), probability_.size() * sizeof(std::uint8_t)) ||
+      !in.read(reinterpret_cast<char*>(seeds_.data()), seeds_.size() * sizeof(float)) ||
+      !std::is_sorted(keys_.begin(), keys_.end()))
+  {
+    RCLCPP_ERROR(getLogger(), "Reachability map '%s' is truncated or corrupt", filename.c_str());
+    clear();
+    return false;
+  }
+
+  resolution_ = header.resolution;
+  orientation_divisions_ = header.orientation_divisions;
+  variable_count_ = header.variable_count;
+  return true;
+}
+
+double ReachabilityMap::getReachability(const Eigen::Isometry3d& pose) const
+{
+  const std::ptrdiff_t cell = findCell(cellKey(pose));
+  return cell < 0 ? 0.0 : probability_[cell] / 255.0;
+}
+
+bool ReachabilityMap::getSeed(const Eigen::Isometry3d& pose, std::vector<double>& values) const
+{
+  const std::ptrdiff_t cell = findCell(cellKey(pose));
+  if (cell < 0)
+    return false;
+  const float* seed = &seeds_[cell * variable_count_];
+  values.assign(seed, seed + variable_count_);
+  return true;
+}
+
+bool ReachabilityMap::isCompatible(const moveit::core::JointModelGroup* group) const
+{
+  if (!group || group->getName() != group_name_)
+  {
+    RCLCPP_ERROR(getLogger(), "The reachability map for group '%s' cannot be used with group '%s'",
+                 group_name_.c_str(), group ? group->getName().c_str() : "");
+    return false;
+  }
+  if (variable_count_ != group->getVariableCount())
+  {
+    RCLCPP_ERROR(getLogger(), "The reachability map for group '%s' stores %zu variables, but the group has %u",
+                 group_name_.c_str(), variable_count_, group->getVariableCount());
+    return false;
+  }
+  const moveit::core::RobotModel& robot_model = group->getParentModel();
+  if ((!base_link_name_.empty() && !robot_model.hasLinkModel(base_link_name_)) ||
+      !robot_model.hasLinkModel(tip_link_name_))
+  {
+    RCLCPP_ERROR(getLogger(),
+                 "The base link '%s' or tip link '%s' of the reachability map for group '%s' is not part of "
+                 "robot model '%s'",
+                 base_link_name_.c_str(), tip_link_name_.c_str(), group_name_.c_str(), robot_model.getName().c_str());
+    return false;
+  }
+  return true;
+}
+
+Eigen::Isometry3d ReachabilityMap::getBaseTransform(const moveit::core::RobotState& state) const
+{
+  if (base_link_name_.empty())
+    return Eigen::Isometry3d::Identity();
+  return state.getGlobalLinkTransform(base_link_name_);
+}
+}  // namespace constraint_samplers
@@ -158,4 +158,24 @@ bool UnionConstraintSampler::sample(moveit::core::RobotState& state, const movei
   return true;
 }
 
+ConstraintSamplerPtr UnionConstraintSampler::clone() const
+{
+  std::vector<ConstraintSamplerPtr> samplers;
+  samplers.reserve(samplers_.size());
+  for (const ConstraintSamplerPtr& sampler : samplers_)
+  {
+    ConstraintSamplerPtr copy = sampler->clone();
+    if (!copy)
+      return ConstraintSamplerPtr();
+    samplers.push_back(copy);
+  }
+
+  auto sampler = std::make_shared<UnionConstraintSampler>(scene_, jmg_->getName(), samplers);
+  // keep the order of the original, which is already sorted
+  sampler->samplers_ = samplers;
+  sampler->is_valid_ = is_valid_;
+  sampler->verbose_ = verbose_;
+  return sampler;
+}
+
 }  // end of namespace constraint_samplers
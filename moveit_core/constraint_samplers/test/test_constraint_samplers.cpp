@@ -49,6 +49,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <urdf_parser/urdf_parser.h>
+#include <cstdint>
+#include <cstdio>
 #include <fstream>
 #include <functional>
 
@@ -1236,6 +1238,237 @@ TEST_F(LoadPlanningModelsPr2, IKConstraintsSamplerSeeded)
   EXPECT_FALSE((root_to_left_tool2 * root_to_left_tool3.inverse()).matrix().isIdentity(1e-7));
 }
 
+TEST_F(LoadPlanningModelsPr2, ReachabilityMapSampler)
+{
+  moveit::core::RobotState ks(robot_model_);
+  ks.setToDefaultValues();
+  ks.update();
+  moveit::core::RobotState ks_const(robot_model_);
+  ks_const.setToDefaultValues();
+  ks_const.update();
+
+  const moveit::core::JointModelGroup* jmg = robot_model_->getJointModelGroup("left_arm");
+  const moveit::core::LinkModel* link = robot_model_->getLinkModel("l_wrist_roll_link");
+
+  auto map = std::make_shared<constraint_samplers::ReachabilityMap>();
+  ASSERT_TRUE(map->generate(ks_const, jmg, link, 0.05, 50000, 42));
+  EXPECT_EQ(map->getBaseLinkName(), "torso_lift_link");
+
+  // the pose of the default state was reached, a pose far away was not
+  const Eigen::Isometry3d base = map->getBaseTransform(ks_const);
+  const Eigen::Isometry3d reachable = base.inverse() * ks_const.getGlobalLinkTransform(link);
+  EXPECT_GT(map->getReachability(reachable), 0.0);
+  EXPECT_EQ(map->getReachability(Eigen::Translation3d(5.0, 0.0, 0.0) * reachable), 0.0);
+
+  std::vector<double> seed;
+  ASSERT_TRUE(map->getSeed(reachable, seed));
+  ks.setJointGroupPositions(jmg, seed);
+  ks.update();
+  const Eigen::Vector3d offset =
+      ks.getGlobalLinkTransform(link).translation() - ks_const.getGlobalLinkTransform(link).translation();
+  EXPECT_LT(offset.norm(), 0.1);
+
+  // save and load the map
+  const std::string filename = testing::TempDir() + "reachability_map_test.bin";
+  ASSERT_TRUE(map->save(filename));
+  auto loaded = std::make_shared<constraint_samplers::ReachabilityMap>();
+  ASSERT_TRUE(loaded->load(filename));
+  EXPECT_EQ(loaded->getCellCount(), map->getCellCount());
+  EXPECT_EQ(loaded->getReachability(reachable), map->getReachability(reachable));
+  std::remove(filename.c_str());
+
+  moveit_msgs::msg::PositionConstraint pcm;
+  pcm.link_name = "l_wrist_roll_link";
+  pcm.constraint_region.primitives.resize(1);
+  pcm.constraint_region.primitives[0].type = shape_msgs::msg::SolidPrimitive::SPHERE;
+  pcm.constraint_region.primitives[0].dimensions = { 0.001 };
+  pcm.header.frame_id = robot_model_->getModelFrame();
+  pcm.constraint_region.primitive_poses.resize(1);
+  pcm.constraint_region.primitive_poses[0].position.x = 0.55;
+  pcm.constraint_region.primitive_poses[0].position.y = 0.2;
+  pcm.constraint_region.primitive_poses[0].position.z = 1.25;
+  pcm.constraint_region.primitive_poses[0].orientation.w = 1.0;
+  pcm.weight = 1.0;
+
+  moveit_msgs::msg::OrientationConstraint ocm;
+  ocm.link_name = "l_wrist_roll_link";
+  ocm.header.frame_id = robot_model_->getModelFrame();
+  ocm.orientation.w = 1.0;
+  ocm.absolute_x_axis_tolerance = 0.2;
+  ocm.absolute_y_axis_tolerance = 0.1;
+  ocm.absolute_z_axis_tolerance = 0.4;
+  ocm.weight = 1.0;
+
+  moveit_msgs::msg::Constraints c;
+  c.position_constraints.push_back(pcm);
+  c.orientation_constraints.push_back(ocm);
+
+  // the manager hands the map to the samplers it creates
+  constraint_samplers::ConstraintSamplerManager manager;
+  manager.registerReachabilityMap(loaded);
+  constraint_samplers::ConstraintSamplerPtr s = manager.selectSampler(ps_, "left_arm", c);
+  ASSERT_TRUE(s != nullptr);
+  constraint_samplers::IKConstraintSampler* iks = dynamic_cast<constraint_samplers::IKConstraintSampler*>(s.get());
+  ASSERT_TRUE(iks);
+  EXPECT_EQ(iks->getReachabilityMap(), loaded);
+
+  for (int t = 0; t < 100; ++t)
+  {
+    EXPECT_TRUE(s->sample(ks, ks_const, 100));
+    EXPECT_TRUE(iks->getPositionConstraint()->decide(ks).satisfied);
+    EXPECT_TRUE(iks->getOrientationConstraint()->decide(ks).satisfied);
+  }
+
+  // a map for another group is not used
+  constraint_samplers::ConstraintSamplerManager other_manager;
+  auto right_map = std::make_shared<constraint_samplers::ReachabilityMap>();
+  ASSERT_TRUE(right_map->generate(ks_const, robot_model_->getJointModelGroup("right_arm"),
+                                  robot_model_->getLinkModel("r_wrist_roll_link"), 0.1, 1000, 42));
+  other_manager.registerReachabilityMap(right_map);
+  s = other_manager.selectSampler(ps_, "left_arm", c);
+  iks = dynamic_cast<constraint_samplers::IKConstraintSampler*>(s.get());
+  ASSERT_TRUE(iks);
+  EXPECT_FALSE(iks->getReachabilityMap());
+}
+
+TEST_F(LoadPlanningModelsPr2, ReachabilityMapRejectsIncompatibleMaps)
+{
+  moveit::core::RobotState ks(robot_model_);
+  ks.setToDefaultValues();
+  ks.update();
+
+  const moveit::core::JointModelGroup* jmg = robot_model_->getJointModelGroup("left_arm");
+  auto map = std::make_shared<constraint_samplers::ReachabilityMap>();
+  ASSERT_TRUE(map->generate(ks, jmg, robot_model_->getLinkModel("l_wrist_roll_link"), 0.1, 1000, 42));
+  EXPECT_EQ(map->getVariableCount(), jmg->getVariableCount());
+  EXPECT_TRUE(map->isCompatible(jmg));
+
+  constraint_samplers::IKConstraintSampler iks(ps_, "left_arm");
+  EXPECT_TRUE(iks.setReachabilityMap(map));
+  EXPECT_EQ(iks.getReachabilityMap(), map);
+
+  // a map for another group is rejected
+  constraint_samplers::IKConstraintSampler right_iks(ps_, "right_arm");
+  EXPECT_FALSE(right_iks.setReachabilityMap(map));
+  EXPECT_FALSE(right_iks.getReachabilityMap());
+
+  // maps from files written for another robot: patch a saved copy and load it again
+  const std::string filename = testing::TempDir() + "reachability_map_incompatible_test.bin";
+  const auto load_patched = [&](std::streamoff offset, const std::string& bytes) {
+    EXPECT_TRUE(map->save(filename));
+    {
+      std::fstream file(filename, std::ios::binary | std::ios::in | std::ios::out);
+      file.seekp(offset);
+      file.write(bytes.data(), bytes.size());
+    }
+    auto patched = std::make_shared<constraint_samplers::ReachabilityMap>();
+    EXPECT_TRUE(patched->load(filename));
+    return patched;
+  };
+
+  // the variable count follows the 8 byte magic and the 4 byte version
+  const std::uint32_t variable_count = jmg->getVariableCount() - 1;
+  auto bad_map = load_patched(12, std::string(reinterpret_cast<const char*>(&variable_count), sizeof(variable_count)));
+  EXPECT_FALSE(bad_map->isCompatible(jmg));
+  EXPECT_FALSE(iks.setReachabilityMap(bad_map));
+  EXPECT_FALSE(iks.getReachabilityMap());
+
+  // the base link name follows the 40 byte header and the length prefixed group name
+  bad_map = load_patched(40 + 4 + map->getGroupName().size() + 4, "X");
+  EXPECT_EQ(bad_map->getVariableCount(), map->getVariableCount());
+  EXPECT_NE(bad_map->getBaseLinkName(), map->getBaseLinkName());
+  EXPECT_FALSE(iks.setReachabilityMap(bad_map));
+  EXPECT_FALSE(iks.getReachabilityMap());
+
+  std::remove(filename.c_str());
+}
+
+TEST_F(LoadPlanningModelsPr2, ConstraintSamplerClone)
+{
+  moveit::core::RobotState ks(robot_model_);
+  ks.setToDefaultValues();
+  ks.update();
+  moveit::core::RobotState ks_const(robot_model_);
+  ks_const.setToDefaultValues();
+  ks_const.update();
+
+  moveit_msgs::msg::JointConstraint jcm;
+  jcm.joint_name = "torso_lift_joint";
+  jcm.position = ks.getVariablePosition("torso_lift_joint");
+  jcm.tolerance_above = 0.01;
+  jcm.tolerance_below = 0.01;
+  jcm.weight = 1.0;
+
+  moveit_msgs::msg::PositionConstraint pcm;
+  pcm.link_name = "l_wrist_roll_link";
+  pcm.constraint_region.primitives.resize(1);
+  pcm.constraint_region.primitives[0].type = shape_msgs::msg::SolidPrimitive::SPHERE;
+  pcm.constraint_region.primitives[0].dimensions = { 0.001 };
+  pcm.header.frame_id = robot_model_->getModelFrame();
+  pcm.constraint_region.primitive_poses.resize(1);
+  pcm.constraint_region.primitive_poses[0].position.x = 0.55;
+  pcm.constraint_region.primitive_poses[0].position.y = 0.2;
+  pcm.constraint_region.primitive_poses[0].position.z = 1.25;
+  pcm.constraint_region.primitive_poses[0].orientation.w = 1.0;
+  pcm.weight = 1.0;
+
+  moveit_msgs::msg::OrientationConstraint ocm;
+  ocm.link_name = "l_wrist_roll_link";
+  ocm.header.frame_id = robot_model_->getModelFrame();
+  ocm.orientation.w = 1.0;
+  ocm.absolute_x_axis_tolerance = 0.2;
+  ocm.absolute_y_axis_tolerance = 0.1;
+  ocm.absolute_z_axis_tolerance = 0.4;
+  ocm.weight = 1.0;
+
+  moveit_msgs::msg::Constraints c;
+  c.joint_constraints.push_back(jcm);
+  c.position_constraints.push_back(pcm);
+  c.orientation_constraints.push_back(ocm);
+
+  kinematic_constraints::KinematicConstraintSet constraint_set(robot_model_);
+  constraint_set.add(c, ps_->getTransforms());
+
+  // the IK solver allocator of the fixture shares one solver, which a copy must not use
+  constraint_samplers::ConstraintSamplerPtr s =
+      constraint_samplers::ConstraintSamplerManager::selectDefaultSampler(ps_, "arms_and_torso", c);
+  ASSERT_TRUE(s != nullptr);
+  ASSERT_TRUE(dynamic_cast<constraint_samplers::UnionConstraintSampler*>(s.get()));
+  EXPECT_FALSE(s->clone());
+
+  // with a solver per allocation the union and all its samplers can be copied
+  std::map<std::string, moveit::core::SolverAllocatorFn> allocators;
+  allocators["right_arm"] = func_right_arm_;
+  allocators["left_arm"] = [this](const moveit::core::JointModelGroup* /*jmg*/) {
+    auto solver = std::make_shared<pr2_arm_kinematics::PR2ArmKinematicsPlugin>();
+    solver->initialize(node_, *robot_model_, "left_arm", "torso_lift_link", { "l_wrist_roll_link" }, .01);
+    return kinematics::KinematicsBasePtr(solver);
+  };
+  robot_model_->setKinematicsAllocators(allocators);
+  s = constraint_samplers::ConstraintSamplerManager::selectDefaultSampler(ps_, "arms_and_torso", c);
+  ASSERT_TRUE(s != nullptr);
+  constraint_samplers::ConstraintSamplerPtr copy = s->clone();
+  ASSERT_TRUE(copy != nullptr);
+  EXPECT_EQ(copy->getName(), s->getName());
+  EXPECT_EQ(copy->getFrameDependency(), s->getFrameDependency());
+
+  const auto& samplers = static_cast<constraint_samplers::UnionConstraintSampler*>(s.get())->getSamplers();
+  const auto& copies = static_cast<constraint_samplers::UnionConstraintSampler*>(copy.get())->getSamplers();
+  ASSERT_EQ(copies.size(), samplers.size());
+  for (std::size_t i = 0; i < samplers.size(); ++i)
+  {
+    EXPECT_NE(copies[i], samplers[i]);
+    EXPECT_EQ(copies[i]->getName(), samplers[i]->getName());
+  }
+
+  for (int t = 0; t < 10; ++t)
+  {
+    ASSERT_TRUE(copy->sample(ks, ks_const, 100));
+    ks.update();
+    EXPECT_TRUE(constraint_set.decide(ks).satisfied);
+  }
+}
+
 int main(int argc, char** argv)
 {
   rclcpp::init(argc, argv);
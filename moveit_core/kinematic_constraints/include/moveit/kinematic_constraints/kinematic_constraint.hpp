@@ -322,6 +322,17 @@ public:
     return joint_tolerance_below_;
   }
 
+  /**
+   * \brief Whether the joint variable wraps around, as for continuous joints
+   *
+   *
+   * @return True if distances are computed modulo 2*pi
+   */
+  bool isJointContinuous() const
+  {
+    return joint_is_continuous_;
+  }
+
 protected:
   const moveit::core::JointModel* joint_model_; /**< \brief The joint from the kinematic model for this constraint */
   bool joint_is_continuous_;                    /**< \brief Whether or not the joint is continuous */
@@ -882,7 +893,8 @@ protected:
   double max_range_angle_;           /**< \brief Storage for the max range angle */
 };
 
-MOVEIT_CLASS_FORWARD(KinematicConstraintSet);  // Defines KinematicConstraintSetPtr, ConstPtr, WeakPtr... etc
+MOVEIT_CLASS_FORWARD(CompiledKinematicConstraintSet);  // Defines CompiledKinematicConstraintSetPtr, ConstPtr, etc
+MOVEIT_CLASS_FORWARD(KinematicConstraintSet);          // Defines KinematicConstraintSetPtr, ConstPtr, WeakPtr... etc
 
 /**
  * \brief A class that contains many different constraints, and can
@@ -1087,6 +1099,16 @@ public:
     return kinematic_constraints_.empty();
   }
 
+  /**
+   * \brief Flatten the constraints of this set for evaluating many states at once
+   *
+   * The returned set holds on to the current constraints; constraints added
+   * to this set afterwards are not part of it.
+   *
+   * @return The compiled constraint set
+   */
+  CompiledKinematicConstraintSetPtr compile() const;
+
 protected:
   moveit::core::RobotModelConstPtr robot_model_; /**< \brief The kinematic model used for by the Set */
   std::vector<KinematicConstraintPtr>
@@ -1104,4 +1126,142 @@ protected:
                                                                                internal visibility constraints */
   moveit_msgs::msg::Constraints all_constraints_; /**<  \brief Messages corresponding to all internal constraints */
 };
+
+/**
+ * \brief An immutable, flattened form of a set of kinematic constraints,
+ * made for evaluating many states at once (e.g. all waypoints of a path).
+ *
+ * Joint constraints, as well as position and orientation constraints
+ * expressed in a fixed frame, are stored as structure-of-arrays programs
+ * that are evaluated one constraint at a time over all states, reading the
+ * link transforms already computed in each state. Box, sphere and cylinder
+ * position regions are tested inline. Constraints that cannot be flattened
+ * (visibility constraints and constraints in a mobile frame) are evaluated
+ * through KinematicConstraint::decide().
+ *
+ * The results are the same as those of KinematicConstraintSet::decide(),
+ * except that distances may differ in the last bits as they are summed in a
+ * different order.
+ */
+class CompiledKinematicConstraintSet
+{
+public:
+  /**
+   * \brief Compile a list of configured constraints
+   *
+   * Disabled constraints are dropped, as they are always satisfied.
+   *
+   * @param constraints The constraints to compile
+   */
+  CompiledKinematicConstraintSet(const std::vector<KinematicConstraintPtr>& constraints);
+
+  /**
+   * \brief Determines whether all constraints are satisfied by a state
+   *
+   * @param state The state to test, with updated link transforms
+   *
+   * @return The aggregate result of all constraints
+   */
+  ConstraintEvaluationResult decide(const moveit::core::RobotState& state) const;
+
+  /**
+   * \brief Determines whether all constraints are satisfied by each of a number of states
+   *
+   * @param [in] states The states to test, all with updated link transforms
+   * @param [out] results The aggregate result of all constraints for each state
+   */
+  void decide(const std::vector<const moveit::core::RobotState*>& states,
+              std::vector<ConstraintEvaluationResult>& results) const;
+
+  /**
+   * \brief Number of constraints evaluated by the flattened programs
+   */
+  std::size_t getCompiledConstraintCount() const
+  {
+    return joint_.size() + position_.size() + orientation_.size();
+  }
+
+  /**
+   * \brief Number of constraints evaluated through KinematicConstraint::decide()
+   */
+  std::size_t getFallbackConstraintCount() const
+  {
+    return fallback_.size();
+  }
+
+protected:
+  /** \brief Joint constraints, one entry per constraint */
+  struct JointProgram
+  {
+    std::size_t size() const
+    {
+      return variable_index.size();
+    }
+
+    std::vector<int> variable_index;
+    std::vector<double> position;
+    std::vector<double> tolerance_above;
+    std::vector<double> tolerance_below;
+    std::vector<double> weight;
+    std::vector<char> continuous;
+  };
+
+  /** \brief Position constraints in a fixed frame, one entry per constraint; regions are stored separately */
+  struct PositionProgram
+  {
+    std::size_t size() const
+    {
+      return link.size();
+    }
+
+    std::vector<const moveit::core::LinkModel*> link;
+    std::vector<Eigen::Vector3d> offset;
+    std::vector<double> weight;
+    std::vector<std::size_t> regions_begin; /**< \brief Range of this constraint's regions in RegionProgram */
+    std::vector<std::size_t> regions_end;
+  };
+
+  /** \brief Regions of position constraints, one entry per region */
+  struct RegionProgram
+  {
+    enum Kind : char
+    {
+      BOX,
+      SPHERE,
+      CYLINDER,
+      BODY /**< \brief Any other body, tested with bodies::Body::containsPoint() */
+    };
+
+    std::vector<char> kind;
+    std::vector<Eigen::Vector3d> center;
+    std::vector<Eigen::Matrix3d> inverse_rotation;
+    /** \brief Box: half extents. Sphere, cylinder: squared radius, half length */
+    std::vector<Eigen::Vector3d> extents;
+    std::vector<bodies::BodyPtr> body;
+  };
+
+  /** \brief Orientation constraints in a fixed frame, one entry per constraint */
+  struct OrientationProgram
+  {
+    std::size_t size() const
+    {
+      return link.size();
+    }
+
+    std::vector<const moveit::core::LinkModel*> link;
+    std::vector<Eigen::Matrix3d> desired_rotation_inv;
+    std::vector<Eigen::Matrix3d> desired_rotation_in_frame_id;
+    std::vector<Eigen::Vector3d> tolerance;
+    std::vector<int> parameterization_type;
+    std::vector<double> weight;
+  };
+
+  void addPositionConstraint(const PositionConstraint& constraint);
+
+  JointProgram joint_;
+  PositionProgram position_;
+  RegionProgram region_;
+  OrientationProgram orientation_;
+  std::vector<KinematicConstraintPtr> fallback_; /**< \brief Constraints evaluated through decide() */
+};
 }  // namespace kinematic_constraints
@@ -130,6 +130,79 @@ calcEulerAngles(const Eigen::MatrixBase<Derived>& R)
   return { res, false };
 }
 
+// Signed shortest difference between a joint position and the desired position
+static double jointPositionDifference(double position, double desired, bool continuous)
+{
+  if (!continuous)
+    return position - desired;
+
+  // compute signed shortest distance for continuous joints
+  double dif = normalizeAngle(position) - desired;
+  if (dif > M_PI)
+  {
+    dif = 2.0 * M_PI - dif;
+  }
+  else if (dif < -M_PI)
+  {
+    dif += 2.0 * M_PI;  // we include a sign change to have dif > 0
+  }
+  return dif;
+}
+
+static bool jointDifferenceWithinTolerance(double dif, double tolerance_above, double tolerance_below)
+{
+  return dif <= (tolerance_above + 2.0 * std::numeric_limits<double>::epsilon()) &&
+         dif >= (-tolerance_below - 2.0 * std::numeric_limits<double>::epsilon());
+}
+
+// Absolute error about each axis of diff = desired^-1 * actual, in the given parameterization
+static Eigen::Vector3d orientationError(const Eigen::Matrix3d& diff, int parameterization_type,
+                                        const Eigen::Matrix3d& desired_R_in_frame_id, double absolute_z_axis_tolerance)
+{
+  Eigen::Vector3d xyz_rotation = Eigen::Vector3d::Zero();
+  if (parameterization_type == moveit_msgs::msg::OrientationConstraint::XYZ_EULER_ANGLES)
+  {
+    const std::tuple<Eigen::Vector3d, bool> euler_angles_error = calcEulerAngles(diff);
+    // Converting from a rotation matrix to intrinsic XYZ Euler angles has 2 singularities:
+    // pitch ~= pi/2 ==> roll + yaw = theta
+    // pitch ~= -pi/2 ==> roll - yaw = theta
+    // in those cases calcEulerAngles will set roll (xyz_rotation(0)) to theta and yaw (xyz_rotation(2)) to zero, so for
+    // us to be able to capture yaw tolerance violations we do the following: If theta violates the absolute yaw
+    // tolerance we think of it as a pure yaw rotation and set roll to zero.
+    xyz_rotation = std::get<Eigen::Vector3d>(euler_angles_error);
+    if (!std::get<bool>(euler_angles_error))
+    {
+      if (normalizeAbsoluteAngle(xyz_rotation(0)) > absolute_z_axis_tolerance + std::numeric_limits<double>::epsilon())
+      {
+        xyz_rotation(2) = xyz_rotation(0);
+        xyz_rotation(0) = 0;
+      }
+    }
+    // Account for angle wrapping
+    xyz_rotation = xyz_rotation.unaryExpr(&normalizeAbsoluteAngle);
+  }
+  else if (parameterization_type == moveit_msgs::msg::OrientationConstraint::ROTATION_VECTOR)
+  {
+    Eigen::AngleAxisd aa(diff);
+    // transform rotation vector from target frame to frame_id and take absolute values
+    xyz_rotation = (desired_R_in_frame_id * (aa.axis() * aa.angle())).cwiseAbs();
+  }
+  else
+  {
+    /* The parameterization type should be validated in configure, so this should never happen. */
+    RCLCPP_ERROR(getLogger(), "The parameterization type for the orientation constraints is invalid.");
+  }
+  return xyz_rotation;
+}
+
+static bool orientationErrorWithinTolerance(const Eigen::Vector3d& xyz_rotation, double absolute_x_axis_tolerance,
+                                            double absolute_y_axis_tolerance, double absolute_z_axis_tolerance)
+{
+  return xyz_rotation(2) < absolute_z_axis_tolerance + std::numeric_limits<double>::epsilon() &&
+         xyz_rotation(1) < absolute_y_axis_tolerance + std::numeric_limits<double>::epsilon() &&
+         xyz_rotation(0) < absolute_x_axis_tolerance + std::numeric_limits<double>::epsilon();
+}
+
 KinematicConstraint::KinematicConstraint(const moveit::core::RobotModelConstPtr& model)
   : type_(UNKNOWN_CONSTRAINT), robot_model_(model), constraint_weight_(std::numeric_limits<double>::epsilon())
 {
@@ -292,28 +365,10 @@ ConstraintEvaluationResult JointConstraint::decide(const moveit::core::RobotStat
     return ConstraintEvaluationResult(true, 0.0);
 
   double current_joint_position = state.getVariablePosition(joint_variable_index_);
-  double dif = 0.0;
-
-  // compute signed shortest distance for continuous joints
-  if (joint_is_continuous_)
-  {
-    dif = normalizeAngle(current_joint_position) - joint_position_;
-
-    if (dif > M_PI)
-    {
-      dif = 2.0 * M_PI - dif;
-    }
-    else if (dif < -M_PI)
-    {
-      dif += 2.0 * M_PI;  // we include a sign change to have dif > 0
-    }
-  }
-  else
-    dif = current_joint_position - joint_position_;
+  double dif = jointPositionDifference(current_joint_position, joint_position_, joint_is_continuous_);
 
   // check bounds
-  bool result = dif <= (joint_tolerance_above_ + 2.0 * std::numeric_limits<double>::epsilon()) &&
-                dif >= (-joint_tolerance_below_ - 2.0 * std::numeric_limits<double>::epsilon());
+  bool result = jointDifferenceWithinTolerance(dif, joint_tolerance_above_, joint_tolerance_below_);
   if (verbose)
   {
     RCLCPP_INFO(getLogger(),
@@ -724,45 +779,11 @@ ConstraintEvaluationResult OrientationConstraint::decide(const moveit::core::Rob
     diff = Eigen::Isometry3d(desired_rotation_matrix_inv_ * state.getGlobalLinkTransform(link_model_).linear());
   }
 
-  // This needs to live outside the if-block scope (as xyz_rotation points to its data).
-  std::tuple<Eigen::Vector3d, bool> euler_angles_error;
-  Eigen::Vector3d xyz_rotation;
-  if (parameterization_type_ == moveit_msgs::msg::OrientationConstraint::XYZ_EULER_ANGLES)
-  {
-    euler_angles_error = calcEulerAngles(diff.linear());
-    // Converting from a rotation matrix to intrinsic XYZ Euler angles has 2 singularities:
-    // pitch ~= pi/2 ==> roll + yaw = theta
-    // pitch ~= -pi/2 ==> roll - yaw = theta
-    // in those cases calcEulerAngles will set roll (xyz_rotation(0)) to theta and yaw (xyz_rotation(2)) to zero, so for
-    // us to be able to capture yaw tolerance violations we do the following: If theta violates the absolute yaw
-    // tolerance we think of it as a pure yaw rotation and set roll to zero.
-    xyz_rotation = std::get<Eigen::Vector3d>(euler_angles_error);
-    if (!std::get<bool>(euler_angles_error))
-    {
-      if (normalizeAbsoluteAngle(xyz_rotation(0)) > absolute_z_axis_tolerance_ + std::numeric_limits<double>::epsilon())
-      {
-        xyz_rotation(2) = xyz_rotation(0);
-        xyz_rotation(0) = 0;
-      }
-    }
-    // Account for angle wrapping
-    xyz_rotation = xyz_rotation.unaryExpr(&normalizeAbsoluteAngle);
-  }
-  else if (parameterization_type_ == moveit_msgs::msg::OrientationConstraint::ROTATION_VECTOR)
-  {
-    Eigen::AngleAxisd aa(diff.linear());
-    // transform rotation vector from target frame to frame_id and take absolute values
-    xyz_rotation = (desired_R_in_frame_id_ * (aa.axis() * aa.angle())).cwiseAbs();
-  }
-  else
-  {
-    /* The parameterization type should be validated in configure, so this should never happen. */
-    RCLCPP_ERROR(getLogger(), "The parameterization type for the orientation constraints is invalid.");
-  }
+  const Eigen::Vector3d xyz_rotation =
+      orientationError(diff.linear(), parameterization_type_, desired_R_in_frame_id_, absolute_z_axis_tolerance_);
 
-  bool result = xyz_rotation(2) < absolute_z_axis_tolerance_ + std::numeric_limits<double>::epsilon() &&
-                xyz_rotation(1) < absolute_y_axis_tolerance_ + std::numeric_limits<double>::epsilon() &&
-                xyz_rotation(0) < absolute_x_axis_tolerance_ + std::numeric_limits<double>::epsilon();
+  bool result = orientationErrorWithinTolerance(xyz_rotation, absolute_x_axis_tolerance_, absolute_y_axis_tolerance_,
+                                                absolute_z_axis_tolerance_);
 
   if (verbose)
   {
@@ -1329,6 +1350,11 @@ ConstraintEvaluationResult KinematicConstraintSet::decide(const moveit::core::Ro
   return result;
 }
 
+CompiledKinematicConstraintSetPtr KinematicConstraintSet::compile() const
+{
+  return std::make_shared<CompiledKinematicConstraintSet>(kinematic_constraints_);
+}
+
 void KinematicConstraintSet::print(std::ostream& out) const
 {
   out << kinematic_constraints_.size() << " kinematic constraints" << '\n';
@@ -1359,4 +1385,207 @@ bool KinematicConstraintSet::equal(const KinematicConstraintSet& other, double m
   return true;
 }
 
+CompiledKinematicConstraintSet::CompiledKinematicConstraintSet(const std::vector<KinematicConstraintPtr>& constraints)
+{
+  for (const KinematicConstraintPtr& constraint : constraints)
+  {
+    if (!constraint->enabled())
+      continue;
+
+    switch (constraint->getType())
+    {
+      case KinematicConstraint::JOINT_CONSTRAINT:
+      {
+        const JointConstraint& jc = static_cast<const JointConstraint&>(*constraint);
+        joint_.variable_index.push_back(jc.getJointVariableIndex());
+        joint_.position.push_back(jc.getDesiredJointPosition());
+        joint_.tolerance_above.push_back(jc.getJointToleranceAbove());
+        joint_.tolerance_below.push_back(jc.getJointToleranceBelow());
+        joint_.weight.push_back(jc.getConstraintWeight());
+        joint_.continuous.push_back(jc.isJointContinuous());
+        break;
+      }
+      case KinematicConstraint::POSITION_CONSTRAINT:
+      {
+        const PositionConstraint& pc = static_cast<const PositionConstraint&>(*constraint);
+        if (pc.mobileReferenceFrame())
+          fallback_.push_back(constraint);
+        else
+          addPositionConstraint(pc);
+        break;
+      }
+      case KinematicConstraint::ORIENTATION_CONSTRAINT:
+      {
+        const OrientationConstraint& oc = static_cast<const OrientationConstraint&>(*constraint);
+        if (oc.mobileReferenceFrame())
+        {
+          fallback_.push_back(constraint);
+          break;
+        }
+        orientation_.link.push_back(oc.getLinkModel());
+        orientation_.desired_rotation_inv.push_back(oc.getDesiredRotationMatrix().transpose());
+        orientation_.desired_rotation_in_frame_id.push_back(oc.getDesiredRotationMatrixInRefFrame());
+        orientation_.tolerance.emplace_back(oc.getXAxisTolerance(), oc.getYAxisTolerance(), oc.getZAxisTolerance());
+        orientation_.parameterization_type.push_back(oc.getParameterizationType());
+        orientation_.weight.push_back(oc.getConstraintWeight());
+        break;
+      }
+      default:
+        fallback_.push_back(constraint);
+    }
+  }
+}
+
+void CompiledKinematicConstraintSet::addPositionConstraint(const PositionConstraint& constraint)
+{
+  position_.link.push_back(constraint.getLinkModel());
+  position_.offset.push_back(constraint.getLinkOffset());
+  position_.weight.push_back(constraint.getConstraintWeight());
+  position_.regions_begin.push_back(region_.kind.size());
+
+  // Mirror the containment tests of the bodies, including scale and padding
+  for (const bodies::BodyPtr& body : constraint.getConstraintRegions())
+  {
+    const Eigen::Isometry3d& pose = body->getPose();
+    const std::vector<double> dimensions = body->getDimensions();
+    const double scale = body->getScale();
+    const double padding = body->getPadding();
+
+    region_.center.push_back(pose.translation());
+    region_.inverse_rotation.push_back(pose.linear().transpose());
+    region_.body.push_back(body);
+    switch (body->getType())
+    {
+      case shapes::BOX:
+        region_.kind.push_back(RegionProgram::BOX);
+        region_.extents.emplace_back(dimensions[0] * scale / 2.0 + padding, dimensions[1] * scale / 2.0 + padding,
+                                     dimensions[2] * scale / 2.0 + padding);
+        break;
+      case shapes::SPHERE:
+      {
+        const double radius = dimensions[0] * scale + padding;
+        region_.kind.push_back(RegionProgram::SPHERE);
+        region_.extents.emplace_back(radius * radius, 0.0, 0.0);
+        break;
+      }
+      case shapes::CYLINDER:
+      {
+        const double radius = dimensions[0] * scale + padding;
+        region_.kind.push_back(RegionProgram::CYLINDER);
+        region_.extents.emplace_back(radius * radius, dimensions[1] * scale / 2.0 + padding, 0.0);
+        break;
+      }
+      default:
+        region_.kind.push_back(RegionProgram::BODY);
+        region_.extents.emplace_back(Eigen::Vector3d::Zero());
+    }
+  }
+  position_.regions_end.push_back(region_.kind.size());
+}
+
+ConstraintEvaluationResult CompiledKinematicConstraintSet::decide(const moveit::core::RobotState& state) const
+{
+  std::vector<ConstraintEvaluationResult> results;
+  decide({ &state }, results);
+  return results[0];
+}
+
+void CompiledKinematicConstraintSet::decide(const std::vector<const moveit::core::RobotState*>& states,
+                                            std::vector<ConstraintEvaluationResult>& results) const
+{
+  const std::size_t n = states.size();
+  results.assign(n, ConstraintEvaluationResult(true, 0.0));
+
+  for (std::size_t c = 0; c < joint_.size(); ++c)
+  {
+    const int index = joint_.variable_index[c];
+    const double position = joint_.position[c];
+    const double above = joint_.tolerance_above[c];
+    const double below = joint_.tolerance_below[c];
+    const double weight = joint_.weight[c];
+    const bool continuous = joint_.continuous[c];
+    for (std::size_t s = 0; s < n; ++s)
+    {
+      const double dif = jointPositionDifference(states[s]->getVariablePosition(index), position, continuous);
+      if (!jointDifferenceWithinTolerance(dif, above, below))
+        results[s].satisfied = false;
+      results[s].distance += weight * fabs(dif);
+    }
+  }
+
+  // The constrained points of all states, reused for each position constraint
+  std::vector<Eigen::Vector3d> points(position_.size() ? n : 0);
+  for (std::size_t c = 0; c < position_.size(); ++c)
+  {
+    for (std::size_t s = 0; s < n; ++s)
+      points[s] = states[s]->getGlobalLinkTransform(position_.link[c]) * position_.offset[c];
+
+    const std::size_t begin = position_.regions_begin[c];
+    const std::size_t end = position_.regions_end[c];
+    for (std::size_t s = 0; s < n; ++s)
+    {
+      const Eigen::Vector3d& pt = points[s];
+      // As in PositionConstraint::decide(), the first region containing the point decides, or else the last one
+      std::size_t r = begin;
+      bool inside = false;
+      for (; r < end; ++r)
+      {
+        const Eigen::Vector3d& extents = region_.extents[r];
+        switch (region_.kind[r])
+        {
+          case RegionProgram::BOX:
+          {
+            const Eigen::Vector3d local = (region_.inverse_rotation[r] * (pt - region_.center[r])).cwiseAbs();
+            inside = local.x() <= extents.x() && local.y() <= extents.y() && local.z() <= extents.z();
+            break;
+          }
+          case RegionProgram::SPHERE:
+            inside = (pt - region_.center[r]).squaredNorm() <= extents.x();
+            break;
+          case RegionProgram::CYLINDER:
+          {
+            const Eigen::Vector3d local = region_.inverse_rotation[r] * (pt - region_.center[r]);
+            inside = fabs(local.z()) <= extents.y() && local.x() * local.x() + local.y() * local.y() <= extents.x();
+            break;
+          }
+          default:
+            inside = region_.body[r]->containsPoint(pt);
+        }
+        if (inside || r + 1 == end)
+          break;
+      }
+      if (!inside)
+        results[s].satisfied = false;
+      results[s].distance += position_.weight[c] * (region_.center[r] - pt).norm();
+    }
+  }
+
+  for (std::size_t c = 0; c < orientation_.size(); ++c)
+  {
+    const Eigen::Matrix3d& desired_inv = orientation_.desired_rotation_inv[c];
+    const Eigen::Vector3d& tolerance = orientation_.tolerance[c];
+    for (std::size_t s = 0; s < n; ++s)
+    {
+      const Eigen::Matrix3d diff = desired_inv * states[s]->getGlobalLinkTransform(orientation_.link[c]).linear();
+      const Eigen::Vector3d xyz_rotation =
+          orientationError(diff, orientation_.parameterization_type[c], orientation_.desired_rotation_in_frame_id[c],
+                           tolerance.z());
+      if (!orientationErrorWithinTolerance(xyz_rotation, tolerance.x(), tolerance.y(), tolerance.z()))
+        results[s].satisfied = false;
+      results[s].distance += orientation_.weight[c] * (xyz_rotation(0) + xyz_rotation(1) + xyz_rotation(2));
+    }
+  }
+
+  for (const KinematicConstraintPtr& constraint : fallback_)
+  {
+    for (std::size_t s = 0; s < n; ++s)
+    {
+      const ConstraintEvaluationResult r = constraint->decide(*states[s]);
+      if (!r.satisfied)
+        results[s].satisfied = false;
+      results[s].distance += r.distance;
+    }
+  }
+}
+
 }  // end of namespace kinematic_constraints
@@ -934,6 +934,98 @@ TEST_F(LoadPlanningModelsPr2, TestKinematicConstraintSetEquality)
   EXPECT_TRUE(kcs2.equal(kcs, .1));
 }
 
+TEST_F(LoadPlanningModelsPr2, TestCompiledKinematicConstraintSet)
+{
+  moveit::core::RobotState default_state(robot_model_);
+  default_state.setToDefaultValues();
+  default_state.setVariablePosition("r_wrist_roll_joint", -3.1);
+  default_state.update();
+  moveit::core::Transforms tf(robot_model_->getModelFrame());
+
+  moveit_msgs::msg::Constraints constraints;
+
+  // a continuous joint close to wrapping around, and a regular joint
+  constraints.joint_constraints.resize(2);
+  constraints.joint_constraints[0].joint_name = "r_wrist_roll_joint";
+  constraints.joint_constraints[0].position = 3.0;
+  constraints.joint_constraints[0].tolerance_above = 0.5;
+  constraints.joint_constraints[0].tolerance_below = 0.5;
+  constraints.joint_constraints[0].weight = 1.0;
+  constraints.joint_constraints[1].joint_name = "l_shoulder_pan_joint";
+  constraints.joint_constraints[1].position = 0.0;
+  constraints.joint_constraints[1].tolerance_above = 0.3;
+  constraints.joint_constraints[1].tolerance_below = 0.2;
+  constraints.joint_constraints[1].weight = 0.5;
+
+  // one region of each compiled kind, in the model frame
+  moveit_msgs::msg::PositionConstraint pcm;
+  pcm.header.frame_id = robot_model_->getModelFrame();
+  pcm.link_name = "l_wrist_roll_link";
+  pcm.target_point_offset.x = 0.1;
+  pcm.weight = 1.0;
+  pcm.constraint_region.primitives.resize(3);
+  pcm.constraint_region.primitives[0].type = shape_msgs::msg::SolidPrimitive::BOX;
+  pcm.constraint_region.primitives[0].dimensions = { 0.2, 0.3, 0.4 };
+  pcm.constraint_region.primitives[1].type = shape_msgs::msg::SolidPrimitive::SPHERE;
+  pcm.constraint_region.primitives[1].dimensions = { 0.15 };
+  pcm.constraint_region.primitives[2].type = shape_msgs::msg::SolidPrimitive::CYLINDER;
+  pcm.constraint_region.primitives[2].dimensions = { 0.4, 0.1 };
+  const Eigen::Vector3d wrist = default_state.getGlobalLinkTransform("l_wrist_roll_link").translation();
+  pcm.constraint_region.primitive_poses.resize(3);
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    const Eigen::Isometry3d pose = Eigen::Translation3d(wrist + Eigen::Vector3d(0.1 * i, -0.05 * i, 0.05)) *
+                                   Eigen::AngleAxisd(0.3 * (i + 1), Eigen::Vector3d(1.0, 2.0, 0.5).normalized());
+    pcm.constraint_region.primitive_poses[i] = tf2::toMsg(pose);
+  }
+  constraints.position_constraints.push_back(pcm);
+
+  // the same constraint in a mobile frame is evaluated through decide()
+  pcm.header.frame_id = "r_wrist_roll_link";
+  constraints.position_constraints.push_back(pcm);
+
+  // both orientation parameterizations
+  moveit_msgs::msg::OrientationConstraint ocm;
+  ocm.header.frame_id = robot_model_->getModelFrame();
+  ocm.link_name = "r_wrist_roll_link";
+  ocm.orientation = tf2::toMsg(Eigen::Quaterniond(default_state.getGlobalLinkTransform(ocm.link_name).linear()));
+  ocm.absolute_x_axis_tolerance = 0.4;
+  ocm.absolute_y_axis_tolerance = 0.3;
+  ocm.absolute_z_axis_tolerance = 0.6;
+  ocm.weight = 1.0;
+  constraints.orientation_constraints.push_back(ocm);
+  ocm.parameterization = moveit_msgs::msg::OrientationConstraint::ROTATION_VECTOR;
+  constraints.orientation_constraints.push_back(ocm);
+
+  kinematic_constraints::KinematicConstraintSet kcs(robot_model_);
+  EXPECT_TRUE(kcs.add(constraints, tf));
+
+  kinematic_constraints::CompiledKinematicConstraintSetPtr compiled = kcs.compile();
+  EXPECT_EQ(compiled->getCompiledConstraintCount(), 5u);
+  EXPECT_EQ(compiled->getFallbackConstraintCount(), 1u);
+
+  std::vector<moveit::core::RobotState> states(500, default_state);
+  std::vector<const moveit::core::RobotState*> state_ptrs;
+  for (moveit::core::RobotState& state : states)
+  {
+    state.setToRandomPositionsNearBy(robot_model_->getJointModelGroup("arms"), default_state, 0.5);
+    state.update();
+    state_ptrs.push_back(&state);
+  }
+
+  std::vector<kinematic_constraints::ConstraintEvaluationResult> results;
+  compiled->decide(state_ptrs, results);
+  ASSERT_EQ(results.size(), states.size());
+
+  for (std::size_t i = 0; i < states.size(); ++i)
+  {
+    const kinematic_constraints::ConstraintEvaluationResult expected = kcs.decide(states[i]);
+    EXPECT_EQ(results[i].satisfied, expected.satisfied);
+    EXPECT_NEAR(results[i].distance, expected.distance, 1e-9);
+    EXPECT_EQ(compiled->decide(states[i]).satisfied, expected.satisfied);
+  }
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
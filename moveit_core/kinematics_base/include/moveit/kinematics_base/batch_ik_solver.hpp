@@ -0,0 +1,151 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <geometry_msgs/msg/pose.hpp>
+#include <moveit/kinematics_base/kinematics_base.hpp>
+#include <moveit/macros/class_forward.hpp>
+#include <moveit_msgs/msg/move_it_error_codes.hpp>
+
+#include <moveit_kinematics_base_export.h>
+
+namespace kinematics
+{
+MOVEIT_CLASS_FORWARD(BatchIKSolver);  // Defines BatchIKSolverPtr, ConstPtr, WeakPtr... etc
+
+/**
+ * @class BatchIKSolver
+ * @brief Solves batches of independent IK queries on a pool of worker threads.
+ *
+ * Kinematics solvers are generally not thread-safe, so every worker owns a separate solver instance. A batch is split
+ * into contiguous slices, and every worker solves its slice through KinematicsBase::searchPositionIKBatch(). Solvers
+ * that warm-start from the previous pose of a batch hence keep doing so within their slice.
+ */
+class MOVEIT_KINEMATICS_BASE_EXPORT BatchIKSolver
+{
+public:
+  /** @brief Function type that allocates a new, initialized solver instance */
+  using SolverFactoryFn = std::function<KinematicsBasePtr()>;
+
+  /**
+   * @brief Create a batch solver with solver instances allocated by \e solver_factory
+   * @param solver_factory Called once per thread. It must return a distinct solver instance on every call.
+   * @param thread_count The number of threads to solve on, or 0 to use one per hardware thread
+   */
+  BatchIKSolver(const SolverFactoryFn& solver_factory, std::size_t thread_count = 0);
+
+  /**
+   * @brief Create a batch solver with solver instances allocated by the solver allocator of \e jmg
+   * @param jmg The group to solve for. Its solver allocator must be set.
+   * @param thread_count The number of threads to solve on, or 0 to use one per hardware thread
+   */
+  BatchIKSolver(const moveit::core::JointModelGroup* jmg, std::size_t thread_count = 0);
+
+  ~BatchIKSolver();
+
+  BatchIKSolver(const BatchIKSolver&) = delete;
+  BatchIKSolver& operator=(const BatchIKSolver&) = delete;
+
+  /** @brief The number of solver instances, i.e. the maximum number of slices a batch is solved in */
+  std::size_t getThreadCount() const
+  {
+    return solvers_.size();
+  }
+
+  /** @brief Batches are not split into slices of fewer poses than this, to amortize the cost of a hand-off */
+  void setMinPosesPerThread(std::size_t min_poses_per_thread)
+  {
+    min_poses_per_thread_ = min_poses_per_thread > 0 ? min_poses_per_thread : 1;
+  }
+
+  std::size_t getMinPosesPerThread() const
+  {
+    return min_poses_per_thread_;
+  }
+
+  /**
+   * @brief Search for the joint angles reaching each of a batch of tip poses, in parallel.
+   * The arguments are as for KinematicsBase::searchPositionIKBatch(). Concurrent calls are serialized.
+   * @return True if a valid solution was found for every pose, false otherwise
+   */
+  bool searchPositionIK(const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                        const std::vector<std::vector<double>>& ik_seed_states, double timeout,
+                        std::vector<std::vector<double>>& solutions,
+                        std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes,
+                        const KinematicsQueryOptions& options = KinematicsQueryOptions());
+
+private:
+  /** @brief A slice of a batch, handed to one worker */
+  struct Slice
+  {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    bool solved = true;
+  };
+
+  void createSolvers(const SolverFactoryFn& solver_factory, std::size_t thread_count);
+  void workerLoop(std::size_t worker);
+  void solveSlice(std::size_t worker);
+
+  std::vector<KinematicsBasePtr> solvers_;
+  std::vector<std::thread> threads_;  ///< Workers 1..n-1. Worker 0 is the calling thread.
+  std::size_t min_poses_per_thread_ = 8;
+
+  std::mutex call_mutex_;  ///< Serializes calls to searchPositionIK()
+
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  std::size_t generation_ = 0;  ///< Incremented for every batch handed to the workers
+  std::size_t pending_ = 0;     ///< Number of workers still solving the current batch
+  bool stop_ = false;
+
+  // The batch being solved. Only valid while a call to searchPositionIK() is in progress.
+  const std::vector<geometry_msgs::msg::Pose>* ik_poses_ = nullptr;
+  const std::vector<std::vector<double>>* ik_seed_states_ = nullptr;
+  double timeout_ = 0.0;
+  std::vector<std::vector<double>>* solutions_ = nullptr;
+  std::vector<moveit_msgs::msg::MoveItErrorCodes>* error_codes_ = nullptr;
+  const KinematicsQueryOptions* options_ = nullptr;
+  std::vector<Slice> slices_;
+};
+}  // namespace kinematics
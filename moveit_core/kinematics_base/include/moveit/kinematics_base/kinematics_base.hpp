@@ -368,6 +368,26 @@ public:
     return false;
   }
 
+  /**
+   * @brief Given a batch of independent desired poses for the tip link of the chain, search for the joint angles
+   * required to reach each of them.
+   * The default implementation calls searchPositionIK() for one pose after the other. Solvers that can share work
+   * between the poses of a batch should override it. Use kinematics::BatchIKSolver to solve a batch in parallel.
+   * @param ik_poses the desired poses of the tip link, in the reference frame of the kinematics solver
+   * @param ik_seed_states one initial guess per pose, or a single initial guess used for all poses
+   * @param timeout The amount of time (in seconds) available to the solver for each pose
+   * @param solutions the solution vectors, one per pose. The solution of an unsolved pose is left empty.
+   * @param error_codes the error codes, one per pose, encoding the reason for failure or success
+   * @param options container for other IK options. See definition of KinematicsQueryOptions for details.
+   * @return True if a valid solution was found for every pose, false otherwise
+   */
+  virtual bool
+  searchPositionIKBatch(const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                        const std::vector<std::vector<double>>& ik_seed_states, double timeout,
+                        std::vector<std::vector<double>>& solutions,
+                        std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes,
+                        const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const;
+
   /**
    * @brief Given a set of joint angles and a set of links, compute their pose
    * @param link_names A set of links for which FK needs to be computed
@@ -0,0 +1,215 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/kinematics_base/batch_ik_solver.hpp>
+#include <moveit/robot_model/joint_model_group.hpp>
+#include <moveit/utils/logger.hpp>
+#include <rclcpp/logging.hpp>
+
+#include <algorithm>
+
+namespace kinematics
+{
+namespace
+{
+rclcpp::Logger getLogger()
+{
+  return moveit::getLogger("moveit.core.batch_ik_solver");
+}
+}  // namespace
+
+BatchIKSolver::BatchIKSolver(const SolverFactoryFn& solver_factory, std::size_t thread_count)
+{
+  createSolvers(solver_factory, thread_count);
+}
+
+BatchIKSolver::BatchIKSolver(const moveit::core::JointModelGroup* jmg, std::size_t thread_count)
+{
+  const moveit::core::SolverAllocatorFn& allocator = jmg->getGroupKinematics().first.allocator_;
+  if (!allocator)
+  {
+    RCLCPP_ERROR(getLogger(), "No kinematics solver allocator is set for group '%s'", jmg->getName().c_str());
+    return;
+  }
+  createSolvers([jmg, allocator] { return allocator(jmg); }, thread_count);
+}
+
+BatchIKSolver::~BatchIKSolver()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (std::thread& thread : threads_)
+    thread.join();
+}
+
+void BatchIKSolver::createSolvers(const SolverFactoryFn& solver_factory, std::size_t thread_count)
+{
+  if (thread_count == 0)
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+  solvers_.reserve(thread_count);
+  for (std::size_t i = 0; i < thread_count; ++i)
+  {
+    KinematicsBasePtr solver = solver_factory();
+    if (!solver)
+    {
+      RCLCPP_ERROR(getLogger(), "Failed to allocate kinematics solver %zu of %zu", i + 1, thread_count);
+      break;
+    }
+    if (std::find(solvers_.begin(), solvers_.end(), solver) != solvers_.end())
+    {
+      RCLCPP_ERROR(getLogger(), "The solver factory returned the same solver instance twice. "
+                                "Solving on %zu threads only.",
+                   solvers_.size());
+      break;
+    }
+    solvers_.push_back(std::move(solver));
+  }
+
+  for (std::size_t worker = 1; worker < solvers_.size(); ++worker)
+    threads_.emplace_back(&BatchIKSolver::workerLoop, this, worker);
+}
+
+bool BatchIKSolver::searchPositionIK(const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                                     const std::vector<std::vector<double>>& ik_seed_states, double timeout,
+                                     std::vector<std::vector<double>>& solutions,
+                                     std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes,
+                                     const KinematicsQueryOptions& options)
+{
+  if (solvers_.empty())
+  {
+    RCLCPP_ERROR(getLogger(), "No kinematics solver available to solve the batch");
+    solutions.assign(ik_poses.size(), std::vector<double>());
+    error_codes.assign(ik_poses.size(), moveit_msgs::msg::MoveItErrorCodes());
+    for (moveit_msgs::msg::MoveItErrorCodes& error_code : error_codes)
+      error_code.val = moveit_msgs::msg::MoveItErrorCodes::NO_IK_SOLUTION;
+    return false;
+  }
+
+  std::lock_guard<std::mutex> call_lock(call_mutex_);
+
+  const std::size_t slice_count = std::min(
+      solvers_.size(), std::max<std::size_t>(1, (ik_poses.size() + min_poses_per_thread_ - 1) / min_poses_per_thread_));
+  if (slice_count == 1 || (ik_seed_states.size() != 1 && ik_seed_states.size() != ik_poses.size()))
+  {
+    // Not worth a hand-off, or invalid. In the latter case, the solver reports the error.
+    return solvers_[0]->searchPositionIKBatch(ik_poses, ik_seed_states, timeout, solutions, error_codes, options);
+  }
+
+  solutions.assign(ik_poses.size(), std::vector<double>());
+  error_codes.resize(ik_poses.size());
+
+  slices_.assign(slice_count, Slice());
+  for (std::size_t i = 0; i < slice_count; ++i)
+  {
+    slices_[i].begin = ik_poses.size() * i / slice_count;
+    slices_[i].end = ik_poses.size() * (i + 1) / slice_count;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ik_poses_ = &ik_poses;
+    ik_seed_states_ = &ik_seed_states;
+    timeout_ = timeout;
+    solutions_ = &solutions;
+    error_codes_ = &error_codes;
+    options_ = &options;
+    pending_ = threads_.size();
+    ++generation_;
+  }
+  work_cv_.notify_all();
+
+  solveSlice(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this] { return pending_ == 0; });
+  ik_poses_ = nullptr;
+  ik_seed_states_ = nullptr;
+  solutions_ = nullptr;
+  error_codes_ = nullptr;
+  options_ = nullptr;
+
+  return std::all_of(slices_.begin(), slices_.end(), [](const Slice& slice) { return slice.solved; });
+}
+
+void BatchIKSolver::workerLoop(std::size_t worker)
+{
+  std::size_t seen_generation = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_cv_.wait(lock, [this, seen_generation] { return stop_ || generation_ != seen_generation; });
+      if (stop_)
+        return;
+      seen_generation = generation_;
+    }
+
+    if (worker < slices_.size())
+      solveSlice(worker);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --pending_;
+    }
+    done_cv_.notify_one();
+  }
+}
+
+void BatchIKSolver::solveSlice(std::size_t worker)
+{
+  Slice& slice = slices_[worker];
+  if (slice.begin == slice.end)
+    return;
+
+  const auto begin = static_cast<std::ptrdiff_t>(slice.begin);
+  const auto end = static_cast<std::ptrdiff_t>(slice.end);
+  const std::vector<geometry_msgs::msg::Pose> poses(ik_poses_->begin() + begin, ik_poses_->begin() + end);
+  const std::vector<std::vector<double>> seeds =
+      ik_seed_states_->size() == 1 ? *ik_seed_states_ :
+                                     std::vector<std::vector<double>>(ik_seed_states_->begin() + begin,
+                                                                      ik_seed_states_->begin() + end);
+
+  std::vector<std::vector<double>> solutions;
+  std::vector<moveit_msgs::msg::MoveItErrorCodes> error_codes;
+  slice.solved = solvers_[worker]->searchPositionIKBatch(poses, seeds, timeout_, solutions, error_codes, *options_);
+
+  // Every slice writes to a disjoint range of the output
+  std::move(solutions.begin(), solutions.end(), solutions_->begin() + begin);
+  std::move(error_codes.begin(), error_codes.end(), error_codes_->begin() + begin);
+}
+}  // namespace kinematics
@@ -632,6 +632,13 @@ public:
    * requested object*/
   bool getCollisionObjectMsg(moveit_msgs::msg::CollisionObject& collision_obj, const std::string& ns) const;
 
+  /** \brief Construct a MOVE message (\e collision_obj) carrying only the object and shape poses of the requested
+   * object, without its geometry. Returns false if the object does not exist or its shapes cannot be moved this way
+   * (they are not stored in primitive, mesh, plane order or include shapes without a message type).
+   * getPlanningSceneDiffMsg() does not use this, because a receiver that missed the original ADD cannot apply a
+   * MOVE. */
+  bool getCollisionObjectMoveMsg(moveit_msgs::msg::CollisionObject& collision_obj, const std::string& ns) const;
+
   /** \brief Construct a vector of messages (\e collision_objects) with the collision object data for all objects in
    * planning_scene */
   void getCollisionObjectMsgs(std::vector<moveit_msgs::msg::CollisionObject>& collision_objs) const;
@@ -677,6 +684,13 @@ public:
                                                 EigenSTL::vector_Isometry3d& shape_poses);
 
   bool processCollisionObjectMsg(const moveit_msgs::msg::CollisionObject& object);
+
+  /** \brief Process several collision object messages, in order.
+   * The geometry of added objects is decoded in parallel, and consecutive additions are committed to the world
+   * together. All changes are made in a single transaction of the world, so that the collision environments
+   * update once for the whole list instead of once per object.
+   * Returns false if any of the messages could not be processed. */
+  bool processCollisionObjectMsgs(const std::vector<moveit_msgs::msg::CollisionObject>& objects);
   bool processAttachedCollisionObjectMsg(const moveit_msgs::msg::AttachedCollisionObject& object);
 
   bool processPlanningSceneWorldMsg(const moveit_msgs::msg::PlanningSceneWorld& world);
@@ -936,6 +950,10 @@ private:
   bool processCollisionObjectAdd(const moveit_msgs::msg::CollisionObject& object);
   bool processCollisionObjectRemove(const moveit_msgs::msg::CollisionObject& object);
   bool processCollisionObjectMove(const moveit_msgs::msg::CollisionObject& object);
+  void addCollisionObjectToWorld(const moveit_msgs::msg::CollisionObject& object,
+                                 const Eigen::Isometry3d& object_frame_transform,
+                                 const std::vector<shapes::ShapeConstPtr>& shapes,
+                                 const EigenSTL::vector_Isometry3d& shape_poses);
 
   MOVEIT_STRUCT_FORWARD(CollisionDetector);
 
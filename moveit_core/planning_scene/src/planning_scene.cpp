@@ -45,6 +45,7 @@
 #include <moveit/exceptions/exceptions.hpp>
 #include <moveit/robot_state/attached_body.hpp>
 #include <moveit/utils/message_checks.hpp>
+#include <moveit/utils/parallel_for.hpp>
 #include <octomap_msgs/conversions.h>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
@@ -837,6 +838,56 @@ private:
 };
 }  // namespace
 
+bool PlanningScene::getCollisionObjectMoveMsg(moveit_msgs::msg::CollisionObject& collision_obj,
+                                              const std::string& ns) const
+{
+  collision_detection::CollisionEnv::ObjectConstPtr obj = world_->getObject(ns);
+  if (!obj)
+    return false;
+
+  // processCollisionObjectMove() assigns the received poses to the shapes in primitive, mesh, plane order,
+  // so this message can only be used if the shapes are stored in that order
+  moveit_msgs::msg::CollisionObject msg;
+  int last_kind = 0;
+  for (std::size_t j = 0; j < obj->shapes_.size(); ++j)
+  {
+    int kind;
+    std::vector<geometry_msgs::msg::Pose>* poses;
+    switch (obj->shapes_[j]->type)
+    {
+      case shapes::SPHERE:
+      case shapes::CYLINDER:
+      case shapes::CONE:
+      case shapes::BOX:
+        kind = 0;
+        poses = &msg.primitive_poses;
+        break;
+      case shapes::MESH:
+        kind = 1;
+        poses = &msg.mesh_poses;
+        break;
+      case shapes::PLANE:
+        kind = 2;
+        poses = &msg.plane_poses;
+        break;
+      default:
+        // shapes without a message representation are not counted by the receiver
+        return false;
+    }
+    if (kind < last_kind)
+      return false;
+    last_kind = kind;
+    poses->push_back(tf2::toMsg(obj->shape_poses_[j]));
+  }
+
+  msg.header.frame_id = getPlanningFrame();
+  msg.pose = tf2::toMsg(obj->pose_);
+  msg.id = ns;
+  msg.operation = moveit_msgs::msg::CollisionObject::MOVE;
+  collision_obj = std::move(msg);
+  return true;
+}
+
 bool PlanningScene::getCollisionObjectMsg(moveit_msgs::msg::CollisionObject& collision_obj, const std::string& ns) const
 {
   collision_detection::CollisionEnv::ObjectConstPtr obj = world_->getObject(ns);
@@ -1354,8 +1405,7 @@ bool PlanningScene::setPlanningSceneDiffMsg(const moveit_msgs::msg::PlanningScen
     setObjectColor(object_color.id, object_color.color);
 
   // process collision object updates
-  for (const moveit_msgs::msg::CollisionObject& collision_object : scene_msg.world.collision_objects)
-    result &= processCollisionObjectMsg(collision_object);
+  result &= processCollisionObjectMsgs(scene_msg.world.collision_objects);
 
   // if an octomap was specified, replace the one we have with that one
   if (!scene_msg.world.octomap.octomap.id.empty())
@@ -1389,15 +1439,15 @@ bool PlanningScene::setPlanningSceneMsg(const moveit_msgs::msg::PlanningScene& s
   original_object_colors_ = std::make_unique<ObjectColorMap>();
   for (const moveit_msgs::msg::ObjectColor& object_color : scene_msg.object_colors)
     setObjectColor(object_color.id, object_color.color);
+  // the removed and the new objects reach the collision environments together
+  collision_detection::World::ScopedTransaction transaction(*world_);
   world_->clearObjects();
   return processPlanningSceneWorldMsg(scene_msg.world);
 }
 
 bool PlanningScene::processPlanningSceneWorldMsg(const moveit_msgs::msg::PlanningSceneWorld& world)
 {
-  bool result = true;
-  for (const moveit_msgs::msg::CollisionObject& collision_object : world.collision_objects)
-    result &= processCollisionObjectMsg(collision_object);
+  const bool result = processCollisionObjectMsgs(world.collision_objects);
   processOctomapMsg(world.octomap);
   return result;
 }
@@ -1512,11 +1562,10 @@ void PlanningScene::processOctomapPtr(const std::shared_ptr<const octomap::OcTre
         // if the pose changed, we update it
         if (map->shape_poses_[0].isApprox(t, std::numeric_limits<double>::epsilon() * 100.0))
         {
-          if (world_diff_)
-          {
-            world_diff_->set(OCTOMAP_NS, collision_detection::World::DESTROY | collision_detection::World::CREATE |
-                                             collision_detection::World::ADD_SHAPE);
-          }
+          // the octree was modified in place, so observers only need to refresh their derived data
+          shapes::ShapeConstPtr shape = map->shapes_[0];
+          map.reset();
+          world_->updateShapeInObject(OCTOMAP_NS, shape);
         }
         else
         {
@@ -1797,6 +1846,114 @@ bool PlanningScene::processCollisionObjectMsg(const moveit_msgs::msg::CollisionO
   return false;
 }
 
+bool PlanningScene::processCollisionObjectMsgs(const std::vector<moveit_msgs::msg::CollisionObject>& objects)
+{
+  // messages that add shapes are decoded up front, their geometry does not depend on the scene
+  std::vector<std::size_t> added;
+  for (std::size_t i = 0; i < objects.size(); ++i)
+  {
+    const moveit_msgs::msg::CollisionObject& object = objects[i];
+    if ((object.operation == moveit_msgs::msg::CollisionObject::ADD ||
+         object.operation == moveit_msgs::msg::CollisionObject::APPEND) &&
+        object.id != OCTOMAP_NS && (!object.primitives.empty() || !object.meshes.empty() || !object.planes.empty()))
+      added.push_back(i);
+  }
+
+  // observers of the world, e.g. the collision environments, are updated once for all messages
+  collision_detection::World::ScopedTransaction transaction(*world_);
+  bool result = true;
+  if (added.size() < 2)
+  {
+    for (const moveit_msgs::msg::CollisionObject& object : objects)
+      result &= processCollisionObjectMsg(object);
+    return result;
+  }
+
+  struct DecodedObject
+  {
+    bool valid = false;
+    Eigen::Isometry3d header_to_pose_transform;
+    std::vector<shapes::ShapeConstPtr> shapes;
+    EigenSTL::vector_Isometry3d shape_poses;
+  };
+  std::vector<DecodedObject> decoded(added.size());
+  moveit::core::parallelFor(added.size(), [this, &objects, &added, &decoded](std::size_t i) {
+    DecodedObject& d = decoded[i];
+    d.valid = shapesAndPosesFromCollisionObjectMessage(objects[added[i]], d.header_to_pose_transform, d.shapes,
+                                                       d.shape_poses);
+  });
+
+  // consecutive additions are committed to the world together; everything else is processed in message order
+  std::vector<collision_detection::World::ObjectPtr> batch;
+  std::set<std::string> batch_ids;
+  const auto commit_batch = [this, &batch, &batch_ids] {
+    if (!batch.empty())
+      world_->addObjects(batch);
+    batch.clear();
+    batch_ids.clear();
+  };
+
+  std::size_t next_added = 0;
+  for (std::size_t i = 0; i < objects.size(); ++i)
+  {
+    const moveit_msgs::msg::CollisionObject& object = objects[i];
+    if (next_added == added.size() || added[next_added] != i)
+    {
+      commit_batch();
+      result &= processCollisionObjectMsg(object);
+      continue;
+    }
+    DecodedObject& d = decoded[next_added++];
+
+    // the header frame may be an object (or subframe of an object) that is not committed yet
+    if (batch_ids.count(object.header.frame_id.substr(0, object.header.frame_id.find('/'))))
+      commit_batch();
+    if (!knowsFrameTransform(object.header.frame_id))
+    {
+      RCLCPP_ERROR_STREAM(getLogger(), "Unknown frame: " << object.header.frame_id);
+      result = false;
+      continue;
+    }
+
+    if (!d.valid)
+    {
+      // same outcome as processCollisionObjectAdd(): an object replaced by invalid geometry is removed
+      commit_batch();
+      if (object.operation == moveit_msgs::msg::CollisionObject::ADD && world_->hasObject(object.id))
+        world_->removeObject(object.id);
+      result = false;
+      continue;
+    }
+
+    const Eigen::Isometry3d object_frame_transform =
+        getFrameTransform(object.header.frame_id) * d.header_to_pose_transform;
+    if (object.operation == moveit_msgs::msg::CollisionObject::APPEND &&
+        (batch_ids.count(object.id) || world_->hasObject(object.id)))
+    {
+      commit_batch();
+      addCollisionObjectToWorld(object, object_frame_transform, d.shapes, d.shape_poses);
+      continue;
+    }
+
+    auto world_object = std::make_shared<collision_detection::World::Object>(object.id);
+    world_object->pose_ = object_frame_transform;
+    world_object->shapes_ = std::move(d.shapes);
+    world_object->shape_poses_ = std::move(d.shape_poses);
+    Eigen::Isometry3d subframe_pose;
+    for (std::size_t j = 0; j < object.subframe_poses.size(); ++j)
+    {
+      utilities::poseMsgToEigen(object.subframe_poses[j], subframe_pose);
+      world_object->subframe_poses_[object.subframe_names[j]] = subframe_pose;
+    }
+    if (!object.type.key.empty() || !object.type.db.empty())
+      setObjectType(object.id, object.type);
+    batch.push_back(std::move(world_object));
+    batch_ids.insert(object.id);
+  }
+  commit_batch();
+  return result;
+}
+
 bool PlanningScene::shapesAndPosesFromCollisionObjectMessage(const moveit_msgs::msg::CollisionObject& object,
                                                              Eigen::Isometry3d& object_pose,
                                                              std::vector<shapes::ShapeConstPtr>& shapes,
@@ -1910,6 +2067,15 @@ bool PlanningScene::processCollisionObjectAdd(const moveit_msgs::msg::CollisionO
     return false;
   const Eigen::Isometry3d object_frame_transform = world_to_object_header_transform * header_to_pose_transform;
 
+  addCollisionObjectToWorld(object, object_frame_transform, shapes, shape_poses);
+  return true;
+}
+
+void PlanningScene::addCollisionObjectToWorld(const moveit_msgs::msg::CollisionObject& object,
+                                              const Eigen::Isometry3d& object_frame_transform,
+                                              const std::vector<shapes::ShapeConstPtr>& shapes,
+                                              const EigenSTL::vector_Isometry3d& shape_poses)
+{
   world_->addToObject(object.id, object_frame_transform, shapes, shape_poses);
 
   if (!object.type.key.empty() || !object.type.db.empty())
@@ -1925,7 +2091,6 @@ bool PlanningScene::processCollisionObjectAdd(const moveit_msgs::msg::CollisionO
     subframes[name] = subframe_pose;
   }
   world_->setSubframesOfObject(object.id, subframes);
-  return true;
 }
 
 bool PlanningScene::processCollisionObjectRemove(const moveit_msgs::msg::CollisionObject& object)
@@ -2373,6 +2538,17 @@ bool PlanningScene::isPathValid(const robot_trajectory::RobotTrajectory& traject
   kinematic_constraints::KinematicConstraintSet ks_p(getRobotModel());
   ks_p.add(path_constraints, getTransforms());
   std::size_t n_wp = trajectory.getWayPointCount();
+
+  // Unless every constraint should report on its own, evaluate the path constraints for all waypoints at once
+  std::vector<kinematic_constraints::ConstraintEvaluationResult> path_results;
+  if (!ks_p.empty() && !verbose)
+  {
+    std::vector<const moveit::core::RobotState*> waypoints(n_wp);
+    for (std::size_t i = 0; i < n_wp; ++i)
+      waypoints[i] = &trajectory.getWayPoint(i);
+    ks_p.compile()->decide(waypoints, path_results);
+  }
+
   for (std::size_t i = 0; i < n_wp; ++i)
   {
     const moveit::core::RobotState& st = trajectory.getWayPoint(i);
@@ -2382,7 +2558,12 @@ bool PlanningScene::isPathValid(const robot_trajectory::RobotTrajectory& traject
       this_state_valid = false;
     if (!isStateFeasible(st, verbose))
       this_state_valid = false;
-    if (!ks_p.empty() && !ks_p.decide(st, verbose).satisfied)
+    if (!path_results.empty())
+    {
+      if (!path_results[i].satisfied)
+        this_state_valid = false;
+    }
+    else if (!ks_p.empty() && !ks_p.decide(st, verbose).satisfied)
       this_state_valid = false;
 
     if (!this_state_valid)
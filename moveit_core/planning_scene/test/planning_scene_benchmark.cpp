@@ -0,0 +1,93 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+// To run this benchmark, 'cd' to the build/moveit_core/planning_scene directory and directly run the binary.
+
+#include <benchmark/benchmark.h>
+#include <geometric_shapes/shapes.h>
+#include <moveit/planning_scene/planning_scene.hpp>
+#include <moveit/utils/robot_model_test_utils.hpp>
+
+// Robot to use in the benchmarks.
+constexpr char TEST_ROBOT[] = "panda";
+
+namespace
+{
+// Create a scene with a given number of box objects on a grid away from the robot.
+planning_scene::PlanningScenePtr createLargeScene(int n_objects)
+{
+  auto scene = std::make_shared<planning_scene::PlanningScene>(moveit::core::loadTestingRobotModel(TEST_ROBOT));
+  const shapes::ShapeConstPtr box = std::make_shared<const shapes::Box>(0.05, 0.05, 0.05);
+  for (int i = 0; i < n_objects; ++i)
+  {
+    const Eigen::Isometry3d pose(Eigen::Translation3d(2.0 + 0.1 * (i % 100), 0.1 * (i / 100), 0.0));
+    scene->getWorldNonConst()->addToObject("box" + std::to_string(i), box, pose);
+  }
+  return scene;
+}
+}  // namespace
+
+// Benchmark cloning a scene with a given number of objects.
+static void planningSceneClone(benchmark::State& st)
+{
+  const planning_scene::PlanningScenePtr scene = createLargeScene(st.range(0));
+  for (auto _ : st)
+  {
+    planning_scene::PlanningScenePtr clone = planning_scene::PlanningScene::clone(scene);
+    benchmark::DoNotOptimize(clone);
+  }
+}
+
+// Benchmark cloning a scene, moving one of its objects and checking the clone for collisions, as done when applying
+// a request-specific diff.
+static void planningSceneCloneModifyCheck(benchmark::State& st)
+{
+  const planning_scene::PlanningScenePtr scene = createLargeScene(st.range(0));
+  collision_detection::CollisionRequest req;
+  for (auto _ : st)
+  {
+    planning_scene::PlanningScenePtr clone = planning_scene::PlanningScene::clone(scene);
+    clone->getWorldNonConst()->moveObject("box0", Eigen::Isometry3d(Eigen::Translation3d(0.0, 0.0, 0.1)));
+    clone->getAllowedCollisionMatrixNonConst().setEntry("box0", "panda_link0", true);
+
+    collision_detection::CollisionResult res;
+    clone->checkCollision(req, res);
+    benchmark::DoNotOptimize(res.collision);
+  }
+}
+
+BENCHMARK(planningSceneClone)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(planningSceneCloneModifyCheck)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
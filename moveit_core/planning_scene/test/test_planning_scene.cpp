@@ -50,6 +50,7 @@
 
 #include <moveit/collision_detection/collision_common.hpp>
 #include <moveit/collision_detection/collision_plugin_cache.hpp>
+#include <geometric_shapes/mesh_operations.h>
 
 // Test not setting the object's pose should use the shape pose as the object pose
 TEST(PlanningScene, TestOneShapeObjectPose)
@@ -672,6 +673,91 @@ TEST(PlanningScene, UpdateACMAfterObjectRemoval)
 // instantiate parameterized tests for common collision plugins
 INSTANTIATE_TEST_SUITE_P(PluginTests, CollisionDetectorTests, testing::Values("FCL", "Bullet"));
 
+TEST(PlanningScene, CloneIsCopyOnWrite)
+{
+  auto robot_model = moveit::core::loadTestingRobotModel("panda");
+  auto ps = std::make_shared<planning_scene::PlanningScene>(robot_model);
+
+  // a box around the base of the robot and one far away
+  ps->getWorldNonConst()->addToObject("box", std::make_shared<shapes::Box>(0.2, 0.2, 0.2),
+                                      Eigen::Isometry3d::Identity());
+  ps->getWorldNonConst()->addToObject("far", std::make_shared<shapes::Box>(0.2, 0.2, 0.2),
+                                      Eigen::Isometry3d(Eigen::Translation3d(5.0, 0.0, 0.0)));
+
+  auto check_collision = [](const planning_scene::PlanningScene& scene) {
+    collision_detection::CollisionRequest req;
+    collision_detection::CollisionResult res;
+    scene.checkCollision(req, res);
+    return res.collision;
+  };
+  EXPECT_TRUE(check_collision(*ps));
+
+  planning_scene::PlanningScenePtr clone = planning_scene::PlanningScene::clone(ps);
+  EXPECT_TRUE(check_collision(*clone));
+  EXPECT_EQ(ps->getWorld()->getObject("far"), clone->getWorld()->getObject("far"));
+
+  // moving an object in the clone leaves the original untouched
+  EXPECT_TRUE(clone->getWorldNonConst()->moveObject("box", Eigen::Isometry3d(Eigen::Translation3d(2.0, 0.0, 0.0))));
+  EXPECT_FALSE(check_collision(*clone));
+  EXPECT_TRUE(check_collision(*ps));
+  EXPECT_EQ(ps->getWorld()->getObject("far"), clone->getWorld()->getObject("far"));
+
+  // and so does changing the allowed collision matrix of the original
+  ps->getAllowedCollisionMatrixNonConst().setDefaultEntry("box", true);
+  EXPECT_FALSE(check_collision(*ps));
+  collision_detection::AllowedCollision::Type type;
+  EXPECT_FALSE(clone->getAllowedCollisionMatrix().getDefaultEntry("box", type));
+  EXPECT_TRUE(clone->getWorldNonConst()->moveObject("box", Eigen::Isometry3d(Eigen::Translation3d(-2.0, 0.0, 0.0))));
+  EXPECT_TRUE(check_collision(*clone));
+}
+
+TEST(PlanningScene, CollisionObjectMoveMsg)
+{
+  auto robot_model = moveit::core::loadTestingRobotModel("panda");
+  auto ps = std::make_shared<planning_scene::PlanningScene>(robot_model);
+
+  const auto box = std::make_shared<shapes::Box>(0.2, 0.2, 0.2);
+  const shapes::ShapeConstPtr mesh(shapes::createMeshFromShape(*box));
+  ps->getWorldNonConst()->addToObject("obj", box, Eigen::Isometry3d::Identity());
+  ps->getWorldNonConst()->addToObject("obj", mesh, Eigen::Isometry3d(Eigen::Translation3d(0.0, 0.5, 0.0)));
+  // shapes out of primitive, mesh, plane order cannot be described by a MOVE
+  ps->getWorldNonConst()->addToObject("unordered", mesh, Eigen::Isometry3d::Identity());
+  ps->getWorldNonConst()->addToObject("unordered", box, Eigen::Isometry3d(Eigen::Translation3d(0.0, 0.5, 0.0)));
+
+  planning_scene::PlanningScenePtr next = ps->diff();
+  const Eigen::Isometry3d pose(Eigen::Translation3d(1.0, 0.0, 0.0));
+  EXPECT_TRUE(next->getWorldNonConst()->moveObject("obj", pose));
+  EXPECT_TRUE(next->getWorldNonConst()->moveObject("unordered", pose));
+
+  moveit_msgs::msg::CollisionObject move;
+  EXPECT_FALSE(next->getCollisionObjectMoveMsg(move, "unordered"));
+  ASSERT_TRUE(next->getCollisionObjectMoveMsg(move, "obj"));
+  EXPECT_EQ(move.operation, moveit_msgs::msg::CollisionObject::MOVE);
+  EXPECT_TRUE(move.primitives.empty());
+  EXPECT_TRUE(move.meshes.empty());
+  EXPECT_EQ(move.primitive_poses.size(), 1u);
+  EXPECT_EQ(move.mesh_poses.size(), 1u);
+
+  // diffs keep sending moved objects as full ADDs, so receivers that missed the original ADD still recover
+  moveit_msgs::msg::PlanningScene msg;
+  next->getPlanningSceneDiffMsg(msg);
+  ASSERT_EQ(msg.world.collision_objects.size(), 2u);
+  for (const moveit_msgs::msg::CollisionObject& object : msg.world.collision_objects)
+    EXPECT_EQ(object.operation, moveit_msgs::msg::CollisionObject::ADD);
+
+  // applying the MOVE to a copy of the original scene reproduces the moved object
+  planning_scene::PlanningScenePtr copy = planning_scene::PlanningScene::clone(ps);
+  ASSERT_TRUE(copy->processCollisionObjectMsg(move));
+  const auto expected = next->getWorld()->getObject("obj");
+  const auto actual = copy->getWorld()->getObject("obj");
+  ASSERT_EQ(actual->shapes_.size(), expected->shapes_.size());
+  for (std::size_t i = 0; i < expected->shapes_.size(); ++i)
+  {
+    EXPECT_EQ(actual->shapes_[i], expected->shapes_[i]);
+    EXPECT_TRUE(actual->global_shape_poses_[i].isApprox(expected->global_shape_poses_[i]));
+  }
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
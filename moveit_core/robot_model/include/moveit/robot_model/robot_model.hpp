@@ -78,6 +78,12 @@ public:
   /** \brief Construct a kinematic model from a parsed description and a list of planning groups */
   RobotModel(const urdf::ModelInterfaceSharedPtr& urdf_model, const srdf::ModelConstSharedPtr& srdf_model);
 
+  /** \brief Construct a kinematic model from a parsed description and a list of planning groups. Decoded link meshes
+   *  are kept as snapshots in \e mesh_cache_directory, so later constructions skip decoding them (see
+   *  loadMeshResource()). */
+  RobotModel(const urdf::ModelInterfaceSharedPtr& urdf_model, const srdf::ModelConstSharedPtr& srdf_model,
+             const std::string& mesh_cache_directory);
+
   /** \brief Destructor. Clear all memory. */
   ~RobotModel();
 
@@ -488,6 +494,13 @@ protected:
 
   urdf::ModelInterfaceSharedPtr urdf_;
 
+  /** \brief The directory mesh snapshots are kept in; empty if meshes are always decoded */
+  std::string mesh_cache_directory_;
+
+  /** \brief The number of meshes loaded while building the model, and how many of them came from snapshots */
+  std::size_t mesh_count_;
+  std::size_t cached_mesh_count_;
+
   // LINKS
 
   /** \brief The first physical link for the robot */
@@ -0,0 +1,229 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/robot_model/mesh_cache.hpp>
+#include <moveit/utils/logger.hpp>
+
+#include <ament_index_cpp/get_package_share_directory.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <geometric_shapes/mesh_operations.h>
+#include <iterator>
+#include <memory>
+#include <rclcpp/logging.hpp>
+#include <vector>
+
+namespace moveit
+{
+namespace core
+{
+namespace
+{
+rclcpp::Logger getLogger()
+{
+  return moveit::getLogger("moveit.core.mesh_cache");
+}
+
+const char SNAPSHOT_MAGIC[4] = { 'M', 'V', 'M', 'S' };
+// increase whenever the snapshot layout changes, so old snapshots are ignored
+const std::uint32_t SNAPSHOT_VERSION = 1;
+
+// 64 bit FNV-1a
+void hashBytes(std::uint64_t& hash, const void* data, std::size_t bytes)
+{
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  for (std::size_t i = 0; i < bytes; ++i)
+  {
+    hash ^= p[i];
+    hash *= 1099511628211ull;
+  }
+}
+
+/** \brief Get the local file a mesh resource refers to; empty if it is not a local file */
+std::string resolveResource(const std::string& resource)
+{
+  static const std::string FILE_PREFIX = "file://";
+  static const std::string PACKAGE_PREFIX = "package://";
+  if (resource.compare(0, FILE_PREFIX.size(), FILE_PREFIX) == 0)
+    return resource.substr(FILE_PREFIX.size());
+  if (resource.compare(0, PACKAGE_PREFIX.size(), PACKAGE_PREFIX) == 0)
+  {
+    const std::size_t slash = resource.find('/', PACKAGE_PREFIX.size());
+    if (slash == std::string::npos)
+      return std::string();
+    try
+    {
+      const std::string package = resource.substr(PACKAGE_PREFIX.size(), slash - PACKAGE_PREFIX.size());
+      return ament_index_cpp::get_package_share_directory(package) + resource.substr(slash);
+    }
+    catch (const std::exception&)
+    {
+      return std::string();
+    }
+  }
+  if (!resource.empty() && resource[0] == '/')
+    return resource;
+  return std::string();
+}
+
+/** \brief Hash the content of \e path together with \e scale; false if the file cannot be read */
+bool hashResource(const std::string& path, const Eigen::Vector3d& scale, std::uint64_t& hash)
+{
+  std::ifstream in(path, std::ios::binary);
+  if (!in)
+    return false;
+  hash = 14695981039346656037ull;
+  hashBytes(hash, &SNAPSHOT_VERSION, sizeof(SNAPSHOT_VERSION));
+  hashBytes(hash, scale.data(), 3 * sizeof(double));
+  std::vector<char> buffer(1 << 16);
+  while (in)
+  {
+    in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    hashBytes(hash, buffer.data(), static_cast<std::size_t>(in.gcount()));
+  }
+  return in.eof();
+}
+
+shapes::Mesh* readSnapshot(const std::string& path, std::uint64_t hash)
+{
+  std::ifstream in(path, std::ios::binary);
+  if (!in)
+    return nullptr;
+
+  char magic[sizeof(SNAPSHOT_MAGIC)];
+  std::uint32_t version;
+  std::uint64_t stored_hash;
+  std::uint32_t vertex_count, triangle_count;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char*>(&version), sizeof(version));
+  in.read(reinterpret_cast<char*>(&stored_hash), sizeof(stored_hash));
+  in.read(reinterpret_cast<char*>(&vertex_count), sizeof(vertex_count));
+  in.read(reinterpret_cast<char*>(&triangle_count), sizeof(triangle_count));
+  if (!in || std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0 || version != SNAPSHOT_VERSION ||
+      stored_hash != hash)
+  {
+    return nullptr;
+  }
+
+  // check the size before allocating, the counts could be garbage
+  const std::streamoff header_size = in.tellg();
+  in.seekg(0, std::ios::end);
+  const std::streamoff expected_size = header_size + static_cast<std::streamoff>(3 * sizeof(double)) * vertex_count +
+                                       static_cast<std::streamoff>(3 * sizeof(unsigned int)) * triangle_count;
+  if (in.tellg() != expected_size)
+    return nullptr;
+  in.seekg(header_size);
+
+  auto mesh = std::make_unique<shapes::Mesh>(vertex_count, triangle_count);
+  in.read(reinterpret_cast<char*>(mesh->vertices), static_cast<std::streamsize>(3 * sizeof(double) * vertex_count));
+  in.read(reinterpret_cast<char*>(mesh->triangles),
+          static_cast<std::streamsize>(3 * sizeof(unsigned int) * triangle_count));
+  if (!in)
+    return nullptr;
+  mesh->computeTriangleNormals();
+  mesh->computeVertexNormals();
+  return mesh.release();
+}
+
+void writeSnapshot(const std::string& path, std::uint64_t hash, const shapes::Mesh& mesh)
+{
+  // write to a temporary file first, so concurrently starting processes never read a partial snapshot
+  const std::string tmp_path = path + ".tmp" + std::to_string(reinterpret_cast<std::uintptr_t>(&mesh));
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    const std::uint32_t vertex_count = mesh.vertex_count;
+    const std::uint32_t triangle_count = mesh.triangle_count;
+    out.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    out.write(reinterpret_cast<const char*>(&SNAPSHOT_VERSION), sizeof(SNAPSHOT_VERSION));
+    out.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+    out.write(reinterpret_cast<const char*>(&vertex_count), sizeof(vertex_count));
+    out.write(reinterpret_cast<const char*>(&triangle_count), sizeof(triangle_count));
+    out.write(reinterpret_cast<const char*>(mesh.vertices),
+              static_cast<std::streamsize>(3 * sizeof(double) * vertex_count));
+    out.write(reinterpret_cast<const char*>(mesh.triangles),
+              static_cast<std::streamsize>(3 * sizeof(unsigned int) * triangle_count));
+    out.close();
+    if (out)
+    {
+      std::error_code ec;
+      std::filesystem::rename(tmp_path, path, ec);
+      if (!ec)
+        return;
+    }
+  }
+  RCLCPP_WARN(getLogger(), "Could not write mesh snapshot '%s'", path.c_str());
+  std::error_code ec;
+  std::filesystem::remove(tmp_path, ec);
+}
+}  // namespace
+
+shapes::Mesh* loadMeshResource(const std::string& resource, const Eigen::Vector3d& scale,
+                               const std::string& cache_directory, bool* from_cache)
+{
+  if (from_cache)
+    *from_cache = false;
+
+  std::string snapshot_path;
+  std::uint64_t hash = 0;
+  if (!cache_directory.empty())
+  {
+    const std::string path = resolveResource(resource);
+    if (!path.empty() && hashResource(path, scale, hash))
+    {
+      char name[24];
+      std::snprintf(name, sizeof(name), "%016llx.mesh", static_cast<unsigned long long>(hash));
+      snapshot_path = (std::filesystem::path(cache_directory) / name).string();
+      if (shapes::Mesh* mesh = readSnapshot(snapshot_path, hash))
+      {
+        if (from_cache)
+          *from_cache = true;
+        return mesh;
+      }
+    }
+  }
+
+  shapes::Mesh* mesh = shapes::createMeshFromResource(resource, scale);
+  if (mesh && !snapshot_path.empty())
+  {
+    std::error_code ec;
+    std::filesystem::create_directories(cache_directory, ec);
+    writeSnapshot(snapshot_path, hash, *mesh);
+  }
+  return mesh;
+}
+}  // namespace core
+}  // namespace moveit
@@ -36,9 +36,11 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/robot_model/robot_model.hpp>
+#include <moveit/robot_model/mesh_cache.hpp>
 #include <geometric_shapes/shape_operations.h>
 #include <rclcpp/logger.hpp>
 #include <algorithm>
+#include <chrono>
 #include <limits>
 #include <cmath>
 #include <memory>
@@ -59,10 +61,17 @@ rclcpp::Logger getLogger()
 }  // namespace
 
 RobotModel::RobotModel(const urdf::ModelInterfaceSharedPtr& urdf_model, const srdf::ModelConstSharedPtr& srdf_model)
+  : RobotModel(urdf_model, srdf_model, std::string())
+{
+}
+
+RobotModel::RobotModel(const urdf::ModelInterfaceSharedPtr& urdf_model, const srdf::ModelConstSharedPtr& srdf_model,
+                       const std::string& mesh_cache_directory)
 {
   root_joint_ = nullptr;
   urdf_ = urdf_model;
   srdf_ = srdf_model;
+  mesh_cache_directory_ = mesh_cache_directory;
   buildModel(*urdf_model, *srdf_model);
 }
 
@@ -92,8 +101,11 @@ void RobotModel::buildModel(const urdf::ModelInterface& urdf_model, const srdf::
   root_link_ = nullptr;
   link_geometry_count_ = 0;
   variable_count_ = 0;
+  mesh_count_ = 0;
+  cached_mesh_count_ = 0;
   model_name_ = urdf_model.getName();
   RCLCPP_INFO(getLogger(), "Loading robot model '%s'...", model_name_.c_str());
+  const auto start = std::chrono::steady_clock::now();
 
   if (urdf_model.getRoot())
   {
@@ -125,6 +137,13 @@ void RobotModel::buildModel(const urdf::ModelInterface& urdf_model, const srdf::
 
     // For debugging entire model
     // printModelInfo(std::cout);
+
+    if (!mesh_cache_directory_.empty())
+    {
+      RCLCPP_INFO(getLogger(), "Built robot model '%s' in %.3f seconds, %zu of %zu meshes read from '%s'",
+                  model_name_.c_str(), std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+                  cached_mesh_count_, mesh_count_, mesh_cache_directory_.c_str());
+    }
   }
   else
   {
@@ -1277,7 +1296,11 @@ shapes::ShapePtr RobotModel::constructShape(const urdf::Geometry* geom)
       if (!mesh->filename.empty())
       {
         Eigen::Vector3d scale(mesh->scale.x, mesh->scale.y, mesh->scale.z);
-        shapes::Mesh* m = shapes::createMeshFromResource(mesh->filename, scale);
+        bool from_cache;
+        shapes::Mesh* m = loadMeshResource(mesh->filename, scale, mesh_cache_directory_, &from_cache);
+        ++mesh_count_;
+        if (from_cache)
+          ++cached_mesh_count_;
         new_shape = m;
       }
     }
@@ -35,7 +35,10 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/robot_model/robot_model.hpp>
+#include <moveit/robot_model/mesh_cache.hpp>
 #include <urdf_parser/urdf_parser.h>
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <gtest/gtest.h>
 
@@ -204,6 +207,37 @@ TEST(PlanarJointTest, ComputeVariablePositionsNormalizeYaw)
   }
 }
 
+TEST(MeshCache, SnapshotMatchesDecodedMesh)
+{
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / "moveit_test_mesh_cache";
+  std::filesystem::remove_all(directory);
+
+  const std::string resource = "package://moveit_resources_pr2_description/urdf/meshes/base_v0/base_L.stl";
+  const Eigen::Vector3d scale(1.0, 2.0, 1.0);
+  bool from_cache;
+  std::unique_ptr<shapes::Mesh> decoded(
+      moveit::core::loadMeshResource(resource, scale, directory.string(), &from_cache));
+  ASSERT_TRUE(decoded);
+  EXPECT_FALSE(from_cache);
+
+  std::unique_ptr<shapes::Mesh> cached(
+      moveit::core::loadMeshResource(resource, scale, directory.string(), &from_cache));
+  ASSERT_TRUE(cached);
+  EXPECT_TRUE(from_cache);
+  ASSERT_EQ(cached->vertex_count, decoded->vertex_count);
+  ASSERT_EQ(cached->triangle_count, decoded->triangle_count);
+  EXPECT_TRUE(std::equal(decoded->vertices, decoded->vertices + 3 * decoded->vertex_count, cached->vertices));
+  EXPECT_TRUE(std::equal(decoded->triangles, decoded->triangles + 3 * decoded->triangle_count, cached->triangles));
+
+  // a different scale is a different snapshot
+  std::unique_ptr<shapes::Mesh> rescaled(
+      moveit::core::loadMeshResource(resource, Eigen::Vector3d::Ones(), directory.string(), &from_cache));
+  ASSERT_TRUE(rescaled);
+  EXPECT_FALSE(from_cache);
+
+  std::filesystem::remove_all(directory);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
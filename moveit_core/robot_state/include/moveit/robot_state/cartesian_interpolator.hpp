@@ -102,6 +102,15 @@ struct MaxEEFStep
   double rotation;     // Radians
 };
 
+/** \brief Struct with options for computing Cartesian paths with differential IK */
+struct DifferentialIKOptions
+{
+  double tolerance = 1e-5;                    //< max pose error of a waypoint (meters and radians)
+  unsigned int max_corrector_iterations = 3;  //< Jacobian steps refining a predicted waypoint before IK is used
+  double damping = 1e-3;                      //< damping of the least-squares inverse of the Jacobian
+  std::size_t validity_check_interval = 16;   //< number of accepted waypoints after which they are validated
+};
+
 class CartesianInterpolator
 {
   // TODO(mlautman): Eventually, this planner should be moved out of robot_state
@@ -221,6 +230,40 @@ public:
       const kinematics::KinematicsBase::IKCostFn& cost_function = kinematics::KinematicsBase::IKCostFn(),
       const Eigen::Isometry3d& link_offset = Eigen::Isometry3d::Identity());
 
+  /** \brief Compute the sequence of joint values that correspond to a straight Cartesian path, for a particular frame,
+     using differential IK.
+
+     Instead of solving IK from scratch at every step, each waypoint is predicted from the previous one using the
+     Jacobian at that waypoint, and refined by a few corrector steps that reuse the same Jacobian. The kinematics
+     solver is only queried, seeded with the prediction, if the corrector does not converge.
+     The step size adapts to the curvature of the path: a step is halved while the Cartesian deviation at its
+     joint-space midpoint exceeds \e precision, and grows back while the deviation is well below it, bounded by
+     \e max_step.
+     Validity checks are deferred until waypoints are accepted, so rejected trial steps are never checked. Every
+     \e validity_check_interval accepted waypoints, they are passed to \e validCallback one after the other. The path
+     is truncated before the first invalid waypoint.
+
+     Groups for which no Jacobian can be computed fall back to the IK-based version above. This function returns the
+     fraction (0..1) of path that was achieved. */
+  static Percentage computeCartesianPathDiffIK(
+      const RobotState* start_state, const JointModelGroup* group, std::vector<RobotStatePtr>& traj,
+      const LinkModel* link, const Eigen::Isometry3d& target, bool global_reference_frame, const MaxEEFStep& max_step,
+      const CartesianPrecision& precision,
+      const GroupStateValidityCallbackFn& validCallback = GroupStateValidityCallbackFn(),
+      const DifferentialIKOptions& diff_ik_options = DifferentialIKOptions(),
+      const Eigen::Isometry3d& link_offset = Eigen::Isometry3d::Identity());
+
+  /** \brief Compute the sequence of joint values that perform a general Cartesian path using differential IK.
+
+     The waypoints are interpreted as in the IK-based version. All other comments from the previous function apply. */
+  static Percentage computeCartesianPathDiffIK(
+      const RobotState* start_state, const JointModelGroup* group, std::vector<RobotStatePtr>& traj,
+      const LinkModel* link, const EigenSTL::vector_Isometry3d& waypoints, bool global_reference_frame,
+      const MaxEEFStep& max_step, const CartesianPrecision& precision,
+      const GroupStateValidityCallbackFn& validCallback = GroupStateValidityCallbackFn(),
+      const DifferentialIKOptions& diff_ik_options = DifferentialIKOptions(),
+      const Eigen::Isometry3d& link_offset = Eigen::Isometry3d::Identity());
+
   /** \brief Compute the sequence of joint values that correspond to a straight Cartesian path for a particular link.
 
      The Cartesian path to be followed is specified as a \e translation vector to be followed by the robot \e link.
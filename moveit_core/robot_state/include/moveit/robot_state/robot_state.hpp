@@ -44,6 +44,7 @@
 #include <visualization_msgs/msg/marker_array.hpp>
 #include <std_msgs/msg/color_rgba.hpp>
 #include <geometry_msgs/msg/twist.hpp>
+#include <algorithm>
 #include <cassert>
 
 #include <rclcpp/duration.hpp>
@@ -1271,7 +1272,7 @@ public:
       throw Exception("Invalid link");
     }
     assert(checkLinkTransforms());
-    return global_link_transforms_[link->getLinkIndex()];
+    return memory_ ? global_link_transforms_[link->getLinkIndex()] : getIdentityTransform();
   }
 
   /** \brief Get the link transform w.r.t. the root link (model frame) of the RobotModel.
@@ -1303,7 +1304,8 @@ public:
   const Eigen::Isometry3d& getCollisionBodyTransform(const LinkModel* link, std::size_t index) const
   {
     assert(checkCollisionTransforms());
-    return global_collision_body_transforms_[link->getFirstCollisionBodyTransformIndex() + index];
+    return memory_ ? global_collision_body_transforms_[link->getFirstCollisionBodyTransformIndex() + index] :
+                     getIdentityTransform();
   }
 
   const Eigen::Isometry3d& getJointTransform(const std::string& joint_name)
@@ -1321,12 +1323,12 @@ public:
   const Eigen::Isometry3d& getJointTransform(const JointModel* joint) const
   {
     assert(checkJointTransforms(joint));
-    return variable_joint_transforms_[joint->getJointIndex()];
+    return memory_ ? variable_joint_transforms_[joint->getJointIndex()] : getIdentityTransform();
   }
 
   bool dirtyJointTransform(const JointModel* joint) const
   {
-    return dirty_joint_transforms_[joint->getJointIndex()];
+    return !memory_ || dirty_joint_transforms_[joint->getJointIndex()];
   }
 
   bool dirtyLinkTransforms() const
@@ -1672,26 +1674,44 @@ public:
   bool setToIKSolverFrame(Eigen::Isometry3d& pose, const std::string& ik_frame);
 
 private:
+  /** \brief Allocate the block holding the transforms, if it is not allocated yet. All transforms start out dirty. */
   void allocMemory();
+  /** \brief Release the block holding the transforms, which leaves all transforms dirty */
+  void freeMemory();
   void init();
   void copyFrom(const RobotState& other);
 
+  /** \brief Returned by the const transform getters while no transforms are allocated */
+  static const Eigen::Isometry3d& getIdentityTransform();
+
   void markDirtyJointTransforms(const JointModel* joint)
   {
-    dirty_joint_transforms_[joint->getJointIndex()] = 1;
+    if (memory_)
+      dirty_joint_transforms_[joint->getJointIndex()] = 1;
     dirty_link_transforms_ =
         dirty_link_transforms_ == nullptr ? joint : robot_model_->getCommonRoot(dirty_link_transforms_, joint);
   }
 
   void markDirtyJointTransforms(const JointModelGroup* group)
   {
-    for (const JointModel* jm : group->getActiveJointModels())
-      dirty_joint_transforms_[jm->getJointIndex()] = 1;
+    if (memory_)
+    {
+      for (const JointModel* jm : group->getActiveJointModels())
+        dirty_joint_transforms_[jm->getJointIndex()] = 1;
+    }
     dirty_link_transforms_ = dirty_link_transforms_ == nullptr ?
                                  group->getCommonRoot() :
                                  robot_model_->getCommonRoot(dirty_link_transforms_, group->getCommonRoot());
   }
 
+  /** \brief Mark all transforms dirty, e.g. after all variable positions changed */
+  void markDirtyAllTransforms()
+  {
+    if (memory_)
+      std::fill_n(dirty_joint_transforms_, robot_model_->getJointModelCount(), 1);
+    dirty_link_transforms_ = robot_model_->getRootJoint();
+  }
+
   void markVelocity();
   void markAcceleration();
   void markEffort();
@@ -1735,14 +1755,17 @@ private:
   const JointModel* dirty_link_transforms_ = nullptr;
   const JointModel* dirty_collision_body_transforms_ = nullptr;
 
-  // All the following transform variables point into aligned memory.
+  // All the following transform variables point into a single block of aligned memory, memory_.
   // They are updated lazily, based on the flags in dirty_joint_transforms_
-  // resp. the pointers dirty_link_transforms_ and dirty_collision_body_transforms_
-  std::vector<Eigen::Isometry3d> variable_joint_transforms_;  ///< Local transforms of all joints
-  std::vector<Eigen::Isometry3d> global_link_transforms_;  ///< Transforms from model frame to link frame for each link
-  std::vector<Eigen::Isometry3d> global_collision_body_transforms_;  ///< Transforms from model frame to collision
-                                                                     ///< bodies
-  std::vector<unsigned char> dirty_joint_transforms_;
+  // resp. the pointers dirty_link_transforms_ and dirty_collision_body_transforms_.
+  // The block itself is only allocated once transforms are computed, so states that are only used for their
+  // variable values (e.g. trajectory waypoints) stay small and cheap to copy.
+  void* memory_ = nullptr;
+  Eigen::Isometry3d* variable_joint_transforms_ = nullptr;  ///< Local transforms of all joints
+  Eigen::Isometry3d* global_link_transforms_ = nullptr;  ///< Transforms from model frame to link frame for each link
+  Eigen::Isometry3d* global_collision_body_transforms_ = nullptr;  ///< Transforms from model frame to collision
+                                                                   ///< bodies
+  unsigned char* dirty_joint_transforms_ = nullptr;
 
   /** \brief All attached bodies that are part of this state, indexed by their name */
   std::map<std::string, std::unique_ptr<AttachedBody>> attached_body_map_;
@@ -108,6 +108,17 @@ bool validateAndImproveInterval(const RobotState& start_state, const RobotState&
                                     precision, validCallback, options, cost_function, link_offset);
 }
 
+// Pose error of 'actual' w.r.t. 'desired' as a (linear; angular) twist, rotated by 'rotation'
+Eigen::Matrix<double, 6, 1> poseError(const Eigen::Isometry3d& desired, const Eigen::Isometry3d& actual,
+                                      const Eigen::Matrix3d& rotation)
+{
+  const Eigen::AngleAxisd angular_error(desired.linear() * actual.linear().transpose());
+  Eigen::Matrix<double, 6, 1> error;
+  error.head<3>() = rotation * (desired.translation() - actual.translation());
+  error.tail<3>() = rotation * (angular_error.angle() * angular_error.axis());
+  return error;
+}
+
 std::optional<int> hasRelativeJointSpaceJump(const std::vector<moveit::core::RobotStatePtr>& waypoints,
                                              const moveit::core::JointModelGroup& group, double jump_threshold_factor)
 {
@@ -306,6 +317,213 @@ CartesianInterpolator::Percentage CartesianInterpolator::computeCartesianPath(
   return percentage_solved;
 }
 
+CartesianInterpolator::Percentage CartesianInterpolator::computeCartesianPathDiffIK(
+    const RobotState* start_state, const JointModelGroup* group, std::vector<RobotStatePtr>& traj,
+    const LinkModel* link, const Eigen::Isometry3d& target, bool global_reference_frame, const MaxEEFStep& max_step,
+    const CartesianPrecision& precision, const GroupStateValidityCallbackFn& validCallback,
+    const DifferentialIKOptions& diff_ik_options, const Eigen::Isometry3d& link_offset)
+{
+  // check unsanitized inputs for non-isometry
+  ASSERT_ISOMETRY(target)
+  ASSERT_ISOMETRY(link_offset)
+
+  // the predictor needs the Jacobian of the group w.r.t. the link
+  if (!group->isChain() || group->getUpdatedLinkModelsSet().count(link) == 0)
+  {
+    RCLCPP_DEBUG(getLogger(), "Group '%s' is not a chain moving link '%s', solving IK for every waypoint",
+                 group->getName().c_str(), link->getName().c_str());
+    return computeCartesianPath(start_state, group, traj, link, target, global_reference_frame, max_step, precision,
+                                validCallback, kinematics::KinematicsQueryOptions(),
+                                kinematics::KinematicsBase::IKCostFn(), link_offset);
+  }
+
+  RobotState state(*start_state);
+
+  const std::vector<const JointModel*>& cjnt = group->getContinuousJointModels();
+  // make sure that continuous joints wrap
+  for (const JointModel* joint : cjnt)
+    state.enforceBounds(joint);
+  state.updateLinkTransforms();
+
+  // Cartesian pose we start from
+  const Eigen::Isometry3d start_pose = state.getGlobalLinkTransform(link) * link_offset;
+  const Eigen::Isometry3d inv_offset = link_offset.inverse();
+
+  // the target can be in the local reference frame (in which case we rotate it)
+  const Eigen::Isometry3d rotated_target = global_reference_frame ? target : start_pose * target;
+
+  const Eigen::Quaterniond start_quaternion(start_pose.linear());
+  const Eigen::Quaterniond target_quaternion(rotated_target.linear());
+  const auto interpolated_pose = [&](double percentage) {
+    Eigen::Isometry3d pose(start_quaternion.slerp(percentage, target_quaternion));
+    pose.translation() = percentage * rotated_target.translation() + (1 - percentage) * start_pose.translation();
+    return pose;
+  };
+
+  // the largest step (as fraction of the path) that respects max_step
+  const double rotation_distance = start_quaternion.angularDistance(target_quaternion);
+  const double translation_distance = (rotated_target.translation() - start_pose.translation()).norm();
+  std::size_t translation_steps = 0;
+  if (max_step.translation > 0.0)
+    translation_steps = floor(translation_distance / max_step.translation);
+  std::size_t rotation_steps = 0;
+  if (max_step.rotation > 0.0)
+    rotation_steps = floor(rotation_distance / max_step.rotation);
+  const double max_width = 1.0 / static_cast<double>(std::max(translation_steps, rotation_steps) + 1);
+  const double min_width = std::min(max_width, precision.max_resolution);
+
+  // the Jacobian is expressed in the frame of the group's root link, which the group does not move
+  const LinkModel* root_link = group->getJointModels().front()->getParentLinkModel();
+  const Eigen::Matrix3d to_root =
+      root_link ? state.getGlobalLinkTransform(root_link).linear().transpose() : Eigen::Matrix3d::Identity();
+
+  // damped least-squares inverse of the Jacobian at the last waypoint, shared by the predictor and the corrector
+  Eigen::MatrixXd jacobian;
+  Eigen::MatrixXd jacobian_inverse;
+  const auto update_jacobian_inverse = [&](const RobotState& waypoint) {
+    if (!waypoint.getJacobian(group, link, link_offset.translation(), jacobian))
+      return false;
+    Eigen::Matrix<double, 6, 6> jjt = jacobian * jacobian.transpose();
+    jjt.diagonal().array() += diff_ik_options.damping * diff_ik_options.damping;
+    jacobian_inverse = jacobian.transpose() * jjt.ldlt().solve(Eigen::Matrix<double, 6, 6>::Identity());
+    return true;
+  };
+  if (!update_jacobian_inverse(state))
+    return 0.0;
+
+  traj.clear();
+  // start from the local copy, whose continuous joints are wrapped and whose transforms are up to date
+  traj.push_back(std::make_shared<moveit::core::RobotState>(state));
+  std::vector<double> percentages(1, 0.0);
+
+  // validate the waypoints accepted since the last check one by one, truncating the path before the first invalid one
+  std::size_t validated = 1;
+  std::vector<double> group_values;
+  const auto validate_pending = [&] {
+    for (; validCallback && validated < traj.size(); ++validated)
+    {
+      traj[validated]->copyJointGroupPositions(group, group_values);
+      if (!validCallback(traj[validated].get(), group, group_values.data()))
+      {
+        traj.resize(validated);
+        return false;
+      }
+    }
+    return true;
+  };
+
+  const auto within_tolerance = [tolerance = diff_ik_options.tolerance](const Eigen::Matrix<double, 6, 1>& error) {
+    return error.head<3>().norm() <= tolerance && error.tail<3>().norm() <= tolerance;
+  };
+
+  Eigen::VectorXd positions;
+  state.copyJointGroupPositions(group, positions);
+  Eigen::VectorXd trial_positions;
+  RobotState trial_state(state);
+  RobotState mid_state(state);
+  double percentage = 0.0;
+  double width = max_width;
+  while (percentage < 1.0)
+  {
+    const double next_percentage = std::min(1.0, percentage + width);
+    const Eigen::Isometry3d pose = interpolated_pose(next_percentage);
+
+    // predict the waypoint from the Jacobian at the last one, and correct it with the same Jacobian
+    trial_positions = positions;
+    Eigen::Matrix<double, 6, 1> error =
+        poseError(pose, traj.back()->getGlobalLinkTransform(link) * link_offset, to_root);
+    bool solved = false;
+    for (unsigned int i = 0; i <= diff_ik_options.max_corrector_iterations && !solved; ++i)
+    {
+      trial_positions += jacobian_inverse * error;
+      trial_state.setJointGroupPositions(group, trial_positions);
+      trial_state.enforceBounds(group);
+      trial_state.copyJointGroupPositions(group, trial_positions);
+      trial_state.updateLinkTransforms();
+      error = poseError(pose, trial_state.getGlobalLinkTransform(link) * link_offset, to_root);
+      solved = within_tolerance(error);
+    }
+
+    // otherwise solve IK, seeded with the prediction
+    if (!solved)
+    {
+      solved = trial_state.setFromIK(group, pose * inv_offset, link->getName(), 0.0);
+      trial_state.updateLinkTransforms();
+    }
+
+    // compare the pose at the joint-space midpoint of the step with the Cartesian midpoint
+    double linear_distance = std::numeric_limits<double>::infinity();
+    double angular_distance = std::numeric_limits<double>::infinity();
+    if (solved)
+    {
+      traj.back()->interpolate(trial_state, 0.5, mid_state);
+      const Eigen::Isometry3d fk_pose = mid_state.getGlobalLinkTransform(link) * link_offset;
+      const Eigen::Isometry3d mid_pose = interpolated_pose(0.5 * (percentage + next_percentage));
+      linear_distance = (mid_pose.translation() - fk_pose.translation()).norm();
+      angular_distance = Eigen::Quaterniond(mid_pose.linear()).angularDistance(Eigen::Quaterniond(fk_pose.linear()));
+    }
+
+    if (linear_distance > precision.translational || angular_distance > precision.rotational)
+    {
+      if (width <= min_width)
+        break;  // failed to find linear interpolation within max_resolution
+      width = std::max(min_width, 0.5 * width);
+      continue;
+    }
+
+    trial_state.copyJointGroupPositions(group, positions);
+    traj.push_back(std::make_shared<moveit::core::RobotState>(trial_state));
+    percentages.push_back(next_percentage);
+    percentage = next_percentage;
+
+    if (traj.size() - validated >= diff_ik_options.validity_check_interval && !validate_pending())
+      break;
+    if (!update_jacobian_inverse(*traj.back()))
+      break;
+
+    // grow the step again where the path is nearly linear in joint space
+    if (linear_distance < 0.25 * precision.translational && angular_distance < 0.25 * precision.rotational)
+      width = std::min(max_width, 2.0 * width);
+  }
+
+  validate_pending();
+  return percentages[traj.size() - 1];
+}
+
+CartesianInterpolator::Percentage CartesianInterpolator::computeCartesianPathDiffIK(
+    const RobotState* start_state, const JointModelGroup* group, std::vector<RobotStatePtr>& traj,
+    const LinkModel* link, const EigenSTL::vector_Isometry3d& waypoints, bool global_reference_frame,
+    const MaxEEFStep& max_step, const CartesianPrecision& precision, const GroupStateValidityCallbackFn& validCallback,
+    const DifferentialIKOptions& diff_ik_options, const Eigen::Isometry3d& link_offset)
+{
+  double percentage_solved = 0.0;
+  for (std::size_t i = 0; i < waypoints.size(); ++i)
+  {
+    std::vector<RobotStatePtr> waypoint_traj;
+    double wp_percentage_solved =
+        computeCartesianPathDiffIK(start_state, group, waypoint_traj, link, waypoints[i], global_reference_frame,
+                                   max_step, precision, validCallback, diff_ik_options, link_offset);
+
+    std::vector<RobotStatePtr>::iterator start = waypoint_traj.begin();
+    if (i > 0 && !waypoint_traj.empty())
+      std::advance(start, 1);
+    traj.insert(traj.end(), start, waypoint_traj.end());
+
+    if (fabs(wp_percentage_solved - 1.0) < std::numeric_limits<double>::epsilon())
+    {
+      percentage_solved = static_cast<double>(i + 1) / static_cast<double>(waypoints.size());
+    }
+    else
+    {
+      percentage_solved += wp_percentage_solved / static_cast<double>(waypoints.size());
+      break;
+    }
+    start_state = traj.back().get();
+  }
+
+  return percentage_solved;
+}
+
 JumpThreshold JumpThreshold::disabled()
 {
   return JumpThreshold();
@@ -47,6 +47,7 @@
 #include <tf2_eigen/tf2_eigen.hpp>
 #include <cassert>
 #include <functional>
+#include <new>
 #include <moveit/macros/console_colors.hpp>
 #include <moveit/robot_model/aabb.hpp>
 #include <moveit/utils/logger.hpp>
@@ -61,6 +62,66 @@ rclcpp::Logger getLogger()
 {
   return moveit::getLogger("moveit.core.robot_state");
 }
+
+/** \brief Per-thread free list of transform blocks. States are created and destroyed at high rates by planners and
+ *  trajectory processing, and all states of a robot model use blocks of the same size, so blocks of destroyed states
+ *  are kept for reuse instead of being returned to the heap. */
+class TransformBlockPool
+{
+public:
+  static constexpr std::align_val_t ALIGNMENT{ alignof(Eigen::Isometry3d) };
+
+  ~TransformBlockPool()
+  {
+    destroyed = true;
+    for (const std::pair<std::size_t, void*>& block : blocks_)
+      ::operator delete(block.second, ALIGNMENT);
+  }
+
+  void* allocate(std::size_t size)
+  {
+    for (auto it = blocks_.rbegin(); it != blocks_.rend(); ++it)
+    {
+      if (it->first == size)
+      {
+        void* block = it->second;
+        blocks_.erase(std::next(it).base());
+        return block;
+      }
+    }
+    return ::operator new(size, ALIGNMENT);
+  }
+
+  void release(void* block, std::size_t size)
+  {
+    if (blocks_.size() < MAX_BLOCKS)
+      blocks_.emplace_back(size, block);
+    else
+      ::operator delete(block, ALIGNMENT);
+  }
+
+  /** \brief True once the pool of this thread has been destroyed during thread or program exit */
+  static thread_local bool destroyed;
+
+private:
+  static constexpr std::size_t MAX_BLOCKS = 64;
+  std::vector<std::pair<std::size_t, void*>> blocks_;
+};
+
+thread_local bool TransformBlockPool::destroyed = false;
+
+TransformBlockPool& getTransformBlockPool()
+{
+  static thread_local TransformBlockPool pool;
+  return pool;
+}
+
+std::size_t getTransformBlockSize(const RobotModel& model)
+{
+  return (model.getJointModelCount() + model.getLinkModelCount() + model.getLinkGeometryCount()) *
+             sizeof(Eigen::Isometry3d) +
+         model.getJointModelCount() * sizeof(unsigned char);
+}
 }  // namespace
 
 RobotState::RobotState(const RobotModelConstPtr& robot_model)
@@ -90,14 +151,12 @@ RobotState::RobotState(const RobotState& other) : rng_(nullptr)
 RobotState::~RobotState()
 {
   clearAttachedBodies();
+  freeMemory();
 }
 
 void RobotState::init()
 {
-  variable_joint_transforms_.resize(robot_model_->getJointModelCount(), Eigen::Isometry3d::Identity());
-  global_link_transforms_.resize(robot_model_->getLinkModelCount(), Eigen::Isometry3d::Identity());
-  global_collision_body_transforms_.resize(robot_model_->getLinkGeometryCount(), Eigen::Isometry3d::Identity());
-  dirty_joint_transforms_.resize(robot_model_->getJointModelCount(), 1);
+  // transforms are allocated by allocMemory() once they are needed
   position_.resize(robot_model_->getVariableCount());
   velocity_.resize(robot_model_->getVariableCount());
   effort_or_acceleration_.resize(robot_model_->getVariableCount());
@@ -110,19 +169,70 @@ RobotState& RobotState::operator=(const RobotState& other)
   return *this;
 }
 
+void RobotState::allocMemory()
+{
+  if (memory_)
+    return;
+
+  const std::size_t joint_count = robot_model_->getJointModelCount();
+  const std::size_t link_count = robot_model_->getLinkModelCount();
+  const std::size_t geometry_count = robot_model_->getLinkGeometryCount();
+  memory_ = getTransformBlockPool().allocate(getTransformBlockSize(*robot_model_));
+  variable_joint_transforms_ = static_cast<Eigen::Isometry3d*>(memory_);
+  global_link_transforms_ = variable_joint_transforms_ + joint_count;
+  global_collision_body_transforms_ = global_link_transforms_ + link_count;
+  dirty_joint_transforms_ = reinterpret_cast<unsigned char*>(global_collision_body_transforms_ + geometry_count);
+
+  std::uninitialized_fill_n(variable_joint_transforms_, joint_count + link_count + geometry_count,
+                            Eigen::Isometry3d::Identity());
+  std::fill_n(dirty_joint_transforms_, joint_count, 1);
+  dirty_link_transforms_ = robot_model_->getRootJoint();
+}
+
+void RobotState::freeMemory()
+{
+  if (!memory_)
+    return;
+
+  // blocks released during thread teardown go straight back to the heap
+  if (!TransformBlockPool::destroyed)
+    getTransformBlockPool().release(memory_, getTransformBlockSize(*robot_model_));
+  else
+    ::operator delete(memory_, TransformBlockPool::ALIGNMENT);
+  memory_ = nullptr;
+  variable_joint_transforms_ = nullptr;
+  global_link_transforms_ = nullptr;
+  global_collision_body_transforms_ = nullptr;
+  dirty_joint_transforms_ = nullptr;
+  dirty_link_transforms_ = robot_model_->getRootJoint();
+  dirty_collision_body_transforms_ = nullptr;
+}
+
+const Eigen::Isometry3d& RobotState::getIdentityTransform()
+{
+  static const Eigen::Isometry3d IDENTITY = Eigen::Isometry3d::Identity();
+  return IDENTITY;
+}
+
 void RobotState::copyFrom(const RobotState& other)
 {
   has_velocity_ = other.has_velocity_;
   has_acceleration_ = other.has_acceleration_;
   has_effort_ = other.has_effort_;
 
+  // a single copy of the whole transform block; Eigen transforms are plain arrays of doubles
+  if (other.memory_)
+  {
+    allocMemory();
+    memcpy(memory_, other.memory_, getTransformBlockSize(*robot_model_));
+  }
+  else
+  {
+    freeMemory();
+  }
   dirty_collision_body_transforms_ = other.dirty_collision_body_transforms_;
   dirty_link_transforms_ = other.dirty_link_transforms_;
 
-  variable_joint_transforms_ = other.variable_joint_transforms_;
-  global_link_transforms_ = other.global_link_transforms_;
-  global_collision_body_transforms_ = other.global_collision_body_transforms_;
-  dirty_joint_transforms_ = other.dirty_joint_transforms_;
   position_ = other.position_;
   velocity_ = other.velocity_;
   effort_or_acceleration_ = other.effort_or_acceleration_;
@@ -263,8 +373,7 @@ void RobotState::setToRandomPositions()
 {
   random_numbers::RandomNumberGenerator& rng = getRandomNumberGenerator();
   robot_model_->getVariableRandomPositions(rng, position_);
-  std::fill(dirty_joint_transforms_.begin(), dirty_joint_transforms_.end(), 1);
-  dirty_link_transforms_ = robot_model_->getRootJoint();
+  markDirtyAllTransforms();
   // mimic values are correctly set in RobotModel
 }
 
@@ -342,8 +451,7 @@ void RobotState::setToDefaultValues()
   // set velocity & acceleration to 0
   std::fill(velocity_.begin(), velocity_.end(), 0);
   std::fill(effort_or_acceleration_.begin(), effort_or_acceleration_.end(), 0);
-  std::fill(dirty_joint_transforms_.begin(), dirty_joint_transforms_.end(), 1);
-  dirty_link_transforms_ = robot_model_->getRootJoint();
+  markDirtyAllTransforms();
 }
 
 void RobotState::setVariablePositions(const double* position)
@@ -354,8 +462,7 @@ void RobotState::setVariablePositions(const double* position)
   // the full state includes mimic joint values, so no need to update mimic here
 
   // Since all joint values have potentially changed, we will need to recompute all transforms
-  std::fill(dirty_joint_transforms_.begin(), dirty_joint_transforms_.end(), 1);
-  dirty_link_transforms_ = robot_model_->getRootJoint();
+  markDirtyAllTransforms();
 }
 
 void RobotState::setVariablePositions(const std::map<std::string, double>& variable_map)
@@ -731,10 +838,7 @@ void RobotState::update(bool force)
 {
   // make sure we do everything from scratch if needed
   if (force)
-  {
-    std::fill(dirty_joint_transforms_.begin(), dirty_joint_transforms_.end(), 1);
-    dirty_link_transforms_ = robot_model_->getRootJoint();
-  }
+    markDirtyAllTransforms();
 
   // this actually triggers all needed updates
   updateCollisionBodyTransforms();
@@ -776,6 +880,7 @@ void RobotState::updateLinkTransforms()
 {
   if (dirty_link_transforms_ != nullptr)
   {
+    allocMemory();
     updateLinkTransformsInternal(dirty_link_transforms_);
     if (dirty_collision_body_transforms_)
     {
@@ -946,6 +1051,8 @@ const LinkModel* RobotState::getRigidlyConnectedParentLinkModel(const std::strin
 
 const Eigen::Isometry3d& RobotState::getJointTransform(const JointModel* joint)
 {
+  if (!memory_)
+    allocMemory();
   const int idx = joint->getJointIndex();
   if (joint->getVariableCount() == 0)
   {
@@ -1140,8 +1247,7 @@ void RobotState::interpolate(const RobotState& to, double t, RobotState& state)
   checkInterpolationParamBounds(getLogger(), t);
   robot_model_->interpolate(getVariablePositions(), to.getVariablePositions(), t, state.getVariablePositions());
 
-  std::fill(state.dirty_joint_transforms_.begin(), state.dirty_joint_transforms_.end(), 1);
-  state.dirty_link_transforms_ = state.robot_model_->getRootJoint();
+  state.markDirtyAllTransforms();
 }
 
 void RobotState::interpolate(const RobotState& to, double t, RobotState& state, const JointModelGroup* joint_group) const
@@ -1350,8 +1456,7 @@ const Eigen::Isometry3d& RobotState::getFrameInfo(const std::string& frame_id, c
   }
   if ((robot_link = robot_model_->getLinkModel(frame_id, &frame_found)))
   {
-    assert(checkLinkTransforms());
-    return global_link_transforms_[robot_link->getLinkIndex()];
+    return getGlobalLinkTransform(robot_link);
   }
   robot_link = nullptr;
 
@@ -1472,8 +1577,7 @@ void RobotState::getRobotMarkers(visualization_msgs::msg::MarkerArray& arr, cons
         // if the object is invisible (0 volume) we skip it
         if (fabs(mark.scale.x * mark.scale.y * mark.scale.z) < std::numeric_limits<double>::epsilon())
           continue;
-        mark.pose =
-            tf2::toMsg(global_collision_body_transforms_[link_model->getFirstCollisionBodyTransformIndex() + j]);
+        mark.pose = tf2::toMsg(getCollisionBodyTransform(link_model, j));
       }
       else
       {
@@ -1485,7 +1589,7 @@ void RobotState::getRobotMarkers(visualization_msgs::msg::MarkerArray& arr, cons
         mark.scale.x = mesh_scale[0];
         mark.scale.y = mesh_scale[1];
         mark.scale.z = mesh_scale[2];
-        mark.pose = tf2::toMsg(global_link_transforms_[link_model->getLinkIndex()] * link_model->getVisualMeshOrigin());
+        mark.pose = tf2::toMsg(getGlobalLinkTransform(link_model) * link_model->getVisualMeshOrigin());
       }
 
       arr.markers.push_back(mark);
@@ -2424,7 +2528,7 @@ void RobotState::printTransform(const Eigen::Isometry3d& transform, std::ostream
 
 void RobotState::printTransforms(std::ostream& out) const
 {
-  if (variable_joint_transforms_.empty())
+  if (!memory_)
   {
     out << "No transforms computed\n";
     return;
@@ -2495,7 +2599,7 @@ void RobotState::getStateTreeJointString(std::ostream& ss, const JointModel* jm,
 
   ss << pfx << "Link: " << link_model->getName() << '\n';
   getPoseString(ss, link_model->getJointOriginTransform(), pfx + "joint_origin:");
-  if (!variable_joint_transforms_.empty())
+  if (memory_)
   {
     getPoseString(ss, variable_joint_transforms_[jm->getJointIndex()], pfx + "joint_variable:");
     getPoseString(ss, global_link_transforms_[link_model->getLinkIndex()], pfx + "link_global:");
@@ -38,6 +38,10 @@
 // To run this benchmark, 'cd' to the build/moveit_core/robot_state directory and directly run the binary.
 
 #include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
 #include <random>
 #include <kdl_parser/kdl_parser.hpp>
 #include <kdl/treejnttojacsolver.hpp>
@@ -51,6 +55,22 @@ constexpr char PANDA_TEST_GROUP[] = "panda_arm";
 
 namespace
 {
+// Heap allocations of the calling thread, counted by the replaced global allocation functions below.
+thread_local std::size_t heap_allocations = 0;
+thread_local std::size_t heap_bytes = 0;
+
+void* countedAllocation(std::size_t size, std::size_t alignment)
+{
+  ++heap_allocations;
+  heap_bytes += size;
+  // aligned_alloc requires the size to be a multiple of the alignment
+  alignment = std::max(alignment, alignof(std::max_align_t));
+  const std::size_t aligned_size = (std::max<std::size_t>(size, 1) + alignment - 1) / alignment * alignment;
+  if (void* ptr = std::aligned_alloc(alignment, aligned_size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
 Eigen::Isometry3d createTestIsometry()
 {
   // An arbitrary Eigen::Isometry3d object.
@@ -60,6 +80,36 @@ Eigen::Isometry3d createTestIsometry()
 }
 }  // namespace
 
+void* operator new(std::size_t size)
+{
+  return countedAllocation(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+  return countedAllocation(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /* size */) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t /* alignment */) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /* size */, std::align_val_t /* alignment */) noexcept
+{
+  std::free(ptr);
+}
+
 // Benchmark time to multiply an Eigen::Affine3d with an Eigen::Matrix4d.
 // The NoAlias versions just use Eigen's .noalias() modifier, allowing to write the result of matrix multiplication
 // directly into the result matrix instead of using an intermediate temporary (which is the default).
@@ -233,6 +283,71 @@ BENCHMARK_DEFINE_F(RobotStateBenchmark, copyConstruct)(benchmark::State& st)
   }
 }
 
+// Benchmark time to copy-construct a RobotState that holds positions only; its transforms are not allocated yet.
+BENCHMARK_DEFINE_F(RobotStateBenchmark, copyConstructPositionsOnly)(benchmark::State& st)
+{
+  moveit::core::RobotState state(robot_model);
+  state.setToDefaultValues();
+
+  for (auto _ : st)
+  {
+    auto states = constructStates(st.range(0), state);
+    benchmark::DoNotOptimize(states);
+    benchmark::ClobberMemory();
+  }
+}
+
+// Measure the heap memory allocated per RobotState copy, with and without computed transforms, including the storage of
+// the RobotState objects themselves. Also measure the allocations of a copy while the transform block pool holds a
+// released block.
+BENCHMARK_DEFINE_F(RobotStateBenchmark, memoryFootprint)(benchmark::State& st)
+{
+  // more states than the transform block pool keeps
+  constexpr size_t POOL_DRAIN_STATES = 100;
+  const size_t num = st.range(0);
+
+  moveit::core::RobotState positions_only(robot_model);
+  positions_only.setToDefaultValues();
+  moveit::core::RobotState with_transforms(positions_only);
+  with_transforms.update();
+
+  std::size_t positions_only_allocations = 0, positions_only_bytes = 0;
+  std::size_t with_transforms_allocations = 0, with_transforms_bytes = 0;
+  std::size_t pooled_copy_allocations = 0;
+  for (auto _ : st)
+  {
+    // take all blocks out of the pool, so that every measured copy allocates its own
+    auto pool_drain = constructStates(POOL_DRAIN_STATES, with_transforms);
+    {
+      const std::size_t allocations = heap_allocations, bytes = heap_bytes;
+      auto states = constructStates(num, positions_only);
+      positions_only_allocations = heap_allocations - allocations;
+      positions_only_bytes = heap_bytes - bytes;
+      benchmark::DoNotOptimize(states);
+    }
+    {
+      const std::size_t allocations = heap_allocations, bytes = heap_bytes;
+      auto states = constructStates(num, with_transforms);
+      with_transforms_allocations = heap_allocations - allocations;
+      with_transforms_bytes = heap_bytes - bytes;
+      benchmark::DoNotOptimize(states);
+    }
+    {
+      // the states destroyed above released their blocks to the pool
+      const std::size_t allocations = heap_allocations;
+      moveit::core::RobotState copy(with_transforms);
+      pooled_copy_allocations = heap_allocations - allocations;
+      benchmark::DoNotOptimize(copy);
+    }
+  }
+
+  st.counters["positions_only_bytes"] = static_cast<double>(positions_only_bytes) / num;
+  st.counters["positions_only_allocations"] = static_cast<double>(positions_only_allocations) / num;
+  st.counters["with_transforms_bytes"] = static_cast<double>(with_transforms_bytes) / num;
+  st.counters["with_transforms_allocations"] = static_cast<double>(with_transforms_allocations) / num;
+  st.counters["pooled_copy_allocations"] = static_cast<double>(pooled_copy_allocations);
+}
+
 // Benchmark time to call `setToRandomPositions` and `update` on RobotState.
 BENCHMARK_DEFINE_F(RobotStateBenchmark, update)(benchmark::State& st)
 {
@@ -328,6 +443,11 @@ BENCHMARK_REGISTER_F(RobotStateBenchmark, copyConstruct)
     ->RangeMultiplier(10)
     ->Range(100, 10000)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(RobotStateBenchmark, copyConstructPositionsOnly)
+    ->RangeMultiplier(10)
+    ->Range(100, 10000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(RobotStateBenchmark, memoryFootprint)->Arg(1000)->Unit(benchmark::kMillisecond);
 BENCHMARK_REGISTER_F(RobotStateBenchmark, update)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMillisecond);
 
 BENCHMARK_REGISTER_F(RobotStateBenchmark, jacobianMoveIt);
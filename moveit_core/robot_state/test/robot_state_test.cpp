@@ -1251,6 +1251,137 @@ TEST(getJointPositions, getFixedJointValue)
   ASSERT_EQ(joint_value, nullptr);
 }
 
+// The transforms of a state are only allocated once they are computed
+class TransformMemory : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    robot_model_ = moveit::core::loadTestingRobotModel("panda");
+    link_ = robot_model_->getLinkModel("panda_link8");
+    ASSERT_TRUE(link_);
+  }
+
+  moveit::core::RobotState createState(bool with_transforms) const
+  {
+    moveit::core::RobotState state(robot_model_);
+    state.setToDefaultValues();
+    state.setVariablePosition("panda_joint2", 0.3);
+    if (with_transforms)
+      state.update();
+    return state;
+  }
+
+  static bool hasTransforms(const moveit::core::RobotState& state)
+  {
+    std::stringstream ss;
+    state.printTransforms(ss);
+    return ss.str() != "No transforms computed\n";
+  }
+
+  moveit::core::RobotModelPtr robot_model_;
+  const moveit::core::LinkModel* link_;
+};
+
+TEST_F(TransformMemory, CopyUnallocated)
+{
+  const moveit::core::RobotState reference = createState(true);
+  const moveit::core::RobotState state = createState(false);
+  EXPECT_FALSE(hasTransforms(state));
+
+  moveit::core::RobotState copy(state);
+  EXPECT_FALSE(hasTransforms(copy));
+  EXPECT_TRUE(copy.dirtyLinkTransforms());
+  EXPECT_EQ(copy.getVariablePosition("panda_joint2"), 0.3);
+
+  copy.update();
+  EXPECT_TRUE(hasTransforms(copy));
+  EXPECT_TRUE(copy.getGlobalLinkTransform(link_).isApprox(reference.getGlobalLinkTransform(link_)));
+}
+
+TEST_F(TransformMemory, CopyAllocated)
+{
+  const moveit::core::RobotState state = createState(true);
+
+  const moveit::core::RobotState copy(state);
+  EXPECT_TRUE(hasTransforms(copy));
+  EXPECT_FALSE(copy.dirty());
+  EXPECT_TRUE(copy.getGlobalLinkTransform(link_).isApprox(state.getGlobalLinkTransform(link_)));
+  for (const moveit::core::LinkModel* link : robot_model_->getLinkModelsWithCollisionGeometry())
+  {
+    EXPECT_TRUE(copy.getCollisionBodyTransform(link, 0).isApprox(state.getCollisionBodyTransform(link, 0)))
+        << link->getName();
+  }
+  // the copy owns its transforms
+  EXPECT_NE(&copy.getGlobalLinkTransform(link_), &state.getGlobalLinkTransform(link_));
+}
+
+TEST_F(TransformMemory, AssignAllocatedToUnallocated)
+{
+  const moveit::core::RobotState state = createState(true);
+  moveit::core::RobotState target(robot_model_);
+  target.setToDefaultValues();
+  ASSERT_FALSE(hasTransforms(target));
+
+  target = state;
+  EXPECT_TRUE(hasTransforms(target));
+  EXPECT_FALSE(target.dirty());
+  EXPECT_TRUE(target.getGlobalLinkTransform(link_).isApprox(state.getGlobalLinkTransform(link_)));
+}
+
+TEST_F(TransformMemory, AssignUnallocatedToAllocated)
+{
+  const moveit::core::RobotState reference = createState(true);
+  moveit::core::RobotState target(robot_model_);
+  target.setToDefaultValues();
+  target.update();
+  ASSERT_TRUE(hasTransforms(target));
+
+  target = createState(false);
+  EXPECT_FALSE(hasTransforms(target));
+  EXPECT_TRUE(target.dirtyLinkTransforms());
+  EXPECT_EQ(target.getVariablePosition("panda_joint2"), 0.3);
+
+  // the transforms are recomputed for the assigned positions
+  target.update();
+  EXPECT_TRUE(target.getGlobalLinkTransform(link_).isApprox(reference.getGlobalLinkTransform(link_)));
+}
+
+TEST_F(TransformMemory, ConstGettersDoNotAllocate)
+{
+#ifndef NDEBUG
+  GTEST_SKIP() << "Getting dirty transforms asserts in debug builds";
+#endif
+  const moveit::core::RobotState state = createState(false);
+  const Eigen::Isometry3d identity = Eigen::Isometry3d::Identity();
+  EXPECT_TRUE(state.getGlobalLinkTransform(link_).isApprox(identity));
+  EXPECT_TRUE(state.getJointTransform(robot_model_->getJointModel("panda_joint2")).isApprox(identity));
+  EXPECT_TRUE(state.getCollisionBodyTransform(link_->getParentLinkModel(), 0).isApprox(identity));
+  EXPECT_FALSE(hasTransforms(state));
+}
+
+TEST_F(TransformMemory, ReusesReleasedBlocks)
+{
+  const Eigen::Isometry3d* released;
+  {
+    const moveit::core::RobotState state = createState(true);
+    released = &state.getGlobalLinkTransform(link_);
+  }
+
+  // the next state of the same model gets the block of the destroyed one, with correctly initialized transforms
+  moveit::core::RobotState state = createState(false);
+  state.setVariablePosition("panda_joint1", 0.5);
+  state.update();
+  EXPECT_EQ(&state.getGlobalLinkTransform(link_), released);
+
+  moveit::core::RobotState reference(robot_model_);
+  reference.setToDefaultValues();
+  reference.setVariablePosition("panda_joint2", 0.3);
+  reference.setVariablePosition("panda_joint1", 0.5);
+  reference.update();
+  EXPECT_TRUE(state.getGlobalLinkTransform(link_).isApprox(reference.getGlobalLinkTransform(link_)));
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
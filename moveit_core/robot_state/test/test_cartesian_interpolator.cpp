@@ -198,6 +198,108 @@ TEST_F(SimpleRobot, checkRelativeJointSpaceJump)
   EXPECT_ANY_THROW(CartesianInterpolator::checkJointSpaceJump(joint_model_group, traj, JumpThreshold::relative(0.0)));
 }
 
+// Differential IK converges without a kinematics plugin for short, smooth paths
+class PandaRobotDiffIK : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    robot_model_ = loadTestingRobotModel("panda");
+    jmg_ = robot_model_->getJointModelGroup("panda_arm");
+    link_ = robot_model_->getLinkModel("panda_link8");
+    ASSERT_TRUE(link_);
+    start_state_ = std::make_shared<RobotState>(robot_model_);
+    ASSERT_TRUE(start_state_->setToDefaultValues(jmg_, "ready"));
+    start_state_->update();
+    start_pose_ = start_state_->getGlobalLinkTransform(link_);
+  }
+
+  RobotModelPtr robot_model_;
+  const JointModelGroup* jmg_;
+  const LinkModel* link_;
+  RobotStatePtr start_state_;
+  Eigen::Isometry3d start_pose_;
+  std::vector<std::shared_ptr<RobotState>> result_;
+};
+
+TEST_F(PandaRobotDiffIK, testTranslationGlobal)
+{
+  Eigen::Isometry3d goal = start_pose_;
+  goal.translation().x() += 0.1;
+
+  EXPECT_DOUBLE_EQ(CartesianInterpolator::computeCartesianPathDiffIK(start_state_.get(), jmg_, result_, link_, goal,
+                                                                     true, MaxEEFStep(0.01), CartesianPrecision{}),
+                   1.0);
+  ASSERT_GE(result_.size(), 11u);
+  EXPECT_EIGEN_EQ(result_.front()->getGlobalLinkTransform(link_), start_pose_);
+  EXPECT_EIGEN_NEAR(result_.back()->getGlobalLinkTransform(link_), goal, 1e-4);
+
+  // all waypoints stay on the line
+  for (const auto& waypoint : result_)
+  {
+    const Eigen::Vector3d position = waypoint->getGlobalLinkTransform(link_).translation();
+    EXPECT_NEAR(position.y(), start_pose_.translation().y(), 1e-3);
+    EXPECT_NEAR(position.z(), start_pose_.translation().z(), 1e-3);
+  }
+}
+
+// The start state is not required to have up-to-date transforms
+TEST_F(PandaRobotDiffIK, testStartStateNotUpdated)
+{
+  RobotState start_state(robot_model_);
+  ASSERT_TRUE(start_state.setToDefaultValues(jmg_, "ready"));
+  ASSERT_TRUE(start_state.dirtyLinkTransforms());
+  Eigen::Isometry3d goal = start_pose_;
+  goal.translation().x() += 0.1;
+
+  EXPECT_DOUBLE_EQ(CartesianInterpolator::computeCartesianPathDiffIK(&start_state, jmg_, result_, link_, goal, true,
+                                                                     MaxEEFStep(0.01), CartesianPrecision{}),
+                   1.0);
+  ASSERT_FALSE(result_.empty());
+  EXPECT_FALSE(result_.front()->dirtyLinkTransforms());
+  EXPECT_EIGEN_EQ(result_.front()->getGlobalLinkTransform(link_), start_pose_);
+  EXPECT_EIGEN_NEAR(result_.back()->getGlobalLinkTransform(link_), goal, 1e-4);
+  for (const auto& waypoint : result_)
+  {
+    const Eigen::Vector3d position = waypoint->getGlobalLinkTransform(link_).translation();
+    EXPECT_NEAR(position.y(), start_pose_.translation().y(), 1e-3);
+    EXPECT_NEAR(position.z(), start_pose_.translation().z(), 1e-3);
+  }
+}
+
+TEST_F(PandaRobotDiffIK, testRotationLocal)
+{
+  Eigen::Isometry3d rot(Eigen::AngleAxisd(M_PI / 8, Eigen::Vector3d::UnitZ()));
+
+  EXPECT_DOUBLE_EQ(CartesianInterpolator::computeCartesianPathDiffIK(start_state_.get(), jmg_, result_, link_, rot,
+                                                                     false, MaxEEFStep(0.01), CartesianPrecision{}),
+                   1.0);
+  EXPECT_EIGEN_NEAR(result_.back()->getGlobalLinkTransform(link_), start_pose_ * rot, 1e-4);
+}
+
+TEST_F(PandaRobotDiffIK, testValidityCallbackTruncates)
+{
+  Eigen::Isometry3d goal = start_pose_;
+  goal.translation().x() += 0.1;
+  const double max_x = start_pose_.translation().x() + 0.055;
+  std::size_t checked = 0;
+  const GroupStateValidityCallbackFn valid = [&](RobotState* state, const JointModelGroup* group,
+                                                 const double* values) {
+    ++checked;
+    state->setJointGroupPositions(group, values);
+    return state->getGlobalLinkTransform(link_).translation().x() <= max_x;
+  };
+
+  DifferentialIKOptions options;
+  options.validity_check_interval = 4;
+  const double fraction = CartesianInterpolator::computeCartesianPathDiffIK(
+      start_state_.get(), jmg_, result_, link_, goal, true, MaxEEFStep(0.01), CartesianPrecision{}, valid, options);
+  EXPECT_NEAR(fraction, 0.5, 0.1);
+  EXPECT_GE(checked, result_.size());
+  for (const auto& waypoint : result_)
+    EXPECT_LE(waypoint->getGlobalLinkTransform(link_).translation().x(), max_x);
+}
+
 // TODO - The tests below fail since no kinematic plugins are found. Move the tests to IK plugin package.
 // class PandaRobot : public testing::Test
 // {
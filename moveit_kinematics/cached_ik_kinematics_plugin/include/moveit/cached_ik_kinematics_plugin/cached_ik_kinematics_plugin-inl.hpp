@@ -36,6 +36,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>
 
@@ -51,16 +52,36 @@ CachedIKKinematicsPlugin<KinematicsPlugin>::~CachedIKKinematicsPlugin()
 {
 }
 
+template <class KinematicsPlugin>
+void CachedIKKinematicsPlugin<KinematicsPlugin>::loadParams(const rclcpp::Node::SharedPtr& node,
+                                                            const std::string& group_name)
+{
+  node_ = node;
+
+  std::string kinematics_param_prefix = "robot_description_kinematics." + group_name;
+  param_listener_ = std::make_shared<cached_ik_kinematics::ParamListener>(node, kinematics_param_prefix);
+  params_ = param_listener_->get_params();
+}
+
 template <class KinematicsPlugin>
 void CachedIKKinematicsPlugin<KinematicsPlugin>::initCache(const std::string& robot_id, const std::string& group_name,
-                                                           const std::string& cache_name)
+                                                           const std::string& cache_name,
+                                                           const std::string& legacy_cache_name)
 {
   IKCache::Options opts;
+  opts.legacy_cache_name = legacy_cache_name;
   opts.max_cache_size = params_.max_cache_size;
   opts.min_pose_distance = params_.min_pose_distance;
   opts.min_joint_config_distance = params_.min_joint_config_distance;
   opts.cached_ik_path = params_.cached_ik_path;
 
+  if (params_.concurrent_cache)
+  {
+    concurrent_cache_ = std::make_unique<ConcurrentIKCache>();
+    concurrent_cache_->initializeCache(robot_id, group_name, cache_name, KinematicsPlugin::getJointNames().size(),
+                                       opts);
+    return;
+  }
   cache_.initializeCache(robot_id, group_name, cache_name, KinematicsPlugin::getJointNames().size(), opts);
 
   // for debugging purposes:
@@ -69,19 +90,58 @@ void CachedIKKinematicsPlugin<KinematicsPlugin>::initCache(const std::string& ro
   // cache_.verifyCache(fk);
 }
 
+template <class KinematicsPlugin>
+typename CachedIKKinematicsPlugin<KinematicsPlugin>::IKEntry
+CachedIKKinematicsPlugin<KinematicsPlugin>::getBestApproximateIKSolution(const Pose& pose) const
+{
+  if (concurrent_cache_)
+    return concurrent_cache_->getBestApproximateIKSolution(pose);
+  return cache_.getBestApproximateIKSolution(pose);
+}
+
+template <class KinematicsPlugin>
+typename CachedIKKinematicsPlugin<KinematicsPlugin>::IKEntry
+CachedIKKinematicsPlugin<KinematicsPlugin>::getBestApproximateIKSolution(const std::vector<Pose>& poses) const
+{
+  if (concurrent_cache_)
+    return concurrent_cache_->getBestApproximateIKSolution(poses);
+  return cache_.getBestApproximateIKSolution(poses);
+}
+
+template <class KinematicsPlugin>
+void CachedIKKinematicsPlugin<KinematicsPlugin>::updateCache(const IKEntry& nearest, const Pose& pose,
+                                                             const std::vector<double>& config) const
+{
+  if (concurrent_cache_)
+    concurrent_cache_->updateCache(nearest, pose, config);
+  else
+    cache_.updateCache(nearest, pose, config);
+}
+
+template <class KinematicsPlugin>
+void CachedIKKinematicsPlugin<KinematicsPlugin>::updateCache(const IKEntry& nearest, const std::vector<Pose>& poses,
+                                                             const std::vector<double>& config) const
+{
+  if (concurrent_cache_)
+    concurrent_cache_->updateCache(nearest, poses, config);
+  else
+    cache_.updateCache(nearest, poses, config);
+}
+
 template <class KinematicsPlugin>
 bool CachedMultiTipIKKinematicsPlugin<KinematicsPlugin>::initialize(
     const rclcpp::Node::SharedPtr& node, const moveit::core::RobotModel& robot_model, const std::string& group_name,
     const std::string& base_frame, const std::vector<std::string>& tip_frames, double search_discretization)
 {
+  CachedIKKinematicsPlugin<KinematicsPlugin>::loadParams(node, group_name);
+
   // call initialize method of wrapped class
   if (!KinematicsPlugin::initialize(node, robot_model, group_name, base_frame, tip_frames, search_discretization))
     return false;
 
-  std::string cache_name = base_frame;
-  std::accumulate(tip_frames.begin(), tip_frames.end(), cache_name);
-  CachedIKKinematicsPlugin<KinematicsPlugin>::cache_.initializeCache(robot_model.getName(), group_name, cache_name,
-                                                                     KinematicsPlugin::getJointNames().size());
+  // caches used to be named after the base frame only, so existing files are still picked up
+  const std::string cache_name = std::accumulate(tip_frames.begin(), tip_frames.end(), base_frame);
+  CachedIKKinematicsPlugin<KinematicsPlugin>::initCache(robot_model.getName(), group_name, cache_name, base_frame);
   return true;
 }
 
@@ -93,11 +153,11 @@ bool CachedIKKinematicsPlugin<KinematicsPlugin>::getPositionIK(const geometry_ms
                                                                const KinematicsQueryOptions& options) const
 {
   Pose pose(ik_pose);
-  const IKEntry& nearest = cache_.getBestApproximateIKSolution(pose);
+  const IKEntry nearest = getBestApproximateIKSolution(pose);
   bool solution_found = KinematicsPlugin::getPositionIK(ik_pose, nearest.second, solution, error_code, options) ||
                         KinematicsPlugin::getPositionIK(ik_pose, ik_seed_state, solution, error_code, options);
   if (solution_found)
-    cache_.updateCache(nearest, pose, solution);
+    updateCache(nearest, pose, solution);
   return solution_found;
 }
 
@@ -110,7 +170,7 @@ bool CachedIKKinematicsPlugin<KinematicsPlugin>::searchPositionIK(const geometry
 {
   std::chrono::time_point<std::chrono::system_clock> start(std::chrono::system_clock::now());
   Pose pose(ik_pose);
-  const IKEntry& nearest = cache_.getBestApproximateIKSolution(pose);
+  const IKEntry nearest = getBestApproximateIKSolution(pose);
   bool solution_found =
       KinematicsPlugin::searchPositionIK(ik_pose, nearest.second, timeout, solution, error_code, options);
   if (!solution_found)
@@ -120,7 +180,7 @@ bool CachedIKKinematicsPlugin<KinematicsPlugin>::searchPositionIK(const geometry
         KinematicsPlugin::searchPositionIK(ik_pose, ik_seed_state, diff.count(), solution, error_code, options);
   }
   if (solution_found)
-    cache_.updateCache(nearest, pose, solution);
+    updateCache(nearest, pose, solution);
   return solution_found;
 }
 
@@ -132,7 +192,7 @@ bool CachedIKKinematicsPlugin<KinematicsPlugin>::searchPositionIK(
 {
   std::chrono::time_point<std::chrono::system_clock> start(std::chrono::system_clock::now());
   Pose pose(ik_pose);
-  const IKEntry& nearest = cache_.getBestApproximateIKSolution(pose);
+  const IKEntry nearest = getBestApproximateIKSolution(pose);
   bool solution_found = KinematicsPlugin::searchPositionIK(ik_pose, nearest.second, timeout, consistency_limits,
                                                            solution, error_code, options);
   if (!solution_found)
@@ -142,7 +202,7 @@ bool CachedIKKinematicsPlugin<KinematicsPlugin>::searchPositionIK(
                                                         solution, error_code, options);
   }
   if (solution_found)
-    cache_.updateCache(nearest, pose, solution);
+    updateCache(nearest, pose, solution);
   return solution_found;
 }
 
@@ -156,7 +216,7 @@ bool CachedIKKinematicsPlugin<KinematicsPlugin>::searchPositionIK(const geometry
 {
   std::chrono::time_point<std::chrono::system_clock> start(std::chrono::system_clock::now());
   Pose pose(ik_pose);
-  const IKEntry& nearest = cache_.getBestApproximateIKSolution(pose);
+  const IKEntry nearest = getBestApproximateIKSolution(pose);
   bool solution_found = KinematicsPlugin::searchPositionIK(ik_pose, nearest.second, timeout, solution,
                                                            solution_callback, error_code, options);
   if (!solution_found)
@@ -166,7 +226,7 @@ bool CachedIKKinematicsPlugin<KinematicsPlugin>::searchPositionIK(const geometry
                                                         solution_callback, error_code, options);
   }
   if (solution_found)
-    cache_.updateCache(nearest, pose, solution);
+    updateCache(nearest, pose, solution);
   return solution_found;
 }
 
@@ -178,7 +238,7 @@ bool CachedIKKinematicsPlugin<KinematicsPlugin>::searchPositionIK(
 {
   std::chrono::time_point<std::chrono::system_clock> start(std::chrono::system_clock::now());
   Pose pose(ik_pose);
-  const IKEntry& nearest = cache_.getBestApproximateIKSolution(pose);
+  const IKEntry nearest = getBestApproximateIKSolution(pose);
   bool solution_found = KinematicsPlugin::searchPositionIK(ik_pose, nearest.second, timeout, consistency_limits,
                                                            solution, solution_callback, error_code, options);
   if (!solution_found)
@@ -188,10 +248,59 @@ bool CachedIKKinematicsPlugin<KinematicsPlugin>::searchPositionIK(
                                                         solution, solution_callback, error_code, options);
   }
   if (solution_found)
-    cache_.updateCache(nearest, pose, solution);
+    updateCache(nearest, pose, solution);
   return solution_found;
 }
 
+template <class KinematicsPlugin>
+bool CachedIKKinematicsPlugin<KinematicsPlugin>::searchPositionIKBatch(
+    const std::vector<geometry_msgs::msg::Pose>& ik_poses, const std::vector<std::vector<double>>& ik_seed_states,
+    double timeout, std::vector<std::vector<double>>& solutions,
+    std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes, const KinematicsQueryOptions& options) const
+{
+  if (ik_seed_states.size() != 1 && ik_seed_states.size() != ik_poses.size())
+    return KinematicsPlugin::searchPositionIKBatch(ik_poses, ik_seed_states, timeout, solutions, error_codes, options);
+
+  solutions.assign(ik_poses.size(), std::vector<double>());
+  error_codes.resize(ik_poses.size());
+
+  // Seed every pose from the cache first. If that fails, fall back to the given seed or, if a single seed is given
+  // for the whole batch, to the solution of the previous pose, which is usually close for a sequence of poses.
+  const std::vector<double>* fallback_seed = &ik_seed_states[0];
+  bool all_solved = true;
+  for (std::size_t i = 0; i < ik_poses.size(); ++i)
+  {
+    std::chrono::time_point<std::chrono::system_clock> start(std::chrono::system_clock::now());
+    if (ik_seed_states.size() != 1)
+      fallback_seed = &ik_seed_states[i];
+
+    Pose pose(ik_poses[i]);
+    const IKEntry nearest = getBestApproximateIKSolution(pose);
+    bool solution_found =
+        KinematicsPlugin::searchPositionIK(ik_poses[i], nearest.second, timeout, solutions[i], error_codes[i], options);
+    if (!solution_found)
+    {
+      std::chrono::duration<double> diff = std::chrono::system_clock::now() - start;
+      solution_found = KinematicsPlugin::searchPositionIK(ik_poses[i], *fallback_seed,
+                                                          std::max(timeout - diff.count(), 0.0), solutions[i],
+                                                          error_codes[i], options);
+    }
+
+    if (solution_found)
+    {
+      updateCache(nearest, pose, solutions[i]);
+      if (ik_seed_states.size() == 1)
+        fallback_seed = &solutions[i];
+    }
+    else
+    {
+      solutions[i].clear();
+      all_solved = false;
+    }
+  }
+  return all_solved;
+}
+
 template <class KinematicsPlugin>
 bool CachedMultiTipIKKinematicsPlugin<KinematicsPlugin>::searchPositionIK(
     const std::vector<geometry_msgs::msg::Pose>& ik_poses, const std::vector<double>& ik_seed_state, double timeout,
@@ -203,7 +312,7 @@ bool CachedMultiTipIKKinematicsPlugin<KinematicsPlugin>::searchPositionIK(
   std::vector<Pose> poses(ik_poses.size());
   for (unsigned int i = 0; i < poses.size(); ++i)
     poses[i] = Pose(ik_poses[i]);
-  const IKEntry& nearest = CachedIKKinematicsPlugin<KinematicsPlugin>::cache_.getBestApproximateIKSolution(poses);
+  const IKEntry nearest = CachedIKKinematicsPlugin<KinematicsPlugin>::getBestApproximateIKSolution(poses);
   bool solution_found =
       KinematicsPlugin::searchPositionIK(ik_poses, nearest.second, timeout, consistency_limits, solution,
                                          solution_callback, error_code, options, context_state);
@@ -216,7 +325,7 @@ bool CachedMultiTipIKKinematicsPlugin<KinematicsPlugin>::searchPositionIK(
   }
 
   if (solution_found)
-    CachedIKKinematicsPlugin<KinematicsPlugin>::cache_.updateCache(nearest, poses, solution);
+    CachedIKKinematicsPlugin<KinematicsPlugin>::updateCache(nearest, poses, solution);
   return solution_found;
 }
 }  // namespace cached_ik_kinematics_plugin
@@ -51,7 +51,10 @@
 #else
 #include <tf2/LinearMath/Vector3.h>
 #endif
+#include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <filesystem>
@@ -74,6 +77,9 @@ public:
     double min_pose_distance;
     double min_joint_config_distance;
     std::string cached_ik_path;
+    /** cache name of an older file to load if none exists for the current cache name; it is saved under the
+        current name */
+    std::string legacy_cache_name;
   };
 
   /**
@@ -188,6 +194,105 @@ protected:
   unsigned int num_joints_;
 };
 
+/**
+  \brief A cache of inverse kinematic solutions that can be shared by many threads
+
+  Lookups never wait for insertions: the entries are stored in a small
+  number of immutable blocks, each indexed by a vantage-point tree that
+  is laid out in the order of its entries, and readers take a
+  reference to the current set of blocks (a snapshot) without taking the
+  cache's writer lock. Note that std::atomic_load on a shared_ptr is not
+  lock-free in libstdc++ (it uses a small pool of mutexes), so loading the
+  snapshot is short but not wait-free.
+  Insertions are queued and processed by a background thread, which
+  builds a new block, merges blocks of similar size, and then publishes a
+  new snapshot. The cache file is an image of a single block, so it is
+  memory-mapped on startup instead of being parsed and re-indexed. Caches
+  in the format written by IKCache are imported on first use.
+*/
+class ConcurrentIKCache
+{
+public:
+  using Options = IKCache::Options;
+  using Pose = IKCache::Pose;
+  using IKEntry = IKCache::IKEntry;
+
+  ConcurrentIKCache();
+  ~ConcurrentIKCache();
+  ConcurrentIKCache(const ConcurrentIKCache&) = delete;
+
+  /** get the entry from the IK cache that best matches a given pose */
+  IKEntry getBestApproximateIKSolution(const Pose& pose) const;
+  /** get the entry from the IK cache that best matches a given vector of poses */
+  IKEntry getBestApproximateIKSolution(const std::vector<Pose>& poses) const;
+  /** initialize cache, map it from disk if found */
+  void initializeCache(const std::string& robot_id, const std::string& group_name, const std::string& cache_name,
+                       const unsigned int num_joints, const Options& opts = Options());
+  /**
+    queue (pose,config) for insertion if it's different enough from the
+    most similar cache entry
+  */
+  void updateCache(const IKEntry& nearest, const Pose& pose, const std::vector<double>& config) const;
+  /**
+    queue (poses,config) for insertion if it's different enough from the
+    most similar cache entry
+  */
+  void updateCache(const IKEntry& nearest, const std::vector<Pose>& poses, const std::vector<double>& config) const;
+  /** wait until all queued insertions are visible to lookups */
+  void flush() const;
+  /** number of entries visible to lookups */
+  std::size_t size() const;
+
+  /** file name for loading / saving cache */
+  const std::filesystem::path& getCacheFileName() const
+  {
+    return cache_file_name_;
+  }
+
+protected:
+  struct Snapshot;
+  using SnapshotConstPtr = std::shared_ptr<const Snapshot>;
+
+  /** stop the insertion thread after it has processed all queued insertions */
+  void stopInsertionThread();
+  /** main loop of the insertion thread */
+  void processInsertions() const;
+  /** add a batch of entries to the cache and publish a new snapshot */
+  void insertBatch(const std::vector<IKEntry>& batch) const;
+  /** find the best entry in a snapshot; returns false if the snapshot is empty */
+  bool nearest(const Snapshot& snapshot, const std::vector<double>& query, const double*& record) const;
+  /** whether an entry is different enough from its nearest neighbor to be added */
+  bool isNovel(const IKEntry& nearest, const std::vector<Pose>& poses, const std::vector<double>& config) const;
+  /** save a snapshot that consists of a single block to disk */
+  void saveCache(const Snapshot& snapshot) const;
+
+  /** number of joints in the system */
+  unsigned int num_joints_{ 0 };
+  /** for all cache entries, the poses are at least min_pose_distance_ apart ... */
+  double min_pose_distance_{ 1.0 };
+  /** ... or the configurations are at least min_config_distance2_^.5 apart. */
+  double min_config_distance2_{ 1.0 };
+  /** maximum size of the cache */
+  unsigned int max_cache_size_{ 5000 };
+  /** file name for loading / saving cache */
+  std::filesystem::path cache_file_name_;
+
+  /** the published snapshot; only accessed through std::atomic_load / std::atomic_store */
+  mutable SnapshotConstPtr snapshot_;
+  /** size of the cache when it was last saved; only used by the insertion thread */
+  mutable std::size_t last_saved_cache_size_{ 0 };
+
+  /** protects the insertion queue and the counters below */
+  mutable std::mutex queue_lock_;
+  mutable std::condition_variable queue_condition_;
+  mutable std::condition_variable flush_condition_;
+  mutable std::vector<IKEntry> queue_;
+  mutable std::size_t num_queued_{ 0 };
+  mutable std::size_t num_processed_{ 0 };
+  mutable bool stop_{ false };
+  mutable std::thread insertion_thread_;
+};
+
 // Helper class to enable/disable initialize() methods with new/old API
 // HasRobotModelApi<T>::value provides a true/false constexpr depending on KinematicsPlugin offers the new Api
 // This uses SFINAE magic: https://jguegant.github.io/blogs/tech/sfinae-introduction.html
@@ -237,12 +342,7 @@ public:
                   const std::string& group_name, const std::string& base_frame,
                   const std::vector<std::string>& tip_frames, double search_discretization) override
   {
-    node_ = node;
-
-    std::string kinematics_param_prefix = "robot_description_kinematics." + group_name;
-    param_listener_ = std::make_shared<cached_ik_kinematics::ParamListener>(node, kinematics_param_prefix);
-    params_ = param_listener_->get_params();
-
+    loadParams(node, group_name);
     return initializeImpl(node, robot_model, group_name, base_frame, tip_frames, search_discretization);
   }
 
@@ -269,14 +369,31 @@ public:
                         const IKCallbackFn& solution_callback, moveit_msgs::msg::MoveItErrorCodes& error_code,
                         const KinematicsQueryOptions& options = KinematicsQueryOptions()) const override;
 
+  bool searchPositionIKBatch(const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                             const std::vector<std::vector<double>>& ik_seed_states, double timeout,
+                             std::vector<std::vector<double>>& solutions,
+                             std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes,
+                             const KinematicsQueryOptions& options = KinematicsQueryOptions()) const override;
+
+protected:
+  /* The cache is only accessed through these methods, which use concurrent_cache_ instead of cache_ if the
+     concurrent_cache parameter is set. */
+  void loadParams(const rclcpp::Node::SharedPtr& node, const std::string& group_name);
+  void initCache(const std::string& robot_id, const std::string& group_name, const std::string& cache_name,
+                 const std::string& legacy_cache_name = "");
+  IKEntry getBestApproximateIKSolution(const Pose& pose) const;
+  IKEntry getBestApproximateIKSolution(const std::vector<Pose>& poses) const;
+  void updateCache(const IKEntry& nearest, const Pose& pose, const std::vector<double>& config) const;
+  void updateCache(const IKEntry& nearest, const std::vector<Pose>& poses, const std::vector<double>& config) const;
+
 private:
   rclcpp::Node::SharedPtr node_;
   std::shared_ptr<cached_ik_kinematics::ParamListener> param_listener_;
   cached_ik_kinematics::Params params_;
 
   IKCache cache_;
-
-  void initCache(const std::string& robot_id, const std::string& group_name, const std::string& cache_name);
+  /** used instead of cache_ if the concurrent_cache parameter is set */
+  std::unique_ptr<ConcurrentIKCache> concurrent_cache_;
 
   /* Using templates and SFINAE magic, we can selectively enable/disable methods depending on
      availability of API in wrapped KinematicsPlugin class.
@@ -0,0 +1,677 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <moveit/cached_ik_kinematics_plugin/cached_ik_kinematics_plugin.hpp>
+#include <moveit/utils/logger.hpp>
+
+namespace cached_ik_kinematics_plugin
+{
+namespace
+{
+rclcpp::Logger getLogger()
+{
+  return moveit::getLogger("moveit.core.cached_ik_kinematics_plugin");
+}
+
+/*
+  A block is stored exactly as it is written to disk, so that cache files
+  can be memory-mapped:
+
+    FileHeader
+    num_entries records; each record holds, for each end effector, the
+      position (x, y, z) and orientation (x, y, z, w), followed by the
+      joint values
+    num_entries radii
+
+  The records are ordered as an implicit vantage-point tree: the node for
+  the range [lo, hi) has its vantage point at lo, the entries within
+  radii[lo] of the vantage point in [lo + 1, mid) and the others in
+  [mid, hi), where mid = lo + 1 + (hi - lo - 1) / 2. Ranges of at most
+  LEAF_SIZE entries are leaves. Data is stored in native byte order.
+*/
+constexpr char MAGIC[8] = { 'M', 'V', 'I', 'K', 'C', 'V', 'P', 'T' };
+constexpr std::uint32_t VERSION = 1;
+constexpr std::size_t POSE_SIZE = 7;
+constexpr std::size_t LEAF_SIZE = 8;
+/** minimum number of new entries before the cache is saved again */
+constexpr std::size_t MIN_SAVE_INTERVAL = 500;
+
+struct FileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t num_dofs;
+  std::uint32_t num_tips;
+  std::uint32_t reserved;
+  std::uint64_t num_entries;
+};
+
+static_assert(sizeof(FileHeader) % sizeof(double) == 0, "records must be aligned");
+
+/** an immutable set of cache entries with a nearest-neighbor index */
+struct Block
+{
+  /** the memory-mapped file or heap buffer that holds the image */
+  std::shared_ptr<const void> storage;
+  const char* data = nullptr;
+  std::size_t length = 0;
+
+  FileHeader header;
+  std::size_t stride = 0;
+  const double* records = nullptr;
+  const double* radii = nullptr;
+
+  std::size_t size() const
+  {
+    return header.num_entries;
+  }
+  const double* record(std::size_t i) const
+  {
+    return records + i * stride;
+  }
+};
+
+using BlockConstPtr = std::shared_ptr<const Block>;
+
+std::size_t imageLength(std::size_t stride, std::size_t num_entries)
+{
+  return sizeof(FileHeader) + num_entries * (stride + 1) * sizeof(double);
+}
+
+/** wrap an image in a block, or return nullptr if the image is malformed */
+BlockConstPtr parseImage(std::shared_ptr<const void> storage, std::size_t length)
+{
+  const char* data = static_cast<const char*>(storage.get());
+  if (length < sizeof(FileHeader))
+    return nullptr;
+
+  auto block = std::make_shared<Block>();
+  std::memcpy(&block->header, data, sizeof(FileHeader));
+  const FileHeader& header = block->header;
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.num_tips == 0)
+    return nullptr;
+
+  block->stride = header.num_tips * POSE_SIZE + header.num_dofs;
+  if (length != imageLength(block->stride, header.num_entries))
+    return nullptr;
+
+  block->storage = std::move(storage);
+  block->data = data;
+  block->length = length;
+  block->records = reinterpret_cast<const double*>(data + sizeof(FileHeader));
+  block->radii = block->records + header.num_entries * block->stride;
+  return block;
+}
+
+/** same metric as IKCache::Pose::distance, summed over end effectors; stops early once bound is reached */
+double poseDistance(const double* a, const double* b, unsigned int num_tips,
+                    double bound = std::numeric_limits<double>::infinity())
+{
+  double dist = 0.;
+  for (unsigned int i = 0; i < num_tips; ++i, a += POSE_SIZE, b += POSE_SIZE)
+  {
+    const double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    dist += std::sqrt(dx * dx + dy * dy + dz * dz);
+    if (dist >= bound)
+      return dist;
+    dist += tf2::Quaternion(a[3], a[4], a[5], a[6]).angleShortestPath(tf2::Quaternion(b[3], b[4], b[5], b[6]));
+  }
+  return dist;
+}
+
+/** order[lo, hi) into a vantage-point tree; radii are indexed like order */
+void buildTree(const std::vector<const double*>& records, unsigned int num_tips, std::vector<std::size_t>& order,
+               std::vector<double>& radii, std::vector<std::pair<double, std::size_t>>& scratch, std::size_t lo,
+               std::size_t hi)
+{
+  if (hi - lo <= LEAF_SIZE)
+    return;
+
+  std::swap(order[lo], order[lo + (hi - lo) / 2]);
+  const double* vantage = records[order[lo]];
+  scratch.clear();
+  for (std::size_t i = lo + 1; i < hi; ++i)
+    scratch.emplace_back(poseDistance(vantage, records[order[i]], num_tips), order[i]);
+
+  const std::size_t mid = lo + 1 + (hi - lo - 1) / 2;
+  const auto median = scratch.begin() + (mid - lo - 1);
+  std::nth_element(scratch.begin(), median, scratch.end());
+  radii[lo] = median->first;
+  for (std::size_t i = lo + 1; i < hi; ++i)
+    order[i] = scratch[i - lo - 1].second;
+
+  buildTree(records, num_tips, order, radii, scratch, lo + 1, mid);
+  buildTree(records, num_tips, order, radii, scratch, mid, hi);
+}
+
+/** build a block from records, which may point into other blocks */
+BlockConstPtr buildBlock(unsigned int num_dofs, unsigned int num_tips, const std::vector<const double*>& records)
+{
+  FileHeader header;
+  std::memset(&header, 0, sizeof(FileHeader));
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.num_dofs = num_dofs;
+  header.num_tips = num_tips;
+  header.num_entries = records.size();
+
+  std::vector<std::size_t> order(records.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::vector<double> radii(records.size(), 0.);
+  std::vector<std::pair<double, std::size_t>> scratch;
+  scratch.reserve(records.size());
+  buildTree(records, num_tips, order, radii, scratch, 0, records.size());
+
+  const std::size_t stride = num_tips * POSE_SIZE + num_dofs;
+  const std::size_t length = imageLength(stride, records.size());
+  std::shared_ptr<char[]> buffer(new char[length]);
+  char* out = buffer.get();
+  std::memcpy(out, &header, sizeof(FileHeader));
+  out += sizeof(FileHeader);
+  for (std::size_t i : order)
+  {
+    std::memcpy(out, records[i], stride * sizeof(double));
+    out += stride * sizeof(double);
+  }
+  if (!radii.empty())
+    std::memcpy(out, radii.data(), radii.size() * sizeof(double));
+
+  return parseImage(std::shared_ptr<const void>(buffer, buffer.get()), length);
+}
+
+/** merge blocks [first, blocks.end()) into a single block */
+BlockConstPtr mergeBlocks(const std::vector<BlockConstPtr>& blocks, std::size_t first)
+{
+  std::vector<const double*> records;
+  for (std::size_t b = first; b < blocks.size(); ++b)
+    for (std::size_t i = 0; i < blocks[b]->size(); ++i)
+      records.push_back(blocks[b]->record(i));
+  const FileHeader& header = blocks[first]->header;
+  return buildBlock(header.num_dofs, header.num_tips, records);
+}
+
+/** memory-map a cache file */
+BlockConstPtr mapImage(const std::filesystem::path& path)
+{
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return nullptr;
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size <= 0)
+  {
+    ::close(fd);
+    return nullptr;
+  }
+  const std::size_t length = static_cast<std::size_t>(st.st_size);
+  void* address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (address == MAP_FAILED)
+    return nullptr;
+  std::shared_ptr<const void> storage(address, [length](const void* p) { ::munmap(const_cast<void*>(p), length); });
+  return parseImage(std::move(storage), length);
+}
+
+/** read a cache file written by IKCache */
+std::vector<double> readLegacyCache(const std::filesystem::path& path, unsigned int& num_dofs, unsigned int& num_tips)
+{
+  std::ifstream cache_file(path, std::ios_base::binary | std::ios_base::in);
+  unsigned int num_entries = 0;
+  cache_file.read(reinterpret_cast<char*>(&num_entries), sizeof(unsigned int));
+  cache_file.read(reinterpret_cast<char*>(&num_dofs), sizeof(unsigned int));
+  cache_file.read(reinterpret_cast<char*>(&num_tips), sizeof(unsigned int));
+  if (!cache_file)
+    return {};
+
+  const std::size_t stride = num_tips * POSE_SIZE + num_dofs;
+  std::vector<double> records(num_entries * stride);
+  std::vector<tf2Scalar> pose(POSE_SIZE);
+  double* record = records.data();
+  for (unsigned int i = 0; i < num_entries && cache_file; ++i)
+  {
+    for (unsigned int j = 0; j < num_tips; ++j, record += POSE_SIZE)
+    {
+      cache_file.read(reinterpret_cast<char*>(pose.data()), POSE_SIZE * sizeof(tf2Scalar));
+      std::copy(pose.begin(), pose.end(), record);
+    }
+    cache_file.read(reinterpret_cast<char*>(record), num_dofs * sizeof(double));
+    record += num_dofs;
+  }
+  if (!cache_file)
+    return {};
+  return records;
+}
+
+/** write a block to disk; the file is replaced atomically so that existing mappings stay valid */
+bool writeImage(const Block& block, const std::filesystem::path& path)
+{
+  std::filesystem::path tmp_path(path);
+  tmp_path += ".tmp";
+  {
+    std::ofstream cache_file(tmp_path, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+    cache_file.write(block.data, static_cast<std::streamsize>(block.length));
+    if (!cache_file)
+      return false;
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  return !ec;
+}
+
+void encodePoses(const std::vector<IKCache::Pose>& poses, std::vector<double>& out)
+{
+  for (const auto& pose : poses)
+  {
+    out.insert(out.end(), { pose.position.x(), pose.position.y(), pose.position.z() });
+    out.insert(out.end(), { pose.orientation.x(), pose.orientation.y(), pose.orientation.z(), pose.orientation.w() });
+  }
+}
+
+IKCache::IKEntry decodeEntry(const double* record, unsigned int num_tips, unsigned int num_dofs)
+{
+  IKCache::IKEntry entry;
+  entry.first.resize(num_tips);
+  for (auto& pose : entry.first)
+  {
+    pose.position.setValue(record[0], record[1], record[2]);
+    pose.orientation = tf2::Quaternion(record[3], record[4], record[5], record[6]);
+    record += POSE_SIZE;
+  }
+  entry.second.assign(record, record + num_dofs);
+  return entry;
+}
+
+/** find the nearest record in the tree for [lo, hi), if it is closer than best */
+void searchTree(const Block& block, std::size_t lo, std::size_t hi, const double* query, double& best,
+                const double*& best_record)
+{
+  const unsigned int num_tips = block.header.num_tips;
+  if (hi - lo <= LEAF_SIZE)
+  {
+    for (std::size_t i = lo; i < hi; ++i)
+    {
+      const double* record = block.record(i);
+      const double dist = poseDistance(record, query, num_tips, best);
+      if (dist < best)
+      {
+        best = dist;
+        best_record = record;
+      }
+    }
+    return;
+  }
+
+  const double* vantage = block.record(lo);
+  const double dist = poseDistance(vantage, query, num_tips);
+  if (dist < best)
+  {
+    best = dist;
+    best_record = vantage;
+  }
+
+  // by the triangle inequality, the inside is at least dist - radius away and the outside radius - dist
+  const std::size_t mid = lo + 1 + (hi - lo - 1) / 2;
+  const double radius = block.radii[lo];
+  if (dist < radius)
+  {
+    searchTree(block, lo + 1, mid, query, best, best_record);
+    if (dist + best >= radius)
+      searchTree(block, mid, hi, query, best, best_record);
+  }
+  else
+  {
+    searchTree(block, mid, hi, query, best, best_record);
+    if (dist - best <= radius)
+      searchTree(block, lo + 1, mid, query, best, best_record);
+  }
+}
+}  // namespace
+
+/** the set of blocks visible to lookups; block sizes decrease geometrically */
+struct ConcurrentIKCache::Snapshot
+{
+  std::vector<BlockConstPtr> blocks;
+  std::size_t size = 0;
+  unsigned int num_tips = 0;
+};
+
+ConcurrentIKCache::ConcurrentIKCache() : snapshot_(std::make_shared<const Snapshot>())
+{
+}
+
+ConcurrentIKCache::~ConcurrentIKCache()
+{
+  stopInsertionThread();
+  SnapshotConstPtr snapshot = std::atomic_load(&snapshot_);
+  if (!cache_file_name_.empty() && snapshot->size > last_saved_cache_size_)
+  {
+    auto merged = std::make_shared<Snapshot>(*snapshot);
+    if (merged->blocks.size() > 1)
+      merged->blocks = { mergeBlocks(merged->blocks, 0) };
+    saveCache(*merged);
+  }
+}
+
+void ConcurrentIKCache::initializeCache(const std::string& robot_id, const std::string& group_name,
+                                        const std::string& cache_name, const unsigned int num_joints,
+                                        const Options& opts)
+{
+  stopInsertionThread();
+
+  num_joints_ = num_joints;
+  max_cache_size_ = opts.max_cache_size;
+  min_pose_distance_ = opts.min_pose_distance;
+  min_config_distance2_ = opts.min_joint_config_distance * opts.min_joint_config_distance;
+
+  // determine cache file name
+  std::filesystem::path prefix(!opts.cached_ik_path.empty() ? std::filesystem::path(opts.cached_ik_path) :
+                                                              std::filesystem::current_path());
+  // create cache directory if necessary
+  std::filesystem::create_directories(prefix);
+
+  const auto file_name = [&](const std::string& name, const char* extension) {
+    return prefix / (robot_id + group_name + "_" + name + "_" + std::to_string(max_cache_size_) + "_" +
+                     std::to_string(min_pose_distance_) + "_" + std::to_string(std::sqrt(min_config_distance2_)) +
+                     extension);
+  };
+  cache_file_name_ = file_name(cache_name, ".ikcmap");
+  std::filesystem::path map_file_name = cache_file_name_;
+  std::filesystem::path legacy_file_name = file_name(cache_name, ".ikcache");
+  // fall back to the files of the cache name used before, which are then saved under the current name
+  if (!opts.legacy_cache_name.empty() && !std::filesystem::exists(map_file_name) &&
+      !std::filesystem::exists(legacy_file_name))
+  {
+    map_file_name = file_name(opts.legacy_cache_name, ".ikcmap");
+    legacy_file_name = file_name(opts.legacy_cache_name, ".ikcache");
+  }
+
+  auto snapshot = std::make_shared<Snapshot>();
+  last_saved_cache_size_ = 0;
+  if (std::filesystem::exists(map_file_name))
+  {
+    BlockConstPtr block = mapImage(map_file_name);
+    if (!block)
+      RCLCPP_ERROR(getLogger(), "Ignoring malformed cache file %s", map_file_name.string().c_str());
+    else if (block->header.num_dofs != num_joints_)
+      RCLCPP_ERROR(getLogger(), "Ignoring cache file %s for a %u-dof system", map_file_name.string().c_str(),
+                   block->header.num_dofs);
+    else
+    {
+      snapshot->blocks.push_back(block);
+      if (map_file_name == cache_file_name_)
+        last_saved_cache_size_ = block->size();
+    }
+  }
+  else if (std::filesystem::exists(legacy_file_name))
+  {
+    unsigned int num_dofs = 0, num_tips = 0;
+    std::vector<double> records = readLegacyCache(legacy_file_name, num_dofs, num_tips);
+    if (num_dofs == num_joints_ && num_tips > 0 && !records.empty())
+    {
+      const std::size_t stride = num_tips * POSE_SIZE + num_dofs;
+      std::vector<const double*> record_ptrs;
+      for (std::size_t i = 0; i < records.size(); i += stride)
+        record_ptrs.push_back(&records[i]);
+      snapshot->blocks.push_back(buildBlock(num_dofs, num_tips, record_ptrs));
+      RCLCPP_INFO(getLogger(), "Imported %zu IK solutions from %s", record_ptrs.size(),
+                  legacy_file_name.string().c_str());
+    }
+    else
+      RCLCPP_ERROR(getLogger(), "Could not import cache file %s", legacy_file_name.string().c_str());
+  }
+  if (!snapshot->blocks.empty())
+  {
+    snapshot->size = snapshot->blocks[0]->size();
+    snapshot->num_tips = snapshot->blocks[0]->header.num_tips;
+    RCLCPP_INFO(getLogger(), "Found %zu IK solutions for a %u-dof system with %u end effectors", snapshot->size,
+                num_joints_, snapshot->num_tips);
+  }
+  std::atomic_store(&snapshot_, SnapshotConstPtr(snapshot));
+
+  {
+    // updateCache() checks under the lock whether the insertion thread runs
+    std::lock_guard<std::mutex> slock(queue_lock_);
+    queue_.clear();
+    num_queued_ = num_processed_ = 0;
+    stop_ = false;
+    insertion_thread_ = std::thread([this] { processInsertions(); });
+  }
+
+  RCLCPP_INFO(getLogger(), "cache file %s initialized!", cache_file_name_.string().c_str());
+}
+
+ConcurrentIKCache::IKEntry ConcurrentIKCache::getBestApproximateIKSolution(const Pose& pose) const
+{
+  return getBestApproximateIKSolution(std::vector<Pose>(1, pose));
+}
+
+ConcurrentIKCache::IKEntry ConcurrentIKCache::getBestApproximateIKSolution(const std::vector<Pose>& poses) const
+{
+  SnapshotConstPtr snapshot = std::atomic_load(&snapshot_);
+  std::vector<double> query;
+  encodePoses(poses, query);
+  const double* record = nullptr;
+  if (poses.size() != snapshot->num_tips || !nearest(*snapshot, query, record))
+    return std::make_pair(poses, std::vector<double>(num_joints_, 0.));
+  return decodeEntry(record, snapshot->num_tips, num_joints_);
+}
+
+bool ConcurrentIKCache::nearest(const Snapshot& snapshot, const std::vector<double>& query,
+                                const double*& record) const
+{
+  double best = std::numeric_limits<double>::infinity();
+  record = nullptr;
+  for (const auto& block : snapshot.blocks)
+    searchTree(*block, 0, block->size(), query.data(), best, record);
+  return record != nullptr;
+}
+
+bool ConcurrentIKCache::isNovel(const IKEntry& nearest, const std::vector<Pose>& poses,
+                                const std::vector<double>& config) const
+{
+  double dist = 0., diff;
+  for (unsigned int i = 0; i < config.size() && i < nearest.second.size(); ++i)
+  {
+    diff = nearest.second[i] - config[i];
+    dist += diff * diff;
+  }
+  if (dist > min_config_distance2_)
+    return true;
+
+  dist = 0.;
+  for (unsigned int i = 0; i < poses.size() && i < nearest.first.size(); ++i)
+  {
+    dist += nearest.first[i].distance(poses[i]);
+    if (dist > min_pose_distance_)
+      return true;
+  }
+  return false;
+}
+
+void ConcurrentIKCache::updateCache(const IKEntry& nearest, const Pose& pose, const std::vector<double>& config) const
+{
+  updateCache(nearest, std::vector<Pose>(1, pose), config);
+}
+
+void ConcurrentIKCache::updateCache(const IKEntry& nearest, const std::vector<Pose>& poses,
+                                    const std::vector<double>& config) const
+{
+  const std::size_t cache_size = size();
+  if (cache_size > 0 && !isNovel(nearest, poses, config))
+    return;
+
+  std::lock_guard<std::mutex> slock(queue_lock_);
+  if (!insertion_thread_.joinable() || cache_size + (num_queued_ - num_processed_) >= max_cache_size_)
+    return;
+  queue_.emplace_back(poses, config);
+  ++num_queued_;
+  queue_condition_.notify_one();
+}
+
+void ConcurrentIKCache::flush() const
+{
+  std::unique_lock<std::mutex> ulock(queue_lock_);
+  flush_condition_.wait(ulock, [this] { return num_processed_ == num_queued_; });
+}
+
+std::size_t ConcurrentIKCache::size() const
+{
+  return std::atomic_load(&snapshot_)->size;
+}
+
+void ConcurrentIKCache::stopInsertionThread()
+{
+  // take the thread out under the lock, so that updateCache() stops queueing entries right away
+  std::thread insertion_thread;
+  {
+    std::lock_guard<std::mutex> slock(queue_lock_);
+    if (!insertion_thread_.joinable())
+      return;
+    stop_ = true;
+    insertion_thread = std::move(insertion_thread_);
+  }
+  queue_condition_.notify_all();
+  insertion_thread.join();
+}
+
+void ConcurrentIKCache::processInsertions() const
+{
+  std::unique_lock<std::mutex> ulock(queue_lock_);
+  while (true)
+  {
+    queue_condition_.wait(ulock, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty())
+      break;
+    std::vector<IKEntry> batch;
+    batch.swap(queue_);
+    ulock.unlock();
+    insertBatch(batch);
+    ulock.lock();
+    num_processed_ += batch.size();
+    flush_condition_.notify_all();
+  }
+}
+
+void ConcurrentIKCache::insertBatch(const std::vector<IKEntry>& batch) const
+{
+  // only this thread publishes snapshots, so the snapshot cannot change underneath us
+  SnapshotConstPtr snapshot = std::atomic_load(&snapshot_);
+  const unsigned int num_tips = snapshot->blocks.empty() ? batch.front().first.size() : snapshot->num_tips;
+  const std::size_t stride = num_tips * POSE_SIZE + num_joints_;
+
+  std::vector<double> records;
+  std::vector<double> query;
+  const double* record;
+  std::vector<const IKEntry*> accepted;
+  for (const auto& entry : batch)
+  {
+    if (snapshot->size + accepted.size() >= max_cache_size_)
+      break;
+    if (entry.first.size() != num_tips || entry.second.size() != num_joints_)
+      continue;
+    // callers compare against the snapshot they read, which may be older than the current one
+    query.clear();
+    encodePoses(entry.first, query);
+    if (nearest(*snapshot, query, record) &&
+        !isNovel(decodeEntry(record, num_tips, num_joints_), entry.first, entry.second))
+      continue;
+    // entries of the same batch are not in the snapshot yet; batches are small, so compare with each of them
+    if (!std::all_of(accepted.begin(), accepted.end(), [&](const IKEntry* other) {
+          return isNovel(*other, entry.first, entry.second);
+        }))
+      continue;
+    records.insert(records.end(), query.begin(), query.end());
+    records.insert(records.end(), entry.second.begin(), entry.second.end());
+    accepted.push_back(&entry);
+  }
+  const std::size_t num_accepted = accepted.size();
+  if (num_accepted == 0)
+    return;
+
+  auto next = std::make_shared<Snapshot>(*snapshot);
+  next->num_tips = num_tips;
+  next->size += num_accepted;
+  std::vector<const double*> record_ptrs(num_accepted);
+  for (std::size_t i = 0; i < num_accepted; ++i)
+    record_ptrs[i] = &records[i * stride];
+  next->blocks.push_back(buildBlock(num_joints_, num_tips, record_ptrs));
+
+  // merge blocks of similar size, so that a lookup visits O(log n) blocks and every entry is copied O(log n) times
+  std::vector<BlockConstPtr>& blocks = next->blocks;
+  while (blocks.size() > 1 && 2 * blocks.back()->size() >= blocks[blocks.size() - 2]->size())
+  {
+    BlockConstPtr merged = mergeBlocks(blocks, blocks.size() - 2);
+    blocks.pop_back();
+    blocks.back() = merged;
+  }
+
+  // saving rewrites the whole file, so save less often as the cache grows
+  const bool save = next->size >= last_saved_cache_size_ + std::max(MIN_SAVE_INTERVAL, last_saved_cache_size_ / 8) ||
+                    next->size == max_cache_size_;
+  if (save && blocks.size() > 1)
+    blocks = { mergeBlocks(blocks, 0) };
+
+  std::atomic_store(&snapshot_, SnapshotConstPtr(next));
+
+  if (save)
+  {
+    saveCache(*next);
+    last_saved_cache_size_ = next->size;
+  }
+}
+
+void ConcurrentIKCache::saveCache(const Snapshot& snapshot) const
+{
+  if (cache_file_name_.empty())
+  {
+    RCLCPP_ERROR(getLogger(), "can't save cache before initialization");
+    return;
+  }
+  RCLCPP_INFO(getLogger(), "writing %zu IK solutions to %s", snapshot.size, cache_file_name_.string().c_str());
+  if (snapshot.blocks.size() != 1 || !writeImage(*snapshot.blocks.front(), cache_file_name_))
+    RCLCPP_ERROR(getLogger(), "Failed to write cache file %s", cache_file_name_.string().c_str());
+}
+}  // namespace cached_ik_kinematics_plugin
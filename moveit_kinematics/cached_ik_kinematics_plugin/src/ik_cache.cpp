@@ -86,17 +86,23 @@ void IKCache::initializeCache(const std::string& robot_id, const std::string& gr
   // create cache directory if necessary
   std::filesystem::create_directories(prefix);
 
-  cache_file_name_ = prefix / (robot_id + group_name + "_" + cache_name + "_" + std::to_string(max_cache_size_) + "_" +
-                               std::to_string(min_pose_distance_) + "_" +
-                               std::to_string(std::sqrt(min_config_distance2_)) + ".ikcache");
+  const auto file_name = [&](const std::string& name) {
+    return prefix / (robot_id + group_name + "_" + name + "_" + std::to_string(max_cache_size_) + "_" +
+                     std::to_string(min_pose_distance_) + "_" + std::to_string(std::sqrt(min_config_distance2_)) +
+                     ".ikcache");
+  };
+  cache_file_name_ = file_name(cache_name);
+  std::filesystem::path load_file_name = cache_file_name_;
+  if (!std::filesystem::exists(load_file_name) && !opts.legacy_cache_name.empty())
+    load_file_name = file_name(opts.legacy_cache_name);
 
   ik_cache_.clear();
   ik_nn_.clear();
   last_saved_cache_size_ = 0;
-  if (std::filesystem::exists(cache_file_name_))
+  if (std::filesystem::exists(load_file_name))
   {
     // read cache
-    std::ifstream cache_file(cache_file_name_, std::ios_base::binary | std::ios_base::in);
+    std::ifstream cache_file(load_file_name, std::ios_base::binary | std::ios_base::in);
     cache_file.read(reinterpret_cast<char*>(&last_saved_cache_size_), sizeof(unsigned int));
     unsigned int num_dofs;
     cache_file.read(reinterpret_cast<char*>(&num_dofs), sizeof(unsigned int));
@@ -104,7 +110,7 @@ void IKCache::initializeCache(const std::string& robot_id, const std::string& gr
     cache_file.read(reinterpret_cast<char*>(&num_tips), sizeof(unsigned int));
 
     RCLCPP_INFO(getLogger(), "Found %d IK solutions for a %d-dof system with %d end effectors in %s",
-                last_saved_cache_size_, num_dofs, num_tips, cache_file_name_.string().c_str());
+                last_saved_cache_size_, num_dofs, num_tips, load_file_name.string().c_str());
 
     unsigned int position_size = 3 * sizeof(tf2Scalar);
     unsigned int orientation_size = 4 * sizeof(tf2Scalar);
@@ -138,6 +144,9 @@ void IKCache::initializeCache(const std::string& robot_id, const std::string& gr
     for (unsigned int i = 0; i < last_saved_cache_size_; ++i)
       ik_entry_ptrs[i] = &ik_cache_[i];
     ik_nn_.add(ik_entry_ptrs);
+    // entries read from a legacy file are not saved under the current name yet
+    if (load_file_name != cache_file_name_)
+      last_saved_cache_size_ = 0;
   }
 
   num_joints_ = num_joints;
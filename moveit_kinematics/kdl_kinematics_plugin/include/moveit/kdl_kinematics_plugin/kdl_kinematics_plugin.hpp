@@ -59,7 +59,10 @@
 #include <moveit/robot_state/robot_state.hpp>
 #include <moveit_kinematics/kdl_kinematics_parameters.hpp>
 
+#include <atomic>
 #include <cfloat>
+#include <memory>
+#include <mutex>
 
 namespace KDL
 {
@@ -80,6 +83,8 @@ public:
    */
   KDLKinematicsPlugin();
 
+  ~KDLKinematicsPlugin() override;
+
   bool
   getPositionIK(const geometry_msgs::msg::Pose& ik_pose, const std::vector<double>& ik_seed_state,
                 std::vector<double>& solution, moveit_msgs::msg::MoveItErrorCodes& error_code,
@@ -108,6 +113,16 @@ public:
       const IKCallbackFn& solution_callback, moveit_msgs::msg::MoveItErrorCodes& error_code,
       const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
 
+  /**
+   * @brief Solve a batch of poses. If a single seed is given for the whole batch, every pose is seeded with the
+   * solution of the previous pose, which converges quickly for a sequence of nearby poses, e.g. a Cartesian path.
+   */
+  bool searchPositionIKBatch(
+      const std::vector<geometry_msgs::msg::Pose>& ik_poses, const std::vector<std::vector<double>>& ik_seed_states,
+      double timeout, std::vector<std::vector<double>>& solutions,
+      std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes,
+      const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
+
   bool getPositionFK(const std::vector<std::string>& link_names, const std::vector<double>& joint_angles,
                      std::vector<geometry_msgs::msg::Pose>& poses) const override;
 
@@ -135,6 +150,30 @@ protected:
                 const Twist& cartesian_weights) const;
 
 private:
+  /// Preallocated temporaries of an IK search, see createWorkspace()
+  struct IKWorkspace;
+
+  /// Allocate the temporaries of an IK search for this chain
+  std::unique_ptr<IKWorkspace> createWorkspace() const;
+
+  /// Solve position IK with pseudo-inverse steps, using the preallocated temporaries of workspace
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  int CartToJnt(IKWorkspace& workspace, KDL::ChainIkSolverVelMimicSVD& ik_solver, const KDL::JntArray& q_init,
+                const KDL::Frame& p_in, KDL::JntArray& q_out, const unsigned int max_iter,
+                const Eigen::VectorXd& joint_weights, const Twist& cartesian_weights) const;
+
+  /** @brief Solve position IK with damped Levenberg-Marquardt steps, using the preallocated temporaries of workspace.
+   *  When a step is rejected, only the damping is increased and the factorization of the Jacobian is reused. */
+  int cartToJntDampedLM(IKWorkspace& workspace, const KDL::JntArray& q_init, const KDL::Frame& p_in,
+                        KDL::JntArray& q_out, const unsigned int max_iter, const Eigen::VectorXd& joint_weights,
+                        const Twist& cartesian_weights, bool position_only) const;
+
+  /// Remember a solution for seeding later IK searches, see params_.solution_memory_size
+  void rememberSolution(const KDL::Frame& pose, const KDL::JntArray& solution) const;
+
+  /// Find the remembered solution whose tip pose is nearest to pose. Return false if none is remembered.
+  bool getNearestRememberedSolution(const KDL::Frame& pose, Eigen::VectorXd& jnt_array) const;
+
   void getJointWeights();
   bool timedOut(const rclcpp::Time& start_time, double duration) const;
 
@@ -175,5 +214,14 @@ private:
 
   std::shared_ptr<kdl_kinematics::ParamListener> param_listener_;
   kdl_kinematics::Params params_;
+
+  std::unique_ptr<IKWorkspace> workspace_;     ///< Temporaries of IK searches, reused across calls
+  mutable std::atomic<bool> workspace_in_use_;  ///< Concurrent or nested searches allocate their own workspace
+
+  /// Ring buffer of recent solutions, shared by all searches including those with their own workspace
+  mutable std::vector<std::pair<KDL::Frame, Eigen::VectorXd>> remembered_solutions_;
+  mutable std::size_t num_remembered_solutions_ = 0;
+  mutable std::size_t next_remembered_solution_ = 0;
+  mutable std::mutex solution_memory_mutex_;  ///< Guards the remembered solutions
 };
 }  // namespace kdl_kinematics_plugin
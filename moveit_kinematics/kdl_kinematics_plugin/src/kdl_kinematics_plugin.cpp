@@ -48,9 +48,13 @@
 
 #include <kdl_parser/kdl_parser.hpp>
 #include <kdl/chainfksolverpos_recursive.hpp>
+#include <kdl/chainjnttojacsolver.hpp>
 #include <kdl/frames_io.hpp>
 #include <kdl/kinfam_io.hpp>
 
+#include <Eigen/SVD>
+#include <algorithm>
+
 namespace kdl_kinematics_plugin
 {
 namespace
@@ -63,10 +67,106 @@ rclcpp::Logger getLogger()
 
 static rclcpp::Clock steady_clock = rclcpp::Clock(RCL_ROS_TIME);
 
-KDLKinematicsPlugin::KDLKinematicsPlugin() : initialized_(false)
+struct KDLKinematicsPlugin::IKWorkspace
+{
+  IKWorkspace(unsigned int dimension, unsigned int active_dimension)
+    : jnt_seed_state(dimension)
+    , jnt_pos_in(dimension)
+    , jnt_pos_out(dimension)
+    , delta_q(dimension)
+    , q_backup(dimension)
+    , extra_joint_weights(active_dimension)
+  {
+  }
+
+  // search state
+  KDL::JntArray jnt_seed_state;
+  KDL::JntArray jnt_pos_in;
+  KDL::JntArray jnt_pos_out;
+
+  // pseudo-inverse and damped Levenberg-Marquardt iterations
+  KDL::Frame frame;
+  KDL::JntArray delta_q;
+  KDL::JntArray q_backup;
+  Eigen::ArrayXd extra_joint_weights;
+  std::unique_ptr<KDL::ChainIkSolverVelMimicSVD> ik_solver_vel;
+
+  // damped Levenberg-Marquardt iteration only
+  std::unique_ptr<KDL::ChainJntToJacSolver> jnt_to_jac;
+  KDL::Jacobian jacobian;
+  Eigen::MatrixXd weighted_jacobian;  ///< Jacobian of the active joints, scaled by joint and Cartesian weights
+  Eigen::JacobiSVD<Eigen::MatrixXd> svd;
+  Eigen::VectorXd weighted_error;
+  Eigen::VectorXd projected_error;  ///< U^T * weighted_error, reused for every damping of the same factorization
+  Eigen::VectorXd damped_error;
+  Eigen::VectorXd delta_q_active;
+};
+
+KDLKinematicsPlugin::KDLKinematicsPlugin() : initialized_(false), workspace_in_use_(false)
 {
 }
 
+KDLKinematicsPlugin::~KDLKinematicsPlugin() = default;
+
+std::unique_ptr<KDLKinematicsPlugin::IKWorkspace> KDLKinematicsPlugin::createWorkspace() const
+{
+  const unsigned int active_dimension = joint_weights_.size();
+  const bool position_only = params_.position_only_ik || params_.orientation_vs_position == 0.0;
+  const unsigned int rows = position_only ? 3 : 6;
+
+  auto workspace = std::make_unique<IKWorkspace>(dimension_, active_dimension);
+  workspace->ik_solver_vel = std::make_unique<KDL::ChainIkSolverVelMimicSVD>(kdl_chain_, mimic_joints_, position_only);
+  if (params_.solver_type == "damped_lm")
+  {
+    workspace->jnt_to_jac = std::make_unique<KDL::ChainJntToJacSolver>(kdl_chain_);
+    workspace->jacobian.resize(kdl_chain_.getNrOfJoints());
+    workspace->weighted_jacobian.resize(rows, active_dimension);
+    workspace->svd =
+        Eigen::JacobiSVD<Eigen::MatrixXd>(rows, active_dimension, Eigen::ComputeThinU | Eigen::ComputeThinV);
+    workspace->weighted_error.resize(rows);
+    workspace->projected_error.resize(std::min(rows, active_dimension));
+    workspace->damped_error.resize(std::min(rows, active_dimension));
+    workspace->delta_q_active.resize(active_dimension);
+  }
+  return workspace;
+}
+
+void KDLKinematicsPlugin::rememberSolution(const KDL::Frame& pose, const KDL::JntArray& solution) const
+{
+  std::lock_guard<std::mutex> lock(solution_memory_mutex_);
+  if (remembered_solutions_.empty())
+    return;
+
+  auto& [remembered_pose, remembered_solution] = remembered_solutions_[next_remembered_solution_];
+  remembered_pose = pose;
+  remembered_solution = solution.data;
+  next_remembered_solution_ = (next_remembered_solution_ + 1) % remembered_solutions_.size();
+  num_remembered_solutions_ = std::min(num_remembered_solutions_ + 1, remembered_solutions_.size());
+}
+
+bool KDLKinematicsPlugin::getNearestRememberedSolution(const KDL::Frame& pose, Eigen::VectorXd& jnt_array) const
+{
+  const double orientation_weight = params_.position_only_ik ? 0.0 : params_.orientation_vs_position;
+  std::lock_guard<std::mutex> lock(solution_memory_mutex_);
+  const Eigen::VectorXd* nearest = nullptr;
+  double nearest_distance = DBL_MAX;
+  for (std::size_t i = 0; i < num_remembered_solutions_; ++i)
+  {
+    const KDL::Twist delta = KDL::diff(remembered_solutions_[i].first, pose);
+    const double distance = delta.vel.Norm() + orientation_weight * delta.rot.Norm();
+    if (distance < nearest_distance)
+    {
+      nearest_distance = distance;
+      nearest = &remembered_solutions_[i].second;
+    }
+  }
+  if (!nearest)
+    return false;
+
+  jnt_array = *nearest;
+  return true;
+}
+
 void KDLKinematicsPlugin::getRandomConfiguration(Eigen::VectorXd& jnt_array) const
 {
   state_->setToRandomPositions(joint_model_group_);
@@ -244,6 +344,11 @@ bool KDLKinematicsPlugin::initialize(const rclcpp::Node::SharedPtr& node, const
   state_ = std::make_shared<moveit::core::RobotState>(robot_model_);
 
   fk_solver_ = std::make_unique<KDL::ChainFkSolverPos_recursive>(kdl_chain_);
+  workspace_ = createWorkspace();
+  remembered_solutions_.assign(params_.solution_memory_size,
+                               std::make_pair(KDL::Frame::Identity(), Eigen::VectorXd::Zero(dimension_)));
+  num_remembered_solutions_ = 0;
+  next_remembered_solution_ = 0;
 
   initialized_ = true;
   RCLCPP_DEBUG(getLogger(), "KDL solver initialized");
@@ -349,13 +454,29 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_po
   cartesian_weights.topRows<3>().setConstant(1.0);
   cartesian_weights.bottomRows<3>().setConstant(orientation_vs_position_weight);
 
-  KDL::JntArray jnt_seed_state(dimension_);
-  KDL::JntArray jnt_pos_in(dimension_);
-  KDL::JntArray jnt_pos_out(dimension_);
+  // Reuse the workspace of this instance, unless a concurrent or nested search is using it already
+  std::unique_ptr<IKWorkspace> local_workspace;
+  const bool own_workspace = !workspace_in_use_.exchange(true);
+  if (!own_workspace)
+    local_workspace = createWorkspace();
+  IKWorkspace& workspace = own_workspace ? *workspace_ : *local_workspace;
+  struct WorkspaceRelease
+  {
+    std::atomic<bool>* in_use;
+    ~WorkspaceRelease()
+    {
+      if (in_use)
+        in_use->store(false);
+    }
+  } workspace_release{ own_workspace ? &workspace_in_use_ : nullptr };
+
+  KDL::JntArray& jnt_seed_state = workspace.jnt_seed_state;
+  KDL::JntArray& jnt_pos_in = workspace.jnt_pos_in;
+  KDL::JntArray& jnt_pos_out = workspace.jnt_pos_out;
   jnt_seed_state.data = Eigen::Map<const Eigen::VectorXd>(ik_seed_state.data(), ik_seed_state.size());
   jnt_pos_in = jnt_seed_state;
 
-  KDL::ChainIkSolverVelMimicSVD ik_solver_vel(kdl_chain_, mimic_joints_, orientation_vs_position_weight == 0.0);
+  const bool damped_lm = params_.solver_type == "damped_lm";
   solution.resize(dimension_);
 
   KDL::Frame pose_desired;
@@ -370,7 +491,13 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_po
   do
   {
     ++attempt;
-    if (attempt > 1)  // randomly re-seed after first attempt
+    if (attempt == 2 && consistency_limits_mimic.empty() &&
+        getNearestRememberedSolution(pose_desired, jnt_pos_in.data))
+    {
+      // re-seed from the nearest remembered solution after first attempt
+      RCLCPP_DEBUG_STREAM(getLogger(), "Remembered configuration (" << attempt << "): " << jnt_pos_in);
+    }
+    else if (attempt > 1)  // randomly re-seed after first attempt
     {
       if (!consistency_limits_mimic.empty())
       {
@@ -383,9 +510,13 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_po
       RCLCPP_DEBUG_STREAM(getLogger(), "New random configuration (" << attempt << "): " << jnt_pos_in);
     }
 
-    int ik_valid =
-        CartToJnt(ik_solver_vel, jnt_pos_in, pose_desired, jnt_pos_out, params_.max_solver_iterations,
-                  Eigen::Map<const Eigen::VectorXd>(joint_weights_.data(), joint_weights_.size()), cartesian_weights);
+    const Eigen::Map<const Eigen::VectorXd> joint_weights(joint_weights_.data(), joint_weights_.size());
+    int ik_valid = damped_lm ?
+                       cartToJntDampedLM(workspace, jnt_pos_in, pose_desired, jnt_pos_out,
+                                         params_.max_solver_iterations, joint_weights, cartesian_weights,
+                                         orientation_vs_position_weight == 0.0) :
+                       CartToJnt(workspace, *workspace.ik_solver_vel, jnt_pos_in, pose_desired, jnt_pos_out,
+                                 params_.max_solver_iterations, joint_weights, cartesian_weights);
     if (ik_valid == 0 || options.return_approximate_solution)  // found acceptable solution
     {
       if (!consistency_limits_mimic.empty() &&
@@ -401,6 +532,8 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_po
       }
 
       // solution passed consistency check and solution callback
+      if (ik_valid == 0)
+        rememberSolution(pose_desired, jnt_pos_out);
       error_code.val = error_code.SUCCESS;
       RCLCPP_DEBUG_STREAM(getLogger(), "Solved after " << (steady_clock.now() - start_time).seconds() << " < "
                                                        << timeout << "s and " << attempt << " attempts");
@@ -414,18 +547,60 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_po
   return false;
 }
 
+bool KDLKinematicsPlugin::searchPositionIKBatch(const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                                                const std::vector<std::vector<double>>& ik_seed_states, double timeout,
+                                                std::vector<std::vector<double>>& solutions,
+                                                std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes,
+                                                const kinematics::KinematicsQueryOptions& options) const
+{
+  if (ik_seed_states.size() != 1)
+    return KinematicsBase::searchPositionIKBatch(ik_poses, ik_seed_states, timeout, solutions, error_codes, options);
+
+  solutions.assign(ik_poses.size(), std::vector<double>());
+  error_codes.resize(ik_poses.size());
+
+  // warm-start every pose from the last solution found
+  const std::vector<double>* seed = &ik_seed_states[0];
+  bool all_solved = true;
+  for (std::size_t i = 0; i < ik_poses.size(); ++i)
+  {
+    if (searchPositionIK(ik_poses[i], *seed, timeout, solutions[i], error_codes[i], options))
+    {
+      seed = &solutions[i];
+    }
+    else
+    {
+      solutions[i].clear();
+      all_solved = false;
+    }
+  }
+  return all_solved;
+}
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 int KDLKinematicsPlugin::CartToJnt(KDL::ChainIkSolverVelMimicSVD& ik_solver, const KDL::JntArray& q_init,
                                    const KDL::Frame& p_in, KDL::JntArray& q_out, const unsigned int max_iter,
                                    const Eigen::VectorXd& joint_weights, const Twist& cartesian_weights) const
+{
+  IKWorkspace workspace(q_out.rows(), joint_weights.rows());
+  return CartToJnt(workspace, ik_solver, q_init, p_in, q_out, max_iter, joint_weights, cartesian_weights);
+}
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+int KDLKinematicsPlugin::CartToJnt(IKWorkspace& workspace, KDL::ChainIkSolverVelMimicSVD& ik_solver,
+                                   const KDL::JntArray& q_init, const KDL::Frame& p_in, KDL::JntArray& q_out,
+                                   const unsigned int max_iter, const Eigen::VectorXd& joint_weights,
+                                   const Twist& cartesian_weights) const
 {
   double last_delta_twist_norm = DBL_MAX;
   double step_size = 1.0;
-  KDL::Frame f;
+  KDL::Frame& f = workspace.frame;
   KDL::Twist delta_twist;
-  KDL::JntArray delta_q(q_out.rows()), q_backup(q_out.rows());
-  Eigen::ArrayXd extra_joint_weights(joint_weights.rows());
+  KDL::JntArray& delta_q = workspace.delta_q;
+  KDL::JntArray& q_backup = workspace.q_backup;
+  Eigen::ArrayXd& extra_joint_weights = workspace.extra_joint_weights;
   extra_joint_weights.setOnes();
+  delta_q.data.setZero();
 
   q_out = q_init;
   RCLCPP_DEBUG_STREAM(getLogger(), "Input: " << q_init);
@@ -496,6 +671,108 @@ int KDLKinematicsPlugin::CartToJnt(KDL::ChainIkSolverVelMimicSVD& ik_solver, con
   return result;
 }
 
+int KDLKinematicsPlugin::cartToJntDampedLM(IKWorkspace& workspace, const KDL::JntArray& q_init, const KDL::Frame& p_in,
+                                           KDL::JntArray& q_out, const unsigned int max_iter,
+                                           const Eigen::VectorXd& joint_weights, const Twist& cartesian_weights,
+                                           bool position_only) const
+{
+  static constexpr double MIN_DAMPING = 1e-12;
+  static constexpr double MAX_DAMPING = 1e8;
+
+  const Eigen::Index rows = workspace.weighted_jacobian.rows();
+  KDL::Frame& f = workspace.frame;
+  KDL::JntArray& q_candidate = workspace.q_backup;
+  KDL::JntArray& delta_q = workspace.delta_q;
+  Eigen::MatrixXd& jac = workspace.weighted_jacobian;
+  Eigen::VectorXd& error = workspace.weighted_error;
+  Eigen::VectorXd& projected_error = workspace.projected_error;
+  Eigen::VectorXd& damped_error = workspace.damped_error;
+  Eigen::VectorXd& delta_q_active = workspace.delta_q_active;
+
+  // weighted error of q, returning the larger of the unweighted position and orientation errors
+  auto compute_error = [&](const KDL::JntArray& q, Eigen::VectorXd& weighted_error) {
+    fk_solver_->JntToCart(q, f);
+    const KDL::Twist delta_twist = diff(f, p_in);
+    for (Eigen::Index r = 0; r < rows; ++r)
+      weighted_error[r] = delta_twist[r] * cartesian_weights[r];
+    return std::max(delta_twist.vel.Norm(), position_only ? 0.0 : delta_twist.rot.Norm());
+  };
+
+  q_out = q_init;
+  double error_norm = compute_error(q_out, error);
+  double cost = error.squaredNorm();
+  double damping = params_.lm_initial_damping;
+  bool factorized = false;
+
+  unsigned int i;
+  bool success = false;
+  for (i = 0; i < max_iter; ++i)
+  {
+    if (error_norm <= params_.epsilon)
+    {
+      success = true;
+      break;
+    }
+
+    if (!factorized)
+    {
+      // Jacobian of the active joints, with the columns of mimic joints added onto the joints they follow
+      workspace.jnt_to_jac->JntToJac(q_out, workspace.jacobian);
+      jac.setZero();
+      for (std::size_t j = 0; j < mimic_joints_.size(); ++j)
+        jac.col(mimic_joints_[j].map_index) += mimic_joints_[j].multiplier * workspace.jacobian.data.col(j).head(rows);
+      jac.array().colwise() *= cartesian_weights.head(rows).array();
+      jac.array().rowwise() *= joint_weights.array().transpose();
+
+      workspace.svd.compute(jac);
+      projected_error.noalias() = workspace.svd.matrixU().transpose() * error;
+      factorized = true;
+    }
+
+    // damped least-squares step: V * diag(s / (s^2 + damping)) * U^T * error
+    const Eigen::VectorXd& singular_values = workspace.svd.singularValues();
+    damped_error.array() =
+        singular_values.array() / (singular_values.array().square() + damping) * projected_error.array();
+    delta_q_active.noalias() = workspace.svd.matrixV() * damped_error;
+    delta_q_active.array() *= joint_weights.array();
+
+    for (std::size_t j = 0; j < mimic_joints_.size(); ++j)
+    {
+      delta_q(j) = delta_q_active[mimic_joints_[j].map_index] * mimic_joints_[j].multiplier;
+      q_candidate(j) = std::clamp(q_out(j) + delta_q(j), joint_min_(j), joint_max_(j));
+    }
+
+    double candidate_error_norm = compute_error(q_candidate, error);
+    double candidate_cost = error.squaredNorm();
+    if (candidate_cost < cost)
+    {
+      // accept the step, and trust the linearization more
+      const double step_norm = (q_candidate.data - q_out.data).lpNorm<1>();
+      q_out = q_candidate;
+      error_norm = candidate_error_norm;
+      cost = candidate_cost;
+      damping = std::max(0.1 * damping, MIN_DAMPING);
+      factorized = false;
+      if (step_norm < params_.epsilon && error_norm > params_.epsilon)  // stuck in local minimum
+        break;
+    }
+    else
+    {
+      // reject the step, and retry with more damping on the same factorization.
+      // error is only needed again to factorize after an accepted step, which overwrites it.
+      damping *= 10.0;
+      if (damping > MAX_DAMPING)  // cannot reduce the error any further
+        break;
+    }
+    RCLCPP_DEBUG(getLogger(), "[%3d] err: %f  damping: %g", i, error_norm, damping);
+  }
+
+  int result = (i == max_iter) ? -3 : (success ? 0 : -2);
+  RCLCPP_DEBUG_STREAM(getLogger(), "Result " << result << " after " << i << " iterations: " << q_out);
+
+  return result;
+}
+
 void KDLKinematicsPlugin::clipToJointLimits(const KDL::JntArray& q, KDL::JntArray& q_delta,
                                             Eigen::ArrayXd& weighting) const
 {
@@ -34,9 +34,12 @@
 
 /* Author: Mark Moll */
 
+#include <algorithm>
 #include <chrono>
 #include <rclcpp/rclcpp.hpp>
 #include <boost/program_options.hpp>
+#include <tf2_eigen/tf2_eigen.hpp>
+#include <moveit/kinematics_base/batch_ik_solver.hpp>
 #include <moveit/robot_model_loader/robot_model_loader.hpp>
 #include <moveit/planning_scene/planning_scene.hpp>
 #include <moveit/utils/robot_model_test_utils.hpp>
@@ -44,12 +47,94 @@
 
 namespace po = boost::program_options;
 
+// Measure the throughput of solving IK for batches of random poses with the batch IK API
+void benchmarkBatchIK(const rclcpp::Node::SharedPtr& node, planning_scene::PlanningScene& planning_scene,
+                      const moveit::core::JointModelGroup* group, unsigned int num, unsigned int batch_size,
+                      unsigned int threads, bool reset_to_default)
+{
+  const kinematics::KinematicsBaseConstPtr solver = group->getSolverInstance();
+  if (solver->getTipFrames().size() != 1)
+  {
+    RCLCPP_WARN_STREAM(node->get_logger(),
+                       "Batch IK only supports single-tip solvers, but group '" << group->getName() << "' has "
+                                                                                << solver->getTipFrames().size()
+                                                                                << " tips - skipping");
+    return;
+  }
+
+  kinematics::BatchIKSolver batch_solver(group, threads);
+  if (batch_solver.getThreadCount() == 0)
+    return;
+
+  moveit::core::RobotState& robot_state = planning_scene.getCurrentStateNonConst();
+  collision_detection::CollisionRequest collision_request;
+  collision_detection::CollisionResult collision_result;
+  const std::vector<size_t>& bijection = group->getKinematicsSolverJointBijection();
+
+  // IK poses are expressed in the base frame of the solver, and seeds are in the joint order of the solver
+  auto solver_seed = [&] {
+    std::vector<double> group_values, seed(bijection.size());
+    robot_state.copyJointGroupPositions(group, group_values);
+    for (std::size_t j = 0; j < bijection.size(); ++j)
+      seed[j] = group_values[bijection[j]];
+    return seed;
+  };
+  robot_state.setToDefaultValues();
+  const std::vector<double> default_seed = solver_seed();
+
+  std::vector<geometry_msgs::msg::Pose> poses;
+  std::vector<std::vector<double>> seeds, solutions;
+  std::vector<moveit_msgs::msg::MoveItErrorCodes> error_codes;
+  std::chrono::duration<double> ik_time(0);
+  unsigned int i = 0, num_failed_calls = 0, num_self_collisions = 0;
+  while (i < num)
+  {
+    poses.clear();
+    seeds.clear();
+    while (poses.size() < std::min(batch_size, num - i))
+    {
+      robot_state.setToRandomPositions(group);
+      collision_result.clear();
+      planning_scene.checkSelfCollision(collision_request, collision_result);
+      if (collision_result.collision)
+      {
+        ++num_self_collisions;
+        continue;
+      }
+      poses.push_back(tf2::toMsg(robot_state.getGlobalLinkTransform(solver->getBaseFrame()).inverse() *
+                                 robot_state.getGlobalLinkTransform(solver->getTipFrame())));
+      if (!reset_to_default)
+        seeds.push_back(solver_seed());
+    }
+    if (reset_to_default)
+      seeds.assign(1, default_seed);
+
+    auto start = std::chrono::system_clock::now();
+    batch_solver.searchPositionIK(poses, seeds, 0.1, solutions, error_codes);
+    ik_time += std::chrono::system_clock::now() - start;
+
+    num_failed_calls += std::count_if(error_codes.begin(), error_codes.end(), [](const auto& error_code) {
+      return error_code.val != moveit_msgs::msg::MoveItErrorCodes::SUCCESS;
+    });
+    i += poses.size();
+    RCLCPP_INFO(node->get_logger(),
+                "%g IK solutions per second on %zu threads after %d calls. %g%% of calls failed to return a solution. "
+                "%g%% of random joint configurations were ignored due to self-collisions.",
+                i / ik_time.count(), batch_solver.getThreadCount(), i, 100. * num_failed_calls / i,
+                100. * num_self_collisions / (num_self_collisions + i));
+  }
+  RCLCPP_INFO(node->get_logger(), "Summary for group %s: %g %g %g", group->getName().c_str(), i / ik_time.count(),
+              100. * num_failed_calls / i, 100. * num_self_collisions / (num_self_collisions + i));
+}
+
 // Benchmark program measuring time to solve inverse kinematics of robot described in robot_description
 int main(int argc, char* argv[])
 {
   std::string group;
   std::string tip;
   unsigned int num;
+  unsigned int batch_size;
+  unsigned int threads;
   bool reset_to_default;
   po::options_description desc("Options");
   // clang-format off
@@ -60,7 +145,12 @@ int main(int argc, char* argv[])
       ("num", po::value<unsigned int>(&num)->default_value(100000), "number of IK solutions to compute")
       ("reset_to_default", po::value<bool>(&reset_to_default)->default_value(true),
        "whether to reset IK seed to default state. If set to false, the seed is the "
-       "correct IK solution (to accelerate filling the cache).");
+       "correct IK solution (to accelerate filling the cache).")
+      ("batch_size", po::value<unsigned int>(&batch_size)->default_value(0),
+       "number of poses per batch IK call. If non-zero, the throughput of the batch IK API is measured "
+       "instead of the time per IK solver call.")
+      ("threads", po::value<unsigned int>(&threads)->default_value(0),
+       "number of threads to solve batches on, 0 for one per hardware thread");
   // clang-format on
 
   po::variables_map vm;
@@ -135,6 +225,12 @@ int main(int argc, char* argv[])
       robot_state.setFromIK(group, default_eef_states, end_effectors, 0.1);
     }
 
+    if (batch_size > 0)
+    {
+      benchmarkBatchIK(node, planning_scene, group, num, batch_size, threads, reset_to_default);
+      continue;
+    }
+
     bool found_ik;
     unsigned int num_failed_calls = 0, num_self_collisions = 0;
     EigenSTL::vector_Isometry3d end_effector_states(end_effectors.size());
@@ -0,0 +1,116 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Description: Compare the IK iterations of the KDL kinematics plugin on the panda arm */
+
+#include <chrono>
+#include <random_numbers/random_numbers.h>
+#include <rclcpp/rclcpp.hpp>
+#include <tf2_eigen/tf2_eigen.hpp>
+#include <moveit/kdl_kinematics_plugin/kdl_kinematics_plugin.hpp>
+#include <moveit/robot_model/robot_model.hpp>
+#include <moveit/robot_state/robot_state.hpp>
+#include <moveit/utils/robot_model_test_utils.hpp>
+
+namespace
+{
+const std::string GROUP = "panda_arm";
+const std::string BASE_LINK = "panda_link0";
+const std::string TIP_LINK = "panda_link8";
+constexpr std::size_t NUM_POSES = 1000;
+constexpr double TIMEOUT = 0.1;
+
+// Solve IK for random reachable poses, seeded from the default state (like benchmark_ik's reset_to_default)
+void solveRandomPoses(const rclcpp::Logger& logger, const moveit::core::RobotModelPtr& robot_model,
+                      const std::string& solver_type, int solution_memory_size)
+{
+  rclcpp::NodeOptions node_options;
+  node_options.parameter_overrides({ { "robot_description_kinematics." + GROUP + ".solver_type", solver_type },
+                                     { "robot_description_kinematics." + GROUP + ".solution_memory_size",
+                                       solution_memory_size } });
+  const auto node = rclcpp::Node::make_shared("benchmark_kdl_ik_" + solver_type, node_options);
+
+  kdl_kinematics_plugin::KDLKinematicsPlugin solver;
+  if (!solver.initialize(node, *robot_model, GROUP, BASE_LINK, { TIP_LINK }, 0.0))
+  {
+    RCLCPP_ERROR(logger, "Failed to initialize the KDL kinematics plugin with solver_type '%s'", solver_type.c_str());
+    return;
+  }
+
+  const moveit::core::JointModelGroup* jmg = robot_model->getJointModelGroup(GROUP);
+  moveit::core::RobotState state(robot_model);
+  state.setToDefaultValues();
+  std::vector<double> seed;
+  state.copyJointGroupPositions(jmg, seed);
+
+  // Fixed poses, so that all iterations solve the same problems
+  random_numbers::RandomNumberGenerator rng(42);
+  std::vector<geometry_msgs::msg::Pose> poses;
+  poses.reserve(NUM_POSES);
+  for (std::size_t i = 0; i < NUM_POSES; ++i)
+  {
+    state.setToRandomPositions(jmg, rng);
+    state.updateLinkTransforms();
+    poses.push_back(tf2::toMsg(state.getGlobalLinkTransform(TIP_LINK)));
+  }
+
+  std::vector<double> solution;
+  moveit_msgs::msg::MoveItErrorCodes error_code;
+  std::size_t num_solved = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const geometry_msgs::msg::Pose& pose : poses)
+  {
+    if (solver.searchPositionIK(pose, seed, TIMEOUT, solution, error_code))
+      ++num_solved;
+  }
+  const std::chrono::duration<double, std::micro> ik_time = std::chrono::steady_clock::now() - start;
+  RCLCPP_INFO(logger, "%s (solution_memory_size %d): %g us per IK call, %g%% of calls returned a solution",
+              solver_type.c_str(), solution_memory_size, ik_time.count() / NUM_POSES,
+              100. * num_solved / NUM_POSES);
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  rclcpp::init(argc, argv);
+  const rclcpp::Logger logger = rclcpp::get_logger("benchmark_kdl_ik");
+  const moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("panda");
+
+  solveRandomPoses(logger, robot_model, "svd", 0);
+  solveRandomPoses(logger, robot_model, "damped_lm", 0);
+  solveRandomPoses(logger, robot_model, "damped_lm", 16);
+
+  rclcpp::shutdown();
+  return 0;
+}
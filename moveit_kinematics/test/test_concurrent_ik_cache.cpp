@@ -0,0 +1,243 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <moveit/cached_ik_kinematics_plugin/cached_ik_kinematics_plugin.hpp>
+
+using cached_ik_kinematics_plugin::ConcurrentIKCache;
+using cached_ik_kinematics_plugin::IKCache;
+
+namespace
+{
+constexpr unsigned int NUM_JOINTS = 3;
+
+IKCache::Pose randomPose(std::mt19937& generator)
+{
+  std::uniform_real_distribution<double> position(-1.0, 1.0);
+  std::normal_distribution<double> orientation;
+  IKCache::Pose pose;
+  pose.position.setValue(position(generator), position(generator), position(generator));
+  pose.orientation = tf2::Quaternion(orientation(generator), orientation(generator), orientation(generator),
+                                     orientation(generator))
+                         .normalized();
+  return pose;
+}
+
+class ConcurrentIKCacheTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    opts_.cached_ik_path = (std::filesystem::temp_directory_path() / "test_concurrent_ik_cache").string();
+    std::filesystem::remove_all(opts_.cached_ik_path);
+    opts_.max_cache_size = 100000;
+    // accept every entry, so the cache contents are known
+    opts_.min_pose_distance = -1.0;
+    opts_.min_joint_config_distance = 0.0;
+  }
+
+  void TearDown() override
+  {
+    std::filesystem::remove_all(opts_.cached_ik_path);
+  }
+
+  /** insert random entries; the first joint value is the index of the entry */
+  void fill(ConcurrentIKCache& cache, std::size_t num_entries)
+  {
+    for (std::size_t i = 0; i < num_entries; ++i)
+    {
+      IKCache::Pose pose = randomPose(generator_);
+      std::vector<double> config(NUM_JOINTS, 0.0);
+      config[0] = static_cast<double>(entries_.size());
+      cache.updateCache(cache.getBestApproximateIKSolution(pose), pose, config);
+      entries_.emplace_back(std::vector<IKCache::Pose>(1, pose), config);
+    }
+    cache.flush();
+  }
+
+  /** check lookups against a linear scan */
+  void expectNearest(const ConcurrentIKCache& cache, std::size_t num_queries)
+  {
+    for (std::size_t i = 0; i < num_queries; ++i)
+    {
+      IKCache::Pose query = randomPose(generator_);
+      double best = std::numeric_limits<double>::infinity();
+      for (const auto& entry : entries_)
+        best = std::min(best, entry.first[0].distance(query));
+
+      IKCache::IKEntry nearest = cache.getBestApproximateIKSolution(query);
+      ASSERT_EQ(nearest.second.size(), NUM_JOINTS);
+      EXPECT_NEAR(nearest.first[0].distance(query), best, 1e-9);
+    }
+  }
+
+  IKCache::Options opts_;
+  std::mt19937 generator_{ 42 };
+  std::vector<IKCache::IKEntry> entries_;
+};
+}  // namespace
+
+TEST_F(ConcurrentIKCacheTest, EmptyCache)
+{
+  ConcurrentIKCache cache;
+  cache.initializeCache("robot", "group", "tip", NUM_JOINTS, opts_);
+  EXPECT_EQ(cache.size(), 0u);
+
+  IKCache::Pose pose = randomPose(generator_);
+  IKCache::IKEntry nearest = cache.getBestApproximateIKSolution(pose);
+  EXPECT_EQ(nearest.second, std::vector<double>(NUM_JOINTS, 0.0));
+}
+
+TEST_F(ConcurrentIKCacheTest, NearestNeighbor)
+{
+  ConcurrentIKCache cache;
+  cache.initializeCache("robot", "group", "tip", NUM_JOINTS, opts_);
+  // several batches, so that lookups go through multiple blocks
+  for (int i = 0; i < 5; ++i)
+  {
+    fill(cache, 700);
+    expectNearest(cache, 50);
+  }
+  EXPECT_EQ(cache.size(), entries_.size());
+}
+
+TEST_F(ConcurrentIKCacheTest, MaxCacheSize)
+{
+  opts_.max_cache_size = 100;
+  ConcurrentIKCache cache;
+  cache.initializeCache("robot", "group", "tip", NUM_JOINTS, opts_);
+  fill(cache, 300);
+  EXPECT_EQ(cache.size(), 100u);
+}
+
+TEST_F(ConcurrentIKCacheTest, DuplicatesInOneBatch)
+{
+  opts_.min_pose_distance = 0.1;
+  opts_.min_joint_config_distance = 0.1;
+  ConcurrentIKCache cache;
+  cache.initializeCache("robot", "group", "tip", NUM_JOINTS, opts_);
+
+  // all copies are compared with the empty cache, and most end up in the same insertion batch
+  const IKCache::Pose pose = randomPose(generator_);
+  const std::vector<double> config(NUM_JOINTS, 0.5);
+  const IKCache::IKEntry nearest = cache.getBestApproximateIKSolution(pose);
+  for (int i = 0; i < 100; ++i)
+    cache.updateCache(nearest, pose, config);
+  cache.flush();
+  EXPECT_EQ(cache.size(), 1u);
+}
+
+TEST_F(ConcurrentIKCacheTest, LookupsDuringInsertion)
+{
+  ConcurrentIKCache cache;
+  cache.initializeCache("robot", "group", "tip", NUM_JOINTS, opts_);
+
+  std::atomic<bool> done(false);
+  std::atomic<std::size_t> num_lookups(0);
+  std::vector<std::thread> readers;
+  for (unsigned int t = 0; t < 4; ++t)
+  {
+    readers.emplace_back([&cache, &done, &num_lookups, t] {
+      std::mt19937 generator(t);
+      while (!done)
+      {
+        IKCache::IKEntry nearest = cache.getBestApproximateIKSolution(randomPose(generator));
+        EXPECT_EQ(nearest.second.size(), NUM_JOINTS);
+        ++num_lookups;
+      }
+    });
+  }
+  fill(cache, 5000);
+  done = true;
+  for (auto& reader : readers)
+    reader.join();
+
+  EXPECT_GT(num_lookups, 0u);
+  EXPECT_EQ(cache.size(), entries_.size());
+  expectNearest(cache, 50);
+}
+
+TEST_F(ConcurrentIKCacheTest, SaveAndMap)
+{
+  {
+    ConcurrentIKCache cache;
+    cache.initializeCache("robot", "group", "tip", NUM_JOINTS, opts_);
+    fill(cache, 2000);
+  }
+
+  ConcurrentIKCache cache;
+  cache.initializeCache("robot", "group", "tip", NUM_JOINTS, opts_);
+  EXPECT_TRUE(std::filesystem::exists(cache.getCacheFileName()));
+  EXPECT_EQ(cache.size(), entries_.size());
+  expectNearest(cache, 50);
+
+  // the mapped block stays in use as entries are added
+  fill(cache, 100);
+  EXPECT_EQ(cache.size(), entries_.size());
+  expectNearest(cache, 50);
+}
+
+TEST_F(ConcurrentIKCacheTest, ImportLegacyCache)
+{
+  {
+    IKCache cache;
+    cache.initializeCache("robot", "group", "tip", NUM_JOINTS, opts_);
+    for (std::size_t i = 0; i < 200; ++i)
+    {
+      IKCache::Pose pose = randomPose(generator_);
+      std::vector<double> config(NUM_JOINTS, static_cast<double>(i));
+      cache.updateCache(cache.getBestApproximateIKSolution(pose), pose, config);
+      entries_.emplace_back(std::vector<IKCache::Pose>(1, pose), config);
+    }
+  }
+
+  ConcurrentIKCache cache;
+  cache.initializeCache("robot", "group", "tip", NUM_JOINTS, opts_);
+  EXPECT_EQ(cache.size(), entries_.size());
+  expectNearest(cache, 50);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
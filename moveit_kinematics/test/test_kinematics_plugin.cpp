@@ -44,6 +44,7 @@
 #include <tf2_eigen/tf2_eigen.hpp>
 
 // MoveIt
+#include <moveit/kinematics_base/batch_ik_solver.hpp>
 #include <moveit/kinematics_base/kinematics_base.hpp>
 #include <moveit/rdf_loader/rdf_loader.hpp>
 #include <moveit/robot_model/robot_model.hpp>
@@ -584,6 +585,66 @@ TEST_F(KinematicsTest, searchIK)
   EXPECT_GE(success, EXPECTED_SUCCESS_RATE * num_ik_tests_);
 }
 
+TEST_F(KinematicsTest, searchIKBatch)
+{
+  const std::vector<std::string>& fk_names = kinematics_solver_->getTipFrames();
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+
+  std::vector<geometry_msgs::msg::Pose> poses;
+  std::vector<double> fk_values;
+  for (unsigned int i = 0; i < num_ik_tests_; ++i)
+  {
+    robot_state.setToRandomPositions(jmg_, this->rng_);
+    robot_state.copyJointGroupPositions(jmg_, fk_values);
+    std::vector<geometry_msgs::msg::Pose> fk_poses;
+    ASSERT_TRUE(kinematics_solver_->getPositionFK(fk_names, fk_values, fk_poses));
+    poses.push_back(fk_poses[0]);
+  }
+
+  const std::vector<std::vector<double>> seeds(1, std::vector<double>(kinematics_solver_->getJointNames().size(), 0.0));
+  auto validate_batch = [&](const std::vector<std::vector<double>>& solutions,
+                            const std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes) {
+    ASSERT_EQ(solutions.size(), poses.size());
+    ASSERT_EQ(error_codes.size(), poses.size());
+    unsigned int success = 0;
+    for (std::size_t i = 0; i < poses.size(); ++i)
+    {
+      if (error_codes[i].val != moveit_msgs::msg::MoveItErrorCodes::SUCCESS)
+      {
+        EXPECT_TRUE(solutions[i].empty());
+        continue;
+      }
+      success++;
+      const std::vector<geometry_msgs::msg::Pose> target_poses(1, poses[i]);
+      std::vector<geometry_msgs::msg::Pose> reached_poses;
+      kinematics_solver_->getPositionFK(fk_names, solutions[i], reached_poses);
+      EXPECT_NEAR_POSES(target_poses, reached_poses, tolerance_);
+    }
+    EXPECT_GE(success, EXPECTED_SUCCESS_RATE * poses.size());
+  };
+
+  std::vector<std::vector<double>> solutions;
+  std::vector<moveit_msgs::msg::MoveItErrorCodes> error_codes;
+  kinematics_solver_->searchPositionIKBatch(poses, seeds, timeout_, solutions, error_codes);
+  validate_batch(solutions, error_codes);
+
+  // solve the same batch on per-thread solver instances
+  kinematics::BatchIKSolver batch_solver(
+      [this]() -> kinematics::KinematicsBasePtr {
+        kinematics::KinematicsBasePtr solver = SharedData::instance().createUniqueInstance(ik_plugin_name_);
+        if (!solver->initialize(node_, *robot_model_, group_name_, root_link_, { tip_link_ },
+                                DEFAULT_SEARCH_DISCRETIZATION))
+          return nullptr;
+        return solver;
+      },
+      4);
+  ASSERT_EQ(batch_solver.getThreadCount(), 4u);
+  batch_solver.setMinPosesPerThread(1);
+  batch_solver.searchPositionIK(poses, seeds, timeout_, solutions, error_codes);
+  validate_batch(solutions, error_codes);
+}
+
 TEST_F(KinematicsTest, searchIKWithCallback)
 {
   std::vector<double> seed, fk_values, solution;
@@ -43,20 +43,75 @@
 #include <moveit/robot_state/robot_state.hpp>
 #include <moveit/robot_model/joint_model_group.hpp>
 
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
 namespace ompl_interface
 {
 class ModelBasedPlanningContext;
 
 /** @class ConstrainedGoalSampler
- *  An interface to the OMPL goal lazy sampler*/
+ *  An interface to the OMPL goal lazy sampler.
+ *
+ *  With more than one sampling thread, each thread draws goals from its own clone of the
+ *  constraint sampler and pushes them into a lock-free queue that the OMPL sampling thread
+ *  drains. If the constraint sampler cannot be cloned, sampling stays on the OMPL thread. */
 class ConstrainedGoalSampler : public ompl::base::GoalLazySamples
 {
 public:
   ConstrainedGoalSampler(const ModelBasedPlanningContext* pc, kinematic_constraints::KinematicConstraintSetPtr ks,
-                         constraint_samplers::ConstraintSamplerPtr cs = constraint_samplers::ConstraintSamplerPtr());
+                         constraint_samplers::ConstraintSamplerPtr cs = constraint_samplers::ConstraintSamplerPtr(),
+                         unsigned int sampling_threads = 1);
+
+  ~ConstrainedGoalSampler() override;
+
+  /** \brief Start the sampler threads and the OMPL sampling thread. This hides the non-virtual
+      ompl::base::GoalLazySamples::startSampling(), so it must be called on this type. */
+  void startSampling();
+
+  /** \brief Stop the OMPL sampling thread and join the sampler threads */
+  void stopSampling();
+
+  /** \brief Get the number of threads drawing samples from the constraint sampler */
+  unsigned int getSamplingThreadCount() const
+  {
+    return worker_samplers_.empty() ? 1 : worker_samplers_.size();
+  }
 
 private:
+  /** \brief Bounded lock-free multi-producer multi-consumer queue of goal states */
+  class GoalQueue
+  {
+  public:
+    GoalQueue(ompl::base::SpaceInformationPtr si, std::size_t capacity);
+    ~GoalQueue();
+
+    /** \brief Copy \e state into the queue; returns false if the queue is full */
+    bool push(const ompl::base::State* state);
+
+    /** \brief Copy the oldest state of the queue into \e state; returns false if the queue is empty */
+    bool pop(ompl::base::State* state);
+
+  private:
+    struct Slot
+    {
+      std::atomic<std::size_t> sequence;
+      ompl::base::State* state;
+    };
+
+    ompl::base::SpaceInformationPtr si_;
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t mask_;
+    std::atomic<std::size_t> enqueue_position_;
+    std::atomic<std::size_t> dequeue_position_;
+  };
+
   bool sampleUsingConstraintSampler(const ompl::base::GoalLazySamples* gls, ompl::base::State* new_goal);
+  bool takeSampledGoal(const ompl::base::GoalLazySamples* gls, ompl::base::State* new_goal);
+  void sampleInThread(const constraint_samplers::ConstraintSamplerPtr& sampler);
+  void joinSamplingThreads();
   bool stateValidityCallback(ompl::base::State* new_goal, const moveit::core::RobotState* state,
                              const moveit::core::JointModelGroup* /*jmg*/, const double* /*jpos*/,
                              bool verbose = false) const;
@@ -71,5 +126,12 @@ private:
   unsigned int invalid_sampled_constraints_;
   bool warned_invalid_samples_;
   unsigned int verbose_display_;
+
+  std::vector<constraint_samplers::ConstraintSamplerPtr> worker_samplers_;
+  std::vector<std::thread> workers_;
+  std::unique_ptr<GoalQueue> goal_queue_;
+  std::atomic<bool> stop_workers_;
+  std::atomic<unsigned int> running_workers_;
+  std::atomic<unsigned int> worker_attempts_;
 };
 }  // namespace ompl_interface
@@ -39,6 +39,8 @@
 #include <moveit/ompl_interface/detail/state_validity_checker.hpp>
 #include <moveit/utils/logger.hpp>
 
+#include <cassert>
+#include <chrono>
 #include <utility>
 
 namespace ompl_interface
@@ -49,11 +51,80 @@ rclcpp::Logger getLogger()
 {
   return moveit::getLogger("moveit.planners.ompl.constrained_goal_sampler");
 }
+
+// number of goals the sampler threads can queue ahead of the OMPL sampling thread; a power of two
+constexpr std::size_t GOAL_QUEUE_CAPACITY = 64;
 }  // namespace
 
+ConstrainedGoalSampler::GoalQueue::GoalQueue(ompl::base::SpaceInformationPtr si, std::size_t capacity)
+  : si_(std::move(si)), slots_(new Slot[capacity]), mask_(capacity - 1), enqueue_position_(0), dequeue_position_(0)
+{
+  assert((capacity & mask_) == 0);
+  for (std::size_t i = 0; i < capacity; ++i)
+  {
+    slots_[i].sequence.store(i, std::memory_order_relaxed);
+    slots_[i].state = si_->allocState();
+  }
+}
+
+ConstrainedGoalSampler::GoalQueue::~GoalQueue()
+{
+  for (std::size_t i = 0; i <= mask_; ++i)
+    si_->freeState(slots_[i].state);
+}
+
+bool ConstrainedGoalSampler::GoalQueue::push(const ompl::base::State* state)
+{
+  std::size_t position = enqueue_position_.load(std::memory_order_relaxed);
+  Slot* slot;
+  while (true)
+  {
+    slot = &slots_[position & mask_];
+    const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+    if (difference == 0)
+    {
+      if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (difference < 0)
+      return false;  // full
+    else
+      position = enqueue_position_.load(std::memory_order_relaxed);
+  }
+  si_->copyState(slot->state, state);
+  slot->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+bool ConstrainedGoalSampler::GoalQueue::pop(ompl::base::State* state)
+{
+  std::size_t position = dequeue_position_.load(std::memory_order_relaxed);
+  Slot* slot;
+  while (true)
+  {
+    slot = &slots_[position & mask_];
+    const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+    if (difference == 0)
+    {
+      if (dequeue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (difference < 0)
+      return false;  // empty
+    else
+      position = dequeue_position_.load(std::memory_order_relaxed);
+  }
+  si_->copyState(state, slot->state);
+  slot->sequence.store(position + mask_ + 1, std::memory_order_release);
+  return true;
+}
+
 ConstrainedGoalSampler::ConstrainedGoalSampler(const ModelBasedPlanningContext* pc,
                                                kinematic_constraints::KinematicConstraintSetPtr ks,
-                                               constraint_samplers::ConstraintSamplerPtr cs)
+                                               constraint_samplers::ConstraintSamplerPtr cs,
+                                               unsigned int sampling_threads)
   : ob::GoalLazySamples(
         pc->getOMPLSimpleSetup()->getSpaceInformation(),
         [this](const GoalLazySamples* gls, ompl::base::State* state) {
@@ -67,13 +138,74 @@ ConstrainedGoalSampler::ConstrainedGoalSampler(const ModelBasedPlanningContext*
   , invalid_sampled_constraints_(0)
   , warned_invalid_samples_(false)
   , verbose_display_(0)
+  , stop_workers_(false)
+  , running_workers_(0)
+  , worker_attempts_(0)
 {
   if (!constraint_sampler_)
     default_sampler_ = si_->allocStateSampler();
+  else if (sampling_threads > 1)
+  {
+    // samplers are not thread-safe, so every thread gets a copy of its own
+    worker_samplers_.push_back(constraint_sampler_);
+    while (worker_samplers_.size() < sampling_threads)
+    {
+      constraint_samplers::ConstraintSamplerPtr clone = constraint_sampler_->clone();
+      if (!clone)
+      {
+        RCLCPP_WARN(getLogger(),
+                    "Constraint sampler '%s' cannot be cloned; sampling goals with %zu threads instead of %u",
+                    constraint_sampler_->getName().c_str(), worker_samplers_.size(), sampling_threads);
+        break;
+      }
+      worker_samplers_.push_back(clone);
+    }
+
+    // a single sampler thread is no better than sampling on the OMPL thread
+    if (worker_samplers_.size() < 2)
+      worker_samplers_.clear();
+    else
+      goal_queue_ = std::make_unique<GoalQueue>(si_, GOAL_QUEUE_CAPACITY);
+  }
   RCLCPP_DEBUG(getLogger(), "Constructed a ConstrainedGoalSampler instance at address %p", this);
   startSampling();
 }
 
+ConstrainedGoalSampler::~ConstrainedGoalSampler()
+{
+  stopSampling();
+}
+
+void ConstrainedGoalSampler::startSampling()
+{
+  // the sampler threads are only (re)started along with the OMPL sampling thread
+  if (!worker_samplers_.empty() && !isSampling())
+  {
+    joinSamplingThreads();
+    stop_workers_ = false;
+    // the attempts of a previous run do not count against this one
+    worker_attempts_ = 0;
+    running_workers_ = worker_samplers_.size();
+    for (const constraint_samplers::ConstraintSamplerPtr& sampler : worker_samplers_)
+      workers_.emplace_back([this, sampler] { sampleInThread(sampler); });
+  }
+  GoalLazySamples::startSampling();
+}
+
+void ConstrainedGoalSampler::stopSampling()
+{
+  stop_workers_ = true;
+  GoalLazySamples::stopSampling();
+  joinSamplingThreads();
+}
+
+void ConstrainedGoalSampler::joinSamplingThreads()
+{
+  for (std::thread& worker : workers_)
+    worker.join();
+  workers_.clear();
+}
+
 bool ConstrainedGoalSampler::checkStateValidity(ob::State* new_goal, const moveit::core::RobotState& state,
                                                 bool verbose) const
 {
@@ -110,6 +242,9 @@ bool ConstrainedGoalSampler::sampleUsingConstraintSampler(const ob::GoalLazySamp
   if (planning_context_->getOMPLSimpleSetup()->getProblemDefinition()->hasSolution())
     return false;
 
+  if (goal_queue_)
+    return takeSampledGoal(gls, new_goal);
+
   unsigned int max_attempts_div2 = max_attempts / 2;
   for (unsigned int a = gls->samplingAttemptsCount(); a < max_attempts && gls->isSampling(); ++a)
   {
@@ -169,4 +304,51 @@ bool ConstrainedGoalSampler::sampleUsingConstraintSampler(const ob::GoalLazySamp
   return false;
 }
 
+bool ConstrainedGoalSampler::takeSampledGoal(const ob::GoalLazySamples* gls, ob::State* new_goal)
+{
+  while (gls->isSampling())
+  {
+    // read this before looking at the queue, so goals pushed by the last thread are not missed
+    const bool workers_done = running_workers_ == 0;
+    if (goal_queue_->pop(new_goal))
+      return true;
+    if (workers_done)
+      return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return false;
+}
+
+void ConstrainedGoalSampler::sampleInThread(const constraint_samplers::ConstraintSamplerPtr& sampler)
+{
+  const unsigned int max_attempts = planning_context_->getMaximumGoalSamplingAttempts();
+  const unsigned int max_state_sampling_attempts = planning_context_->getMaximumStateSamplingAttempts();
+  const ompl::base::ProblemDefinitionPtr& pdef = planning_context_->getOMPLSimpleSetup()->getProblemDefinition();
+
+  moveit::core::RobotState work_state(planning_context_->getCompleteInitialRobotState());
+  ob::State* new_goal = si_->allocState();
+  sampler->setGroupStateValidityCallback(
+      [this, new_goal](moveit::core::RobotState* robot_state, const moveit::core::JointModelGroup* joint_group,
+                       const double* joint_group_variable_values) {
+        return stateValidityCallback(new_goal, robot_state, joint_group, joint_group_variable_values);
+      });
+
+  // the attempts of all threads count towards the same limit
+  while (!stop_workers_ && samplingAttemptsCount() + worker_attempts_++ < max_attempts &&
+         getStateCount() < planning_context_->getMaximumGoalSamples() && !pdef->hasSolution())
+  {
+    if (!sampler->sample(work_state, max_state_sampling_attempts))
+      continue;
+    work_state.update();
+    if (!kinematic_constraint_set_->decide(work_state).satisfied || !checkStateValidity(new_goal, work_state))
+      continue;
+
+    while (!goal_queue_->push(new_goal) && !stop_workers_)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  si_->freeState(new_goal);
+  --running_workers_;
+}
+
 }  // namespace ompl_interface
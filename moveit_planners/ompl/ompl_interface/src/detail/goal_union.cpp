@@ -35,6 +35,7 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/ompl_interface/detail/goal_union.hpp>
+#include <moveit/ompl_interface/detail/constrained_goal_sampler.hpp>
 #include <ompl/base/goals/GoalLazySamples.h>
 
 namespace
@@ -66,7 +67,11 @@ void ompl_interface::GoalSampleableRegionMux::startSampling()
 {
   for (ompl::base::GoalPtr& goal : goals_)
   {
-    if (goal->hasType(ompl::base::GOAL_LAZY_SAMPLES))
+    if (!goal->hasType(ompl::base::GOAL_LAZY_SAMPLES))
+      continue;
+    if (auto sampler = dynamic_cast<ConstrainedGoalSampler*>(goal.get()))
+      sampler->startSampling();
+    else
       static_cast<ompl::base::GoalLazySamples*>(goal.get())->startSampling();
   }
 }
@@ -75,7 +80,11 @@ void ompl_interface::GoalSampleableRegionMux::stopSampling()
 {
   for (ompl::base::GoalPtr& goal : goals_)
   {
-    if (goal->hasType(ompl::base::GOAL_LAZY_SAMPLES))
+    if (!goal->hasType(ompl::base::GOAL_LAZY_SAMPLES))
+      continue;
+    if (auto sampler = dynamic_cast<ConstrainedGoalSampler*>(goal.get()))
+      sampler->stopSampling();
+    else
       static_cast<ompl::base::GoalLazySamples*>(goal.get())->stopSampling();
   }
 }
@@ -403,6 +403,11 @@ void ModelBasedPlanningContext::useConfig()
     cfg.erase(it);
   }
 
+  // the number of goal sampling threads is read when the goal is constructed
+  it = cfg.find("goal_sampling_threads");
+  if (it != cfg.end())
+    cfg.erase(it);
+
   // remove the 'type' parameter; the rest are parameters for the planner itself
   it = cfg.find("type");
   if (it == cfg.end())
@@ -521,6 +526,11 @@ ompl::base::GoalPtr ModelBasedPlanningContext::constructGoal()
 {
   // ******************* set up the goal representation, based on goal constraints
 
+  unsigned int sampling_threads = 1;
+  auto it = spec_.config_.find("goal_sampling_threads");
+  if (it != spec_.config_.end())
+    sampling_threads = std::max(1, boost::lexical_cast<int>(it->second));
+
   std::vector<ob::GoalPtr> goals;
   for (kinematic_constraints::KinematicConstraintSetPtr& goal_constraint : goal_constraints_)
   {
@@ -533,7 +543,8 @@ ompl::base::GoalPtr ModelBasedPlanningContext::constructGoal()
 
     if (constraint_sampler)
     {
-      ob::GoalPtr goal = std::make_shared<ConstrainedGoalSampler>(this, goal_constraint, constraint_sampler);
+      ob::GoalPtr goal =
+          std::make_shared<ConstrainedGoalSampler>(this, goal_constraint, constraint_sampler, sampling_threads);
       goals.push_back(goal);
     }
   }
@@ -717,7 +728,12 @@ void ModelBasedPlanningContext::startSampling()
   bool gls = ompl_simple_setup_->getGoal()->hasType(ob::GOAL_LAZY_SAMPLES);
   if (gls)
   {
-    static_cast<ob::GoalLazySamples*>(ompl_simple_setup_->getGoal().get())->startSampling();
+    // the lazy goal sampler hides the non-virtual start/stop to manage its sampling threads
+    auto goal = ompl_simple_setup_->getGoal().get();
+    if (auto sampler = dynamic_cast<ConstrainedGoalSampler*>(goal))
+      sampler->startSampling();
+    else
+      static_cast<ob::GoalLazySamples*>(goal)->startSampling();
   }
   else
   {
@@ -731,7 +747,12 @@ void ModelBasedPlanningContext::stopSampling()
   bool gls = ompl_simple_setup_->getGoal()->hasType(ob::GOAL_LAZY_SAMPLES);
   if (gls)
   {
-    static_cast<ob::GoalLazySamples*>(ompl_simple_setup_->getGoal().get())->stopSampling();
+    // the lazy goal sampler hides the non-virtual start/stop to manage its sampling threads
+    auto goal = ompl_simple_setup_->getGoal().get();
+    if (auto sampler = dynamic_cast<ConstrainedGoalSampler*>(goal))
+      sampler->stopSampling();
+    else
+      static_cast<ob::GoalLazySamples*>(goal)->stopSampling();
   }
   else
   {
@@ -56,7 +56,11 @@
 
 #include <tf2_eigen/tf2_eigen.hpp>
 
+#include <chrono>
+#include <thread>
+
 #include <moveit/ompl_interface/planning_context_manager.hpp>
+#include <moveit/ompl_interface/detail/constrained_goal_sampler.hpp>
 #include <moveit/planning_scene/planning_scene.hpp>
 #include <moveit/planning_interface/planning_request.hpp>
 #include <moveit/robot_state/conversions.hpp>
@@ -214,6 +218,68 @@ public:
     }
   }
 
+  void testThreadedGoalSampling(const std::vector<double>& start, const std::vector<double>& goal)
+  {
+    SCOPED_TRACE("testThreadedGoalSampling");
+
+    planning_interface::PlannerConfigurationSettings pconfig_settings;
+    pconfig_settings.group = group_name_;
+    pconfig_settings.name = group_name_;
+    pconfig_settings.config = { { "enforce_joint_model_state_space", "0" }, { "goal_sampling_threads", "4" } };
+
+    planning_interface::PlannerConfigurationMap pconfig_map{ { pconfig_settings.name, pconfig_settings } };
+    moveit_msgs::msg::MoveItErrorCodes error_code;
+    planning_interface::MotionPlanRequest request = createRequest(start, goal);
+
+    ompl_interface::PlanningContextManager pcm(robot_model_, constraint_sampler_manager_);
+    pcm.setPlannerConfigurations(pconfig_map);
+    auto pc = pcm.getPlanningContext(planning_scene_, request, error_code, node_, false);
+    ASSERT_NE(pc, nullptr);
+
+    // a single joint goal is sampled by the ConstrainedGoalSampler itself, with a clone of the sampler per thread
+    auto goal_sampler =
+        std::dynamic_pointer_cast<ompl_interface::ConstrainedGoalSampler>(pc->getOMPLSimpleSetup()->getGoal());
+    ASSERT_NE(goal_sampler, nullptr);
+    EXPECT_EQ(goal_sampler->getSamplingThreadCount(), 4u);
+
+    // the OMPL sampling thread only adds goals once the space information is set up
+    goal_sampler->stopSampling();
+    pc->getOMPLSimpleSetup()->setup();
+
+    kinematic_constraints::KinematicConstraintSet goal_constraints(robot_model_);
+    goal_constraints.add(request.goal_constraints[0], planning_scene_->getTransforms());
+    moveit::core::RobotState goal_state(pc->getCompleteInitialRobotState());
+
+    // each run makes at least as many attempts as it finds goals, so if a run inherited the attempts of the earlier
+    // runs, the last runs would find no goals
+    pc->setMaximumGoalSamplingAttempts(60);
+    for (int run = 0; run < 5; ++run)
+    {
+      goal_sampler->clear();
+      goal_sampler->startSampling();
+      const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+      while (goal_sampler->getStateCount() < pc->getMaximumGoalSamples() && goal_sampler->isSampling() &&
+             std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      goal_sampler->stopSampling();
+
+      ASSERT_GT(goal_sampler->getStateCount(), 0u) << "run " << run;
+      for (std::size_t i = 0; i < goal_sampler->getStateCount(); ++i)
+      {
+        pc->getOMPLStateSpace()->copyToRobotState(goal_state, goal_sampler->getState(i));
+        EXPECT_TRUE(goal_constraints.decide(goal_state).satisfied);
+      }
+    }
+
+    // and the threaded sampler solves the problem, also when the context is reused
+    for (int run = 0; run < 2; ++run)
+    {
+      planning_interface::MotionPlanDetailedResponse res;
+      pc->solve(res);
+      ASSERT_TRUE(res.error_code.val == moveit_msgs::msg::MoveItErrorCodes::SUCCESS);
+    }
+  }
+
 protected:
   void SetUp() override
   {
@@ -324,6 +390,11 @@ TEST_F(PandaTestPlanningContext, testSimpleRequest)
   testSimpleRequest({ 0., -0.785, 0., -2.356, 0, 1.571, 0.785 }, { 0., -0.785, 0., -2.356, 0, 1.571, 0.685 });
 }
 
+TEST_F(PandaTestPlanningContext, testThreadedGoalSampling)
+{
+  testThreadedGoalSampling({ 0., -0.785, 0., -2.356, 0, 1.571, 0.785 }, { 0., -0.785, 0., -2.356, 0, 1.571, 0.685 });
+}
+
 // TODO(seng): This test is temporarily disabled as it is flaky since #1300. Re-enable when #2015 is resolved.
 // TEST_F(PandaTestPlanningContext, testPathConstraints)
 // {
@@ -75,12 +75,14 @@ rclcpp::Logger getLogger()
 namespace move_group
 {
 MoveGroupCartesianPathService::MoveGroupCartesianPathService()
-  : MoveGroupCapability("CartesianPathService"), display_computed_paths_(true)
+  : MoveGroupCapability("CartesianPathService"), display_computed_paths_(true), use_differential_ik_(false)
 {
 }
 
 void MoveGroupCartesianPathService::initialize()
 {
+  context_->moveit_cpp_->getNode()->get_parameter_or("cartesian_path_differential_ik", use_differential_ik_, false);
+
   display_path_ =
       context_->moveit_cpp_->getNode()->create_publisher<moveit_msgs::msg::DisplayTrajectory>(DISPLAY_PATH_TOPIC, 10);
 
@@ -183,9 +185,18 @@ bool MoveGroupCartesianPathService::computeService(
             jump_threshold = moveit::core::JumpThreshold::relative(req->jump_threshold);
           }
           std::vector<moveit::core::RobotStatePtr> traj;
-          res->fraction = moveit::core::CartesianInterpolator::computeCartesianPath(
-              &start_state, jmg, traj, start_state.getLinkModel(link_name), waypoints, global_frame,
-              moveit::core::MaxEEFStep(req->max_step), moveit::core::CartesianPrecision{}, constraint_fn);
+          if (use_differential_ik_)
+          {
+            res->fraction = moveit::core::CartesianInterpolator::computeCartesianPathDiffIK(
+                &start_state, jmg, traj, start_state.getLinkModel(link_name), waypoints, global_frame,
+                moveit::core::MaxEEFStep(req->max_step), moveit::core::CartesianPrecision{}, constraint_fn);
+          }
+          else
+          {
+            res->fraction = moveit::core::CartesianInterpolator::computeCartesianPath(
+                &start_state, jmg, traj, start_state.getLinkModel(link_name), waypoints, global_frame,
+                moveit::core::MaxEEFStep(req->max_step), moveit::core::CartesianPrecision{}, constraint_fn);
+          }
           moveit::core::robotStateToRobotStateMsg(start_state, res->start_state);
 
           robot_trajectory::RobotTrajectory rt(context_->planning_scene_monitor_->getRobotModel(), req->group_name);
@@ -58,5 +58,6 @@ private:
   rclcpp::Publisher<moveit_msgs::msg::DisplayTrajectory>::SharedPtr display_path_;
 
   bool display_computed_paths_;
+  bool use_differential_ik_;
 };
 }  // namespace move_group
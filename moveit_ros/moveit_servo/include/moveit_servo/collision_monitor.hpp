@@ -41,6 +41,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <moveit/planning_scene_monitor/planning_scene_monitor.hpp>
 #include <moveit/planning_scene/planning_scene.hpp>
 #include <moveit_servo/moveit_servo_lib_parameters.hpp>
@@ -54,16 +55,55 @@ public:
   CollisionMonitor(const planning_scene_monitor::PlanningSceneMonitorPtr& planning_scene_monitor,
                    const servo::Params& servo_params, std::atomic<double>& collision_velocity_scale);
 
+  ~CollisionMonitor();
+
   void start();
 
   void stop();
 
-private:
+  /**
+   * \brief Set the joint positions most recently commanded for the move group.
+   * If `check_commanded_state_collisions` is enabled, these are checked instead of the current positions.
+   * @param positions The commanded positions of the active joints of the move group.
+   */
+  void setCommandedJointPositions(const Eigen::VectorXd& positions);
+
+  /**
+   * \brief Discard the commanded joint positions, the current positions are checked until new ones are set.
+   * Commanded positions older than `incoming_command_timeout` are discarded as well.
+   */
+  void clearCommandedJointPositions();
+
+protected:
   /**
    * \brief The collision checking function, this will run in a separate thread.
    */
   void checkCollisions();
 
+  /**
+   * \brief Get the commanded joint positions if they were set within the last `incoming_command_timeout`.
+   * @param positions The commanded positions, only written if they are still valid.
+   * @return True if valid commanded positions were written.
+   */
+  bool getCommandedJointPositions(Eigen::VectorXd& positions);
+
+  /**
+   * \brief Check whether the distances computed for `last_checked_state_` are still conclusive for `robot_state_`.
+   * This is the case if the scene did not change and a conservative bound on the displacement of any collision body
+   * since the last check cannot bring the robot closer than the proximity thresholds.
+   * @return True if the distance queries can be skipped, i.e. the velocity scale remains 1.0.
+   */
+  bool canSkipDistanceQueries();
+
+  /**
+   * \brief Compute an upper bound on the displacement of any point on the robot's collision geometry between two
+   * states.
+   * @param from The state the displacement is measured from.
+   * @param to The state the displacement is measured to.
+   * @return The displacement bound [m].
+   */
+  double maxCollisionBodyDisplacement(const moveit::core::RobotState& from, const moveit::core::RobotState& to) const;
+
   // Variables
 
   const servo::Params& servo_params_;
@@ -71,6 +111,23 @@ private:
   const planning_scene_monitor::PlanningSceneMonitorPtr planning_scene_monitor_;
   moveit::core::RobotState robot_state_;
 
+  // The state for which the distances were last computed, and whether it is valid.
+  moveit::core::RobotState last_checked_state_;
+  bool has_last_checked_state_ = false;
+  // Set by the planning scene monitor when the world, transforms or scene changed, through the update callback below.
+  std::shared_ptr<std::atomic<bool>> scene_changed_;
+  planning_scene_monitor::PlanningSceneMonitor::UpdateCallbackHandle scene_update_callback_ = 0;
+  // The radius of a sphere around each link origin that contains the link's collision geometry, by link index.
+  std::vector<double> link_radii_;
+
+  // The commanded joint positions, set by the servo thread. Clearing them only resets the flag, so that the servo
+  // thread does not reallocate them when it sets them again.
+  std::mutex commanded_positions_mutex_;
+  Eigen::VectorXd commanded_positions_;
+  std::chrono::steady_clock::time_point commanded_positions_stamp_;
+  bool has_commanded_positions_ = false;
+  Eigen::VectorXd commanded_positions_copy_;
+
   // The collision monitor thread.
   std::thread monitor_thread_;
   // The flag used for stopping the collision monitor thread.
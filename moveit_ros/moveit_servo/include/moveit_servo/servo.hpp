@@ -89,6 +89,17 @@ public:
    */
   KinematicState getNextJointState(const moveit::core::RobotStatePtr& robot_state, const ServoInput& command);
 
+  /**
+   * \brief Computes the joint state required to follow the given command, writing into an existing state.
+   * Once warmed up with a joint jog command, this performs no heap allocations as long as no subgroup is active.
+   * Twist and pose commands may still allocate inside the IK solver plugin and when transforming between frames.
+   * @param robot_state RobotStatePtr instance used for calculating the next joint state.
+   * @param command The command to follow, std::variant type, can handle JointJog, Twist and Pose.
+   * @param target_state The required joint state. Its storage is reused when the number of joints is unchanged.
+   */
+  void getNextJointState(const moveit::core::RobotStatePtr& robot_state, const ServoInput& command,
+                         KinematicState& target_state);
+
   /**
    * \brief Set the type of incoming servo command.
    * @param command_type The type of command servo should expect.
@@ -141,6 +152,15 @@ public:
    */
   std::pair<bool, KinematicState> smoothHalt(const KinematicState& halt_state);
 
+  /**
+   * \brief Smoothly halt at a commanded state when command goes stale, writing into an existing state.
+   * @param halt_state The desired halting state.
+   * @param target_state A state stepping towards the desired halting state. Its storage is reused when the number of
+   * joints is unchanged. Must not be the same object as halt_state.
+   * @return Whether the robot has stopped.
+   */
+  bool smoothHalt(const KinematicState& halt_state, KinematicState& target_state);
+
   /**
    * \brief Applies smoothing to an input state, if a smoothing plugin is set.
    * @param state The state to be updated by the smoothing plugin.
@@ -190,9 +210,10 @@ private:
    * \brief Compute the change in joint position required to follow the received command.
    * @param command The incoming servo command.
    * @param robot_state RobotStatePtr instance used for calculating the command.
-   * @return The joint position change required (delta).
+   * @param joint_position_deltas The joint position change required (delta), zero if the command is invalid.
    */
-  Eigen::VectorXd jointDeltaFromCommand(const ServoInput& command, const moveit::core::RobotStatePtr& robot_state);
+  void jointDeltaFromCommand(const ServoInput& command, const moveit::core::RobotStatePtr& robot_state,
+                             Eigen::VectorXd& joint_position_deltas);
 
   /**
    * \brief Validate the servo parameters
@@ -215,11 +236,10 @@ private:
    * \brief Apply halting logic to specified joints.
    * @param joints_to_halt The indices of joints to be halted.
    * @param current_state The current kinematic state.
-   * @param target_state The target kinematic state.
-   * @return The bounded kinematic state.
+   * @param target_state The target kinematic state, bounded in place.
    */
-  KinematicState haltJoints(const std::vector<size_t>& joints_to_halt, const KinematicState& current_state,
-                            const KinematicState& target_state) const;
+  void haltJoints(const std::vector<size_t>& joints_to_halt, const KinematicState& current_state,
+                  KinematicState& target_state) const;
 
   // Variables
 
@@ -248,6 +268,16 @@ private:
 
   // The current joint limit safety margins for each active joint position variable.
   std::vector<double> joint_limit_margins_;
+
+  // Reused in every cycle to avoid allocations: the indices of the joint variables to halt.
+  std::vector<size_t> joint_variables_to_halt_;
+
+  // Reused in every cycle to avoid allocations: the current state and the joint position delta of the command.
+  KinematicState current_state_;
+  Eigen::VectorXd joint_position_delta_;
+
+  // Holds the Jacobian factorization shared by the inverse Jacobian and the singularity scaling of a cycle.
+  JacobianSolver jacobian_solver_;
 };
 
 }  // namespace moveit_servo
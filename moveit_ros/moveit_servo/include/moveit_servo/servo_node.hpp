@@ -74,12 +74,36 @@ public:
   // Skip linting due to unconventional function naming
   rclcpp::node_interfaces::NodeBaseInterface::SharedPtr get_node_base_interface();  // NOLINT
 
-private:
+protected:
   /**
    * \brief Loop that handles different types of incoming commands.
    */
   void servoLoop();
 
+  /**
+   * \brief Initialize the state and the preallocated storage used by the servo loop from the current robot state.
+   */
+  void initializeServoLoop();
+
+  /**
+   * \brief Compute the next joint state from the latest command and compose the output messages.
+   * Once warmed up with a joint jog command, this performs no heap allocations as long as no subgroup is active.
+   * Must be called with lock_ held.
+   * @return Whether a new command was computed and should be published.
+   */
+  bool computeNextCommand();
+
+  /**
+   * \brief Publish the composed command, if any, and the servo status. Must be called with lock_ held.
+   * @param publish_command Whether a new command was computed.
+   */
+  void publishCommand(bool publish_command);
+
+  /**
+   * \brief Set the scratch robot state to the current state of the robot and extract it into current_state_.
+   */
+  void updateCurrentState();
+
   /**
    * \brief The service to pause servoing, this does not exit the loop or stop the servo loop thread.
    * The loop will be alive even after pausing, but no commands will be processed.
@@ -99,9 +123,10 @@ private:
   void twistCallback(const geometry_msgs::msg::TwistStamped::ConstSharedPtr& msg);
   void poseCallback(const geometry_msgs::msg::PoseStamped::ConstSharedPtr& msg);
 
-  std::optional<KinematicState> processJointJogCommand(const moveit::core::RobotStatePtr& robot_state);
-  std::optional<KinematicState> processTwistCommand(const moveit::core::RobotStatePtr& robot_state);
-  std::optional<KinematicState> processPoseCommand(const moveit::core::RobotStatePtr& robot_state);
+  // Compute next_joint_state_ for the latest command. Return false if there is no next state to publish.
+  bool processJointJogCommand(const moveit::core::RobotStatePtr& robot_state);
+  bool processTwistCommand(const moveit::core::RobotStatePtr& robot_state);
+  bool processPoseCommand(const moveit::core::RobotStatePtr& robot_state);
 
   // Variables
 
@@ -111,9 +136,25 @@ private:
   planning_scene_monitor::PlanningSceneMonitorPtr planning_scene_monitor_;
 
   KinematicState last_commanded_state_;  // Used when commands go stale;
-  control_msgs::msg::JointJog latest_joint_jog_;
-  geometry_msgs::msg::TwistStamped latest_twist_;
-  geometry_msgs::msg::PoseStamped latest_pose_;
+  // The states of the servo loop are preallocated when the loop starts and are then updated in place.
+  KinematicState current_state_;
+  KinematicState next_joint_state_;
+  moveit::core::RobotStatePtr robot_state_;
+  const moveit::core::JointModelGroup* joint_model_group_ = nullptr;
+  // The commands given to servo, reused so that copying the latest messages into them does not allocate.
+  ServoInput joint_jog_command_{ JointJogCommand{} };
+  ServoInput twist_command_{ TwistCommand{} };
+  ServoInput pose_command_{ PoseCommand{} };
+  // The output messages, reused in every cycle.
+  trajectory_msgs::msg::JointTrajectory trajectory_msg_;
+  std_msgs::msg::Float64MultiArray multi_array_msg_;
+  moveit_msgs::msg::ServoStatus status_msg_;
+  // The latest commands are shared with the subscriptions instead of copied, access them with std::atomic_load/store.
+  control_msgs::msg::JointJog::ConstSharedPtr latest_joint_jog_;
+  // The last joint jog message whose unsupported displacements were warned about. Only used by the servo loop.
+  control_msgs::msg::JointJog::ConstSharedPtr warned_joint_jog_;
+  geometry_msgs::msg::TwistStamped::ConstSharedPtr latest_twist_;
+  geometry_msgs::msg::PoseStamped::ConstSharedPtr latest_pose_;
   rclcpp::Subscription<control_msgs::msg::JointJog>::SharedPtr joint_jog_subscriber_;
   rclcpp::Subscription<geometry_msgs::msg::TwistStamped>::SharedPtr twist_subscriber_;
   rclcpp::Subscription<geometry_msgs::msg::PoseStamped>::SharedPtr pose_subscriber_;
@@ -136,8 +177,11 @@ private:
   // Locks for threads safety
   std::mutex lock_;
 
+  // If true, the node was created with intra-process communication and uses keep-last QoS for its topics.
+  bool use_intra_process_comms_;
+
   // rolling window of joint commands
-  std::deque<KinematicState> joint_cmd_rolling_window_;
+  KinematicStateWindow joint_cmd_rolling_window_;
 };
 
 }  // namespace moveit_servo
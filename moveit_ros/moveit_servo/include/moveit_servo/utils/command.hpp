@@ -62,6 +62,22 @@ JointDeltaResult jointDeltaFromJointJog(const JointJogCommand& command, const mo
                                         const servo::Params& servo_params,
                                         const JointNameToMoveGroupIndexMap& joint_name_group_index_map);
 
+/**
+ * \brief Compute the change in joint position for the given joint jog command, writing into a caller-owned vector.
+ * The vector is only reallocated when its size changes, so this can be used from the servo loop. An active subgroup
+ * still allocates when its delta is expanded to the full move group.
+ * @param command The joint jog command.
+ * @param robot_state_ The current robot state as obtained from PlanningSceneMonitor.
+ * @param servo_params The servo parameters.
+ * @param joint_name_group_index_map Mapping between joint subgroup name and move group joint vector position.
+ * @param joint_position_delta The joint position change required (delta).
+ * @return The status of the computation.
+ */
+StatusCode jointDeltaFromJointJog(const JointJogCommand& command, const moveit::core::RobotStatePtr& robot_state,
+                                  const servo::Params& servo_params,
+                                  const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                                  Eigen::VectorXd& joint_position_delta);
+
 /**
  * \brief Compute the change in joint position for the given twist command.
  * @param command The twist command.
@@ -75,6 +91,21 @@ JointDeltaResult jointDeltaFromTwist(const TwistCommand& command, const moveit::
                                      const servo::Params& servo_params, const std::string& planning_frame,
                                      const JointNameToMoveGroupIndexMap& joint_name_group_index_map);
 
+/**
+ * \brief Compute the change in joint position for the given twist command.
+ * @param command The twist command.
+ * @param robot_state_ The current robot state as obtained from PlanningSceneMonitor.
+ * @param servo_params The servo parameters.
+ * @param planning_frame The planning frame name.
+ * @param joint_name_group_index_map Mapping between joint subgroup name and move group joint vector position.
+ * @param jacobian_solver The Jacobian solver shared within the servo cycle.
+ * @return The status and joint position change required (delta).
+ */
+JointDeltaResult jointDeltaFromTwist(const TwistCommand& command, const moveit::core::RobotStatePtr& robot_state,
+                                     const servo::Params& servo_params, const std::string& planning_frame,
+                                     const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                                     JacobianSolver& jacobian_solver);
+
 /**
  * \brief Compute the change in joint position for the given pose command.
  * @param command The pose command.
@@ -90,6 +121,23 @@ JointDeltaResult jointDeltaFromPose(const PoseCommand& command, const moveit::co
                                     const std::string& ee_frame,
                                     const JointNameToMoveGroupIndexMap& joint_name_group_index_map);
 
+/**
+ * \brief Compute the change in joint position for the given pose command.
+ * @param command The pose command.
+ * @param robot_state_ The current robot state as obtained from PlanningSceneMonitor.
+ * @param servo_params The servo parameters.
+ * @param planning_frame The planning frame name.
+ * @param ee_frame The end effector frame name.
+ * @param joint_name_group_index_map Mapping between sub group joint name and move group joint vector position
+ * @param jacobian_solver The Jacobian solver shared within the servo cycle.
+ * @return The status and joint position change required (delta).
+ */
+JointDeltaResult jointDeltaFromPose(const PoseCommand& command, const moveit::core::RobotStatePtr& robot_state,
+                                    const servo::Params& servo_params, const std::string& planning_frame,
+                                    const std::string& ee_frame,
+                                    const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                                    JacobianSolver& jacobian_solver);
+
 /**
  * \brief Computes the required change in joint angles for given Cartesian change, using the robot's IK solver.
  * @param cartesian_position_delta The change in Cartesian position.
@@ -102,4 +150,19 @@ JointDeltaResult jointDeltaFromIK(const Eigen::VectorXd& cartesian_position_delt
                                   const moveit::core::RobotStatePtr& robot_state, const servo::Params& servo_params,
                                   const JointNameToMoveGroupIndexMap& joint_name_group_index_map);
 
+/**
+ * \brief Computes the required change in joint angles for given Cartesian change, using the robot's IK solver.
+ * If the group has no IK solver, the inverse Jacobian held by the Jacobian solver is used instead.
+ * @param cartesian_position_delta The change in Cartesian position.
+ * @param robot_state_ The current robot state as obtained from PlanningSceneMonitor.
+ * @param servo_params The servo parameters.
+ * @param joint_name_group_index_map Mapping between joint subgroup name and move group joint vector position.
+ * @param jacobian_solver The Jacobian solver shared within the servo cycle.
+ * @return The status and joint position change required (delta).
+ */
+JointDeltaResult jointDeltaFromIK(const Eigen::VectorXd& cartesian_position_delta,
+                                  const moveit::core::RobotStatePtr& robot_state, const servo::Params& servo_params,
+                                  const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                                  JacobianSolver& jacobian_solver);
+
 }  // namespace moveit_servo
@@ -43,6 +43,7 @@
 
 #include <moveit_servo/moveit_servo_lib_parameters.hpp>
 #include <moveit_servo/utils/datatypes.hpp>
+#include <moveit_servo/utils/jacobian_solver.hpp>
 #include <moveit/planning_scene_monitor/planning_scene_monitor.hpp>
 #include <moveit/robot_model/joint_model_group.hpp>
 #include <moveit/robot_state/robot_state.hpp>
@@ -122,6 +123,17 @@ geometry_msgs::msg::Pose poseFromCartesianDelta(const Eigen::VectorXd& delta_x,
 std::optional<trajectory_msgs::msg::JointTrajectory>
 composeTrajectoryMessage(const servo::Params& servo_params, const std::deque<KinematicState>& joint_cmd_rolling_window);
 
+/**
+ * \brief Fill a trajectory message from a rolling window of joint state commands, reusing the storage of the message.
+ * If the message was composed from a window with the same number of states and joints before, this does not allocate.
+ * @param servo_params The configuration used by servo, required for setting some field of the trajectory message.
+ * @param joint_cmd_rolling_window A rolling window of joint state commands.
+ * @param joint_trajectory The trajectory message to fill.
+ * @return True if the window contains enough points to compose a trajectory, else False.
+ */
+bool composeTrajectoryMessage(const servo::Params& servo_params, const KinematicStateWindow& joint_cmd_rolling_window,
+                              trajectory_msgs::msg::JointTrajectory& joint_trajectory);
+
 /**
  * \brief Adds a new joint state command to a queue containing commands over a time window. Also modifies the velocities
  * of the commands to help avoid overshooting.
@@ -134,6 +146,18 @@ composeTrajectoryMessage(const servo::Params& servo_params, const std::deque<Kin
 void updateSlidingWindow(KinematicState& next_joint_state, std::deque<KinematicState>& joint_cmd_rolling_window,
                          double max_expected_latency, const rclcpp::Time& cur_time);
 
+/**
+ * \brief Adds a new joint state command to a preallocated window of commands. Behaves like the std::deque overload,
+ * but does not allocate as long as the window capacity is not exceeded.
+ * @param next_joint_state The next commanded joint state.
+ * @param joint_cmd_rolling_window Preallocated rolling window of joint commands.
+ * @param max_expected_latency The next_joint_state will be added to the joint_cmd_rolling_window with a time stamp of
+ * @param cur_time The current time stamp when the method is called. This value is used to update the time stamp of
+ * next_joint_state
+ */
+void updateSlidingWindow(KinematicState& next_joint_state, KinematicStateWindow& joint_cmd_rolling_window,
+                         double max_expected_latency, const rclcpp::Time& cur_time);
+
 /**
  * \brief Create a Float64MultiArray message from the given joint state.
  *
@@ -149,6 +173,15 @@ void updateSlidingWindow(KinematicState& next_joint_state, std::deque<KinematicS
 std_msgs::msg::Float64MultiArray composeMultiArrayMessage(const servo::Params& servo_params,
                                                           const KinematicState& joint_state);
 
+/**
+ * \brief Fill a Float64MultiArray message from the given joint state, reusing the storage of the message.
+ * @param servo_params Configuration parameters used by Servo (e.g., command type: position or velocity).
+ * @param joint_state The current joint state to be converted into a Float64MultiArray message.
+ * @param multi_array The message to fill.
+ */
+void composeMultiArrayMessage(const servo::Params& servo_params, const KinematicState& joint_state,
+                              std_msgs::msg::Float64MultiArray& multi_array);
+
 /**
  * \brief Computes scaling factor for velocity when the robot is near a singularity.
  * @param robot_state A pointer to the current robot state.
@@ -160,6 +193,20 @@ std::pair<double, StatusCode> velocityScalingFactorForSingularity(const moveit::
                                                                   const Eigen::VectorXd& target_delta_x,
                                                                   const servo::Params& servo_params);
 
+/**
+ * \brief Computes scaling factor for velocity when the robot is near a singularity.
+ * The factorization of the Jacobian held by the solver is reused if it already belongs to the current robot state.
+ * @param robot_state A pointer to the current robot state.
+ * @param target_delta_x The vector containing the required change in Cartesian position.
+ * @param servo_params The servo parameters, contains the singularity thresholds.
+ * @param jacobian_solver The Jacobian solver shared within the servo cycle.
+ * @return The velocity scaling factor and the reason for scaling.
+ */
+std::pair<double, StatusCode> velocityScalingFactorForSingularity(const moveit::core::RobotStatePtr& robot_state,
+                                                                  const Eigen::VectorXd& target_delta_x,
+                                                                  const servo::Params& servo_params,
+                                                                  JacobianSolver& jacobian_solver);
+
 /**
  * \brief Apply velocity scaling based on joint limits. If the robot model does not have velocity limits defined,
  * then a scale factor of 1.0 will be returned.
@@ -183,6 +230,19 @@ std::vector<size_t> jointVariablesToHalt(const Eigen::VectorXd& positions, const
                                          const moveit::core::JointBoundsVector& joint_bounds,
                                          const std::vector<double>& margins);
 
+/**
+ * \brief Finds the joint variable indices corresponding to joints exceeding allowable position limits.
+ * The result is written to a caller-provided vector, which does not allocate if it has sufficient capacity.
+ * @param positions The joint positions.
+ * @param velocities The current commanded velocities.
+ * @param joint_bounds The allowable limits for the robot joints.
+ * @param margins Additional buffer on the actual joint limits.
+ * @param variable_indices_to_halt The joint variable indices that violate the specified position limits.
+ */
+void jointVariablesToHalt(const Eigen::VectorXd& positions, const Eigen::VectorXd& velocities,
+                          const moveit::core::JointBoundsVector& joint_bounds, const std::vector<double>& margins,
+                          std::vector<size_t>& variable_indices_to_halt);
+
 /**
  * \brief Helper function for converting Eigen::Isometry3d to geometry_msgs/TransformStamped.
  * @param eigen_tf The isometry to be converted to TransformStamped.
@@ -201,6 +261,13 @@ geometry_msgs::msg::TransformStamped convertIsometryToTransform(const Eigen::Iso
  */
 PoseCommand poseFromPoseStamped(const geometry_msgs::msg::PoseStamped& msg);
 
+/**
+ * \brief Convert a PoseStamped message to an existing Servo Pose, reusing the storage of its frame name.
+ * @param msg The PoseStamped message.
+ * @param command The Servo Pose to fill.
+ */
+void poseFromPoseStamped(const geometry_msgs::msg::PoseStamped& msg, PoseCommand& command);
+
 /**
  * \brief Creates the planning scene monitor used by servo
  */
@@ -215,4 +282,13 @@ planning_scene_monitor::PlanningSceneMonitorPtr createPlanningSceneMonitor(const
  */
 KinematicState extractRobotState(const moveit::core::RobotStatePtr& robot_state, const std::string& move_group_name);
 
+/**
+ * \brief Extract the state from a RobotStatePtr instance into an existing KinematicState, reusing its storage.
+ * @param robot_state A RobotStatePtr instance.
+ * @param move_group_name The name of the planning group.
+ * @param current_state The state to fill.
+ */
+void extractRobotState(const moveit::core::RobotStatePtr& robot_state, const std::string& move_group_name,
+                       KinematicState& current_state);
+
 }  // namespace moveit_servo
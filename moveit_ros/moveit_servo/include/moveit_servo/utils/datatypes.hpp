@@ -41,10 +41,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <tf2_eigen/tf2_eigen.hpp>
 #include <unordered_map>
+#include <vector>
 
 namespace moveit_servo
 {
@@ -131,6 +133,131 @@ struct KinematicState
   }
 };
 
+// A FIFO of kinematic states with a ring buffer layout. Removed states keep their storage and are overwritten in place
+// by later insertions, so once the capacity has been reserved, adding states of the same size does not allocate.
+class KinematicStateWindow
+{
+public:
+  KinematicStateWindow() = default;
+
+  /**
+   * \brief Create a window and preallocate it.
+   * @param capacity The number of states the window can hold without allocating.
+   * @param prototype A state whose size (number of joints and joint names) is used to preallocate all slots.
+   */
+  KinematicStateWindow(size_t capacity, const KinematicState& prototype)
+  {
+    reserve(capacity, prototype);
+  }
+
+  /**
+   * \brief Preallocate the window. Existing states are kept.
+   * @param capacity The number of states the window can hold without allocating.
+   * @param prototype A state whose size is used to preallocate the unused slots.
+   */
+  void reserve(size_t capacity, const KinematicState& prototype)
+  {
+    if (capacity > buffer_.size())
+    {
+      linearize();
+      buffer_.resize(capacity, prototype);
+    }
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  size_t capacity() const
+  {
+    return buffer_.size();
+  }
+
+  bool empty() const
+  {
+    return size_ == 0;
+  }
+
+  KinematicState& operator[](size_t index)
+  {
+    return buffer_[(head_ + index) % buffer_.size()];
+  }
+
+  const KinematicState& operator[](size_t index) const
+  {
+    return buffer_[(head_ + index) % buffer_.size()];
+  }
+
+  KinematicState& front()
+  {
+    return (*this)[0];
+  }
+
+  const KinematicState& front() const
+  {
+    return (*this)[0];
+  }
+
+  KinematicState& back()
+  {
+    return (*this)[size_ - 1];
+  }
+
+  const KinematicState& back() const
+  {
+    return (*this)[size_ - 1];
+  }
+
+  void pop_front()
+  {
+    head_ = (head_ + 1) % buffer_.size();
+    --size_;
+  }
+
+  void pop_back()
+  {
+    --size_;
+  }
+
+  void clear()
+  {
+    head_ = 0;
+    size_ = 0;
+  }
+
+  /**
+   * \brief Append a copy of a state. The capacity is doubled if the window is full, which allocates.
+   * @param state The state to append.
+   */
+  void push_back(const KinematicState& state)
+  {
+    if (size_ == buffer_.size())
+    {
+      // Copy first, the state might be stored in this window.
+      const KinematicState state_copy = state;
+      reserve(std::max<size_t>(2 * buffer_.size(), 1), state_copy);
+      ++size_;
+      back() = state_copy;
+      return;
+    }
+    ++size_;
+    back() = state;
+  }
+
+private:
+  // Rotate the buffer so that the front state is stored at index 0.
+  void linearize()
+  {
+    std::rotate(buffer_.begin(), buffer_.begin() + head_, buffer_.end());
+    head_ = 0;
+  }
+
+  std::vector<KinematicState> buffer_;
+  size_t head_ = 0;
+  size_t size_ = 0;
+};
+
 // Mapping joint names and their position in the move group vector
 typedef std::unordered_map<std::string, std::size_t> JointNameToMoveGroupIndexMap;
 
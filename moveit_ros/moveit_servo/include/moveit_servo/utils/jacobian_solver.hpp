@@ -0,0 +1,126 @@
+/*******************************************************************************
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2019, Los Alamos National Security, LLC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *******************************************************************************/
+
+/*      Title       : jacobian_solver.hpp
+ *      Project     : moveit_servo
+ *      Created     : 10/18/2026
+ *
+ *      Description : Computes, caches and factorizes the Jacobian of a group once per servo cycle.
+ */
+
+#pragma once
+
+#include <Eigen/SVD>
+#include <moveit/robot_model/joint_model_group.hpp>
+#include <moveit/robot_state/robot_state.hpp>
+
+namespace moveit_servo
+{
+
+/**
+ * \brief Holds the Jacobian of a joint model group together with its singular value decomposition.
+ *
+ * The inverse Jacobian solution and the singularity scaling both need the factorization of the same Jacobian, this
+ * class computes it once per robot state and shares it between them. The joint delta can optionally be computed with
+ * damped least squares instead of the plain pseudo-inverse.
+ */
+class JacobianSolver
+{
+public:
+  /**
+   * \brief Make the Jacobian and its factorization correspond to the given state of the group.
+   * Nothing is computed if they already do, e.g. when called a second time within the same servo cycle.
+   * @param robot_state The current robot state.
+   * @param joint_model_group The group to compute the Jacobian for, it must be a chain.
+   * @return False if the Jacobian could not be computed.
+   */
+  bool update(moveit::core::RobotState& robot_state, const moveit::core::JointModelGroup* joint_model_group);
+
+  /**
+   * \brief Compute the joint delta that achieves the given Cartesian delta, using the current factorization.
+   * @param cartesian_delta The Cartesian delta, expressed in the root frame of the group.
+   * @param damping The damping factor, the plain pseudo-inverse is used if it is zero.
+   * @param joint_delta The resulting joint delta.
+   */
+  void solve(const Eigen::VectorXd& cartesian_delta, double damping, Eigen::VectorXd& joint_delta) const;
+
+  /**
+   * \brief Compute the condition number of the Jacobian after taking a small Cartesian step from the current state.
+   * The robot state is restored to the current joint positions before returning.
+   * @param robot_state The robot state the factorization was last updated with.
+   * @param cartesian_step The Cartesian step to take.
+   * @return The condition number at the displaced state.
+   */
+  double conditionNumberAfterStep(moveit::core::RobotState& robot_state, const Eigen::VectorXd& cartesian_step);
+
+  /**
+   * \brief Get the condition number of the current Jacobian, the ratio of its largest and smallest singular values.
+   */
+  double getConditionNumber() const;
+
+  /**
+   * \brief Get the current Jacobian.
+   */
+  const Eigen::MatrixXd& getJacobian() const
+  {
+    return jacobian_;
+  }
+
+  /**
+   * \brief Get the singular value decomposition of the current Jacobian.
+   */
+  const Eigen::JacobiSVD<Eigen::MatrixXd>& getSVD() const
+  {
+    return svd_;
+  }
+
+  /**
+   * \brief Forget the cached Jacobian, the next update recomputes it.
+   */
+  void reset();
+
+private:
+  const moveit::core::JointModelGroup* joint_model_group_ = nullptr;
+  // The joint positions the Jacobian belongs to.
+  Eigen::VectorXd joint_positions_;
+  Eigen::MatrixXd jacobian_;
+  Eigen::JacobiSVD<Eigen::MatrixXd> svd_;
+
+  // Scratch space, kept to avoid allocations in every cycle.
+  Eigen::VectorXd joint_delta_;
+  Eigen::VectorXd step_positions_;
+  Eigen::MatrixXd step_jacobian_;
+  Eigen::JacobiSVD<Eigen::MatrixXd> step_svd_;
+};
+
+}  // namespace moveit_servo
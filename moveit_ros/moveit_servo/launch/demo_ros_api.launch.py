@@ -105,6 +105,8 @@ def generate_launch_description():
                     moveit_config.robot_description_kinematics,
                     moveit_config.joint_limits,
                 ],
+                # Commands from and outputs to other components of this container are passed without copies.
+                extra_arguments=[{"use_intra_process_comms": True}],
                 condition=UnlessCondition(launch_as_standalone_node),
             ),
             launch_ros.descriptions.ComposableNode(
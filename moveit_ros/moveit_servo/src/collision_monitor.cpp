@@ -38,6 +38,7 @@
  */
 
 #include <moveit_servo/collision_monitor.hpp>
+#include <geometric_shapes/shape_operations.h>
 #include <rclcpp/rclcpp.hpp>
 #include <moveit/utils/logger.hpp>
 
@@ -56,6 +57,7 @@ CollisionMonitor::CollisionMonitor(const planning_scene_monitor::PlanningSceneMo
   : servo_params_(servo_params)
   , planning_scene_monitor_(planning_scene_monitor)
   , robot_state_(planning_scene_monitor->getPlanningScene()->getCurrentState())
+  , last_checked_state_(robot_state_)
   , collision_velocity_scale_(collision_velocity_scale)
 {
   scene_collision_request_.distance = true;
@@ -63,6 +65,68 @@ CollisionMonitor::CollisionMonitor(const planning_scene_monitor::PlanningSceneMo
 
   self_collision_request_.distance = true;
   self_collision_request_.group_name = servo_params.move_group_name;
+
+  // Any change of the world, the scene transforms or the scene itself invalidates the last computed distances.
+  scene_changed_ = std::make_shared<std::atomic<bool>>(true);
+  scene_update_callback_ = planning_scene_monitor_->addUpdateCallback(
+      [scene_changed = scene_changed_](planning_scene_monitor::PlanningSceneMonitor::SceneUpdateType type) {
+        if (type & (planning_scene_monitor::PlanningSceneMonitor::UPDATE_GEOMETRY |
+                    planning_scene_monitor::PlanningSceneMonitor::UPDATE_TRANSFORMS))
+        {
+          *scene_changed = true;
+        }
+      });
+
+  // Bound the collision geometry of each link by a sphere around the link origin.
+  const moveit::core::RobotModelConstPtr& robot_model = robot_state_.getRobotModel();
+  link_radii_.assign(robot_model->getLinkModelCount(), 0.0);
+  for (const moveit::core::LinkModel* link : robot_model->getLinkModelsWithCollisionGeometry())
+  {
+    link_radii_[link->getLinkIndex()] =
+        link->getCenteredBoundingBoxOffset().norm() + 0.5 * link->getShapeExtentsAtOrigin().norm();
+  }
+}
+
+CollisionMonitor::~CollisionMonitor()
+{
+  stop_requested_ = true;
+  if (monitor_thread_.joinable())
+  {
+    monitor_thread_.join();
+  }
+  planning_scene_monitor_->removeUpdateCallback(scene_update_callback_);
+}
+
+void CollisionMonitor::setCommandedJointPositions(const Eigen::VectorXd& positions)
+{
+  std::lock_guard<std::mutex> lock(commanded_positions_mutex_);
+  commanded_positions_ = positions;
+  commanded_positions_stamp_ = std::chrono::steady_clock::now();
+  has_commanded_positions_ = true;
+}
+
+void CollisionMonitor::clearCommandedJointPositions()
+{
+  std::lock_guard<std::mutex> lock(commanded_positions_mutex_);
+  has_commanded_positions_ = false;
+}
+
+bool CollisionMonitor::getCommandedJointPositions(Eigen::VectorXd& positions)
+{
+  std::lock_guard<std::mutex> lock(commanded_positions_mutex_);
+  if (!has_commanded_positions_)
+  {
+    return false;
+  }
+  // Once commands stop, the last commanded state is not going to be reached and must not be checked any longer.
+  const std::chrono::duration<double> age = std::chrono::steady_clock::now() - commanded_positions_stamp_;
+  if (age.count() > servo_params_.incoming_command_timeout)
+  {
+    has_commanded_positions_ = false;
+    return false;
+  }
+  positions = commanded_positions_;
+  return true;
 }
 
 void CollisionMonitor::start()
@@ -86,6 +150,7 @@ void CollisionMonitor::stop()
   {
     monitor_thread_.join();
   }
+  clearCommandedJointPositions();
   RCLCPP_INFO_STREAM(getLogger(), "Collision monitor stopped");
 }
 
@@ -111,67 +176,162 @@ void CollisionMonitor::checkCollisions()
       // Fetch latest robot state using planning scene instead of state monitor due to
       // https://github.com/moveit/moveit2/issues/2748
       robot_state_ = locked_scene->getCurrentState();
+
+      // Look ahead by checking the state servo is about to command.
+      if (servo_params_.check_commanded_state_collisions && getCommandedJointPositions(commanded_positions_copy_))
+      {
+        const moveit::core::JointModelGroup* joint_model_group =
+            robot_state_.getJointModelGroup(servo_params_.move_group_name);
+        if (joint_model_group &&
+            commanded_positions_copy_.size() == static_cast<long>(joint_model_group->getActiveVariableCount()))
+        {
+          robot_state_.setJointGroupActivePositions(joint_model_group, commanded_positions_copy_);
+        }
+      }
+
       // This must be called before doing collision checking.
       robot_state_.updateCollisionBodyTransforms();
 
-      // Check collision with environment.
-      scene_collision_result_.clear();
-      locked_scene->getCollisionEnv()->checkRobotCollision(scene_collision_request_, scene_collision_result_,
-                                                           robot_state_, locked_scene->getAllowedCollisionMatrix());
-
-      // Check robot self collision.
-      self_collision_result_.clear();
-      locked_scene->getCollisionEnvUnpadded()->checkSelfCollision(
-          self_collision_request_, self_collision_result_, robot_state_, locked_scene->getAllowedCollisionMatrix());
-
-      // If collision detected scale velocity to 0, else start decelerating exponentially.
-      // velocity_scale = e ^ k * (collision_distance - threshold)
-      // k = - ln(0.001) / collision_proximity_threshold
-      // velocity_scale should equal one when collision_distance is at collision_proximity_threshold.
-      // velocity_scale should equal 0.001 when collision_distance is at zero.
-      //
-      // NOTE:
-      // collision_velocity_scale_ is shared by the primary servo thread. Be sure to not set any
-      // intermediate values in this loop or they can be picked up and throw off scaling while processing
-      // joint updates.
-
-      if (self_collision_result_.collision || scene_collision_result_.collision)
+      if (servo_params_.skip_collision_checks_when_far && canSkipDistanceQueries())
       {
-        collision_velocity_scale_ = 0.0;
+        // No proximity threshold can have been crossed since the last distance queries.
+        collision_velocity_scale_ = 1.0;
       }
       else
       {
-        self_collision_scale = scene_collision_scale = 1.0;
+        // Check collision with environment.
+        scene_collision_result_.clear();
+        locked_scene->getCollisionEnv()->checkRobotCollision(scene_collision_request_, scene_collision_result_,
+                                                             robot_state_, locked_scene->getAllowedCollisionMatrix());
 
-        approaching_scene_collision =
-            scene_collision_result_.distance < servo_params_.scene_collision_proximity_threshold;
-        approaching_self_collision = self_collision_result_.distance < servo_params_.self_collision_proximity_threshold;
+        // Check robot self collision.
+        self_collision_result_.clear();
+        locked_scene->getCollisionEnvUnpadded()->checkSelfCollision(
+            self_collision_request_, self_collision_result_, robot_state_, locked_scene->getAllowedCollisionMatrix());
 
-        if (approaching_scene_collision)
-        {
-          scene_collision_threshold_delta =
-              scene_collision_result_.distance - servo_params_.scene_collision_proximity_threshold;
-          scene_collision_scale = std::exp(scene_velocity_scale_coefficient * scene_collision_threshold_delta);
-        }
+        // Remember the state the distances belong to, so that later cycles can be bounded against it.
+        last_checked_state_ = robot_state_;
+        has_last_checked_state_ = true;
 
-        if (approaching_self_collision)
+        // If collision detected scale velocity to 0, else start decelerating exponentially.
+        // velocity_scale = e ^ k * (collision_distance - threshold)
+        // k = - ln(0.001) / collision_proximity_threshold
+        // velocity_scale should equal one when collision_distance is at collision_proximity_threshold.
+        // velocity_scale should equal 0.001 when collision_distance is at zero.
+        //
+        // NOTE:
+        // collision_velocity_scale_ is shared by the primary servo thread. Be sure to not set any
+        // intermediate values in this loop or they can be picked up and throw off scaling while processing
+        // joint updates.
+
+        if (self_collision_result_.collision || scene_collision_result_.collision)
         {
-          self_collision_threshold_delta =
-              self_collision_result_.distance - servo_params_.self_collision_proximity_threshold;
-          self_collision_scale = std::exp(self_velocity_scale_coefficient * self_collision_threshold_delta);
+          collision_velocity_scale_ = 0.0;
         }
+        else
+        {
+          self_collision_scale = scene_collision_scale = 1.0;
 
-        // Use the scaling factor with lower value, i.e maximum scale down.
-        collision_velocity_scale_ = std::min(scene_collision_scale, self_collision_scale);
+          approaching_scene_collision =
+              scene_collision_result_.distance < servo_params_.scene_collision_proximity_threshold;
+          approaching_self_collision =
+              self_collision_result_.distance < servo_params_.self_collision_proximity_threshold;
+
+          if (approaching_scene_collision)
+          {
+            scene_collision_threshold_delta =
+                scene_collision_result_.distance - servo_params_.scene_collision_proximity_threshold;
+            scene_collision_scale = std::exp(scene_velocity_scale_coefficient * scene_collision_threshold_delta);
+          }
+
+          if (approaching_self_collision)
+          {
+            self_collision_threshold_delta =
+                self_collision_result_.distance - servo_params_.self_collision_proximity_threshold;
+            self_collision_scale = std::exp(self_velocity_scale_coefficient * self_collision_threshold_delta);
+          }
+
+          // Use the scaling factor with lower value, i.e maximum scale down.
+          collision_velocity_scale_ = std::min(scene_collision_scale, self_collision_scale);
+        }
       }
     }
     else
     {
       // If collision checking is disabled we do not scale
       collision_velocity_scale_ = 1.0;
+      has_last_checked_state_ = false;
     }
 
     rate.sleep();
   }
 }
+
+bool CollisionMonitor::canSkipDistanceQueries()
+{
+  // The scene change flag is consumed here, a change forces the queries in this cycle.
+  if (scene_changed_->exchange(false) || !has_last_checked_state_)
+  {
+    has_last_checked_state_ = false;
+    return false;
+  }
+
+  // Newly attached or detached objects were not part of the last query.
+  if (robot_state_.getAttachedBodies().size() != last_checked_state_.getAttachedBodies().size())
+  {
+    return false;
+  }
+
+  // Distances are only conclusive if the last check found the robot far away from any collision.
+  if (self_collision_result_.collision || scene_collision_result_.collision)
+  {
+    return false;
+  }
+
+  // The world is static, so the scene distance shrinks by at most the displacement of the robot. For self collisions
+  // both bodies of a pair may move towards each other.
+  const double displacement = maxCollisionBodyDisplacement(last_checked_state_, robot_state_);
+  return scene_collision_result_.distance - displacement >= servo_params_.scene_collision_proximity_threshold &&
+         self_collision_result_.distance - 2.0 * displacement >= servo_params_.self_collision_proximity_threshold;
+}
+
+double CollisionMonitor::maxCollisionBodyDisplacement(const moveit::core::RobotState& from,
+                                                      const moveit::core::RobotState& to) const
+{
+  // Attached bodies move rigidly with their link, extend the link radius to contain them.
+  std::vector<std::pair<const moveit::core::LinkModel*, double>> attached_radii;
+  std::vector<const moveit::core::AttachedBody*> attached_bodies;
+  to.getAttachedBodies(attached_bodies);
+  for (const moveit::core::AttachedBody* attached_body : attached_bodies)
+  {
+    double radius = 0.0;
+    const EigenSTL::vector_Isometry3d& shape_poses = attached_body->getShapePosesInLinkFrame();
+    for (std::size_t i = 0; i < attached_body->getShapes().size(); ++i)
+    {
+      Eigen::Vector3d center;
+      double shape_radius;
+      shapes::computeShapeBoundingSphere(attached_body->getShapes()[i].get(), center, shape_radius);
+      radius = std::max(radius, (shape_poses[i] * center).norm() + shape_radius);
+    }
+    attached_radii.emplace_back(attached_body->getAttachedLink(), radius);
+  }
+
+  // A point p on a link moves by at most |t_to - t_from| + angle(R_from^-1 * R_to) * |p|.
+  double max_displacement = 0.0;
+  const auto link_displacement = [&](const moveit::core::LinkModel* link, double radius) {
+    const Eigen::Isometry3d& pose_from = from.getGlobalLinkTransform(link);
+    const Eigen::Isometry3d& pose_to = to.getGlobalLinkTransform(link);
+    const double angle = Eigen::AngleAxisd(pose_from.linear().transpose() * pose_to.linear()).angle();
+    return (pose_to.translation() - pose_from.translation()).norm() + std::abs(angle) * radius;
+  };
+  for (const moveit::core::LinkModel* link : to.getRobotModel()->getLinkModelsWithCollisionGeometry())
+  {
+    max_displacement = std::max(max_displacement, link_displacement(link, link_radii_[link->getLinkIndex()]));
+  }
+  for (const auto& [link, radius] : attached_radii)
+  {
+    max_displacement = std::max(max_displacement, link_displacement(link, radius));
+  }
+  return max_displacement;
+}
 }  // namespace moveit_servo
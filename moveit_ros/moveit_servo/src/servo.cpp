@@ -86,6 +86,10 @@ Servo::Servo(const rclcpp::Node::SharedPtr& node, std::shared_ptr<const servo::P
 
   servo_status_ = StatusCode::NO_WARNING;
 
+  // Preallocate the buffers used in every servo cycle.
+  joint_variables_to_halt_.reserve(
+      planning_scene_monitor_->getRobotModel()->getJointModelGroup(servo_params_.move_group_name)->getVariableCount());
+
   const auto& move_group_joint_names = planning_scene_monitor_->getRobotModel()
                                            ->getJointModelGroup(servo_params_.move_group_name)
                                            ->getActiveJointModelNames();
@@ -334,16 +338,13 @@ void Servo::setCommandType(const CommandType& command_type)
   expected_command_type_ = command_type;
 }
 
-KinematicState Servo::haltJoints(const std::vector<size_t>& joint_variables_to_halt,
-                                 const KinematicState& current_state, const KinematicState& target_state) const
+void Servo::haltJoints(const std::vector<size_t>& joint_variables_to_halt, const KinematicState& current_state,
+                       KinematicState& target_state) const
 {
-  KinematicState bounded_state(target_state.joint_names.size());
-  bounded_state.joint_names = target_state.joint_names;
-
   std::stringstream halting_joint_names;
   for (const auto idx : joint_variables_to_halt)
   {
-    halting_joint_names << bounded_state.joint_names[idx] + " ";
+    halting_joint_names << target_state.joint_names[idx] + " ";
   }
   RCLCPP_WARN_STREAM(logger_, "Joint position limit reached on joints: " << halting_joint_names.str());
 
@@ -353,37 +354,35 @@ KinematicState Servo::haltJoints(const std::vector<size_t>& joint_variables_to_h
 
   if (all_joint_halt)
   {
-    // The velocities are initialized to zero by default, so we don't need to set it here.
-    bounded_state.positions = current_state.positions;
+    target_state.positions = current_state.positions;
+    target_state.velocities.setZero();
   }
   else
   {
     // Halt only the joints that are out of bounds
-    bounded_state.positions = target_state.positions;
-    bounded_state.velocities = target_state.velocities;
     for (const auto idx : joint_variables_to_halt)
     {
-      bounded_state.positions[idx] = current_state.positions[idx];
-      bounded_state.velocities[idx] = 0.0;
+      target_state.positions[idx] = current_state.positions[idx];
+      target_state.velocities[idx] = 0.0;
     }
   }
-
-  return bounded_state;
+  target_state.accelerations.setZero();
 }
 
-Eigen::VectorXd Servo::jointDeltaFromCommand(const ServoInput& command, const moveit::core::RobotStatePtr& robot_state)
+void Servo::jointDeltaFromCommand(const ServoInput& command, const moveit::core::RobotStatePtr& robot_state,
+                                  Eigen::VectorXd& joint_position_deltas)
 {
-  // Determine joint_name_group_index_map, if no subgroup is active, the map is empty
+  // Determine joint_name_group_index_map, if no subgroup is active, the map is empty.
+  // Both branches are lvalues so that the map is bound by reference rather than copied every cycle.
+  static const JointNameToMoveGroupIndexMap EMPTY_JOINT_NAME_GROUP_INDEX_MAP;
   const auto& active_subgroup_name =
       servo_params_.active_subgroup.empty() ? servo_params_.move_group_name : servo_params_.active_subgroup;
   const auto& joint_name_group_index_map = (active_subgroup_name != servo_params_.move_group_name) ?
                                                joint_name_to_index_maps_.at(servo_params_.active_subgroup) :
-                                               JointNameToMoveGroupIndexMap();
+                                               EMPTY_JOINT_NAME_GROUP_INDEX_MAP;
 
   const int num_joints =
       robot_state->getJointModelGroup(servo_params_.move_group_name)->getActiveJointModelNames().size();
-  Eigen::VectorXd joint_position_deltas(num_joints);
-  joint_position_deltas.setZero();
 
   JointDeltaResult delta_result;
 
@@ -392,9 +391,14 @@ Eigen::VectorXd Servo::jointDeltaFromCommand(const ServoInput& command, const mo
   {
     if (expected_type == CommandType::JOINT_JOG)
     {
-      delta_result = jointDeltaFromJointJog(std::get<JointJogCommand>(command), robot_state, servo_params_,
-                                            joint_name_group_index_map);
-      servo_status_ = delta_result.first;
+      // Joint jog commands are written straight into the output vector, which is reused across cycles.
+      servo_status_ = jointDeltaFromJointJog(std::get<JointJogCommand>(command), robot_state, servo_params_,
+                                             joint_name_group_index_map, joint_position_deltas);
+      if (servo_status_ == StatusCode::INVALID)
+      {
+        joint_position_deltas.setZero(num_joints);
+      }
+      return;
     }
     else if (expected_type == CommandType::TWIST)
     {
@@ -408,7 +412,7 @@ Eigen::VectorXd Servo::jointDeltaFromCommand(const ServoInput& command, const mo
         if (command_in_planning_frame_maybe.has_value())
         {
           delta_result = jointDeltaFromTwist(*command_in_planning_frame_maybe, robot_state, servo_params_,
-                                             planning_frame, joint_name_group_index_map);
+                                             planning_frame, joint_name_group_index_map, jacobian_solver_);
           servo_status_ = delta_result.first;
         }
         else
@@ -437,7 +441,8 @@ Eigen::VectorXd Servo::jointDeltaFromCommand(const ServoInput& command, const mo
         if (command_in_planning_frame_maybe.has_value())
         {
           delta_result = jointDeltaFromPose(*command_in_planning_frame_maybe, robot_state, servo_params_,
-                                            planning_frame, *ee_frame_maybe, joint_name_group_index_map);
+                                            planning_frame, *ee_frame_maybe, joint_name_group_index_map,
+                                            jacobian_solver_);
           servo_status_ = delta_result.first;
         }
         else
@@ -456,6 +461,7 @@ Eigen::VectorXd Servo::jointDeltaFromCommand(const ServoInput& command, const mo
     if (servo_status_ != StatusCode::INVALID)
     {
       joint_position_deltas = delta_result.second;
+      return;
     }
   }
   else
@@ -464,10 +470,18 @@ Eigen::VectorXd Servo::jointDeltaFromCommand(const ServoInput& command, const mo
     RCLCPP_WARN_STREAM(logger_, "Incoming servo command type does not match known command types.");
   }
 
-  return joint_position_deltas;
+  joint_position_deltas.setZero(num_joints);
 }
 
 KinematicState Servo::getNextJointState(const moveit::core::RobotStatePtr& robot_state, const ServoInput& command)
+{
+  KinematicState target_state;
+  getNextJointState(robot_state, command, target_state);
+  return target_state;
+}
+
+void Servo::getNextJointState(const moveit::core::RobotStatePtr& robot_state, const ServoInput& command,
+                              KinematicState& target_state)
 {
   // Set status to clear
   servo_status_ = StatusCode::NO_WARNING;
@@ -480,17 +494,21 @@ KinematicState Servo::getNextJointState(const moveit::core::RobotStatePtr& robot
       robot_state->getJointModelGroup(servo_params_.move_group_name);
 
   // Get necessary information about joints
-  const std::vector<std::string> joint_names = joint_model_group->getActiveJointModelNames();
-  const moveit::core::JointBoundsVector joint_bounds = joint_model_group->getActiveJointModelsBounds();
+  const std::vector<std::string>& joint_names = joint_model_group->getActiveJointModelNames();
+  const moveit::core::JointBoundsVector& joint_bounds = joint_model_group->getActiveJointModelsBounds();
   const int num_joints = joint_names.size();
 
-  // Extract current state from robot state
-  KinematicState current_state = extractRobotState(robot_state, servo_params_.move_group_name);
-  KinematicState target_state(num_joints);
+  // Extract current state from robot state. The scratch state and the target keep their storage between cycles.
+  KinematicState& current_state = current_state_;
+  extractRobotState(robot_state, servo_params_.move_group_name, current_state);
   target_state.joint_names = joint_names;
+  target_state.positions.setZero(num_joints);
+  target_state.velocities.setZero(num_joints);
+  target_state.accelerations.setZero(num_joints);
 
   // Compute the change in joint position due to the incoming command
-  Eigen::VectorXd joint_position_delta = jointDeltaFromCommand(command, robot_state);
+  Eigen::VectorXd& joint_position_delta = joint_position_delta_;
+  jointDeltaFromCommand(command, robot_state, joint_position_delta);
 
   if (collision_velocity_scale_ > 0 && collision_velocity_scale_ < 1)
   {
@@ -531,21 +549,33 @@ KinematicState Servo::getNextJointState(const moveit::core::RobotStatePtr& robot
     target_state.velocities = (target_state.positions - current_state.positions) / servo_params_.publish_period;
 
     // Check if any joints are going past joint position limits.
-    const std::vector<size_t> joint_variables_to_halt =
-        jointVariablesToHalt(target_state.positions, target_state.velocities, joint_bounds, joint_limit_margins_);
+    jointVariablesToHalt(target_state.positions, target_state.velocities, joint_bounds, joint_limit_margins_,
+                         joint_variables_to_halt_);
 
     // Apply halting if any joints need to be halted.
-    if (!joint_variables_to_halt.empty())
+    if (!joint_variables_to_halt_.empty())
     {
       servo_status_ = StatusCode::JOINT_BOUND;
-      target_state = haltJoints(joint_variables_to_halt, current_state, target_state);
+      haltJoints(joint_variables_to_halt_, current_state, target_state);
     }
   }
 
   // Apply smoothing to the positions if a smoother was provided.
   doSmoothing(target_state);
 
-  return target_state;
+  // Let the collision monitor look ahead at the state about to be commanded. Invalid or halting commands do not
+  // compute a target, the current state is checked for them.
+  if (servo_params_.check_commanded_state_collisions)
+  {
+    if (servo_status_ != StatusCode::INVALID && servo_status_ != StatusCode::HALT_FOR_COLLISION)
+    {
+      collision_monitor_->setCommandedJointPositions(target_state.positions);
+    }
+    else
+    {
+      collision_monitor_->clearCommandedJointPositions();
+    }
+  }
 }
 
 std::optional<Eigen::Isometry3d> Servo::getPlanningToCommandFrameTransform(const std::string& command_frame,
@@ -662,7 +692,14 @@ KinematicState Servo::getCurrentRobotState(bool block_for_current_state) const
 
 std::pair<bool, KinematicState> Servo::smoothHalt(const KinematicState& halt_state)
 {
-  auto target_state = halt_state;
+  KinematicState target_state;
+  const bool stopped = smoothHalt(halt_state, target_state);
+  return std::make_pair(stopped, target_state);
+}
+
+bool Servo::smoothHalt(const KinematicState& halt_state, KinematicState& target_state)
+{
+  target_state = halt_state;
 
   // If all velocities are near zero, robot has decelerated to a stop.
   bool stopped = (target_state.velocities.cwiseAbs().array() < STOPPED_VELOCITY_EPS).all();
@@ -688,7 +725,7 @@ std::pair<bool, KinematicState> Servo::smoothHalt(const KinematicState& halt_sta
   // apply smoothing: this will change target position/velocity to make slow down gradual
   doSmoothing(target_state);
 
-  return std::make_pair(stopped, target_state);
+  return stopped;
 }
 
 }  // namespace moveit_servo
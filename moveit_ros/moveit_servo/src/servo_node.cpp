@@ -48,6 +48,9 @@
 #include <moveit/utils/logger.hpp>
 #include <moveit_servo/servo_node.hpp>
 
+#include <cmath>
+#include <memory>
+
 namespace moveit_servo
 {
 
@@ -62,6 +65,30 @@ rclcpp::Time convertClockType(const rclcpp::Time& time, rcl_clock_type_t new_clo
   }
   return time;
 }
+
+// The QoS of the servo topics. Intra-process communication requires an explicit keep-last history, and servo only ever
+// uses the latest command, just as controllers only need the latest output.
+rclcpp::QoS servoTopicQoS(bool use_intra_process_comms)
+{
+  return use_intra_process_comms ? rclcpp::SystemDefaultsQoS().keep_last(1) : rclcpp::SystemDefaultsQoS();
+}
+
+// Publishes a message that is reused in every cycle. If the middleware can loan messages, the message is copied into
+// a loaned one. Otherwise the reused message is published, and rclcpp copies it for subscribers in the same process.
+template <typename MessageT>
+void publishMessage(rclcpp::Publisher<MessageT>& publisher, const MessageT& msg)
+{
+  if (publisher.can_loan_messages())
+  {
+    auto loaned_msg = publisher.borrow_loaned_message();
+    loaned_msg.get() = msg;
+    publisher.publish(std::move(loaned_msg));
+  }
+  else
+  {
+    publisher.publish(msg);
+  }
+}
 }  // namespace
 
 rclcpp::node_interfaces::NodeBaseInterface::SharedPtr ServoNode::get_node_base_interface()
@@ -83,6 +110,7 @@ ServoNode::ServoNode(const rclcpp::NodeOptions& options)
   , new_joint_jog_msg_{ false }
   , new_twist_msg_{ false }
   , new_pose_msg_{ false }
+  , use_intra_process_comms_{ node_->get_node_options().use_intra_process_comms() }
 {
   moveit::setNodeLoggerName(node_->get_name());
 
@@ -111,34 +139,40 @@ ServoNode::ServoNode(const rclcpp::NodeOptions& options)
 
   servo_params_ = servo_->getParams();
 
+  const rclcpp::QoS servo_topic_qos = servoTopicQoS(use_intra_process_comms_);
+  if (use_intra_process_comms_)
+  {
+    RCLCPP_INFO_STREAM(node_->get_logger(), "Using intra-process communication for commands and outputs.");
+  }
+
   // Create subscriber for jointjog
   joint_jog_subscriber_ = node_->create_subscription<control_msgs::msg::JointJog>(
-      servo_params_.joint_command_in_topic, rclcpp::SystemDefaultsQoS(),
+      servo_params_.joint_command_in_topic, servo_topic_qos,
       [this](const control_msgs::msg::JointJog::ConstSharedPtr& msg) { return jointJogCallback(msg); });
 
   // Create subscriber for twist
   twist_subscriber_ = node_->create_subscription<geometry_msgs::msg::TwistStamped>(
-      servo_params_.cartesian_command_in_topic, rclcpp::SystemDefaultsQoS(),
+      servo_params_.cartesian_command_in_topic, servo_topic_qos,
       [this](const geometry_msgs::msg::TwistStamped::ConstSharedPtr& msg) { return twistCallback(msg); });
 
   // Create subscriber for pose
   pose_subscriber_ = node_->create_subscription<geometry_msgs::msg::PoseStamped>(
-      servo_params_.pose_command_in_topic, rclcpp::SystemDefaultsQoS(),
+      servo_params_.pose_command_in_topic, servo_topic_qos,
       [this](const geometry_msgs::msg::PoseStamped::ConstSharedPtr& msg) { return poseCallback(msg); });
 
   if (servo_params_.command_out_type == "trajectory_msgs/JointTrajectory")
   {
     trajectory_publisher_ = node_->create_publisher<trajectory_msgs::msg::JointTrajectory>(
-        servo_params_.command_out_topic, rclcpp::SystemDefaultsQoS());
+        servo_params_.command_out_topic, servo_topic_qos);
   }
   else if (servo_params_.command_out_type == "std_msgs/Float64MultiArray")
   {
-    multi_array_publisher_ = node_->create_publisher<std_msgs::msg::Float64MultiArray>(servo_params_.command_out_topic,
-                                                                                       rclcpp::SystemDefaultsQoS());
+    multi_array_publisher_ =
+        node_->create_publisher<std_msgs::msg::Float64MultiArray>(servo_params_.command_out_topic, servo_topic_qos);
   }
   // Create status publisher
   status_publisher_ =
-      node_->create_publisher<moveit_msgs::msg::ServoStatus>(servo_params_.status_topic, rclcpp::SystemDefaultsQoS());
+      node_->create_publisher<moveit_msgs::msg::ServoStatus>(servo_params_.status_topic, servo_topic_qos);
 
   // Create service to enable switching command type
   switch_command_type_ = node_->create_service<moveit_msgs::srv::ServoCommandType>(
@@ -210,40 +244,44 @@ void ServoNode::switchCommandType(const std::shared_ptr<moveit_msgs::srv::ServoC
 
 void ServoNode::jointJogCallback(const control_msgs::msg::JointJog::ConstSharedPtr& msg)
 {
-  latest_joint_jog_ = *msg;
+  std::atomic_store(&latest_joint_jog_, msg);
   new_joint_jog_msg_ = true;
 }
 
 void ServoNode::twistCallback(const geometry_msgs::msg::TwistStamped::ConstSharedPtr& msg)
 {
-  latest_twist_ = *msg;
+  std::atomic_store(&latest_twist_, msg);
   new_twist_msg_ = true;
 }
 
 void ServoNode::poseCallback(const geometry_msgs::msg::PoseStamped::ConstSharedPtr& msg)
 {
-  latest_pose_ = *msg;
+  std::atomic_store(&latest_pose_, msg);
   new_pose_msg_ = true;
 }
 
-std::optional<KinematicState> ServoNode::processJointJogCommand(const moveit::core::RobotStatePtr& robot_state)
+bool ServoNode::processJointJogCommand(const moveit::core::RobotStatePtr& robot_state)
 {
-  std::optional<KinematicState> next_joint_state = std::nullopt;
+  bool has_next_state = false;
   // Reject any other command types that had arrived simultaneously.
   new_twist_msg_ = new_pose_msg_ = false;
 
-  if (!latest_joint_jog_.displacements.empty())
+  const auto latest_joint_jog = std::atomic_load(&latest_joint_jog_);
+  if (!latest_joint_jog->displacements.empty() && latest_joint_jog != warned_joint_jog_)
   {
     RCLCPP_WARN(node_->get_logger(), "Joint jog command displacements field is not yet supported, ignoring.");
-    latest_joint_jog_.displacements.clear();  // Only warn once per message.
+    warned_joint_jog_ = latest_joint_jog;  // Only warn once per message.
   }
 
-  const bool command_stale = (node_->now() - latest_joint_jog_.header.stamp) >=
+  const bool command_stale = (node_->now() - latest_joint_jog->header.stamp) >=
                              rclcpp::Duration::from_seconds(servo_params_.incoming_command_timeout);
   if (!command_stale)
   {
-    JointJogCommand command{ latest_joint_jog_.joint_names, latest_joint_jog_.velocities };
-    next_joint_state = servo_->getNextJointState(robot_state, command);
+    auto& command = std::get<JointJogCommand>(joint_jog_command_);
+    command.names = latest_joint_jog->joint_names;
+    command.velocities = latest_joint_jog->velocities;
+    servo_->getNextJointState(robot_state, joint_jog_command_, next_joint_state_);
+    has_next_state = true;
     // If the command failed, stop trying to process this message
     if (servo_->getStatus() == StatusCode::INVALID)
     {
@@ -252,35 +290,36 @@ std::optional<KinematicState> ServoNode::processJointJogCommand(const moveit::co
   }
   else
   {
-    auto result = servo_->smoothHalt(last_commanded_state_);
-    new_joint_jog_msg_ = !result.first;
+    new_joint_jog_msg_ = !servo_->smoothHalt(last_commanded_state_, next_joint_state_);
     if (new_joint_jog_msg_)
     {
-      next_joint_state = result.second;
+      has_next_state = true;
       RCLCPP_DEBUG_STREAM(node_->get_logger(), "Joint jog command timed out. Halting to a stop.");
     }
   }
 
-  return next_joint_state;
+  return has_next_state;
 }
 
-std::optional<KinematicState> ServoNode::processTwistCommand(const moveit::core::RobotStatePtr& robot_state)
+bool ServoNode::processTwistCommand(const moveit::core::RobotStatePtr& robot_state)
 {
-  std::optional<KinematicState> next_joint_state = std::nullopt;
+  bool has_next_state = false;
 
   // Mark latest twist command as processed.
   // Reject any other command types that had arrived simultaneously.
   new_joint_jog_msg_ = new_pose_msg_ = false;
 
-  const bool command_stale = (node_->now() - latest_twist_.header.stamp) >=
+  const auto latest_twist = std::atomic_load(&latest_twist_);
+  const bool command_stale = (node_->now() - latest_twist->header.stamp) >=
                              rclcpp::Duration::from_seconds(servo_params_.incoming_command_timeout);
   if (!command_stale)
   {
-    const Eigen::Vector<double, 6> velocities{ latest_twist_.twist.linear.x,  latest_twist_.twist.linear.y,
-                                               latest_twist_.twist.linear.z,  latest_twist_.twist.angular.x,
-                                               latest_twist_.twist.angular.y, latest_twist_.twist.angular.z };
-    const TwistCommand command{ latest_twist_.header.frame_id, velocities };
-    next_joint_state = servo_->getNextJointState(robot_state, command);
+    auto& command = std::get<TwistCommand>(twist_command_);
+    command.frame_id = latest_twist->header.frame_id;
+    command.velocities << latest_twist->twist.linear.x, latest_twist->twist.linear.y, latest_twist->twist.linear.z,
+        latest_twist->twist.angular.x, latest_twist->twist.angular.y, latest_twist->twist.angular.z;
+    servo_->getNextJointState(robot_state, twist_command_, next_joint_state_);
+    has_next_state = true;
     if (servo_->getStatus() == StatusCode::INVALID)
     {
       new_twist_msg_ = false;
@@ -288,32 +327,33 @@ std::optional<KinematicState> ServoNode::processTwistCommand(const moveit::core:
   }
   else
   {
-    auto result = servo_->smoothHalt(last_commanded_state_);
-    new_twist_msg_ = !result.first;
+    new_twist_msg_ = !servo_->smoothHalt(last_commanded_state_, next_joint_state_);
     if (new_twist_msg_)
     {
-      next_joint_state = result.second;
+      has_next_state = true;
       RCLCPP_DEBUG_STREAM(node_->get_logger(), "Twist command timed out. Halting to a stop.");
     }
   }
 
-  return next_joint_state;
+  return has_next_state;
 }
 
-std::optional<KinematicState> ServoNode::processPoseCommand(const moveit::core::RobotStatePtr& robot_state)
+bool ServoNode::processPoseCommand(const moveit::core::RobotStatePtr& robot_state)
 {
-  std::optional<KinematicState> next_joint_state = std::nullopt;
+  bool has_next_state = false;
 
   // Mark latest pose command as processed.
   // Reject any other command types that had arrived simultaneously.
   new_joint_jog_msg_ = new_twist_msg_ = false;
 
-  const bool command_stale = (node_->now() - latest_pose_.header.stamp) >=
+  const auto latest_pose = std::atomic_load(&latest_pose_);
+  const bool command_stale = (node_->now() - latest_pose->header.stamp) >=
                              rclcpp::Duration::from_seconds(servo_params_.incoming_command_timeout);
   if (!command_stale)
   {
-    const PoseCommand command = poseFromPoseStamped(latest_pose_);
-    next_joint_state = servo_->getNextJointState(robot_state, command);
+    poseFromPoseStamped(*latest_pose, std::get<PoseCommand>(pose_command_));
+    servo_->getNextJointState(robot_state, pose_command_, next_joint_state_);
+    has_next_state = true;
     if (servo_->getStatus() == StatusCode::INVALID)
     {
       new_pose_msg_ = false;
@@ -321,24 +361,25 @@ std::optional<KinematicState> ServoNode::processPoseCommand(const moveit::core::
   }
   else
   {
-    auto result = servo_->smoothHalt(last_commanded_state_);
-    new_pose_msg_ = !result.first;
+    new_pose_msg_ = !servo_->smoothHalt(last_commanded_state_, next_joint_state_);
     if (new_pose_msg_)
     {
-      next_joint_state = result.second;
+      has_next_state = true;
       RCLCPP_DEBUG_STREAM(node_->get_logger(), "Pose command timed out. Halting to a stop.");
     }
   }
 
-  return next_joint_state;
+  return has_next_state;
 }
 
-void ServoNode::servoLoop()
+void ServoNode::updateCurrentState()
 {
-  moveit_msgs::msg::ServoStatus status_msg;
-  std::optional<KinematicState> next_joint_state = std::nullopt;
-  rclcpp::WallRate servo_frequency(1 / servo_params_.publish_period);
+  planning_scene_monitor_->getStateMonitor()->setToCurrentState(*robot_state_);
+  extractRobotState(robot_state_, servo_params_.move_group_name, current_state_);
+}
 
+void ServoNode::initializeServoLoop()
+{
   const auto servo_node_start = node_->now();
 
   // convert_clock_type() is used in case planning_scene_monitor uses RCL_SYSTEM_TIME
@@ -353,98 +394,127 @@ void ServoNode::servoLoop()
     RCLCPP_INFO(node_->get_logger(), "Waiting to receive robot state update.");
     rclcpp::sleep_for(std::chrono::seconds(1));
   }
-  KinematicState current_state = servo_->getCurrentRobotState(true /* block for current robot state */);
-  last_commanded_state_ = current_state;
+  current_state_ = servo_->getCurrentRobotState(true /* block for current robot state */);
+  last_commanded_state_ = current_state_;
+  next_joint_state_ = current_state_;
   // Ensure the filter is up to date
-  servo_->resetSmoothing(current_state);
+  servo_->resetSmoothing(current_state_);
+
+  // Preallocate the command window so that updating it does not allocate in steady state.
+  // The window holds the commands of one latency period, plus the newest command and one spare slot.
+  joint_cmd_rolling_window_.reserve(
+      static_cast<size_t>(std::ceil(servo_params_.max_expected_latency / servo_params_.publish_period)) + 2,
+      current_state_);
 
   // Get the robot state and joint model group info.
-  moveit::core::RobotStatePtr robot_state = planning_scene_monitor_->getStateMonitor()->getCurrentState();
-  const moveit::core::JointModelGroup* joint_model_group =
-      robot_state->getJointModelGroup(servo_params_.move_group_name);
+  robot_state_ = planning_scene_monitor_->getStateMonitor()->getCurrentState();
+  joint_model_group_ = robot_state_->getJointModelGroup(servo_params_.move_group_name);
+}
+
+bool ServoNode::computeNextCommand()
+{
+  const bool use_trajectory = servo_params_.command_out_type == "trajectory_msgs/JointTrajectory";
+  const auto cur_time = node_->now();
+
+  if (use_trajectory && !joint_cmd_rolling_window_.empty() && joint_cmd_rolling_window_.back().time_stamp > cur_time)
+  {
+    current_state_ = joint_cmd_rolling_window_.back();
+  }
+  else
+  {
+    // if all joint_cmd_rolling_window_ is empty or all commands in it are outdated, use current robot state
+    joint_cmd_rolling_window_.clear();
+    updateCurrentState();
+    current_state_.velocities *= 0.0;
+  }
+
+  // update robot state values
+  robot_state_->setJointGroupPositions(joint_model_group_, current_state_.positions);
+  robot_state_->setJointGroupVelocities(joint_model_group_, current_state_.velocities);
+
+  bool has_next_state = false;
+  const CommandType expected_type = servo_->getCommandType();
+
+  if (expected_type == CommandType::JOINT_JOG && new_joint_jog_msg_)
+  {
+    has_next_state = processJointJogCommand(robot_state_);
+  }
+  else if (expected_type == CommandType::TWIST && new_twist_msg_)
+  {
+    has_next_state = processTwistCommand(robot_state_);
+  }
+  else if (expected_type == CommandType::POSE && new_pose_msg_)
+  {
+    has_next_state = processPoseCommand(robot_state_);
+  }
+  else if (new_joint_jog_msg_ || new_twist_msg_ || new_pose_msg_)
+  {
+    new_joint_jog_msg_ = new_twist_msg_ = new_pose_msg_ = false;
+    RCLCPP_WARN_STREAM(node_->get_logger(), "Command type has not been set, cannot accept input");
+  }
+
+  if (has_next_state && (servo_->getStatus() != StatusCode::INVALID) &&
+      (servo_->getStatus() != StatusCode::HALT_FOR_COLLISION))
+  {
+    if (use_trajectory)
+    {
+      updateSlidingWindow(next_joint_state_, joint_cmd_rolling_window_, servo_params_.max_expected_latency, cur_time);
+      has_next_state = composeTrajectoryMessage(servo_params_, joint_cmd_rolling_window_, trajectory_msg_);
+    }
+    else
+    {
+      composeMultiArrayMessage(servo_->getParams(), next_joint_state_, multi_array_msg_);
+    }
+    last_commanded_state_ = next_joint_state_;
+    return has_next_state;
+  }
+
+  // if no new command was created, use current robot state
+  updateCurrentState();
+  last_commanded_state_ = current_state_;
+  updateSlidingWindow(current_state_, joint_cmd_rolling_window_, servo_params_.max_expected_latency, cur_time);
+  servo_->resetSmoothing(current_state_);
+  return false;
+}
+
+void ServoNode::publishCommand(bool publish_command)
+{
+  if (publish_command)
+  {
+    if (trajectory_publisher_)
+    {
+      publishMessage(*trajectory_publisher_, trajectory_msg_);
+    }
+    else
+    {
+      publishMessage(*multi_array_publisher_, multi_array_msg_);
+    }
+  }
+
+  status_msg_.code = static_cast<int8_t>(servo_->getStatus());
+  status_msg_.message = servo_->getStatusMessage();
+  status_publisher_->publish(status_msg_);
+}
+
+void ServoNode::servoLoop()
+{
+  rclcpp::WallRate servo_frequency(1 / servo_params_.publish_period);
+
+  initializeServoLoop();
 
   while (rclcpp::ok() && !stop_servo_)
   {
     // Skip processing if servoing is disabled.
     if (servo_paused_)
     {
-      servo_->resetSmoothing(current_state);
+      servo_->resetSmoothing(current_state_);
       servo_frequency.sleep();
       continue;
     }
 
     {  // scope for mutex-protected operations
       std::lock_guard<std::mutex> lock_guard(lock_);
-      const bool use_trajectory = servo_params_.command_out_type == "trajectory_msgs/JointTrajectory";
-      const auto cur_time = node_->now();
-
-      if (use_trajectory && !joint_cmd_rolling_window_.empty() && joint_cmd_rolling_window_.back().time_stamp > cur_time)
-      {
-        current_state = joint_cmd_rolling_window_.back();
-      }
-      else
-      {
-        // if all joint_cmd_rolling_window_ is empty or all commands in it are outdated, use current robot state
-        joint_cmd_rolling_window_.clear();
-        current_state = servo_->getCurrentRobotState(false /* block for current robot state */);
-        current_state.velocities *= 0.0;
-      }
-
-      // update robot state values
-      robot_state->setJointGroupPositions(joint_model_group, current_state.positions);
-      robot_state->setJointGroupVelocities(joint_model_group, current_state.velocities);
-
-      next_joint_state = std::nullopt;
-      const CommandType expected_type = servo_->getCommandType();
-
-      if (expected_type == CommandType::JOINT_JOG && new_joint_jog_msg_)
-      {
-        next_joint_state = processJointJogCommand(robot_state);
-      }
-      else if (expected_type == CommandType::TWIST && new_twist_msg_)
-      {
-        next_joint_state = processTwistCommand(robot_state);
-      }
-      else if (expected_type == CommandType::POSE && new_pose_msg_)
-      {
-        next_joint_state = processPoseCommand(robot_state);
-      }
-      else if (new_joint_jog_msg_ || new_twist_msg_ || new_pose_msg_)
-      {
-        new_joint_jog_msg_ = new_twist_msg_ = new_pose_msg_ = false;
-        RCLCPP_WARN_STREAM(node_->get_logger(), "Command type has not been set, cannot accept input");
-      }
-
-      if (next_joint_state && (servo_->getStatus() != StatusCode::INVALID) &&
-          (servo_->getStatus() != StatusCode::HALT_FOR_COLLISION))
-      {
-        if (use_trajectory)
-        {
-          auto& next_joint_state_value = next_joint_state.value();
-          updateSlidingWindow(next_joint_state_value, joint_cmd_rolling_window_, servo_params_.max_expected_latency,
-                              cur_time);
-          if (const auto msg = composeTrajectoryMessage(servo_params_, joint_cmd_rolling_window_))
-          {
-            trajectory_publisher_->publish(msg.value());
-          }
-        }
-        else
-        {
-          multi_array_publisher_->publish(composeMultiArrayMessage(servo_->getParams(), next_joint_state.value()));
-        }
-        last_commanded_state_ = next_joint_state.value();
-      }
-      else
-      {
-        // if no new command was created, use current robot state
-        last_commanded_state_ = current_state = servo_->getCurrentRobotState(false);
-        updateSlidingWindow(current_state, joint_cmd_rolling_window_, servo_params_.max_expected_latency, cur_time);
-        servo_->resetSmoothing(current_state);
-      }
-
-      status_msg.code = static_cast<int8_t>(servo_->getStatus());
-      status_msg.message = servo_->getStatusMessage();
-      status_publisher_->publish(status_msg);
+      publishCommand(computeNextCommand());
     }
 
     servo_frequency.sleep();
@@ -82,23 +82,33 @@ namespace moveit_servo
 JointDeltaResult jointDeltaFromJointJog(const JointJogCommand& command, const moveit::core::RobotStatePtr& robot_state,
                                         const servo::Params& servo_params,
                                         const JointNameToMoveGroupIndexMap& joint_name_group_index_map)
+{
+  Eigen::VectorXd joint_position_delta;
+  const StatusCode status =
+      jointDeltaFromJointJog(command, robot_state, servo_params, joint_name_group_index_map, joint_position_delta);
+  return std::make_pair(status, joint_position_delta);
+}
+
+StatusCode jointDeltaFromJointJog(const JointJogCommand& command, const moveit::core::RobotStatePtr& robot_state,
+                                  const servo::Params& servo_params,
+                                  const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                                  Eigen::VectorXd& joint_position_delta)
 {
   // Find the target joint position based on the commanded joint velocity
   const auto& group_name =
       servo_params.active_subgroup.empty() ? servo_params.move_group_name : servo_params.active_subgroup;
   const moveit::core::JointModelGroup* joint_model_group = robot_state->getJointModelGroup(group_name);
-  const auto joint_names = joint_model_group->getActiveJointModelNames();
-  Eigen::VectorXd joint_position_delta(joint_names.size());
-  Eigen::VectorXd velocities(joint_names.size());
+  const auto& joint_names = joint_model_group->getActiveJointModelNames();
 
-  velocities.setZero();
+  // The commanded velocities are gathered in the output vector and scaled to a position delta in place.
+  joint_position_delta.setZero(joint_names.size());
   if (command.velocities.size() != command.names.size())
   {
     RCLCPP_WARN_STREAM(getLogger(), "Invalid joint jog command. Each joint name must have one corresponding "
                                     "velocity command. Received "
                                         << command.names.size() << " joints with " << command.velocities.size()
                                         << " commands.");
-    return std::make_pair(StatusCode::INVALID, joint_position_delta);
+    return StatusCode::INVALID;
   }
 
   for (size_t i = 0; i < command.names.size(); ++i)
@@ -106,7 +116,7 @@ JointDeltaResult jointDeltaFromJointJog(const JointJogCommand& command, const mo
     auto it = std::find(joint_names.begin(), joint_names.end(), command.names[i]);
     if (it != std::end(joint_names))
     {
-      velocities[std::distance(joint_names.begin(), it)] = command.velocities[i];
+      joint_position_delta[std::distance(joint_names.begin(), it)] = command.velocities[i];
     }
     else
     {
@@ -115,17 +125,17 @@ JointDeltaResult jointDeltaFromJointJog(const JointJogCommand& command, const mo
                                                                 "that is not part of the move group or certain joints "
                                                                 "cannot be moved because a "
                                                                 "subgroup is active and they are not part of it.");
-      return std::make_pair(StatusCode::INVALID, joint_position_delta);
+      return StatusCode::INVALID;
     }
   }
 
-  if (!isValidCommand(velocities))
+  if (!isValidCommand(joint_position_delta))
   {
     RCLCPP_WARN_STREAM(getLogger(), "Invalid velocity values in joint jog command");
-    return std::make_pair(StatusCode::INVALID, joint_position_delta);
+    return StatusCode::INVALID;
   }
 
-  joint_position_delta = velocities * servo_params.publish_period;
+  joint_position_delta *= servo_params.publish_period;
   if (servo_params.command_in_type == "unitless")
   {
     joint_position_delta *= servo_params.scale.joint;
@@ -133,16 +143,26 @@ JointDeltaResult jointDeltaFromJointJog(const JointJogCommand& command, const mo
 
   if (!servo_params.active_subgroup.empty() && servo_params.active_subgroup != servo_params.move_group_name)
   {
-    return std::make_pair(StatusCode::NO_WARNING, createMoveGroupDelta(joint_position_delta, robot_state, servo_params,
-                                                                       joint_name_group_index_map));
+    joint_position_delta =
+        createMoveGroupDelta(joint_position_delta, robot_state, servo_params, joint_name_group_index_map);
   }
 
-  return std::make_pair(StatusCode::NO_WARNING, joint_position_delta);
+  return StatusCode::NO_WARNING;
 }
 
 JointDeltaResult jointDeltaFromTwist(const TwistCommand& command, const moveit::core::RobotStatePtr& robot_state,
                                      const servo::Params& servo_params, const std::string& planning_frame,
                                      const JointNameToMoveGroupIndexMap& joint_name_group_index_map)
+{
+  JacobianSolver jacobian_solver;
+  return jointDeltaFromTwist(command, robot_state, servo_params, planning_frame, joint_name_group_index_map,
+                             jacobian_solver);
+}
+
+JointDeltaResult jointDeltaFromTwist(const TwistCommand& command, const moveit::core::RobotStatePtr& robot_state,
+                                     const servo::Params& servo_params, const std::string& planning_frame,
+                                     const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                                     JacobianSolver& jacobian_solver)
 {
   StatusCode status = StatusCode::NO_WARNING;
   const int num_joints =
@@ -199,15 +219,15 @@ JointDeltaResult jointDeltaFromTwist(const TwistCommand& command, const moveit::
     }
 
     // Compute the required change in joint angles.
-    const auto delta_result =
-        jointDeltaFromIK(cartesian_position_delta, robot_state, servo_params, joint_name_group_index_map);
+    const auto delta_result = jointDeltaFromIK(cartesian_position_delta, robot_state, servo_params,
+                                               joint_name_group_index_map, jacobian_solver);
     status = delta_result.first;
     if (status != StatusCode::INVALID)
     {
       joint_position_delta = delta_result.second;
       // Get velocity scaling information for singularity.
       const auto singularity_scaling_info =
-          velocityScalingFactorForSingularity(robot_state, cartesian_position_delta, servo_params);
+          velocityScalingFactorForSingularity(robot_state, cartesian_position_delta, servo_params, jacobian_solver);
       // Apply velocity scaling for singularity, if there was any scaling.
       if (singularity_scaling_info.second != StatusCode::NO_WARNING)
       {
@@ -225,6 +245,17 @@ JointDeltaResult jointDeltaFromPose(const PoseCommand& command, const moveit::co
                                     const servo::Params& servo_params, const std::string& planning_frame,
                                     const std::string& ee_frame,
                                     const JointNameToMoveGroupIndexMap& joint_name_group_index_map)
+{
+  JacobianSolver jacobian_solver;
+  return jointDeltaFromPose(command, robot_state, servo_params, planning_frame, ee_frame, joint_name_group_index_map,
+                            jacobian_solver);
+}
+
+JointDeltaResult jointDeltaFromPose(const PoseCommand& command, const moveit::core::RobotStatePtr& robot_state,
+                                    const servo::Params& servo_params, const std::string& planning_frame,
+                                    const std::string& ee_frame,
+                                    const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                                    JacobianSolver& jacobian_solver)
 {
   StatusCode status = StatusCode::NO_WARNING;
   const int num_joints =
@@ -278,15 +309,15 @@ JointDeltaResult jointDeltaFromPose(const PoseCommand& command, const moveit::co
   cartesian_position_delta.tail<3>() = angle_axis_error.axis() * angle_axis_error.angle();
 
   // Compute the required change in joint angles.
-  const auto delta_result =
-      jointDeltaFromIK(cartesian_position_delta, robot_state, servo_params, joint_name_group_index_map);
+  const auto delta_result = jointDeltaFromIK(cartesian_position_delta, robot_state, servo_params,
+                                             joint_name_group_index_map, jacobian_solver);
   status = delta_result.first;
   if (status != StatusCode::INVALID)
   {
     joint_position_delta = delta_result.second;
     // Get velocity scaling information for singularity.
     const auto singularity_scaling_info =
-        velocityScalingFactorForSingularity(robot_state, cartesian_position_delta, servo_params);
+        velocityScalingFactorForSingularity(robot_state, cartesian_position_delta, servo_params, jacobian_solver);
     // Apply velocity scaling for singularity, if there was any scaling.
     if (singularity_scaling_info.second != StatusCode::NO_WARNING)
     {
@@ -301,6 +332,16 @@ JointDeltaResult jointDeltaFromPose(const PoseCommand& command, const moveit::co
 JointDeltaResult jointDeltaFromIK(const Eigen::VectorXd& cartesian_position_delta,
                                   const moveit::core::RobotStatePtr& robot_state, const servo::Params& servo_params,
                                   const JointNameToMoveGroupIndexMap& joint_name_group_index_map)
+{
+  JacobianSolver jacobian_solver;
+  return jointDeltaFromIK(cartesian_position_delta, robot_state, servo_params, joint_name_group_index_map,
+                          jacobian_solver);
+}
+
+JointDeltaResult jointDeltaFromIK(const Eigen::VectorXd& cartesian_position_delta,
+                                  const moveit::core::RobotStatePtr& robot_state, const servo::Params& servo_params,
+                                  const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                                  JacobianSolver& jacobian_solver)
 {
   const auto& group_name =
       servo_params.active_subgroup.empty() ? servo_params.move_group_name : servo_params.active_subgroup;
@@ -357,13 +398,16 @@ JointDeltaResult jointDeltaFromIK(const Eigen::VectorXd& cartesian_position_delt
   else
   {
     // Robot does not have an IK solver, use inverse Jacobian to compute IK.
-    const Eigen::MatrixXd jacobian = robot_state->getJacobian(joint_model_group);
-    const Eigen::JacobiSVD<Eigen::MatrixXd> svd =
-        Eigen::JacobiSVD<Eigen::MatrixXd>(jacobian, Eigen::ComputeThinU | Eigen::ComputeThinV);
-    const Eigen::MatrixXd matrix_s = svd.singularValues().asDiagonal();
-    const Eigen::MatrixXd pseudo_inverse = svd.matrixV() * matrix_s.inverse() * svd.matrixU().transpose();
-
-    delta_theta = pseudo_inverse * cartesian_position_delta;
+    // The factorization is shared with the singularity scaling that follows in the same cycle.
+    if (jacobian_solver.update(*robot_state, joint_model_group))
+    {
+      jacobian_solver.solve(cartesian_position_delta, servo_params.inverse_jacobian_damping, delta_theta);
+    }
+    else
+    {
+      status = StatusCode::INVALID;
+      RCLCPP_ERROR_STREAM(getLogger(), "Could not compute the Jacobian of group " << joint_model_group->getName());
+    }
   }
 
   if (!servo_params.active_subgroup.empty() && servo_params.active_subgroup != servo_params.move_group_name)
@@ -39,6 +39,8 @@
 
 #include <moveit_servo/utils/common.hpp>
 
+#include <cmath>
+
 namespace
 {
 // The threshold above which `override_velocity_scaling_factor` will be used instead of computing the scaling from joint bounds.
@@ -49,10 +51,116 @@ constexpr double MIN_ANGLE_THRESHOLD = 1E-16;
 
 // The publishing frequency for the planning scene monitor, in Hz.
 constexpr double PLANNING_SCENE_PUBLISHING_FREQUENCY = 25.0;
+
+// Same as Eigen's sign(): -1, 0 or 1.
+double signum(double value)
+{
+  return static_cast<double>((0.0 < value) - (value < 0.0));
+}
 }  // namespace
 
 namespace moveit_servo
 {
+namespace
+{
+// Shared implementation for std::deque and KinematicStateWindow.
+template <typename Window>
+bool composeTrajectoryMessageImpl(const servo::Params& servo_params, const Window& joint_cmd_rolling_window,
+                                  trajectory_msgs::msg::JointTrajectory& joint_trajectory)
+{
+  if (joint_cmd_rolling_window.size() < MIN_POINTS_FOR_TRAJ_MSG)
+  {
+    return false;
+  }
+
+  joint_trajectory.joint_names = joint_cmd_rolling_window.front().joint_names;
+  joint_trajectory.header.stamp = joint_cmd_rolling_window.front().time_stamp;
+  // The last point in the window is not sent, as its velocity is not final yet.
+  joint_trajectory.points.resize(joint_cmd_rolling_window.size() - 1);
+
+  // Copy into the existing point storage, assign() only allocates if the point has grown.
+  const auto copy_values = [](bool publish, const Eigen::VectorXd& values, std::vector<double>& out) {
+    if (publish)
+    {
+      out.assign(values.data(), values.data() + values.size());
+    }
+    else
+    {
+      out.clear();
+    }
+  };
+
+  const rclcpp::Time& start_time = joint_cmd_rolling_window.front().time_stamp;
+  for (size_t i = 0; i < joint_trajectory.points.size(); ++i)
+  {
+    const KinematicState& state = joint_cmd_rolling_window[i];
+    trajectory_msgs::msg::JointTrajectoryPoint& point = joint_trajectory.points[i];
+    copy_values(servo_params.publish_joint_positions, state.positions, point.positions);
+    copy_values(servo_params.publish_joint_velocities, state.velocities, point.velocities);
+    copy_values(servo_params.publish_joint_accelerations, state.accelerations, point.accelerations);
+    point.time_from_start = state.time_stamp - start_time;
+  }
+
+  return true;
+}
+
+// Shared implementation for std::deque and KinematicStateWindow.
+template <typename Window>
+void updateSlidingWindowImpl(KinematicState& next_joint_state, Window& joint_cmd_rolling_window,
+                             double max_expected_latency, const rclcpp::Time& cur_time)
+{
+  // remove commands older than current time minus the length of the sliding window
+  next_joint_state.time_stamp = cur_time + rclcpp::Duration::from_seconds(max_expected_latency);
+  const auto active_time_window = rclcpp::Duration::from_seconds(max_expected_latency);
+  while (!joint_cmd_rolling_window.empty() &&
+         joint_cmd_rolling_window.front().time_stamp < (cur_time - active_time_window))
+  {
+    joint_cmd_rolling_window.pop_front();
+  }
+
+  // remove commands at end of window if timestamp is the same as current command
+  while (!joint_cmd_rolling_window.empty() && next_joint_state.time_stamp == joint_cmd_rolling_window.back().time_stamp)
+  {
+    joint_cmd_rolling_window.pop_back();
+  }
+
+  // update velocity: the velocity has the potential to dramatically influence interpolation of splines and causes large
+  // overshooting. To alleviate this effect, the target velocity will be set to zero if the motion changes direction,
+  // otherwise, it will calculate the forward and backward finite difference velocities and choose the minimum.
+  if (joint_cmd_rolling_window.size() >= 2)
+  {
+    size_t num_points = joint_cmd_rolling_window.size();
+    auto& last_state = joint_cmd_rolling_window[num_points - 1];
+    auto& second_last_state = joint_cmd_rolling_window[num_points - 2];
+
+    const double delta_time_1 = (next_joint_state.time_stamp - last_state.time_stamp).seconds();
+    const double delta_time_2 = (last_state.time_stamp - second_last_state.time_stamp).seconds();
+    for (long i = 0; i < last_state.velocities.size(); ++i)
+    {
+      // check if the direction have changed. `sign` will either be -2, +2 meaning a flat line, -1, 1 meaning a
+      // rotated L shape, or 0 meaning a v-shape.
+      const double direction_1 = second_last_state.positions[i] - last_state.positions[i];
+      const double direction_2 = next_joint_state.positions[i] - last_state.positions[i];
+      const double sign = std::round(signum(direction_1) - signum(direction_2));
+      if (sign == 0.0)
+      {
+        // direction changed
+        last_state.velocities[i] = 0;
+      }
+      else
+      {
+        const auto velocity_1 = (next_joint_state.positions[i] - last_state.positions[i]) / delta_time_1;
+        const auto velocity_2 = (last_state.positions[i] - second_last_state.positions[i]) / delta_time_2;
+        last_state.velocities[i] = (std::abs(velocity_1) < std::abs(velocity_2)) ? velocity_1 : velocity_2;
+      }
+      next_joint_state.velocities[i] = last_state.velocities[i];
+    }
+  }
+
+  // add next command
+  joint_cmd_rolling_window.push_back(next_joint_state);
+}
+}  // namespace
 
 std::optional<std::string> getIKSolverBaseFrame(const moveit::core::RobotStatePtr& robot_state,
                                                 const std::string& group_name)
@@ -150,115 +258,43 @@ geometry_msgs::msg::Pose poseFromCartesianDelta(const Eigen::VectorXd& delta_x,
 std::optional<trajectory_msgs::msg::JointTrajectory>
 composeTrajectoryMessage(const servo::Params& servo_params, const std::deque<KinematicState>& joint_cmd_rolling_window)
 {
-  if (joint_cmd_rolling_window.size() < MIN_POINTS_FOR_TRAJ_MSG)
-  {
-    return {};
-  }
-
   trajectory_msgs::msg::JointTrajectory joint_trajectory;
-
-  joint_trajectory.joint_names = joint_cmd_rolling_window.front().joint_names;
-  joint_trajectory.points.reserve(joint_cmd_rolling_window.size() + 1);
-  joint_trajectory.header.stamp = joint_cmd_rolling_window.front().time_stamp;
-
-  auto add_point = [servo_params](trajectory_msgs::msg::JointTrajectory& joint_trajectory, const KinematicState& state) {
-    trajectory_msgs::msg::JointTrajectoryPoint point;
-    size_t num_joints = state.positions.size();
-    point.positions.reserve(num_joints);
-    point.velocities.reserve(num_joints);
-    point.accelerations.reserve(num_joints);
-    if (servo_params.publish_joint_positions)
-    {
-      for (const auto& pos : state.positions)
-      {
-        point.positions.emplace_back(pos);
-      }
-    }
-    if (servo_params.publish_joint_velocities)
-    {
-      for (const auto& vel : state.velocities)
-      {
-        point.velocities.emplace_back(vel);
-      }
-    }
-    if (servo_params.publish_joint_accelerations)
-    {
-      for (const auto& acc : state.accelerations)
-      {
-        point.accelerations.emplace_back(acc);
-      }
-    }
-    point.time_from_start = state.time_stamp - joint_trajectory.header.stamp;
-    joint_trajectory.points.emplace_back(point);
-  };
-
-  for (size_t i = 0; i < joint_cmd_rolling_window.size() - 1; ++i)
+  if (!composeTrajectoryMessageImpl(servo_params, joint_cmd_rolling_window, joint_trajectory))
   {
-    add_point(joint_trajectory, joint_cmd_rolling_window[i]);
+    return {};
   }
-
   return joint_trajectory;
 }
 
+bool composeTrajectoryMessage(const servo::Params& servo_params, const KinematicStateWindow& joint_cmd_rolling_window,
+                              trajectory_msgs::msg::JointTrajectory& joint_trajectory)
+{
+  return composeTrajectoryMessageImpl(servo_params, joint_cmd_rolling_window, joint_trajectory);
+}
+
 void updateSlidingWindow(KinematicState& next_joint_state, std::deque<KinematicState>& joint_cmd_rolling_window,
                          double max_expected_latency, const rclcpp::Time& cur_time)
 {
-  // remove commands older than current time minus the length of the sliding window
-  next_joint_state.time_stamp = cur_time + rclcpp::Duration::from_seconds(max_expected_latency);
-  const auto active_time_window = rclcpp::Duration::from_seconds(max_expected_latency);
-  while (!joint_cmd_rolling_window.empty() &&
-         joint_cmd_rolling_window.front().time_stamp < (cur_time - active_time_window))
-  {
-    joint_cmd_rolling_window.pop_front();
-  }
-
-  // remove commands at end of window if timestamp is the same as current command
-  while (!joint_cmd_rolling_window.empty() && next_joint_state.time_stamp == joint_cmd_rolling_window.back().time_stamp)
-  {
-    joint_cmd_rolling_window.pop_back();
-  }
-
-  // update velocity: the velocity has the potential to dramatically influence interpolation of splines and causes large
-  // overshooting. To alleviate this effect, the target velocity will be set to zero if the motion changes direction,
-  // otherwise, it will calculate the forward and backward finite difference velocities and choose the minimum.
-  if (joint_cmd_rolling_window.size() >= 2)
-  {
-    size_t num_points = joint_cmd_rolling_window.size();
-    auto& last_state = joint_cmd_rolling_window[num_points - 1];
-    auto& second_last_state = joint_cmd_rolling_window[num_points - 2];
-
-    Eigen::VectorXd direction_1 = second_last_state.positions - last_state.positions;
-    Eigen::VectorXd direction_2 = next_joint_state.positions - last_state.positions;
-    Eigen::VectorXd signs = (direction_1.array().sign() - direction_2.array().sign()).round();
-    for (long i = 0; i < last_state.velocities.size(); ++i)
-    {
-      // check if the direction have changed. `signs` will either have -2, +2 meaning a flat line, -1, 1 meaning a
-      // rotated L shape, or 0 meaning a v-shape.
-      if (signs[i] == 0.0)
-      {
-        // direction changed
-        last_state.velocities[i] = 0;
-      }
-      else
-      {
-        const double delta_time_1 = (next_joint_state.time_stamp - last_state.time_stamp).seconds();
-        const double delta_time_2 = (last_state.time_stamp - second_last_state.time_stamp).seconds();
-        const auto velocity_1 = (next_joint_state.positions[i] - last_state.positions[i]) / delta_time_1;
-        const auto velocity_2 = (last_state.positions[i] - second_last_state.positions[i]) / delta_time_2;
-        last_state.velocities[i] = (std::abs(velocity_1) < std::abs(velocity_2)) ? velocity_1 : velocity_2;
-      }
-      next_joint_state.velocities[i] = last_state.velocities[i];
-    }
-  }
+  updateSlidingWindowImpl(next_joint_state, joint_cmd_rolling_window, max_expected_latency, cur_time);
+}
 
-  // add next command
-  joint_cmd_rolling_window.push_back(next_joint_state);
+void updateSlidingWindow(KinematicState& next_joint_state, KinematicStateWindow& joint_cmd_rolling_window,
+                         double max_expected_latency, const rclcpp::Time& cur_time)
+{
+  updateSlidingWindowImpl(next_joint_state, joint_cmd_rolling_window, max_expected_latency, cur_time);
 }
 
 std_msgs::msg::Float64MultiArray composeMultiArrayMessage(const servo::Params& servo_params,
                                                           const KinematicState& joint_state)
 {
   std_msgs::msg::Float64MultiArray multi_array;
+  composeMultiArrayMessage(servo_params, joint_state, multi_array);
+  return multi_array;
+}
+
+void composeMultiArrayMessage(const servo::Params& servo_params, const KinematicState& joint_state,
+                              std_msgs::msg::Float64MultiArray& multi_array)
+{
   const size_t num_joints = joint_state.joint_names.size();
   multi_array.data.resize(num_joints);
   if (servo_params.publish_joint_positions)
@@ -275,13 +311,20 @@ std_msgs::msg::Float64MultiArray composeMultiArrayMessage(const servo::Params& s
       multi_array.data[i] = joint_state.velocities[i];
     }
   }
-
-  return multi_array;
 }
 
 std::pair<double, StatusCode> velocityScalingFactorForSingularity(const moveit::core::RobotStatePtr& robot_state,
                                                                   const Eigen::VectorXd& target_delta_x,
                                                                   const servo::Params& servo_params)
+{
+  JacobianSolver jacobian_solver;
+  return velocityScalingFactorForSingularity(robot_state, target_delta_x, servo_params, jacobian_solver);
+}
+
+std::pair<double, StatusCode> velocityScalingFactorForSingularity(const moveit::core::RobotStatePtr& robot_state,
+                                                                  const Eigen::VectorXd& target_delta_x,
+                                                                  const servo::Params& servo_params,
+                                                                  JacobianSolver& jacobian_solver)
 {
   // We need to send information back about if we are halting, moving away or towards the singularity.
   StatusCode servo_status = StatusCode::NO_WARNING;
@@ -297,13 +340,12 @@ std::pair<double, StatusCode> velocityScalingFactorForSingularity(const moveit::
   // Get size of total controllable dimensions.
   const size_t dims = target_delta_x.size();
 
-  // Get the current Jacobian and compute SVD
-  const Eigen::JacobiSVD<Eigen::MatrixXd> current_svd = Eigen::JacobiSVD<Eigen::MatrixXd>(
-      robot_state->getJacobian(joint_model_group), Eigen::ComputeThinU | Eigen::ComputeThinV);
-  const Eigen::MatrixXd matrix_s = current_svd.singularValues().asDiagonal();
-
-  // Compute pseudo inverse
-  const Eigen::MatrixXd pseudo_inverse = current_svd.matrixV() * matrix_s.inverse() * current_svd.matrixU().transpose();
+  // Get the current Jacobian and its SVD, this reuses the factorization if it was already computed in this cycle.
+  if (!jacobian_solver.update(*robot_state, joint_model_group))
+  {
+    throw moveit::Exception("Unable to compute Jacobian");
+  }
+  const Eigen::JacobiSVD<Eigen::MatrixXd>& current_svd = jacobian_solver.getSVD();
 
   // Get the singular vector corresponding to least singular value.
   // This vector represents the least responsive dimension. By convention this is the last column of the matrix U.
@@ -318,18 +360,8 @@ std::pair<double, StatusCode> velocityScalingFactorForSingularity(const moveit::
   // Take a small step in the direction of vector_towards_singularity
   const Eigen::VectorXd delta_x = vector_towards_singularity * servo_params.singularity_step_scale;
 
-  // Compute the new joint angles if we take the small step delta_x
-  Eigen::VectorXd next_joint_angles;
-  robot_state->copyJointGroupPositions(joint_model_group, next_joint_angles);
-  next_joint_angles += pseudo_inverse * delta_x;
-
-  // Compute the Jacobian SVD for the new robot state.
-  robot_state->setJointGroupPositions(joint_model_group, next_joint_angles);
-  const Eigen::JacobiSVD<Eigen::MatrixXd> next_svd = Eigen::JacobiSVD<Eigen::MatrixXd>(
-      robot_state->getJacobian(joint_model_group), Eigen::ComputeThinU | Eigen::ComputeThinV);
-
-  // Compute condition number for the new Jacobian.
-  const double next_condition_number = next_svd.singularValues()(0) / next_svd.singularValues()(dims - 1);
+  // Compute condition number for the Jacobian at the robot state reached by the small step delta_x.
+  const double next_condition_number = jacobian_solver.conditionNumberAfterStep(*robot_state, delta_x);
 
   // If the condition number has increased, we are moving towards singularity and the direction of the
   // vector_towards_singularity is correct. If the condition number has decreased, it means the sign of
@@ -413,6 +445,15 @@ std::vector<size_t> jointVariablesToHalt(const Eigen::VectorXd& positions, const
                                          const std::vector<double>& margins)
 {
   std::vector<size_t> variable_indices_to_halt;
+  jointVariablesToHalt(positions, velocities, joint_bounds, margins, variable_indices_to_halt);
+  return variable_indices_to_halt;
+}
+
+void jointVariablesToHalt(const Eigen::VectorXd& positions, const Eigen::VectorXd& velocities,
+                          const moveit::core::JointBoundsVector& joint_bounds, const std::vector<double>& margins,
+                          std::vector<size_t>& variable_indices_to_halt)
+{
+  variable_indices_to_halt.clear();
 
   // Now get the scaling factor from joint velocity limits.
   size_t variable_idx = 0;
@@ -447,7 +488,6 @@ std::vector<size_t> jointVariablesToHalt(const Eigen::VectorXd& positions, const
       }
     }
   }
-  return variable_indices_to_halt;
 }
 
 /** \brief Helper function for converting Eigen::Isometry3d to geometry_msgs/TransformStamped **/
@@ -464,6 +504,12 @@ geometry_msgs::msg::TransformStamped convertIsometryToTransform(const Eigen::Iso
 PoseCommand poseFromPoseStamped(const geometry_msgs::msg::PoseStamped& msg)
 {
   PoseCommand command;
+  poseFromPoseStamped(msg, command);
+  return command;
+}
+
+void poseFromPoseStamped(const geometry_msgs::msg::PoseStamped& msg, PoseCommand& command)
+{
   command.frame_id = msg.header.frame_id;
 
   const Eigen::Vector3d translation(msg.pose.position.x, msg.pose.position.y, msg.pose.position.z);
@@ -473,8 +519,6 @@ PoseCommand poseFromPoseStamped(const geometry_msgs::msg::PoseStamped& msg)
   command.pose = Eigen::Isometry3d::Identity();
   command.pose.translate(translation);
   command.pose.linear() = rotation.normalized().toRotationMatrix();
-
-  return command;
 }
 
 planning_scene_monitor::PlanningSceneMonitorPtr createPlanningSceneMonitor(const rclcpp::Node::SharedPtr& node,
@@ -514,11 +558,18 @@ planning_scene_monitor::PlanningSceneMonitorPtr createPlanningSceneMonitor(const
 }
 
 KinematicState extractRobotState(const moveit::core::RobotStatePtr& robot_state, const std::string& move_group_name)
+{
+  KinematicState current_state;
+  extractRobotState(robot_state, move_group_name, current_state);
+  return current_state;
+}
+
+void extractRobotState(const moveit::core::RobotStatePtr& robot_state, const std::string& move_group_name,
+                       KinematicState& current_state)
 {
   const moveit::core::JointModelGroup* joint_model_group = robot_state->getJointModelGroup(move_group_name);
-  const auto joint_names = joint_model_group->getActiveJointModelNames();
-  KinematicState current_state(joint_names.size());
-  current_state.joint_names = joint_names;
+  // Assigning over existing names and vectors of the same size reuses their storage.
+  current_state.joint_names = joint_model_group->getActiveJointModelNames();
   robot_state->copyJointGroupPositions(joint_model_group, current_state.positions);
   robot_state->copyJointGroupVelocities(joint_model_group, current_state.velocities);
 
@@ -531,8 +582,6 @@ KinematicState extractRobotState(const moveit::core::RobotStatePtr& robot_state,
     robot_state->zeroAccelerations();
     robot_state->copyJointGroupAccelerations(joint_model_group, current_state.accelerations);
   }
-
-  return current_state;
 }
 
 }  // namespace moveit_servo
@@ -0,0 +1,117 @@
+/*******************************************************************************
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2019, Los Alamos National Security, LLC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *******************************************************************************/
+
+/*      Title     : jacobian_solver.cpp
+ *      Project   : moveit_servo
+ *      Created   : 10/18/2026
+ */
+
+#include <moveit_servo/utils/jacobian_solver.hpp>
+
+namespace moveit_servo
+{
+
+bool JacobianSolver::update(moveit::core::RobotState& robot_state,
+                            const moveit::core::JointModelGroup* joint_model_group)
+{
+  if (joint_model_group != joint_model_group_)
+  {
+    reset();
+  }
+
+  robot_state.copyJointGroupPositions(joint_model_group, step_positions_);
+  if (joint_model_group_ && step_positions_ == joint_positions_)
+  {
+    // The factorization already belongs to this state.
+    return true;
+  }
+
+  if (!robot_state.getJacobian(joint_model_group, joint_model_group->getLinkModels().back(), Eigen::Vector3d::Zero(),
+                               jacobian_))
+  {
+    reset();
+    return false;
+  }
+
+  joint_model_group_ = joint_model_group;
+  joint_positions_ = step_positions_;
+  svd_.compute(jacobian_, Eigen::ComputeThinU | Eigen::ComputeThinV);
+  return true;
+}
+
+void JacobianSolver::solve(const Eigen::VectorXd& cartesian_delta, double damping, Eigen::VectorXd& joint_delta) const
+{
+  // J^+ = V * S^-1 * U^T, damped least squares replaces 1 / s by s / (s^2 + damping^2).
+  const Eigen::VectorXd& singular_values = svd_.singularValues();
+  Eigen::VectorXd projected = svd_.matrixU().transpose() * cartesian_delta;
+  for (Eigen::Index i = 0; i < singular_values.size(); ++i)
+  {
+    const double s = singular_values[i];
+    projected[i] *= s / (s * s + damping * damping);
+  }
+  joint_delta.noalias() = svd_.matrixV() * projected;
+}
+
+double JacobianSolver::conditionNumberAfterStep(moveit::core::RobotState& robot_state,
+                                                const Eigen::VectorXd& cartesian_step)
+{
+  solve(cartesian_step, 0.0, joint_delta_);
+  step_positions_ = joint_positions_ + joint_delta_;
+
+  robot_state.setJointGroupPositions(joint_model_group_, step_positions_);
+  const bool valid = robot_state.getJacobian(joint_model_group_, joint_model_group_->getLinkModels().back(),
+                                             Eigen::Vector3d::Zero(), step_jacobian_);
+  robot_state.setJointGroupPositions(joint_model_group_, joint_positions_);
+  if (!valid)
+  {
+    return getConditionNumber();
+  }
+
+  // Only the singular values are needed here.
+  step_svd_.compute(step_jacobian_);
+  const Eigen::VectorXd& singular_values = step_svd_.singularValues();
+  return singular_values(0) / singular_values(singular_values.size() - 1);
+}
+
+double JacobianSolver::getConditionNumber() const
+{
+  const Eigen::VectorXd& singular_values = svd_.singularValues();
+  return singular_values(0) / singular_values(singular_values.size() - 1);
+}
+
+void JacobianSolver::reset()
+{
+  joint_model_group_ = nullptr;
+}
+
+}  // namespace moveit_servo
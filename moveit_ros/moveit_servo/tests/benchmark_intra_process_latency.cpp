@@ -0,0 +1,222 @@
+/*******************************************************************************
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2019, Los Alamos National Security, LLC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *******************************************************************************/
+
+/*      Title     : benchmark_intra_process_latency.cpp
+ *      Project   : moveit_servo
+ *      Created   : 10/18/2026
+ */
+
+// This file benchmarks the latency of the servo command path when teleop, the servo node and the controller share a
+// process, with and without intra-process communication.
+// To run this benchmark, 'cd' to the build/moveit_servo directory and directly run the binary.
+
+#include <benchmark/benchmark.h>
+#include <geometry_msgs/msg/twist_stamped.hpp>
+#include <moveit/rdf_loader/rdf_loader.hpp>
+#include <moveit_msgs/msg/servo_status.hpp>
+#include <moveit_msgs/srv/servo_command_type.hpp>
+#include <moveit_servo/servo_node.hpp>
+#include <moveit_servo/utils/datatypes.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/joint_state.hpp>
+#include <trajectory_msgs/msg/joint_trajectory.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace
+{
+constexpr double PUBLISH_PERIOD = 0.01;
+// Commands go stale quickly, so that servo halts between the iterations.
+constexpr double INCOMING_COMMAND_TIMEOUT = 0.05;
+// Servo is idle once it did not publish for this long.
+constexpr std::chrono::milliseconds QUIET_PERIOD{ 100 };
+constexpr std::chrono::seconds SETUP_TIMEOUT{ 10 };
+constexpr std::chrono::seconds RECEIVE_TIMEOUT{ 1 };
+const std::string TWIST_TOPIC = "/servo_node/delta_twist_cmds";
+const std::string TRAJECTORY_TOPIC = "/servo_latency_benchmark/joint_trajectory";
+
+// The parameters of a servo node for the panda arm, which only depend on the installed robot description.
+rclcpp::NodeOptions servoNodeOptions(bool use_intra_process_comms)
+{
+  std::string urdf, srdf;
+  rdf_loader::RDFLoader::loadPkgFileToString(urdf, "moveit_resources_panda_description", "urdf/panda.urdf", {});
+  rdf_loader::RDFLoader::loadPkgFileToString(srdf, "moveit_resources_panda_moveit_config", "config/panda.srdf", {});
+  return rclcpp::NodeOptions()
+      .use_intra_process_comms(use_intra_process_comms)
+      .parameter_overrides({ { "robot_description", urdf },
+                             { "robot_description_semantic", srdf },
+                             { "moveit_servo.move_group_name", "panda_arm" },
+                             { "moveit_servo.command_in_type", "speed_units" },
+                             { "moveit_servo.publish_period", PUBLISH_PERIOD },
+                             { "moveit_servo.incoming_command_timeout", INCOMING_COMMAND_TIMEOUT },
+                             { "moveit_servo.command_out_topic", TRAJECTORY_TOPIC },
+                             { "moveit_servo.use_smoothing", false } });
+}
+
+// The joint states of the panda in its "ready" pose.
+sensor_msgs::msg::JointState createJointState()
+{
+  sensor_msgs::msg::JointState joint_state;
+  joint_state.name = { "panda_joint1", "panda_joint2", "panda_joint3",        "panda_joint4",       "panda_joint5",
+                       "panda_joint6", "panda_joint7", "panda_finger_joint1", "panda_finger_joint2" };
+  joint_state.position = { 0.0, -0.785, 0.0, -2.356, 0.0, 1.571, 0.785, 0.035, 0.035 };
+  joint_state.velocity.assign(joint_state.name.size(), 0.0);
+  return joint_state;
+}
+}  // namespace
+
+// Benchmark the time from publishing a twist command until a controller receives the resulting joint trajectory.
+// A ServoNode computes the trajectory, so the time includes the wait for its next cycle and the servo computation.
+// The robot's joint states are published from a separate thread. The argument selects intra-process communication.
+static void servoCommandLatency(benchmark::State& st)
+{
+  const bool use_intra_process_comms = st.range(0) != 0;
+  const auto options = rclcpp::NodeOptions().use_intra_process_comms(use_intra_process_comms);
+  const auto qos = rclcpp::SystemDefaultsQoS().keep_last(1);
+
+  // The robot publishes its joint states for the planning scene monitor of the servo node.
+  const auto robot_node = std::make_shared<rclcpp::Node>("robot", options);
+  const auto joint_state_publisher = robot_node->create_publisher<sensor_msgs::msg::JointState>("/joint_states", qos);
+  sensor_msgs::msg::JointState joint_state = createJointState();
+  const auto joint_state_timer = robot_node->create_wall_timer(std::chrono::milliseconds(10), [&] {
+    joint_state.header.stamp = robot_node->now();
+    joint_state_publisher->publish(joint_state);
+  });
+  rclcpp::executors::SingleThreadedExecutor robot_executor;
+  robot_executor.add_node(robot_node);
+  std::thread robot_thread([&robot_executor] { robot_executor.spin(); });
+  const auto stop_robot = [&] {
+    robot_executor.cancel();
+    robot_thread.join();
+  };
+
+  // Waits for the joint states and for its planning scene monitor to be updated before servoing.
+  const auto servo_node = std::make_shared<moveit_servo::ServoNode>(servoNodeOptions(use_intra_process_comms));
+
+  const auto teleop_node = std::make_shared<rclcpp::Node>("teleop", options);
+  const auto controller_node = std::make_shared<rclcpp::Node>("controller", options);
+  std::atomic<bool> received{ false };
+  auto last_received = std::chrono::steady_clock::now();
+  const auto trajectory_subscriber = controller_node->create_subscription<trajectory_msgs::msg::JointTrajectory>(
+      TRAJECTORY_TOPIC, qos, [&](const trajectory_msgs::msg::JointTrajectory::ConstSharedPtr& /* msg */) {
+        received = true;
+        last_received = std::chrono::steady_clock::now();
+      });
+  std::atomic<bool> servo_running{ false };
+  const auto status_subscriber = teleop_node->create_subscription<moveit_msgs::msg::ServoStatus>(
+      "/servo_node/status", qos,
+      [&servo_running](const moveit_msgs::msg::ServoStatus::ConstSharedPtr& /* msg */) { servo_running = true; });
+  const auto twist_publisher = teleop_node->create_publisher<geometry_msgs::msg::TwistStamped>(TWIST_TOPIC, qos);
+  const auto switch_command_type =
+      teleop_node->create_client<moveit_msgs::srv::ServoCommandType>("/servo_node/switch_command_type");
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(teleop_node);
+  executor.add_node(servo_node->get_node_base_interface());
+  executor.add_node(controller_node);
+
+  // Switch servo to twist commands.
+  auto request = std::make_shared<moveit_msgs::srv::ServoCommandType::Request>();
+  request->command_type = static_cast<int8_t>(moveit_servo::CommandType::TWIST);
+  if (!switch_command_type->wait_for_service(SETUP_TIMEOUT) ||
+      executor.spin_until_future_complete(switch_command_type->async_send_request(request), SETUP_TIMEOUT) !=
+          rclcpp::FutureReturnCode::SUCCESS)
+  {
+    st.SkipWithError("Servo command type could not be switched");
+    stop_robot();
+    return;
+  }
+
+  // Wait until the servo loop runs and the publishers are matched with their subscriptions.
+  const auto setup_deadline = std::chrono::steady_clock::now() + SETUP_TIMEOUT;
+  while (!servo_running || twist_publisher->get_subscription_count() == 0 ||
+         trajectory_subscriber->get_publisher_count() == 0)
+  {
+    if (std::chrono::steady_clock::now() > setup_deadline)
+    {
+      st.SkipWithError("Servo did not start");
+      stop_robot();
+      return;
+    }
+    executor.spin_some();
+  }
+
+  for (auto _ : st)
+  {
+    // Let the previous command go stale, so that the next trajectory is caused by the new command.
+    last_received = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - last_received < QUIET_PERIOD)
+    {
+      executor.spin_some();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    received = false;
+    auto twist = std::make_unique<geometry_msgs::msg::TwistStamped>();
+    twist->header.stamp = teleop_node->now();
+    twist->header.frame_id = "panda_link0";
+    twist->twist.linear.x = 0.05;
+    const auto start = std::chrono::steady_clock::now();
+    twist_publisher->publish(std::move(twist));
+
+    const auto receive_deadline = start + RECEIVE_TIMEOUT;
+    while (!received)
+    {
+      if (std::chrono::steady_clock::now() > receive_deadline)
+      {
+        st.SkipWithError("Joint trajectory was not received");
+        stop_robot();
+        return;
+      }
+      executor.spin_some();
+    }
+    st.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  stop_robot();
+}
+
+BENCHMARK(servoCommandLatency)->Arg(0)->Arg(1)->UseManualTime()->Iterations(50)->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  rclcpp::shutdown();
+  return 0;
+}
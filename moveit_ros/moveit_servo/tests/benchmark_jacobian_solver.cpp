@@ -0,0 +1,152 @@
+/*******************************************************************************
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2019, Los Alamos National Security, LLC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *******************************************************************************/
+
+/*      Title     : benchmark_jacobian_solver.cpp
+ *      Project   : moveit_servo
+ *      Created   : 10/18/2026
+ */
+
+// This file benchmarks the per-cycle cost of the inverse Jacobian and the singularity scaling of servo.
+// To run this benchmark, 'cd' to the build/moveit_servo directory and directly run the binary.
+
+#include <benchmark/benchmark.h>
+#include <moveit_servo/utils/command.hpp>
+#include <moveit_servo/utils/common.hpp>
+#include <moveit/utils/robot_model_test_utils.hpp>
+
+namespace
+{
+constexpr char PANDA_TEST_ROBOT[] = "panda";
+constexpr char PANDA_TEST_GROUP[] = "panda_arm";
+
+// A state away from singularities and joint limits, and a small Cartesian motion as commanded in a servo cycle.
+const Eigen::Vector<double, 7> STATE_READY{ 0.0, -0.785, 0.0, -2.356, 0.0, 1.571, 0.785 };
+const Eigen::Vector<double, 6> CARTESIAN_DELTA{ 0.0005, 0.0002, -0.0003, 0.0, 0.001, 0.0 };
+
+servo::Params createParams()
+{
+  servo::Params servo_params;
+  servo_params.move_group_name = PANDA_TEST_GROUP;
+  return servo_params;
+}
+
+// The inverse Jacobian and singularity scaling as computed before the factorization was shared: the Jacobian and
+// its SVD are computed twice for the current state, and once more for the displaced state.
+double legacyCycle(const moveit::core::RobotStatePtr& robot_state, const servo::Params& servo_params,
+                   const Eigen::VectorXd& target_delta_x)
+{
+  const moveit::core::JointModelGroup* joint_model_group =
+      robot_state->getJointModelGroup(servo_params.move_group_name);
+
+  // Inverse Jacobian.
+  const Eigen::MatrixXd jacobian = robot_state->getJacobian(joint_model_group);
+  const Eigen::JacobiSVD<Eigen::MatrixXd> svd =
+      Eigen::JacobiSVD<Eigen::MatrixXd>(jacobian, Eigen::ComputeThinU | Eigen::ComputeThinV);
+  const Eigen::MatrixXd matrix_s = svd.singularValues().asDiagonal();
+  const Eigen::MatrixXd pseudo_inverse = svd.matrixV() * matrix_s.inverse() * svd.matrixU().transpose();
+  const Eigen::VectorXd delta_theta = pseudo_inverse * target_delta_x;
+
+  // Singularity scaling.
+  const size_t dims = target_delta_x.size();
+  const Eigen::JacobiSVD<Eigen::MatrixXd> current_svd = Eigen::JacobiSVD<Eigen::MatrixXd>(
+      robot_state->getJacobian(joint_model_group), Eigen::ComputeThinU | Eigen::ComputeThinV);
+  const Eigen::MatrixXd current_matrix_s = current_svd.singularValues().asDiagonal();
+  const Eigen::MatrixXd current_pseudo_inverse =
+      current_svd.matrixV() * current_matrix_s.inverse() * current_svd.matrixU().transpose();
+  const Eigen::VectorXd delta_x = current_svd.matrixU().col(dims - 1) * servo_params.singularity_step_scale;
+  Eigen::VectorXd next_joint_angles;
+  robot_state->copyJointGroupPositions(joint_model_group, next_joint_angles);
+  next_joint_angles += current_pseudo_inverse * delta_x;
+  robot_state->setJointGroupPositions(joint_model_group, next_joint_angles);
+  const Eigen::JacobiSVD<Eigen::MatrixXd> next_svd = Eigen::JacobiSVD<Eigen::MatrixXd>(
+      robot_state->getJacobian(joint_model_group), Eigen::ComputeThinU | Eigen::ComputeThinV);
+
+  return delta_theta[0] + next_svd.singularValues()(dims - 1);
+}
+
+// Moves the robot along the joint space, so that every cycle sees a new state as it would while servoing.
+void stepRobotState(const moveit::core::RobotStatePtr& robot_state,
+                    const moveit::core::JointModelGroup* joint_model_group, size_t cycle)
+{
+  Eigen::VectorXd positions = STATE_READY;
+  positions.array() += 0.001 * static_cast<double>(cycle % 100);
+  robot_state->setJointGroupActivePositions(joint_model_group, positions);
+}
+}  // namespace
+
+// Benchmark the per-cycle cost before the Jacobian factorization was shared.
+static void servoJacobianLegacy(benchmark::State& st)
+{
+  const moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel(PANDA_TEST_ROBOT);
+  const auto robot_state = std::make_shared<moveit::core::RobotState>(robot_model);
+  robot_state->setToDefaultValues();
+  const servo::Params servo_params = createParams();
+  const moveit::core::JointModelGroup* joint_model_group = robot_state->getJointModelGroup(PANDA_TEST_GROUP);
+
+  size_t cycle = 0;
+  for (auto _ : st)
+  {
+    stepRobotState(robot_state, joint_model_group, cycle++);
+    benchmark::DoNotOptimize(legacyCycle(robot_state, servo_params, CARTESIAN_DELTA));
+  }
+}
+
+// Benchmark the per-cycle cost with the Jacobian factorization shared between the inverse Jacobian and the
+// singularity scaling. The argument is the damping factor of the least squares solution in thousandths.
+static void servoJacobianShared(benchmark::State& st)
+{
+  const moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel(PANDA_TEST_ROBOT);
+  const auto robot_state = std::make_shared<moveit::core::RobotState>(robot_model);
+  robot_state->setToDefaultValues();
+  servo::Params servo_params = createParams();
+  servo_params.inverse_jacobian_damping = 0.001 * static_cast<double>(st.range(0));
+  const moveit::core::JointModelGroup* joint_model_group = robot_state->getJointModelGroup(PANDA_TEST_GROUP);
+
+  moveit_servo::JacobianSolver jacobian_solver;
+  size_t cycle = 0;
+  for (auto _ : st)
+  {
+    stepRobotState(robot_state, joint_model_group, cycle++);
+    const auto delta_result = moveit_servo::jointDeltaFromIK(CARTESIAN_DELTA, robot_state, servo_params,
+                                                             moveit_servo::JointNameToMoveGroupIndexMap(),
+                                                             jacobian_solver);
+    const auto scaling_result = moveit_servo::velocityScalingFactorForSingularity(robot_state, CARTESIAN_DELTA,
+                                                                                  servo_params, jacobian_solver);
+    benchmark::DoNotOptimize(delta_result.second[0] * scaling_result.first);
+  }
+}
+
+BENCHMARK(servoJacobianLegacy);
+BENCHMARK(servoJacobianShared)->Arg(0)->Arg(50);
+
+BENCHMARK_MAIN();
@@ -39,11 +39,179 @@
    Created   : 07/07/2023
 */
 
+#include "allocation_counter.hpp"
 #include "servo_cpp_fixture.hpp"
+#include <moveit_servo/servo_node.hpp>
+
+#include <chrono>
+#include <thread>
 
 namespace
 {
 
+// Exposes the internals of the collision monitor to the tests.
+class CollisionMonitorTestAccess : public moveit_servo::CollisionMonitor
+{
+public:
+  using CollisionMonitor::CollisionMonitor;
+  using CollisionMonitor::canSkipDistanceQueries;
+  using CollisionMonitor::getCommandedJointPositions;
+  using CollisionMonitor::maxCollisionBodyDisplacement;
+
+  void setCurrentState(const moveit::core::RobotState& state)
+  {
+    robot_state_ = state;
+  }
+
+  // Pretend that the distances of the last check were computed for the given state.
+  void setLastCheck(const moveit::core::RobotState& state, double scene_distance, double self_distance,
+                    bool collision = false)
+  {
+    last_checked_state_ = state;
+    has_last_checked_state_ = true;
+    scene_collision_result_.distance = scene_distance;
+    self_collision_result_.distance = self_distance;
+    scene_collision_result_.collision = collision;
+    self_collision_result_.collision = false;
+    *scene_changed_ = false;
+  }
+};
+
+// Runs the cycles of a servo node on the test thread instead of its servo loop thread.
+class ServoNodeTestAccess : public moveit_servo::ServoNode
+{
+public:
+  using ServoNode::jointJogCallback;
+  using ServoNode::ServoNode;
+
+  // Stop the servo loop thread. It initializes the loop before it stops.
+  void stopServoLoop()
+  {
+    stop_servo_ = true;
+    if (servo_loop_thread_.joinable())
+    {
+      servo_loop_thread_.join();
+    }
+  }
+
+  void setCommandType(moveit_servo::CommandType command_type)
+  {
+    servo_->setCommandType(command_type);
+  }
+
+  bool computeNextCommand()
+  {
+    std::lock_guard<std::mutex> lock_guard(lock_);
+    return ServoNode::computeNextCommand();
+  }
+};
+
+TEST_F(ServoCppFixture, CollisionBodyDisplacementBound)
+{
+  std::atomic<double> collision_velocity_scale{ 1.0 };
+  CollisionMonitorTestAccess collision_monitor(planning_scene_monitor_, servo_params_, collision_velocity_scale);
+
+  moveit::core::RobotState from =
+      planning_scene_monitor::LockedPlanningSceneRO(planning_scene_monitor_)->getCurrentState();
+  from.update();
+  EXPECT_NEAR(collision_monitor.maxCollisionBodyDisplacement(from, from), 0.0, 1.0e-9);
+
+  constexpr double delta = 0.05;
+  moveit::core::RobotState to(from);
+  to.setVariablePosition("panda_joint1", from.getVariablePosition("panda_joint1") + delta);
+  to.setVariablePosition("panda_joint4", from.getVariablePosition("panda_joint4") - delta);
+  to.update();
+  const double bound = collision_monitor.maxCollisionBodyDisplacement(from, to);
+  EXPECT_GT(bound, 0.0);
+
+  // The bound contains the displacement of the origin and of the geometry center of every link.
+  for (const moveit::core::LinkModel* link : from.getRobotModel()->getLinkModelsWithCollisionGeometry())
+  {
+    const Eigen::Vector3d& center = link->getCenteredBoundingBoxOffset();
+    EXPECT_LE((to.getGlobalLinkTransform(link).translation() - from.getGlobalLinkTransform(link).translation()).norm(),
+              bound + 1.0e-9)
+        << link->getName();
+    EXPECT_LE((to.getGlobalLinkTransform(link) * center - from.getGlobalLinkTransform(link) * center).norm(),
+              bound + 1.0e-9)
+        << link->getName();
+  }
+
+  // A larger motion of the same joints gives a larger bound.
+  to.setVariablePosition("panda_joint1", from.getVariablePosition("panda_joint1") + 2 * delta);
+  to.setVariablePosition("panda_joint4", from.getVariablePosition("panda_joint4") - 2 * delta);
+  to.update();
+  EXPECT_GT(collision_monitor.maxCollisionBodyDisplacement(from, to), bound);
+}
+
+TEST_F(ServoCppFixture, CollisionMonitorSkipsDistanceQueriesOnlyWhenFar)
+{
+  std::atomic<double> collision_velocity_scale{ 1.0 };
+  CollisionMonitorTestAccess collision_monitor(planning_scene_monitor_, servo_params_, collision_velocity_scale);
+
+  moveit::core::RobotState state =
+      planning_scene_monitor::LockedPlanningSceneRO(planning_scene_monitor_)->getCurrentState();
+  state.update();
+  collision_monitor.setCurrentState(state);
+
+  // Without a previous check the distances have to be computed.
+  EXPECT_FALSE(collision_monitor.canSkipDistanceQueries());
+
+  constexpr double margin = 0.1;
+  const double scene_distance = servo_params_.scene_collision_proximity_threshold + margin;
+  const double self_distance = servo_params_.self_collision_proximity_threshold + margin;
+
+  // The robot did not move and is far from any collision.
+  collision_monitor.setLastCheck(state, scene_distance, self_distance);
+  EXPECT_TRUE(collision_monitor.canSkipDistanceQueries());
+
+  // A motion well within the margin keeps the last distances conclusive.
+  moveit::core::RobotState moved(state);
+  moved.setVariablePosition("panda_joint1", state.getVariablePosition("panda_joint1") + 1.0e-4);
+  moved.update();
+  collision_monitor.setCurrentState(moved);
+  EXPECT_TRUE(collision_monitor.canSkipDistanceQueries());
+
+  // A motion that can exceed the margin requires new queries.
+  moved.setVariablePosition("panda_joint1", state.getVariablePosition("panda_joint1") + 0.5);
+  moved.update();
+  collision_monitor.setCurrentState(moved);
+  EXPECT_FALSE(collision_monitor.canSkipDistanceQueries());
+
+  // Distances below the proximity thresholds are never skipped, nor are collisions.
+  collision_monitor.setCurrentState(state);
+  collision_monitor.setLastCheck(state, servo_params_.scene_collision_proximity_threshold / 2, self_distance);
+  EXPECT_FALSE(collision_monitor.canSkipDistanceQueries());
+  collision_monitor.setLastCheck(state, scene_distance, self_distance, true);
+  EXPECT_FALSE(collision_monitor.canSkipDistanceQueries());
+
+  // A change of the world geometry invalidates the last distances.
+  collision_monitor.setLastCheck(state, scene_distance, self_distance);
+  planning_scene_monitor_->triggerSceneUpdateEvent(planning_scene_monitor::PlanningSceneMonitor::UPDATE_GEOMETRY);
+  EXPECT_FALSE(collision_monitor.canSkipDistanceQueries());
+}
+
+TEST_F(ServoCppFixture, CollisionMonitorDiscardsStaleCommandedState)
+{
+  std::atomic<double> collision_velocity_scale{ 1.0 };
+  CollisionMonitorTestAccess collision_monitor(planning_scene_monitor_, servo_params_, collision_velocity_scale);
+
+  Eigen::VectorXd commanded = Eigen::VectorXd::Zero(7);
+  Eigen::VectorXd positions;
+  EXPECT_FALSE(collision_monitor.getCommandedJointPositions(positions));
+
+  collision_monitor.setCommandedJointPositions(commanded);
+  ASSERT_TRUE(collision_monitor.getCommandedJointPositions(positions));
+  EXPECT_TRUE(positions.isApprox(commanded));
+
+  collision_monitor.clearCommandedJointPositions();
+  EXPECT_FALSE(collision_monitor.getCommandedJointPositions(positions));
+
+  // Once no new commands arrive, the last commanded state is discarded after the command timeout.
+  collision_monitor.setCommandedJointPositions(commanded);
+  std::this_thread::sleep_for(std::chrono::duration<double>(2 * servo_params_.incoming_command_timeout));
+  EXPECT_FALSE(collision_monitor.getCommandedJointPositions(positions));
+}
+
 TEST_F(ServoCppFixture, JointJogTest)
 {
   planning_scene_monitor::LockedPlanningSceneRO locked_scene(planning_scene_monitor_);
@@ -72,6 +240,92 @@ TEST_F(ServoCppFixture, JointJogTest)
   ASSERT_NEAR(delta, 0.01, tol);
 }
 
+TEST_F(ServoCppFixture, JointJogNoAllocationsAfterWarmUp)
+{
+  if (!allocation_counter::isSupported())
+  {
+    GTEST_SKIP() << "Allocations can only be counted with glibc";
+  }
+
+  planning_scene_monitor::LockedPlanningSceneRO locked_scene(planning_scene_monitor_);
+  auto robot_state = std::make_shared<moveit::core::RobotState>(locked_scene->getCurrentState());
+
+  const moveit_servo::ServoInput joint_jog{ moveit_servo::JointJogCommand{ { "panda_joint1", "panda_joint7" },
+                                                                           { 0.1, -0.1 } } };
+  servo_test_instance_->setCommandType(moveit_servo::CommandType::JOINT_JOG);
+
+  // The first cycles size the scratch storage of servo, the smoother and the target state.
+  moveit_servo::KinematicState next_state;
+  for (size_t i = 0; i < 10; ++i)
+  {
+    servo_test_instance_->getNextJointState(robot_state, joint_jog, next_state);
+  }
+  ASSERT_EQ(servo_test_instance_->getStatus(), moveit_servo::StatusCode::NO_WARNING);
+
+  allocation_counter::start();
+  for (size_t i = 0; i < 100; ++i)
+  {
+    servo_test_instance_->getNextJointState(robot_state, joint_jog, next_state);
+  }
+  const size_t allocation_count = allocation_counter::stop();
+
+  EXPECT_EQ(allocation_count, 0u);
+  EXPECT_EQ(servo_test_instance_->getStatus(), moveit_servo::StatusCode::NO_WARNING);
+  EXPECT_EQ(next_state.positions.size(), 7);
+}
+
+TEST_F(ServoCppFixture, ServoNodeCycleNoAllocationsAfterWarmUp)
+{
+  if (!allocation_counter::isSupported())
+  {
+    GTEST_SKIP() << "Allocations can only be counted with glibc";
+  }
+
+  // The servo node reads the servo parameters of this test from its own namespace.
+  const std::string test_namespace = "moveit_servo_test";
+  std::vector<rclcpp::Parameter> parameter_overrides;
+  for (const auto& name : servo_test_node_->list_parameters({ test_namespace }, 0).names)
+  {
+    parameter_overrides.emplace_back("moveit_servo" + name.substr(test_namespace.size()),
+                                     servo_test_node_->get_parameter(name).get_parameter_value());
+  }
+  ServoNodeTestAccess servo_node(rclcpp::NodeOptions().parameter_overrides(parameter_overrides));
+  servo_node.stopServoLoop();
+  servo_node.setCommandType(moveit_servo::CommandType::JOINT_JOG);
+
+  // The command is refreshed in every cycle, so that it never goes stale.
+  auto joint_jog = std::make_shared<control_msgs::msg::JointJog>();
+  joint_jog->joint_names = { "panda_joint1", "panda_joint7" };
+  joint_jog->velocities = { 0.1, -0.1 };
+  joint_jog->header.stamp = servo_test_node_->now();
+  servo_node.jointJogCallback(joint_jog);
+
+  // Cycles run at the publish period, so that old commands leave the trajectory window as in the servo loop.
+  // The first cycles fill the window and size the scratch storage of the node, servo and the output messages.
+  const std::chrono::duration<double> publish_period(servo_params_.publish_period);
+  const auto run_cycles = [&](size_t num_cycles) {
+    size_t num_commands = 0;
+    for (size_t i = 0; i < num_cycles; ++i)
+    {
+      joint_jog->header.stamp = servo_test_node_->now();
+      if (servo_node.computeNextCommand())
+      {
+        ++num_commands;
+      }
+      std::this_thread::sleep_for(publish_period);
+    }
+    return num_commands;
+  };
+  run_cycles(20);
+
+  allocation_counter::start();
+  const size_t num_commands = run_cycles(50);
+  const size_t allocation_count = allocation_counter::stop();
+
+  EXPECT_EQ(allocation_count, 0u);
+  EXPECT_EQ(num_commands, 50u);
+}
+
 TEST_F(ServoCppFixture, TwistTest)
 {
   planning_scene_monitor::LockedPlanningSceneRO locked_scene(planning_scene_monitor_);
@@ -46,6 +46,8 @@
 #include <moveit/utils/robot_model_test_utils.hpp>
 #include <tf2_eigen/tf2_eigen.hpp>
 
+#include "allocation_counter.hpp"
+
 namespace
 {
 
@@ -234,6 +236,43 @@ TEST(ServoUtilsUnitTests, LeavingSingularityScaling)
   ASSERT_EQ(scaling_result.second, moveit_servo::StatusCode::DECELERATE_FOR_LEAVING_SINGULARITY);
 }
 
+TEST(ServoUtilsUnitTests, SharedJacobianFactorization)
+{
+  using moveit::core::loadTestingRobotModel;
+  moveit::core::RobotModelPtr robot_model = loadTestingRobotModel("panda");
+  moveit::core::RobotStatePtr robot_state = std::make_shared<moveit::core::RobotState>(robot_model);
+
+  servo::Params servo_params;
+  servo_params.move_group_name = "panda_arm";
+  const auto joint_model_group = robot_state->getJointModelGroup(servo_params.move_group_name);
+  robot_state->setToDefaultValues();
+
+  Eigen::Vector<double, 6> cartesian_delta{ 0.005, 0.0, 0.0, 0.0, 0.0, 0.0 };
+  Eigen::Vector<double, 7> state_approaching_singularity{ 0.0, 0.334, 0.0, -1.177, 0.0, 1.510, 0.785 };
+  robot_state->setJointGroupActivePositions(joint_model_group, state_approaching_singularity);
+
+  moveit_servo::JacobianSolver jacobian_solver;
+  ASSERT_TRUE(jacobian_solver.update(*robot_state, joint_model_group));
+  ASSERT_TRUE(jacobian_solver.getJacobian().isApprox(robot_state->getJacobian(joint_model_group)));
+
+  // The shared factorization gives the same scaling as a fresh one, and leaves the robot state untouched.
+  const auto shared_result =
+      moveit_servo::velocityScalingFactorForSingularity(robot_state, cartesian_delta, servo_params, jacobian_solver);
+  Eigen::VectorXd positions;
+  robot_state->copyJointGroupPositions(joint_model_group, positions);
+  ASSERT_EQ(positions, Eigen::VectorXd(state_approaching_singularity));
+  const auto result = moveit_servo::velocityScalingFactorForSingularity(robot_state, cartesian_delta, servo_params);
+  ASSERT_EQ(shared_result.second, moveit_servo::StatusCode::DECELERATE_FOR_APPROACHING_SINGULARITY);
+  ASSERT_EQ(shared_result.second, result.second);
+  ASSERT_NEAR(shared_result.first, result.first, 1e-9);
+
+  // Damping shortens the joint step.
+  Eigen::VectorXd pseudo_inverse_delta, damped_delta;
+  jacobian_solver.solve(cartesian_delta, 0.0, pseudo_inverse_delta);
+  jacobian_solver.solve(cartesian_delta, 0.05, damped_delta);
+  ASSERT_LT(damped_delta.norm(), pseudo_inverse_delta.norm());
+}
+
 TEST(ServoUtilsUnitTests, ExtractRobotState)
 {
   using moveit::core::loadTestingRobotModel;
@@ -279,6 +318,77 @@ TEST(ServoUtilsUnitTests, SlidingWinodw)
   ASSERT_FALSE(msg.has_value());
 }
 
+TEST(ServoUtilsUnitTests, NoAllocationsAfterWarmUp)
+{
+  if (!allocation_counter::isSupported())
+  {
+    GTEST_SKIP() << "Allocations can only be counted with glibc";
+  }
+
+  using moveit::core::loadTestingRobotModel;
+  moveit::core::RobotModelPtr robot_model = loadTestingRobotModel("panda");
+  const auto joint_model_group = robot_model->getJointModelGroup("panda_arm");
+  const auto& joint_bounds = joint_model_group->getActiveJointModelsBounds();
+  const std::vector<double> margins(7, 0.1);
+
+  servo::Params params;
+  params.publish_joint_positions = true;
+  params.publish_joint_velocities = true;
+  const double publish_period = 0.001;
+  const double latency = 0.01;
+
+  moveit_servo::KinematicState state(7);
+  state.joint_names = joint_model_group->getActiveJointModelNames();
+  state.velocities.setConstant(0.1);
+  // Start in the middle of the joint ranges, so that no joint is halted.
+  for (size_t i = 0; i < joint_bounds.size(); ++i)
+  {
+    const auto& joint_bound = (*joint_bounds[i])[0];
+    state.positions[i] = 0.5 * (joint_bound.min_position_ + joint_bound.max_position_);
+  }
+
+  // Preallocate everything used in the cycle, the window is too small on purpose and grows during warm-up.
+  moveit_servo::KinematicStateWindow window(2, state);
+  trajectory_msgs::msg::JointTrajectory trajectory_msg;
+  std_msgs::msg::Float64MultiArray multi_array_msg;
+  std::vector<size_t> joint_variables_to_halt;
+  joint_variables_to_halt.reserve(7);
+
+  size_t num_halted = 0;
+  const auto servo_cycle = [&](size_t cycle) {
+    state.positions.array() += state.velocities.array() * publish_period;
+    const rclcpp::Time now(0, cycle * 1E6, RCL_ROS_TIME);
+    state.velocities *= moveit_servo::jointLimitVelocityScalingFactor(state.velocities, joint_bounds, 0.0);
+    moveit_servo::jointVariablesToHalt(state.positions, state.velocities, joint_bounds, margins,
+                                       joint_variables_to_halt);
+    num_halted += joint_variables_to_halt.size();
+    moveit_servo::updateSlidingWindow(state, window, latency, now);
+    moveit_servo::composeTrajectoryMessage(params, window, trajectory_msg);
+    moveit_servo::composeMultiArrayMessage(params, state, multi_array_msg);
+  };
+
+  size_t cycle = 0;
+  for (; cycle < 100; ++cycle)
+  {
+    servo_cycle(cycle);
+  }
+  ASSERT_GE(window.size(), static_cast<size_t>(moveit_servo::MIN_POINTS_FOR_TRAJ_MSG));
+  const size_t trajectory_size = trajectory_msg.points.size();
+
+  // The counter hooks malloc, so dynamic Eigen temporaries are caught as well as operator new.
+  allocation_counter::start();
+  for (; cycle < 1100; ++cycle)
+  {
+    servo_cycle(cycle);
+  }
+  const size_t allocation_count = allocation_counter::stop();
+
+  EXPECT_EQ(allocation_count, 0u);
+  EXPECT_EQ(trajectory_msg.points.size(), trajectory_size);
+  EXPECT_EQ(num_halted, 0u);
+  EXPECT_EQ(multi_array_msg.data.size(), 7u);
+}
+
 }  // namespace
 
 int main(int argc, char** argv)
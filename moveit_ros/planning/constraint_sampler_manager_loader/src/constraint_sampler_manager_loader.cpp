@@ -85,6 +85,25 @@ public:
         }
       }
     }
+
+    // reachability maps generated offline, e.g. with moveit_generate_reachability_map
+    if (node_->has_parameter("reachability_maps"))
+    {
+      std::string reachability_maps;
+      node_->get_parameter("reachability_maps", reachability_maps);
+      boost::char_separator<char> sep(" ");
+      boost::tokenizer<boost::char_separator<char>> tok(reachability_maps, sep);
+      for (const std::string& filename : tok)
+      {
+        auto map = std::make_shared<constraint_samplers::ReachabilityMap>();
+        if (map->load(filename))
+        {
+          csm->registerReachabilityMap(map);
+          RCLCPP_INFO(logger_, "Loaded reachability map %s for link '%s' of group '%s'", filename.c_str(),
+                      map->getTipLinkName().c_str(), map->getGroupName().c_str());
+        }
+      }
+    }
   }
 
 private:
@@ -0,0 +1,125 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Description: Generate a reachability map for the IK constraint sampler, see constraint_samplers::ReachabilityMap */
+
+#include <moveit/constraint_samplers/reachability_map.hpp>
+#include <moveit/robot_model_loader/robot_model_loader.hpp>
+#include <moveit/robot_state/robot_state.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <rclcpp/node.hpp>
+#include <rclcpp/utilities.hpp>
+#include <moveit/utils/logger.hpp>
+
+static const std::string ROBOT_DESCRIPTION = "robot_description";
+
+int main(int argc, char** argv)
+{
+  std::string group_name;
+  std::string tip_link_name;
+  std::string output;
+  double resolution = 0.05;
+  std::size_t samples = 1000000;
+  std::uint32_t seed = 0;
+  unsigned int orientation_divisions = 2;
+  boost::program_options::options_description desc;
+  // clang-format off
+  desc.add_options()
+      ("help", "show help message")
+      ("group", boost::program_options::value<std::string>(&group_name), "name of the planning group")
+      ("tip", boost::program_options::value<std::string>(&tip_link_name),
+       "link whose poses to record, the last link of the group by default")
+      ("output", boost::program_options::value<std::string>(&output), "file to save the map to")
+      ("resolution", boost::program_options::value<double>(&resolution)->default_value(resolution),
+       "edge length of a voxel, in meters")
+      ("samples", boost::program_options::value<std::size_t>(&samples)->default_value(samples),
+       "number of configurations to sample")
+      ("seed", boost::program_options::value<std::uint32_t>(&seed)->default_value(seed),
+       "seed of the random number generator")
+      ("orientation_divisions",
+       boost::program_options::value<unsigned int>(&orientation_divisions)->default_value(orientation_divisions),
+       "number of orientation bins along each edge of a cube map face");
+  // clang-format on
+  boost::program_options::variables_map vm;
+  boost::program_options::store(
+      boost::program_options::command_line_parser(argc, argv).options(desc).allow_unregistered().run(), vm);
+  boost::program_options::notify(vm);
+
+  if (vm.count("help") || group_name.empty() || output.empty())
+  {
+    std::cout << "Usage: moveit_generate_reachability_map --group <group> --output <file> [options]" << '\n'
+              << desc << '\n';
+    return vm.count("help") ? 0 : 1;
+  }
+
+  rclcpp::init(argc, argv);
+  auto node = rclcpp::Node::make_shared("generate_reachability_map");
+  moveit::setNodeLoggerName(node->get_name());
+
+  robot_model_loader::RobotModelLoader rml(node, ROBOT_DESCRIPTION, false);
+  const moveit::core::RobotModelPtr& robot_model = rml.getModel();
+  if (!robot_model)
+  {
+    RCLCPP_ERROR(node->get_logger(), "Unable to load the robot model from '%s'", ROBOT_DESCRIPTION.c_str());
+    rclcpp::shutdown();
+    return 1;
+  }
+
+  const moveit::core::JointModelGroup* group = robot_model->getJointModelGroup(group_name);
+  if (!group || group->getLinkModels().empty())
+  {
+    RCLCPP_ERROR(node->get_logger(), "Group '%s' does not exist or has no links", group_name.c_str());
+    rclcpp::shutdown();
+    return 1;
+  }
+  const moveit::core::LinkModel* tip_link =
+      tip_link_name.empty() ? group->getLinkModels().back() : robot_model->getLinkModel(tip_link_name);
+
+  // joints outside of the group keep their default values
+  moveit::core::RobotState reference_state(robot_model);
+  reference_state.setToDefaultValues();
+
+  constraint_samplers::ReachabilityMap map;
+  RCLCPP_INFO(node->get_logger(), "Sampling %zu configurations of group '%s'...", samples, group_name.c_str());
+  const bool saved = map.generate(reference_state, group, tip_link, resolution, samples, seed, orientation_divisions) &&
+                     map.save(output);
+  if (saved)
+    RCLCPP_INFO(node->get_logger(), "Saved the reachability map to '%s'", output.c_str());
+  else
+    RCLCPP_ERROR(node->get_logger(), "Failed to generate the reachability map");
+
+  rclcpp::shutdown();
+  return saved ? 0 : 1;
+}
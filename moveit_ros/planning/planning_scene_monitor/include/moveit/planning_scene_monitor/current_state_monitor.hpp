@@ -38,7 +38,10 @@
 
 #include <chrono>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 #include <condition_variable>
 #include <mutex>
 
@@ -326,6 +329,19 @@ public:
   }
 
 private:
+  /** @brief The joint models corresponding to the joint names of received joint state messages. Publishers keep
+   *  sending the same names in the same order, so this is only looked up once per layout */
+  struct JointStateLayout
+  {
+    std::vector<std::string> names;
+    /// The joint for each name, nullptr if it is ignored (not part of the model or not a single-variable joint)
+    std::vector<const moveit::core::JointModel*> joints;
+    /// The bounds to clamp each joint value to, nullptr if the joint is ignored or continuous
+    std::vector<const moveit::core::VariableBounds*> bounds;
+  };
+
+  std::shared_ptr<const JointStateLayout> getJointStateLayout(const std::vector<std::string>& names);
+
   bool haveCompleteStateHelper(const rclcpp::Time& oldest_allowed_update_time,
                                std::vector<std::string>* missing_joints) const;
 
@@ -337,7 +353,7 @@ private:
   std::shared_ptr<tf2_ros::Buffer> tf_buffer_;
   moveit::core::RobotModelConstPtr robot_model_;
   moveit::core::RobotState robot_state_;
-  std::map<const moveit::core::JointModel*, rclcpp::Time> joint_time_;
+  std::vector<std::optional<rclcpp::Time>> joint_time_;  // indexed by joint index, empty if never updated
   bool state_monitor_started_;
   bool copy_dynamics_;  // Copy velocity and effort from joint_state
   rclcpp::Time monitor_start_time_ = rclcpp::Time(0, 0, RCL_ROS_TIME);
@@ -348,6 +364,9 @@ private:
   mutable std::condition_variable state_update_condition_;
   std::vector<JointStateUpdateCallback> update_callbacks_;
 
+  std::mutex joint_state_layouts_lock_;
+  std::vector<std::shared_ptr<const JointStateLayout>> joint_state_layouts_;  // most recently used first
+
   bool use_sim_time_;
 
   rclcpp::Logger logger_;
@@ -373,8 +373,15 @@ public:
   /** @brief Stop the world geometry monitor */
   void stopWorldGeometryMonitor();
 
-  /** @brief Add a function to be called when an update to the scene is received */
-  void addUpdateCallback(const std::function<void(SceneUpdateType)>& fn);
+  /** @brief Handle identifying a function added by addUpdateCallback(), 0 refers to no function */
+  using UpdateCallbackHandle = std::size_t;
+
+  /** @brief Add a function to be called when an update to the scene is received
+   *  @return A handle that can be passed to removeUpdateCallback() */
+  UpdateCallbackHandle addUpdateCallback(const std::function<void(SceneUpdateType)>& fn);
+
+  /** @brief Remove a function added by addUpdateCallback(). Must not be called from within an update callback. */
+  void removeUpdateCallback(UpdateCallbackHandle handle);
 
   /** @brief Clear the functions to be called when an update to the scene is received */
   void clearUpdateCallbacks();
@@ -527,6 +534,9 @@ protected:
   // include a octomap monitor
   std::unique_ptr<occupancy_map_monitor::OccupancyMapMonitor> octomap_monitor_;
 
+  // number of octree nodes seen on the last octomap update
+  std::size_t octomap_size_ = 0;
+
   // include a current state monitor
   CurrentStateMonitorPtr current_state_monitor_;
 
@@ -545,8 +555,9 @@ protected:
 
   /// lock access to update_callbacks_
   std::recursive_mutex update_lock_;
-  std::vector<std::function<void(SceneUpdateType)> > update_callbacks_;  /// List of callbacks to trigger when updates
-                                                                         /// are received
+  /// List of callbacks to trigger when updates are received, with the handles they were added with
+  std::vector<std::pair<UpdateCallbackHandle, std::function<void(SceneUpdateType)> > > update_callbacks_;
+  UpdateCallbackHandle next_update_callback_handle_ = 1;
 
 private:
   void getUpdatedFrameTransforms(std::vector<geometry_msgs::msg::TransformStamped>& transforms);
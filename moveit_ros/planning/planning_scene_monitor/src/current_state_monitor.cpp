@@ -41,6 +41,7 @@
 #include <tf2_eigen/tf2_eigen.hpp>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <limits>
 #include <memory>
@@ -49,6 +50,12 @@ namespace planning_scene_monitor
 {
 using namespace std::chrono_literals;
 
+namespace
+{
+// One layout per joint state publisher is expected, this just bounds the cache if names keep changing
+constexpr std::size_t MAX_JOINT_STATE_LAYOUTS = 16;
+}  // namespace
+
 CurrentStateMonitor::CurrentStateMonitor(std::unique_ptr<CurrentStateMonitor::MiddlewareHandle> middleware_handle,
                                          const moveit::core::RobotModelConstPtr& robot_model,
                                          const std::shared_ptr<tf2_ros::Buffer>& tf_buffer, bool use_sim_time)
@@ -63,6 +70,7 @@ CurrentStateMonitor::CurrentStateMonitor(std::unique_ptr<CurrentStateMonitor::Mi
   , logger_(moveit::getLogger("moveit.ros.current_state_monitor"))
 {
   robot_state_.setToDefaultValues();
+  joint_time_.resize(robot_model_->getJointModelCount());
 }
 
 CurrentStateMonitor::CurrentStateMonitor(const rclcpp::Node::SharedPtr& node,
@@ -149,7 +157,7 @@ void CurrentStateMonitor::startStateMonitor(const std::string& joint_states_topi
 {
   if (!state_monitor_started_ && robot_model_)
   {
-    joint_time_.clear();
+    joint_time_.assign(robot_model_->getJointModelCount(), std::nullopt);
     if (joint_states_topic.empty())
     {
       RCLCPP_ERROR(logger_, "The joint states topic cannot be an empty string");
@@ -204,15 +212,15 @@ bool CurrentStateMonitor::haveCompleteStateHelper(const rclcpp::Time& oldest_all
   std::unique_lock<std::mutex> slock(state_update_lock_);
   for (const moveit::core::JointModel* joint : active_joints)
   {
-    std::map<const moveit::core::JointModel*, rclcpp::Time>::const_iterator it = joint_time_.find(joint);
-    if (it == joint_time_.end())
+    const std::optional<rclcpp::Time>& joint_time = joint_time_[joint->getJointIndex()];
+    if (!joint_time)
     {
       RCLCPP_DEBUG(logger_, "Joint '%s' has never been updated", joint->getName().c_str());
     }
-    else if (it->second < oldest_allowed_update_time)
+    else if (*joint_time < oldest_allowed_update_time)
     {
       RCLCPP_DEBUG(logger_, "Joint '%s' was last updated %0.3lf seconds before requested time",
-                   joint->getName().c_str(), (oldest_allowed_update_time - it->second).seconds());
+                   joint->getName().c_str(), (oldest_allowed_update_time - *joint_time).seconds());
     }
     else
       continue;
@@ -319,6 +327,48 @@ bool CurrentStateMonitor::waitForCompleteState(const std::string& group, double
   return ok;
 }
 
+std::shared_ptr<const CurrentStateMonitor::JointStateLayout>
+CurrentStateMonitor::getJointStateLayout(const std::vector<std::string>& names)
+{
+  std::unique_lock<std::mutex> _(joint_state_layouts_lock_);
+  for (auto it = joint_state_layouts_.begin(); it != joint_state_layouts_.end(); ++it)
+  {
+    if ((*it)->names == names)
+    {
+      std::rotate(joint_state_layouts_.begin(), it, it + 1);
+      return joint_state_layouts_.front();
+    }
+  }
+
+  auto layout = std::make_shared<JointStateLayout>();
+  layout->names = names;
+  layout->joints.resize(names.size(), nullptr);
+  layout->bounds.resize(names.size(), nullptr);
+  for (std::size_t i = 0; i < names.size(); ++i)
+  {
+    // Skip joints that don't belong to the RobotModel
+    if (!robot_model_->hasJointModel(names[i]))
+      continue;
+
+    const moveit::core::JointModel* jm = robot_model_->getJointModel(names[i]);
+    // ignore fixed joints, multi-dof joints (they should not even be in the message)
+    if (jm->getVariableCount() != 1)
+      continue;
+    layout->joints[i] = jm;
+
+    // continuous joints wrap, so we don't modify them (even if they are outside bounds!)
+    if (jm->getType() == moveit::core::JointModel::REVOLUTE &&
+        static_cast<const moveit::core::RevoluteJointModel*>(jm)->isContinuous())
+      continue;
+    layout->bounds[i] = &jm->getVariableBounds()[0];  // only one variable in the joint, so we get its bounds
+  }
+
+  if (joint_state_layouts_.size() >= MAX_JOINT_STATE_LAYOUTS)
+    joint_state_layouts_.pop_back();
+  joint_state_layouts_.insert(joint_state_layouts_.begin(), layout);
+  return layout;
+}
+
 void CurrentStateMonitor::jointStateCallback(const sensor_msgs::msg::JointState::ConstSharedPtr& joint_state)
 {
   if (joint_state->name.size() != joint_state->position.size())
@@ -332,73 +382,67 @@ void CurrentStateMonitor::jointStateCallback(const sensor_msgs::msg::JointState:
 #pragma GCC diagnostic pop
     return;
   }
+  const std::size_t n = joint_state->name.size();
+  const std::shared_ptr<const JointStateLayout> layout = getJointStateLayout(joint_state->name);
+
+  // clamp the received values before taking the state lock
+  thread_local std::vector<double> positions;
+  positions.resize(n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    positions[i] = joint_state->position[i];
+    const moveit::core::VariableBounds* b = layout->bounds[i];
+    if (!b)
+      continue;
+
+    // if the read variable is 'almost' within bounds (up to error_ difference), then consider it to be within bounds
+    if (positions[i] < b->min_position_ && positions[i] >= b->min_position_ - error_)
+    {
+      positions[i] = b->min_position_;
+    }
+    else if (positions[i] > b->max_position_ && positions[i] <= b->max_position_ + error_)
+    {
+      positions[i] = b->max_position_;
+    }
+  }
+
+  // optionally copy velocities and effort
+  const bool copy_velocities = copy_dynamics_ && joint_state->velocity.size() == n;
+  const bool copy_efforts = copy_dynamics_ && joint_state->effort.size() == n;
+  const rclcpp::Time stamp(joint_state->header.stamp);
   bool update = false;
 
   {
     std::unique_lock<std::mutex> _(state_update_lock_);
     // read the received values, and update their time stamps
-    std::size_t n = joint_state->name.size();
-    current_state_time_ = joint_state->header.stamp;
+    current_state_time_ = stamp;
     for (std::size_t i = 0; i < n; ++i)
     {
-      // Skip joints that don't belong to the RobotModel
-      if (!robot_model_->hasJointModel(joint_state->name[i]))
-      {
+      const moveit::core::JointModel* jm = layout->joints[i];
+      if (!jm)
         continue;
-      }
 
-      const moveit::core::JointModel* jm = robot_model_->getJointModel(joint_state->name[i]);
-      // ignore fixed joints, multi-dof joints (they should not even be in the message)
-      if (jm->getVariableCount() != 1)
-        continue;
+      joint_time_[jm->getJointIndex()] = stamp;
 
-      joint_time_.insert_or_assign(jm, joint_state->header.stamp);
+      if (robot_state_.getJointPositions(jm)[0] != positions[i])
+      {
+        update = true;
+        robot_state_.setJointPositions(jm, &positions[i]);
+      }
 
-      if (robot_state_.getJointPositions(jm)[0] != joint_state->position[i])
+      // update joint velocities
+      if (copy_velocities &&
+          (!robot_state_.hasVelocities() || robot_state_.getJointVelocities(jm)[0] != joint_state->velocity[i]))
       {
         update = true;
-        robot_state_.setJointPositions(jm, &(joint_state->position[i]));
-
-        // continuous joints wrap, so we don't modify them (even if they are outside bounds!)
-        if (jm->getType() == moveit::core::JointModel::REVOLUTE)
-        {
-          if (static_cast<const moveit::core::RevoluteJointModel*>(jm)->isContinuous())
-            continue;
-        }
-
-        const moveit::core::VariableBounds& b =
-            jm->getVariableBounds()[0];  // only one variable in the joint, so we get its bounds
-
-        // if the read variable is 'almost' within bounds (up to error_ difference), then consider it to be within
-        // bounds
-        if (joint_state->position[i] < b.min_position_ && joint_state->position[i] >= b.min_position_ - error_)
-        {
-          robot_state_.setJointPositions(jm, &b.min_position_);
-        }
-        else if (joint_state->position[i] > b.max_position_ && joint_state->position[i] <= b.max_position_ + error_)
-        {
-          robot_state_.setJointPositions(jm, &b.max_position_);
-        }
+        robot_state_.setJointVelocities(jm, &(joint_state->velocity[i]));
       }
 
-      // optionally copy velocities and effort
-      if (copy_dynamics_)
+      // update joint efforts
+      if (copy_efforts && (!robot_state_.hasEffort() || robot_state_.getJointEffort(jm)[0] != joint_state->effort[i]))
       {
-        // update joint velocities
-        if (joint_state->name.size() == joint_state->velocity.size() &&
-            (!robot_state_.hasVelocities() || robot_state_.getJointVelocities(jm)[0] != joint_state->velocity[i]))
-        {
-          update = true;
-          robot_state_.setJointVelocities(jm, &(joint_state->velocity[i]));
-        }
-
-        // update joint efforts
-        if (joint_state->name.size() == joint_state->effort.size() &&
-            (!robot_state_.hasEffort() || robot_state_.getJointEffort(jm)[0] != joint_state->effort[i]))
-        {
-          update = true;
-          robot_state_.setJointEfforts(jm, &(joint_state->effort[i]));
-        }
+        update = true;
+        robot_state_.setJointEfforts(jm, &(joint_state->effort[i]));
       }
     }
   }
@@ -446,13 +490,14 @@ void CurrentStateMonitor::updateMultiDofJoints()
         continue;
       }
 
-      if (auto joint_time_it = joint_time_.find(joint); joint_time_it == joint_time_.end())
-        joint_time_.emplace(joint, rclcpp::Time(0, 0, RCL_ROS_TIME));
+      std::optional<rclcpp::Time>& joint_time = joint_time_[joint->getJointIndex()];
+      if (!joint_time)
+        joint_time = rclcpp::Time(0, 0, RCL_ROS_TIME);
 
       // allow update if time is more recent or if it is a static transform (time = 0)
-      if (latest_common_time <= joint_time_[joint] && latest_common_time > rclcpp::Time(0, 0, RCL_ROS_TIME))
+      if (latest_common_time <= *joint_time && latest_common_time > rclcpp::Time(0, 0, RCL_ROS_TIME))
         continue;
-      joint_time_[joint] = latest_common_time;
+      joint_time = latest_common_time;
 
       std::vector<double> new_values(joint->getStateSpaceDimension());
       const moveit::core::LinkModel* link = joint->getChildLinkModel();
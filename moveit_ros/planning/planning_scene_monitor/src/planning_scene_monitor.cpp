@@ -59,6 +59,8 @@
 
 #include <fmt/format.h>
 #include <memory>
+#include <algorithm>
+#include <limits>
 
 #include <std_msgs/msg/string.hpp>
 
@@ -482,6 +484,7 @@ void PlanningSceneMonitor::scenePublishingThread()
     moveit_msgs::msg::PlanningScene msg;
     bool publish_msg = false;
     bool is_full = false;
+    planning_scene::PlanningScenePtr full_scene;
     rclcpp::WallRate rate(publish_planning_scene_frequency_);
     {
       std::unique_lock<std::shared_mutex> ulock(scene_update_mutex_);
@@ -527,13 +530,9 @@ void PlanningSceneMonitor::scenePublishingThread()
             excludeAttachedBodiesFromOctree();  // in case updates have happened to the attached bodies, put them in
             excludeWorldObjectsFromOctree();    // in case updates have happened to the attached bodies, put them in
           }
+          // a full scene is serialized after releasing the lock, from a snapshot that shares the world geometry
           if (is_full)
-          {
-            collision_detection::OccMapTree::ReadLock lock;
-            if (octomap_monitor_)
-              lock = octomap_monitor_->getOcTreePtr()->reading();
-            scene_->getPlanningSceneMsg(msg);
-          }
+            full_scene = planning_scene::PlanningScene::clone(scene_);
           // also publish timestamp of this robot_state
           msg.robot_state.joint_state.header.stamp = last_robot_motion_time_;
           publish_msg = true;
@@ -541,6 +540,18 @@ void PlanningSceneMonitor::scenePublishingThread()
         new_scene_update_ = UPDATE_NONE;
       }
     }
+    if (full_scene)
+    {
+      const builtin_interfaces::msg::Time stamp = msg.robot_state.joint_state.header.stamp;
+      {
+        collision_detection::OccMapTree::ReadLock lock;
+        if (octomap_monitor_)
+          lock = octomap_monitor_->getOcTreePtr()->reading();
+        full_scene->getPlanningSceneMsg(msg);
+      }
+      msg.robot_state.joint_state.header.stamp = stamp;
+      full_scene.reset();
+    }
     if (publish_msg)
     {
       planning_scene_publisher_->publish(msg);
@@ -604,8 +615,8 @@ void PlanningSceneMonitor::triggerSceneUpdateEvent(SceneUpdateType update_type)
   // do not modify update functions while we are calling them
   std::scoped_lock lock(update_lock_);
 
-  for (std::function<void(SceneUpdateType)>& update_callback : update_callbacks_)
-    update_callback(update_type);
+  for (auto& update_callback : update_callbacks_)
+    update_callback.second(update_type);
   new_scene_update_ = static_cast<SceneUpdateType>(static_cast<int>(new_scene_update_) | static_cast<int>(update_type));
   new_scene_update_condition_.notify_all();
 }
@@ -724,6 +735,7 @@ void PlanningSceneMonitor::clearOctomap()
     {
       octomap_monitor_->getOcTreePtr()->lockWrite();
       octomap_monitor_->getOcTreePtr()->clear();
+      octomap_monitor_->getOcTreePtr()->resetChangeDetection();
       octomap_monitor_->getOcTreePtr()->unlockWrite();
     }
     else
@@ -1330,6 +1342,8 @@ void PlanningSceneMonitor::startWorldGeometryMonitor(const std::string& collisio
                                                          occupancy_map_monitor::ShapeTransformCache& cache) {
         return getShapeTransformCache(frame, stamp, cache);
       });
+      // track modified voxels so that updates which do not change the map can be skipped
+      octomap_monitor_->getOcTreePtr()->enableChangeDetection(true);
       octomap_monitor_->setUpdateCallback([this] { octomapUpdateCallback(); });
     }
     octomap_monitor_->startMonitor();
@@ -1431,10 +1445,36 @@ void PlanningSceneMonitor::octomapUpdateCallback()
   if (!octomap_monitor_)
     return;
 
+  // Updates that did not modify any voxel, e.g. sensor data that only confirmed known cells, do not need to refresh
+  // the octomap geometry. Operations that rebuild the tree without change tracking (clearing, loading a map) are
+  // detected by a change of its node count.
+  bool update_octomap;
+  {
+    const collision_detection::OccMapTreePtr& tree = octomap_monitor_->getOcTreePtr();
+    std::size_t tree_size;
+    {
+      auto write_lock = tree->writing();
+      update_octomap = tree->consumeChanges();
+      tree_size = tree->size();
+    }
+    update_octomap = update_octomap || tree_size != octomap_size_;
+    octomap_size_ = tree_size;
+  }
+
   updateFrameTransforms();
   {
     std::unique_lock<std::shared_mutex> ulock(scene_update_mutex_);
     last_update_time_ = rclcpp::Clock().now();
+    if (!update_octomap)
+    {
+      // still apply a change of the octomap pose, which processOctomapPtr() handles as a cheap move
+      const collision_detection::World::ObjectConstPtr map = scene_->getWorld()->getObject(scene_->OCTOMAP_NS);
+      update_octomap = !map || map->shape_poses_.size() != 1 ||
+                       !map->shape_poses_[0].isApprox(Eigen::Isometry3d::Identity(),
+                                                      std::numeric_limits<double>::epsilon() * 100.0);
+    }
+    if (!update_octomap)
+      return;
     octomap_monitor_->getOcTreePtr()->lockRead();
     try
     {
@@ -1533,11 +1573,24 @@ void PlanningSceneMonitor::updateSceneWithCurrentState(bool skip_update_if_locke
   }
 }
 
-void PlanningSceneMonitor::addUpdateCallback(const std::function<void(SceneUpdateType)>& fn)
+PlanningSceneMonitor::UpdateCallbackHandle
+PlanningSceneMonitor::addUpdateCallback(const std::function<void(SceneUpdateType)>& fn)
+{
+  std::scoped_lock lock(update_lock_);
+  if (!fn)
+    return 0;
+  update_callbacks_.emplace_back(next_update_callback_handle_, fn);
+  return next_update_callback_handle_++;
+}
+
+void PlanningSceneMonitor::removeUpdateCallback(UpdateCallbackHandle handle)
 {
   std::scoped_lock lock(update_lock_);
-  if (fn)
-    update_callbacks_.push_back(fn);
+  update_callbacks_.erase(std::remove_if(update_callbacks_.begin(), update_callbacks_.end(),
+                                         [handle](const auto& update_callback) {
+                                           return update_callback.first == handle;
+                                         }),
+                          update_callbacks_.end());
 }
 
 void PlanningSceneMonitor::clearUpdateCallbacks()
@@ -35,8 +35,10 @@
 /* Author: Tyler Weaver */
 
 #include <chrono>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -206,6 +208,54 @@ TEST(CurrentStateMonitorTests, WaitForCompleteStateWaits)
   EXPECT_NEAR(nanoseconds_slept.count(), 1e+9, 1e3);
 }
 
+TEST(CurrentStateMonitorTests, JointStatesFromMultiplePublishers)
+{
+  auto mock_middleware_handle = std::make_unique<MockMiddlewareHandle>();
+
+  planning_scene_monitor::JointStateUpdateCallback joint_state_callback;
+  EXPECT_CALL(*mock_middleware_handle, createJointStateSubscription)
+      .WillOnce(testing::SaveArg<1>(&joint_state_callback));
+
+  // GIVEN a CurrentStateMonitor that is started
+  moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("panda");
+  planning_scene_monitor::CurrentStateMonitor current_state_monitor{
+    std::move(mock_middleware_handle), robot_model,
+    std::make_shared<tf2_ros::Buffer>(std::make_shared<rclcpp::Clock>()), false
+  };
+  current_state_monitor.startStateMonitor();
+  ASSERT_TRUE(joint_state_callback);
+
+  // WHEN two publishers send joint states with different sets and orders of joint names
+  const auto make_joint_state = [](const std::vector<std::string>& names, double position) {
+    auto joint_state = std::make_shared<sensor_msgs::msg::JointState>();
+    joint_state->header.stamp = rclcpp::Time(1, 0, RCL_ROS_TIME);
+    joint_state->name = names;
+    joint_state->position.assign(names.size(), position);
+    return joint_state;
+  };
+  const std::vector<std::string> arm_joints = { "panda_joint7", "panda_joint6", "panda_joint5", "panda_joint4",
+                                                "panda_joint3", "panda_joint2", "panda_joint1", "unknown_joint" };
+  const std::vector<std::string> hand_joints = { "panda_finger_joint1" };
+  for (int i = 1; i <= 3; ++i)
+  {
+    joint_state_callback(make_joint_state(arm_joints, -0.1 * i));
+    joint_state_callback(make_joint_state(hand_joints, 0.01 * i));
+  }
+
+  // THEN we expect all single-DOF joints to be known, with the latest values of both publishers
+  std::vector<std::string> missing_joints;
+  current_state_monitor.haveCompleteState(missing_joints);
+  for (const std::string& name : missing_joints)
+    EXPECT_NE(robot_model->getJointModel(name)->getVariableCount(), 1u) << name;
+  const std::map<std::string, double> values = current_state_monitor.getCurrentStateValues();
+  for (const std::string& name : arm_joints)
+  {
+    if (robot_model->hasJointModel(name))
+      EXPECT_NEAR(values.at(name), -0.3, 1e-9) << name;
+  }
+  EXPECT_NEAR(values.at("panda_finger_joint1"), 0.03, 1e-9);
+}
+
 int main(int argc, char** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -100,6 +100,27 @@ TEST_F(PlanningSceneMonitorTest, TestPersistentScene)
 
 using UpdateType = planning_scene_monitor::PlanningSceneMonitor::SceneUpdateType;
 
+TEST_F(PlanningSceneMonitorTest, RemoveUpdateCallback)
+{
+  planning_scene_monitor_->clearUpdateCallbacks();
+  int first_calls = 0;
+  int second_calls = 0;
+  const auto first = planning_scene_monitor_->addUpdateCallback([&](auto) { ++first_calls; });
+  const auto second = planning_scene_monitor_->addUpdateCallback([&](auto) { ++second_calls; });
+  EXPECT_NE(first, second);
+  EXPECT_EQ(planning_scene_monitor_->addUpdateCallback({}), 0u);
+
+  planning_scene_monitor_->triggerSceneUpdateEvent(UpdateType::UPDATE_SCENE);
+  EXPECT_EQ(first_calls, 1);
+  EXPECT_EQ(second_calls, 1);
+
+  // Only the removed callback stops being called.
+  planning_scene_monitor_->removeUpdateCallback(first);
+  planning_scene_monitor_->triggerSceneUpdateEvent(UpdateType::UPDATE_SCENE);
+  EXPECT_EQ(first_calls, 1);
+  EXPECT_EQ(second_calls, 2);
+}
+
 #define TRIGGERS_UPDATE(msg, expected_update_type)                                                                     \
   {                                                                                                                    \
     planning_scene_monitor_->clearUpdateCallbacks();                                                                   \
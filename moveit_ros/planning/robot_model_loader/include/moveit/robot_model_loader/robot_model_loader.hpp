@@ -74,6 +74,11 @@ public:
     /** @brief Flag indicating whether the kinematics solvers should be loaded as well, using specified ROS parameters
      */
     bool load_kinematics_solvers;
+
+    /** @brief Directory in which decoded link meshes are kept, so later loads skip decoding them. If empty, the
+     * robot_description + "_planning.mesh_cache_directory" ROS parameter is used; if that is not set either, meshes are
+     * always decoded. */
+    std::string mesh_cache_directory;
   };
 
   /** @brief Default constructor */
@@ -116,9 +116,20 @@ void RobotModelLoader::configure(const Options& opt)
   }
   if (rdf_loader_->getURDF())
   {
+    std::string mesh_cache_directory = opt.mesh_cache_directory;
+    if (mesh_cache_directory.empty() && !rdf_loader_->getRobotDescription().empty())
+    {
+      const std::string param_name = rdf_loader_->getRobotDescription() + "_planning.mesh_cache_directory";
+      if (!node_->has_parameter(param_name))
+      {
+        node_->declare_parameter(param_name, rclcpp::ParameterType::PARAMETER_STRING);
+      }
+      node_->get_parameter(param_name, mesh_cache_directory);
+    }
+
     const srdf::ModelSharedPtr& srdf =
         rdf_loader_->getSRDF() ? rdf_loader_->getSRDF() : std::make_shared<srdf::Model>();
-    model_ = std::make_shared<moveit::core::RobotModel>(rdf_loader_->getURDF(), srdf);
+    model_ = std::make_shared<moveit::core::RobotModel>(rdf_loader_->getURDF(), srdf, mesh_cache_directory);
   }
 
   if (model_ && !rdf_loader_->getRobotDescription().empty())
@@ -22,6 +22,10 @@
 #include <chrono>
 #include <cstdint>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <rclcpp/rclcpp.hpp>
@@ -34,12 +38,16 @@
 
 // moveit modules
 #include <moveit/move_group_interface/move_group_interface.hpp>
+#include <moveit/planning_scene/planning_scene.hpp>
+#include <moveit/trajectory_processing/time_parameterization.hpp>
 #include <moveit_msgs/msg/motion_plan_request.hpp>
 #include <moveit_msgs/msg/robot_trajectory.hpp>
 #include <moveit_msgs/srv/get_cartesian_path.hpp>
 
 #include <moveit/trajectory_cache/cache_insert_policies/cache_insert_policy_interface.hpp>
 #include <moveit/trajectory_cache/features/features_interface.hpp>
+#include <moveit/trajectory_cache/utils/async_insert_queue.hpp>
+#include <moveit/trajectory_cache/utils/cache_index.hpp>
 
 namespace moveit_ros
 {
@@ -101,8 +109,23 @@ namespace trajectory_cache
  *
  * Thread-Safety
  * ^^^^^^^^^^^^^
- * This class is NOT thread safe. Synchronize use of it if you need it in
- * multi-threaded contexts.
+ * Calls into this class are serialized internally, so that the background
+ * writer used by the asynchronous insert methods can run alongside them.
+ * The move groups, cache insert policies and features passed to the
+ * asynchronous insert methods are used on the writer thread, and must not be
+ * used elsewhere while inserts that reference them are queued.
+ *
+ * Asynchronous Inserts
+ * ^^^^^^^^^^^^^^^^^^^^
+ * `insertTrajectoryAsync` and `insertCartesianTrajectoryAsync` queue the
+ * insert and return immediately, so the caller does not pay for the insert
+ * policy's fetches, prunes, and database writes. A background writer pops
+ * queued inserts in batches, and runs them one by one, each under the cache's
+ * lock. While queued, inserts with an identical request are coalesced, and the
+ * total size of queued trajectories is bounded.
+ *
+ * @see TrajectoryCache::Options
+ * @see AsyncInsertQueue
  *
  * Injectable Feature Extraction and Cache Insert Policies
  * ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
@@ -218,6 +241,18 @@ public:
    * @property num_additional_trajectories_to_preserve_when_pruning_worse. The number of additional cached trajectories
    * to preserve when `prune_worse_trajectories` is true. It is useful to keep more than one matching trajectory to
    * have alternative trajectories to handle obstacles.
+   * @property use_in_memory_index. If true, fetches are answered from an in-memory index of each collection's
+   * metadata, and only the message bodies of returned entries are pulled from the database. The index is loaded on
+   * first use of a collection and kept in sync with this cache's own inserts and prunes, so the database must not be
+   * written to by other processes while the cache is in use.
+   *   @see CacheIndex
+   * @property max_async_insert_queue_bytes. Memory budget for the trajectories queued by asynchronous inserts.
+   * @property async_insert_batch_size. The maximum number of queued inserts the background writer runs at once.
+   * @property async_insert_timeout. How long an asynchronous insert blocks waiting for room in the memory budget
+   * before it is dropped.
+   * @property coalesce_async_inserts. If true, queued asynchronous inserts with an identical cache namespace and
+   * request are coalesced, keeping the trajectory with the shortest execution time. Disable this if your cache insert
+   * policy keeps more than one trajectory per request.
    */
   struct Options
   {
@@ -226,6 +261,13 @@ public:
 
     double exact_match_precision = 1e-6;
     size_t num_additional_trajectories_to_preserve_when_pruning_worse = 1;
+
+    bool use_in_memory_index = false;
+
+    size_t max_async_insert_queue_bytes = 64 * 1024 * 1024;
+    size_t async_insert_batch_size = 16;
+    std::chrono::milliseconds async_insert_timeout{ 0 };
+    bool coalesce_async_inserts = true;
   };
 
   /**
@@ -234,6 +276,8 @@ public:
    * This sets up the database connection, and sets any configuration parameters.
    * You must call this before calling any other method of the trajectory cache.
    *
+   * Asynchronous inserts queued before a repeated call are written to the previous database first.
+   *
    * @param[in] options. An instance of TrajectoryCache::Options to initialize the cache with.
    *   @see TrajectoryCache::Options
    * @returns True if the database was successfully connected to.
@@ -331,6 +375,40 @@ public:
       const std::vector<std::unique_ptr<FeaturesInterface<moveit_msgs::msg::MotionPlanRequest>>>& features,
       const std::string& sort_by, bool ascending = true, bool metadata_only = false) const;
 
+  /**
+   * @brief Fetches the cached trajectory starting nearest to the request's start state, and adapts it to start there.
+   *
+   * This raises the hit rate of fetches for start states that are slightly off from cached ones. The `features` should
+   * key the start state with a tolerance as large as `max_connector_distance`, to shortlist candidates.
+   *
+   * Candidates are tried in order of joint space distance from the request's start state to their first waypoint. A
+   * straight joint space connector from the start state is prepended to the first candidate whose connector is valid in
+   * the planning scene, and the result is re-timed with the request's velocity and acceleration scaling.
+   *
+   * The cached portion of the trajectory is NOT checked for collisions, as is the case for all cache fetches.
+   *
+   * @see adaptTrajectoryToStartState
+   *
+   * @param[in] move_group. The manipulator move group, used to get its state.
+   * @param[in] cache_namespace. A namespace to separate cache entries by. The name of the robot is a good choice.
+   * @param[in] plan_request. The motion plan request to extract features from to key the cache with.
+   * @param[in] features. The features to key the cache with.
+   * @param[in] planning_scene. The planning scene to resolve the start state in, and to check the connector against.
+   * @param[in] time_parameterization. The parameterizer used to re-time the adapted trajectory.
+   * @param[in] max_connector_distance. The longest connector, in joint space distance, to accept.
+   * @param[in] connector_resolution. The joint space distance between checked connector states.
+   * @param[out] adapted_trajectory. The adapted trajectory. Only written to on success.
+   * @returns moveit::core::MoveItErrorCode::SUCCESS if a cached trajectory was adapted. Otherwise, will return a
+   * different error code.
+   */
+  moveit::core::MoveItErrorCode fetchNearestAdaptedTrajectory(
+      const moveit::planning_interface::MoveGroupInterface& move_group, const std::string& cache_namespace,
+      const moveit_msgs::msg::MotionPlanRequest& plan_request,
+      const std::vector<std::unique_ptr<FeaturesInterface<moveit_msgs::msg::MotionPlanRequest>>>& features,
+      const planning_scene::PlanningScene& planning_scene,
+      const trajectory_processing::TimeParameterization& time_parameterization, double max_connector_distance,
+      double connector_resolution, moveit_msgs::msg::RobotTrajectory& adapted_trajectory) const;
+
   /**
    * @brief Inserts a trajectory into the database, with user-specified insert policy.
    *
@@ -361,6 +439,30 @@ public:
                         const std::vector<std::unique_ptr<FeaturesInterface<moveit_msgs::msg::MotionPlanRequest>>>&
                             additional_features = {});
 
+  /**
+   * @brief Queues a trajectory insert, to be run by a background writer with user-specified insert policy.
+   *
+   * The arguments are as in `insertTrajectory`. The request and plan are copied, and the move group, cache insert
+   * policy and additional features are shared with the writer thread until the insert has run.
+   *
+   * @see TrajectoryCache::insertTrajectory
+   * @see TrajectoryCache::flushAsyncInserts
+   *
+   * @returns True if the insert was queued, or coalesced with a queued insert of the same request. False if there
+   * was no room in the queue's memory budget within `async_insert_timeout`.
+   */
+  bool insertTrajectoryAsync(
+      std::shared_ptr<const moveit::planning_interface::MoveGroupInterface> move_group,
+      const std::string& cache_namespace, const moveit_msgs::msg::MotionPlanRequest& plan_request,
+      const moveit::planning_interface::MoveGroupInterface::Plan& plan,
+      std::shared_ptr<CacheInsertPolicyInterface<moveit_msgs::msg::MotionPlanRequest,
+                                                 moveit::planning_interface::MoveGroupInterface::Plan,
+                                                 moveit_msgs::msg::RobotTrajectory>>
+          cache_insert_policy,
+      bool prune_worse_trajectories = true,
+      std::shared_ptr<const std::vector<std::unique_ptr<FeaturesInterface<moveit_msgs::msg::MotionPlanRequest>>>>
+          additional_features = nullptr);
+
   /**@}*/
 
   /**
@@ -441,14 +543,79 @@ public:
       const std::vector<std::unique_ptr<FeaturesInterface<moveit_msgs::srv::GetCartesianPath::Request>>>&
           additional_features = {});
 
+  /**
+   * @brief Queues a cartesian trajectory insert, to be run by a background writer with user-specified insert policy.
+   *
+   * The arguments are as in `insertCartesianTrajectory`. The request and plan are copied, and the move group, cache
+   * insert policy and additional features are shared with the writer thread until the insert has run.
+   *
+   * @see TrajectoryCache::insertCartesianTrajectory
+   * @see TrajectoryCache::flushAsyncInserts
+   *
+   * @returns True if the insert was queued, or coalesced with a queued insert of the same request. False if there
+   * was no room in the queue's memory budget within `async_insert_timeout`.
+   */
+  bool insertCartesianTrajectoryAsync(
+      std::shared_ptr<const moveit::planning_interface::MoveGroupInterface> move_group,
+      const std::string& cache_namespace, const moveit_msgs::srv::GetCartesianPath::Request& plan_request,
+      const moveit_msgs::srv::GetCartesianPath::Response& plan,
+      std::shared_ptr<
+          CacheInsertPolicyInterface<moveit_msgs::srv::GetCartesianPath::Request,
+                                     moveit_msgs::srv::GetCartesianPath::Response, moveit_msgs::msg::RobotTrajectory>>
+          cache_insert_policy,
+      bool prune_worse_trajectories = true,
+      std::shared_ptr<
+          const std::vector<std::unique_ptr<FeaturesInterface<moveit_msgs::srv::GetCartesianPath::Request>>>>
+          additional_features = nullptr);
+
+  /**@}*/
+
+  /**
+   * @name Asynchronous inserts
+   */
+  /**@{*/
+
+  /** @brief Blocks until all queued asynchronous inserts have been written. */
+  void flushAsyncInserts();
+
+  /** @brief Returns the estimated bytes held by queued asynchronous inserts. */
+  size_t getAsyncInsertQueueBytes() const;
+
   /**@}*/
 
 private:
+  /** @brief Gets the in-memory index for a collection, loading it from the database on first use.
+   * @returns The index, or nullptr if `use_in_memory_index` is disabled.
+   */
+  CacheIndex* getIndex(warehouse_ros::MessageCollection<moveit_msgs::msg::RobotTrajectory>& coll,
+                       const std::string& db_name, const std::string& cache_namespace) const;
+
+  /** @brief Fetches all entries matching the features from the in-memory index, in place of a database query. */
+  template <typename FeatureSourceT>
+  std::vector<warehouse_ros::MessageWithMetadata<moveit_msgs::msg::RobotTrajectory>::ConstPtr>
+  fetchAllMatchingFromIndex(warehouse_ros::MessageCollection<moveit_msgs::msg::RobotTrajectory>& coll,
+                            CacheIndex& index, const moveit::planning_interface::MoveGroupInterface& move_group,
+                            const FeatureSourceT& source,
+                            const std::vector<std::unique_ptr<FeaturesInterface<FeatureSourceT>>>& features,
+                            const std::string& sort_by, bool ascending, bool metadata_only) const;
+
   rclcpp::Node::SharedPtr node_;
   rclcpp::Logger logger_;
   warehouse_ros::DatabaseConnection::Ptr db_;
 
   Options options_;
+
+  /** @brief In-memory indexes, keyed by "<db_name>@<cache_namespace>". */
+  mutable std::unordered_map<std::string, CacheIndex> indexes_;
+
+  /** @brief Serializes calls, including those made by the asynchronous insert writer. */
+  mutable std::recursive_mutex cache_mutex_;
+
+  /** @brief Guards insert_queue_, and the options it was created with, against a concurrent init(). */
+  mutable std::shared_mutex insert_queue_mutex_;
+
+  /** @brief Declared last, so queued inserts are written before the members they use are destroyed. */
+  std::unique_ptr<AsyncInsertQueue> insert_queue_;
 };
 
 }  // namespace trajectory_cache
@@ -0,0 +1,123 @@
+// Copyright 2024 Intrinsic Innovation LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file
+ * @brief Bounded, coalescing work queue drained by a background writer thread.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace moveit_ros
+{
+namespace trajectory_cache
+{
+
+/** @class AsyncInsertQueue async_insert_queue.hpp moveit/trajectory_cache/utils/async_insert_queue.hpp
+ *
+ * @brief Queues cache inserts for a background writer, which runs them in batches.
+ *
+ * Each queued insert has a key, an estimated size in bytes, and a cost:
+ *   - Inserts with the same key are coalesced while queued, keeping the one with the lowest cost.
+ *   - The estimated bytes of all queued inserts are bounded by a memory budget. Pushing past the budget
+ *     blocks the caller for up to a timeout (backpressure), after which the insert is rejected. An insert
+ *     that alone exceeds the budget is accepted only into an empty queue, so it is never starved.
+ *   - The writer thread pops up to `batch_size` inserts at a time and hands them to the batch runner in
+ *     queue order. This only saves queue wakeups; the runner still runs the inserts one by one.
+ */
+class AsyncInsertQueue
+{
+public:
+  using Insert = std::function<void()>;
+  using BatchRunner = std::function<void(std::vector<Insert>& batch)>;
+
+  /**
+   * @brief Starts the writer thread.
+   *
+   * @param[in] run_batch. Called on the writer thread with each batch of inserts to run. Must not throw.
+   * @param[in] max_queued_bytes. Memory budget for the estimated size of all queued inserts.
+   * @param[in] batch_size. The maximum number of inserts handed to `run_batch` at once.
+   * @param[in] coalesce. If true, queued inserts with the same key are coalesced.
+   */
+  AsyncInsertQueue(BatchRunner run_batch, size_t max_queued_bytes, size_t batch_size, bool coalesce);
+
+  /** @brief Runs all queued inserts, then stops the writer thread. */
+  ~AsyncInsertQueue();
+
+  AsyncInsertQueue(const AsyncInsertQueue&) = delete;
+  AsyncInsertQueue& operator=(const AsyncInsertQueue&) = delete;
+
+  /**
+   * @brief Queues an insert.
+   *
+   * @param[in] key. Inserts with equal keys are coalesced while queued.
+   * @param[in] bytes. The estimated memory held by the insert.
+   * @param[in] cost. When coalescing, the insert with the lowest cost is kept.
+   * @param[in] insert. The insert to run on the writer thread.
+   * @param[in] timeout. How long to wait for room in the memory budget.
+   * @returns True if the insert was queued or coalesced, false if it was rejected for lack of room.
+   */
+  bool push(const std::string& key, size_t bytes, double cost, Insert insert,
+            std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+  /** @brief Blocks until every insert queued so far has been run. */
+  void flush();
+
+  /** @brief Returns the number of queued inserts, not counting the batch being run. */
+  size_t size() const;
+
+  /** @brief Returns the estimated bytes held by queued inserts and the batch being run. */
+  size_t queuedBytes() const;
+
+private:
+  struct Entry
+  {
+    std::string key;
+    size_t bytes;
+    double cost;
+    Insert insert;
+  };
+
+  void writerLoop();
+
+  BatchRunner run_batch_;
+  const size_t max_queued_bytes_;
+  const size_t batch_size_;
+  const bool coalesce_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable work_cv_;   // Signalled when inserts are queued, or on stop.
+  std::condition_variable space_cv_;  // Signalled when a batch completes.
+
+  std::list<Entry> queue_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> queued_keys_;
+  size_t queued_bytes_ = 0;
+  size_t in_flight_ = 0;
+  bool stop_ = false;
+
+  std::thread writer_;
+};
+
+}  // namespace trajectory_cache
+}  // namespace moveit_ros
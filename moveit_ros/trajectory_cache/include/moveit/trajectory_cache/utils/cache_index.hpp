@@ -0,0 +1,184 @@
+// Copyright 2024 Intrinsic Innovation LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file
+ * @brief In-memory index over the metadata of a trajectory cache collection.
+ */
+
+#pragma once
+
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <moveit_msgs/msg/robot_trajectory.hpp>
+#include <warehouse_ros/message_collection.h>
+
+namespace moveit_ros
+{
+namespace trajectory_cache
+{
+
+/** @class IndexQuery cache_index.hpp moveit/trajectory_cache/utils/cache_index.hpp
+ *
+ * @brief A warehouse_ros::Query that records its predicates so they can be evaluated against a CacheIndex.
+ *
+ * Features append their fetch predicates to this exactly as they would to a database query, so any
+ * FeaturesInterface<FeatureSourceT> implementation can key an in-memory lookup without modification.
+ *
+ * Numeric predicates on the same field are intersected into a single interval. String predicates are
+ * kept as exact matches.
+ */
+class IndexQuery : public warehouse_ros::Query
+{
+public:
+  /** @brief A (possibly half-open) numeric interval a field must lie in. */
+  struct Interval
+  {
+    double lower = -std::numeric_limits<double>::infinity();
+    double upper = std::numeric_limits<double>::infinity();
+    bool lower_inclusive = true;
+    bool upper_inclusive = true;
+
+    /** @brief Returns true if the value lies in the interval. */
+    bool contains(double value) const;
+
+    /** @brief Narrows this interval to its intersection with [lower, upper]. */
+    void intersect(double other_lower, bool other_lower_inclusive, double other_upper, bool other_upper_inclusive);
+  };
+
+  void append(const std::string& name, const std::string& val) override;
+  void append(const std::string& name, const double val) override;
+  void append(const std::string& name, const int val) override;
+  void append(const std::string& name, const bool val) override;
+  void appendLT(const std::string& name, const double val) override;
+  void appendLT(const std::string& name, const int val) override;
+  void appendLTE(const std::string& name, const double val) override;
+  void appendLTE(const std::string& name, const int val) override;
+  void appendGT(const std::string& name, const double val) override;
+  void appendGT(const std::string& name, const int val) override;
+  void appendGTE(const std::string& name, const double val) override;
+  void appendGTE(const std::string& name, const int val) override;
+  void appendRange(const std::string& name, const double lower, const double upper) override;
+  void appendRange(const std::string& name, const int lower, const int upper) override;
+  void appendRangeInclusive(const std::string& name, const double lower, const double upper) override;
+  void appendRangeInclusive(const std::string& name, const int lower, const int upper) override;
+
+  /** @brief Gets the numeric interval each constrained numeric field must lie in. */
+  const std::unordered_map<std::string, Interval>& getIntervals() const;
+
+  /** @brief Gets the exact value each constrained string field must have. */
+  const std::unordered_map<std::string, std::vector<std::string>>& getStringMatches() const;
+
+private:
+  std::unordered_map<std::string, Interval> intervals_;
+  std::unordered_map<std::string, std::vector<std::string>> string_matches_;
+};
+
+/** @class CacheIndex cache_index.hpp moveit/trajectory_cache/utils/cache_index.hpp
+ *
+ * @brief In-memory mirror of the metadata of one trajectory cache collection.
+ *
+ * Every numeric metadata field is kept in its own sorted secondary index. Fetch predicates produced by
+ * features are axis-aligned boxes (a center and a tolerance per feature), so a lookup binary searches
+ * each constrained field, walks only the narrowest of the resulting slices, and filters that shortlist
+ * against the remaining predicates. No trajectory message is deserialized to answer a query; callers
+ * pull the message body of only the entries they actually want by their "id".
+ *
+ * The index is synchronized incrementally: `sync()` pulls the metadata of entries with an "id" greater
+ * than any it holds, and `remove()` must be called for every entry deleted from the collection.
+ * Writes to the collection made by other processes after the initial sync are not observed.
+ *
+ * Thread-Safety
+ * ^^^^^^^^^^^^^
+ * This class is NOT thread safe.
+ */
+class CacheIndex
+{
+public:
+  using EntryPtr = warehouse_ros::MessageWithMetadata<moveit_msgs::msg::RobotTrajectory>::ConstPtr;
+
+  /** @brief The type a metadata field is read as. Bools and ints are indexed as numeric fields. */
+  enum class FieldType
+  {
+    DOUBLE,
+    INT,
+    STRING,
+    BOOL
+  };
+
+  /** @brief Pulls the metadata of all collection entries not yet in the index.
+   *
+   * The pulled entries are appended to the field indexes first, which are then sorted once.
+   *
+   * @param[in] coll. The collection this index mirrors.
+   * @returns The number of entries added.
+   */
+  size_t sync(warehouse_ros::MessageCollection<moveit_msgs::msg::RobotTrajectory>& coll);
+
+  /** @brief Adds a metadata-only cache entry to the index. Entries without an integer "id" are ignored.
+   * @returns True if the entry was added.
+   */
+  bool add(const EntryPtr& entry);
+
+  /** @brief Removes the entry with the given "id" from the index. */
+  void remove(int id);
+
+  /** @brief Removes all entries. */
+  void clear();
+
+  /** @brief Returns the number of indexed entries. */
+  size_t size() const;
+
+  /** @brief Returns all entries matching the query, sorted by some numeric metadata field.
+   *
+   * Entries missing the sort field are placed last.
+   *
+   * @param[in] query. The recorded fetch predicates.
+   * @param[in] sort_by. The metadata field to sort by. If empty, entries are returned in "id" order.
+   * @param[in] ascending. If true, sorts in ascending order. If false, sorts in descending order.
+   * @returns The matching metadata-only entries.
+   */
+  std::vector<EntryPtr> query(const IndexQuery& query, const std::string& sort_by, bool ascending = true) const;
+
+private:
+  struct Entry
+  {
+    EntryPtr metadata;
+    std::unordered_map<std::string, double> numeric_fields;
+    std::unordered_map<std::string, std::string> string_fields;
+  };
+
+  /** @brief (value, id) pairs, sorted. */
+  using FieldIndex = std::vector<std::pair<double, int>>;
+
+  /** @brief Indexes an entry whose id is not indexed yet.
+   *
+   * If sorted_sizes is null, every field index is kept sorted. Otherwise keys are appended unsorted, and the size of
+   * the sorted prefix of every touched field index is recorded in sorted_sizes, for the caller to sort once.
+   */
+  void index(int id, const EntryPtr& entry, std::unordered_map<FieldIndex*, size_t>* sorted_sizes);
+
+  bool matches(const Entry& entry, const IndexQuery& query) const;
+
+  std::unordered_map<int, Entry> entries_;
+  std::unordered_map<std::string, FieldIndex> field_indexes_;
+  std::unordered_map<std::string, FieldType> field_types_;  ///< Type each field was last read as.
+  int max_id_ = std::numeric_limits<int>::min();
+};
+
+}  // namespace trajectory_cache
+}  // namespace moveit_ros
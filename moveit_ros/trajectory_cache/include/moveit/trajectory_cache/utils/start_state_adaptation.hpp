@@ -0,0 +1,75 @@
+// Copyright 2024 Intrinsic Innovation LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file
+ * @brief Utilities for reusing a cached trajectory from a nearby start state.
+ */
+
+#pragma once
+
+#include <string>
+
+#include <moveit/planning_scene/planning_scene.hpp>
+#include <moveit/robot_state/robot_state.hpp>
+#include <moveit/trajectory_processing/time_parameterization.hpp>
+#include <moveit/utils/moveit_error_code.hpp>
+#include <moveit_msgs/msg/robot_trajectory.hpp>
+
+namespace moveit_ros
+{
+namespace trajectory_cache
+{
+
+/** @brief Computes the joint space distance of a start state to the first waypoint of a trajectory.
+ *
+ * @param[in] start_state. The state to measure from.
+ * @param[in] group_name. The joint model group to measure over.
+ * @param[in] trajectory. The trajectory to measure to.
+ * @returns The distance, or infinity if the trajectory is empty.
+ */
+double distanceToTrajectoryStart(const moveit::core::RobotState& start_state, const std::string& group_name,
+                                 const moveit_msgs::msg::RobotTrajectory& trajectory);
+
+/** @brief Adapts a cached trajectory to start from a nearby start state.
+ *
+ * A straight joint space connector from `start_state` to the first waypoint of `cached_trajectory` is prepended to the
+ * cached trajectory, and the result is re-timed.
+ *
+ * The connector is checked for validity against the planning scene at every `connector_resolution` of joint space
+ * distance. The cached trajectory itself is NOT checked, as is the case for all cache fetches.
+ *
+ * @param[in] planning_scene. The planning scene to check the connector against.
+ * @param[in] start_state. The state the adapted trajectory should start from.
+ * @param[in] group_name. The joint model group the trajectory is for.
+ * @param[in] cached_trajectory. The trajectory to adapt.
+ * @param[in] max_connector_distance. The longest connector, in joint space distance, to accept.
+ * @param[in] connector_resolution. The joint space distance between checked connector states.
+ * @param[in] time_parameterization. The parameterizer used to re-time the adapted trajectory.
+ * @param[in] max_velocity_scaling_factor. The velocity scaling to re-time with.
+ * @param[in] max_acceleration_scaling_factor. The acceleration scaling to re-time with.
+ * @param[out] adapted_trajectory. The adapted trajectory. Only written to on success.
+ * @returns moveit::core::MoveItErrorCode::SUCCESS if the trajectory was adapted. Otherwise, will return a different
+ * error code.
+ */
+moveit::core::MoveItErrorCode
+adaptTrajectoryToStartState(const planning_scene::PlanningScene& planning_scene,
+                            const moveit::core::RobotState& start_state, const std::string& group_name,
+                            const moveit_msgs::msg::RobotTrajectory& cached_trajectory, double max_connector_distance,
+                            double connector_resolution,
+                            const trajectory_processing::TimeParameterization& time_parameterization,
+                            double max_velocity_scaling_factor, double max_acceleration_scaling_factor,
+                            moveit_msgs::msg::RobotTrajectory& adapted_trajectory);
+
+}  // namespace trajectory_cache
+}  // namespace moveit_ros
@@ -235,5 +235,19 @@ moveit::core::MoveItErrorCode appendRobotStateJointStateAsInsertMetadata(
     warehouse_ros::Metadata& metadata, const moveit_msgs::msg::RobotState& robot_state,
     const moveit::planning_interface::MoveGroupInterface& move_group, const std::string& prefix);
 
+/** @brief Replaces a robot state that is a diff by the current state of the move group, as explicit joint values.
+ *
+ * This allows a request to be keyed later on, e.g. by a background writer, with the state the robot was in when the
+ * request was made.
+ *
+ * @param[in,out] robot_state. The robot state to resolve. Left unchanged if it is not a diff.
+ * @param[in] move_group. The manipulator move group, used to get its state.
+ * @returns moveit::core::MoveItErrorCode::SUCCESS if the state was resolved or is not a diff. Otherwise, will return a
+ * different error code, in which case the robot state is left unchanged.
+ */
+moveit::core::MoveItErrorCode
+resolveRobotStateDiff(moveit_msgs::msg::RobotState& robot_state,
+                      const moveit::planning_interface::MoveGroupInterface& move_group);
+
 }  // namespace trajectory_cache
 }  // namespace moveit_ros
@@ -19,11 +19,16 @@
 
 #include <chrono>
 #include <cstdint>
+#include <algorithm>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
 #include <vector>
 
 #include <rclcpp/rclcpp.hpp>
 #include <rclcpp/logging.hpp>
+#include <rclcpp/serialization.hpp>
 
 #include <warehouse_ros/message_collection.h>
 #include <warehouse_ros/database_connection.h>
@@ -37,6 +42,9 @@
 
 #include <moveit/move_group_interface/move_group_interface.hpp>
 #include <moveit/warehouse/moveit_message_storage.hpp>
+#include <moveit/trajectory_cache/utils/async_insert_queue.hpp>
+#include <moveit/trajectory_cache/utils/cache_index.hpp>
+#include <moveit/trajectory_cache/utils/start_state_adaptation.hpp>
 #include <moveit/trajectory_cache/utils/utils.hpp>
 #include <moveit/robot_state/conversions.hpp>
 #include <moveit/robot_state/robot_state.hpp>
@@ -84,6 +92,46 @@ const std::string EXECUTION_TIME = "execution_time_s";
 const std::string FRACTION = "fraction";
 const std::string PLANNING_TIME = "planning_time_s";
 
+const std::string TRAJECTORY_CACHE_DB = "move_group_trajectory_cache";
+const std::string CARTESIAN_TRAJECTORY_CACHE_DB = "move_group_cartesian_trajectory_cache";
+
+std::string indexKey(const std::string& db_name, const std::string& cache_namespace)
+{
+  return db_name + "@" + cache_namespace;
+}
+
+/** @brief Keys an asynchronous insert by its collection and serialized request, for coalescing. */
+template <typename RequestT>
+std::string asyncInsertKey(const std::string& db_name, const std::string& cache_namespace, const RequestT& request)
+{
+  static const rclcpp::Serialization<RequestT> SERIALIZER;
+  rclcpp::SerializedMessage serialized;
+  SERIALIZER.serialize_message(&request, &serialized);
+
+  const rcl_serialized_message_t& buffer = serialized.get_rcl_serialized_message();
+  std::string key = indexKey(db_name, cache_namespace);
+  key.push_back('\0');
+  key.append(reinterpret_cast<const char*>(buffer.buffer), buffer.buffer_length);
+  return key;
+}
+
+/** @brief Estimates the memory held by a trajectory, for the asynchronous insert memory budget. */
+size_t estimateTrajectoryBytes(const RobotTrajectory& trajectory)
+{
+  size_t bytes = sizeof(RobotTrajectory);
+  for (const auto& point : trajectory.joint_trajectory.points)
+  {
+    bytes += sizeof(point) + sizeof(double) * (point.positions.size() + point.velocities.size() +
+                                               point.accelerations.size() + point.effort.size());
+  }
+  for (const auto& point : trajectory.multi_dof_joint_trajectory.points)
+  {
+    bytes += sizeof(point) + sizeof(geometry_msgs::msg::Transform) * point.transforms.size() +
+             sizeof(geometry_msgs::msg::Twist) * (point.velocities.size() + point.accelerations.size());
+  }
+  return bytes;
+}
+
 }  // namespace
 
 // =================================================================================================
@@ -130,6 +178,15 @@ TrajectoryCache::TrajectoryCache(const rclcpp::Node::SharedPtr& node)
 
 bool TrajectoryCache::init(const TrajectoryCache::Options& options)
 {
+  // Asynchronous inserts wait until the queue is replaced, and read the options it was created with.
+  std::unique_lock<std::shared_mutex> queue_lock(insert_queue_mutex_);
+
+  // Write out inserts queued against the previous database. This must happen before taking the cache lock, since the
+  // writer takes it too.
+  insert_queue_.reset();
+
+  std::lock_guard<std::recursive_mutex> lock(cache_mutex_);
+
   RCLCPP_DEBUG(logger_, "Opening trajectory cache database at: %s (Port: %d, Precision: %f)", options.db_path.c_str(),
                options.db_port, options.exact_match_precision);
 
@@ -137,9 +194,31 @@ bool TrajectoryCache::init(const TrajectoryCache::Options& options)
   // default.
   db_ = moveit_warehouse::loadDatabase(node_);
   options_ = options;
+  indexes_.clear();
 
   db_->setParams(options.db_path, options.db_port);
-  return db_->connect();
+  if (!db_->connect())
+  {
+    return false;
+  }
+
+  insert_queue_ = std::make_unique<AsyncInsertQueue>(
+      [this](std::vector<AsyncInsertQueue::Insert>& batch) {
+        // Each insert takes the cache lock on its own, so fetches can run between the inserts of a batch.
+        for (AsyncInsertQueue::Insert& insert : batch)
+        {
+          try
+          {
+            insert();
+          }
+          catch (const std::exception& e)
+          {
+            RCLCPP_ERROR_STREAM(logger_, "Asynchronous trajectory insert failed: " << e.what());
+          }
+        }
+      },
+      options.max_async_insert_queue_bytes, options.async_insert_batch_size, options.coalesce_async_inserts);
+  return true;
 }
 
 // =================================================================================================
@@ -148,6 +227,7 @@ bool TrajectoryCache::init(const TrajectoryCache::Options& options)
 
 unsigned TrajectoryCache::countTrajectories(const std::string& cache_namespace)
 {
+  std::lock_guard<std::recursive_mutex> lock(cache_mutex_);
   MessageCollection<RobotTrajectory> coll =
       db_->openCollection<RobotTrajectory>("move_group_trajectory_cache", cache_namespace);
   return coll.count();
@@ -155,6 +235,7 @@ unsigned TrajectoryCache::countTrajectories(const std::string& cache_namespace)
 
 unsigned TrajectoryCache::countCartesianTrajectories(const std::string& cache_namespace)
 {
+  std::lock_guard<std::recursive_mutex> lock(cache_mutex_);
   MessageCollection<RobotTrajectory> coll =
       db_->openCollection<RobotTrajectory>("move_group_cartesian_trajectory_cache", cache_namespace);
   return coll.count();
@@ -162,32 +243,38 @@ unsigned TrajectoryCache::countCartesianTrajectories(const std::string& cache_na
 
 std::string TrajectoryCache::getDbPath() const
 {
+  std::lock_guard<std::recursive_mutex> lock(cache_mutex_);
   return options_.db_path;
 }
 
 uint32_t TrajectoryCache::getDbPort() const
 {
+  std::lock_guard<std::recursive_mutex> lock(cache_mutex_);
   return options_.db_port;
 }
 
 double TrajectoryCache::getExactMatchPrecision() const
 {
+  std::lock_guard<std::recursive_mutex> lock(cache_mutex_);
   return options_.exact_match_precision;
 }
 
 void TrajectoryCache::setExactMatchPrecision(double exact_match_precision)
 {
+  std::lock_guard<std::recursive_mutex> lock(cache_mutex_);
   options_.exact_match_precision = exact_match_precision;
 }
 
 size_t TrajectoryCache::getNumAdditionalTrajectoriesToPreserveWhenPruningWorse() const
 {
+  std::lock_guard<std::recursive_mutex> lock(cache_mutex_);
   return options_.num_additional_trajectories_to_preserve_when_pruning_worse;
 }
 
 void TrajectoryCache::setNumAdditionalTrajectoriesToPreserveWhenPruningWorse(
     size_t num_additional_trajectories_to_preserve_when_pruning_worse)
 {
+  std::lock_guard<std::recursive_mutex> lock(cache_mutex_);
   options_.num_additional_trajectories_to_preserve_when_pruning_worse =
       num_additional_trajectories_to_preserve_when_pruning_worse;
 }
@@ -201,9 +288,16 @@ std::vector<MessageWithMetadata<RobotTrajectory>::ConstPtr> TrajectoryCache::fet
     const std::vector<std::unique_ptr<FeaturesInterface<MotionPlanRequest>>>& features, const std::string& sort_by,
     bool ascending, bool metadata_only) const
 {
+  std::lock_guard<std::recursive_mutex> lock(cache_mutex_);
   MessageCollection<RobotTrajectory> coll =
       db_->openCollection<RobotTrajectory>("move_group_trajectory_cache", cache_namespace);
 
+  if (CacheIndex* index = getIndex(coll, TRAJECTORY_CACHE_DB, cache_namespace))
+  {
+    return fetchAllMatchingFromIndex(coll, *index, move_group, plan_request, features, sort_by, ascending,
+                                     metadata_only);
+  }
+
   Query::Ptr query = coll.createQuery();
   for (const auto& feature : features)
   {
@@ -224,6 +318,7 @@ MessageWithMetadata<RobotTrajectory>::ConstPtr TrajectoryCache::fetchBestMatchin
     const std::vector<std::unique_ptr<FeaturesInterface<MotionPlanRequest>>>& features, const std::string& sort_by,
     bool ascending, bool metadata_only) const
 {
+  std::lock_guard<std::recursive_mutex> lock(cache_mutex_);
   // Find all matching, with metadata only. We'll use the ID of the best trajectory to pull it.
   std::vector<MessageWithMetadata<RobotTrajectory>::ConstPtr> matching_trajectories =
       this->fetchAllMatchingTrajectories(move_group, cache_namespace, plan_request, features, sort_by, ascending,
@@ -245,6 +340,67 @@ MessageWithMetadata<RobotTrajectory>::ConstPtr TrajectoryCache::fetchBestMatchin
   return coll.findOne(best_query, metadata_only);
 }
 
+MoveItErrorCode TrajectoryCache::fetchNearestAdaptedTrajectory(
+    const MoveGroupInterface& move_group, const std::string& cache_namespace, const MotionPlanRequest& plan_request,
+    const std::vector<std::unique_ptr<FeaturesInterface<MotionPlanRequest>>>& features,
+    const planning_scene::PlanningScene& planning_scene,
+    const trajectory_processing::TimeParameterization& time_parameterization, double max_connector_distance,
+    double connector_resolution, RobotTrajectory& adapted_trajectory) const
+{
+  std::lock_guard<std::recursive_mutex> lock(cache_mutex_);
+
+  std::vector<MessageWithMetadata<RobotTrajectory>::ConstPtr> candidates =
+      this->fetchAllMatchingTrajectories(move_group, cache_namespace, plan_request, features,
+                                         /*sort_by=*/EXECUTION_TIME, /*ascending=*/true);
+  if (candidates.empty())
+  {
+    return MoveItErrorCode(moveit_msgs::msg::MoveItErrorCodes::FAILURE, "No matching trajectories found.");
+  }
+
+  // Resolve the start state the same way planning would, applying diffs onto the scene's current state.
+  moveit::core::RobotState start_state(planning_scene.getCurrentState());
+  moveit::core::robotStateMsgToRobotState(planning_scene.getTransforms(), plan_request.start_state, start_state);
+  start_state.update();
+
+  const std::string& group_name = plan_request.group_name.empty() ? move_group.getName() : plan_request.group_name;
+
+  // Try candidates nearest first. The sort is stable, so ties keep the execution time order.
+  std::vector<std::pair<double, size_t>> by_distance;
+  by_distance.reserve(candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i)
+  {
+    double distance = distanceToTrajectoryStart(start_state, group_name, *candidates[i]);
+    if (distance <= max_connector_distance)
+    {
+      by_distance.emplace_back(distance, i);
+    }
+  }
+  std::stable_sort(by_distance.begin(), by_distance.end(),
+                   [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  // Non-positive or out of range scaling factors mean full speed, as in planning.
+  auto scaling = [](double factor) { return (factor > 0.0 && factor <= 1.0) ? factor : 1.0; };
+
+  MoveItErrorCode ret(moveit_msgs::msg::MoveItErrorCodes::FAILURE,
+                      "No cached trajectory starts within the maximum connector distance.");
+  for (const auto& [distance, index] : by_distance)
+  {
+    ret = adaptTrajectoryToStartState(planning_scene, start_state, group_name, *candidates[index],
+                                      max_connector_distance, connector_resolution, time_parameterization,
+                                      scaling(plan_request.max_velocity_scaling_factor),
+                                      scaling(plan_request.max_acceleration_scaling_factor), adapted_trajectory);
+    if (ret)
+    {
+      RCLCPP_DEBUG(logger_, "Adapted cached trajectory (id: `%d`) with a connector of length %f.",
+                   candidates[index]->lookupInt("id"), distance);
+      return ret;
+    }
+    RCLCPP_DEBUG_STREAM(logger_, "Could not adapt cached trajectory (id: `" << candidates[index]->lookupInt("id")
+                                                                             << "`): " << ret.message);
+  }
+  return ret;
+}
+
 bool TrajectoryCache::insertTrajectory(
     const MoveGroupInterface& move_group, const std::string& cache_namespace, const MotionPlanRequest& plan_request,
     const MoveGroupInterface::Plan& plan,
@@ -252,6 +408,7 @@ bool TrajectoryCache::insertTrajectory(
     bool prune_worse_trajectories,
     const std::vector<std::unique_ptr<FeaturesInterface<MotionPlanRequest>>>& additional_features)
 {
+  std::lock_guard<std::recursive_mutex> lock(cache_mutex_);
   MessageCollection<RobotTrajectory> coll =
       db_->openCollection<RobotTrajectory>("move_group_trajectory_cache", cache_namespace);
 
@@ -282,6 +439,10 @@ bool TrajectoryCache::insertTrajectory(
         Query::Ptr delete_query = coll.createQuery();
         delete_query->append("id", delete_id);
         coll.removeMessages(delete_query);
+        if (auto index_it = indexes_.find(indexKey(TRAJECTORY_CACHE_DB, cache_namespace)); index_it != indexes_.end())
+        {
+          index_it->second.remove(delete_id);
+        }
       }
     }
   }
@@ -318,6 +479,10 @@ bool TrajectoryCache::insertTrajectory(
 
     RCLCPP_DEBUG_STREAM(logger_, "Inserting trajectory:" << insert_reason);
     coll.insert(plan.trajectory, insert_metadata);
+    if (auto index_it = indexes_.find(indexKey(TRAJECTORY_CACHE_DB, cache_namespace)); index_it != indexes_.end())
+    {
+      index_it->second.sync(coll);
+    }
     cache_insert_policy.reset();
     return true;
   }
@@ -339,9 +504,16 @@ std::vector<MessageWithMetadata<RobotTrajectory>::ConstPtr> TrajectoryCache::fet
     const std::vector<std::unique_ptr<FeaturesInterface<GetCartesianPath::Request>>>& features,
     const std::string& sort_by, bool ascending, bool metadata_only) const
 {
+  std::lock_guard<std::recursive_mutex> lock(cache_mutex_);
   MessageCollection<RobotTrajectory> coll =
       db_->openCollection<RobotTrajectory>("move_group_cartesian_trajectory_cache", cache_namespace);
 
+  if (CacheIndex* index = getIndex(coll, CARTESIAN_TRAJECTORY_CACHE_DB, cache_namespace))
+  {
+    return fetchAllMatchingFromIndex(coll, *index, move_group, plan_request, features, sort_by, ascending,
+                                     metadata_only);
+  }
+
   Query::Ptr query = coll.createQuery();
   for (const auto& feature : features)
   {
@@ -363,6 +535,7 @@ MessageWithMetadata<RobotTrajectory>::ConstPtr TrajectoryCache::fetchBestMatchin
     const std::vector<std::unique_ptr<FeaturesInterface<GetCartesianPath::Request>>>& features,
     const std::string& sort_by, bool ascending, bool metadata_only) const
 {
+  std::lock_guard<std::recursive_mutex> lock(cache_mutex_);
   // Find all matching, with metadata only. We'll use the ID of the best trajectory to pull it.
   std::vector<MessageWithMetadata<RobotTrajectory>::ConstPtr> matching_trajectories =
       this->fetchAllMatchingCartesianTrajectories(move_group, cache_namespace, plan_request, features, sort_by,
@@ -392,6 +565,7 @@ bool TrajectoryCache::insertCartesianTrajectory(
     bool prune_worse_trajectories,
     const std::vector<std::unique_ptr<FeaturesInterface<GetCartesianPath::Request>>>& additional_features)
 {
+  std::lock_guard<std::recursive_mutex> lock(cache_mutex_);
   MessageCollection<RobotTrajectory> coll =
       db_->openCollection<RobotTrajectory>("move_group_cartesian_trajectory_cache", cache_namespace);
 
@@ -422,6 +596,11 @@ bool TrajectoryCache::insertCartesianTrajectory(
         Query::Ptr delete_query = coll.createQuery();
         delete_query->append("id", delete_id);
         coll.removeMessages(delete_query);
+        if (auto index_it = indexes_.find(indexKey(CARTESIAN_TRAJECTORY_CACHE_DB, cache_namespace));
+            index_it != indexes_.end())
+        {
+          index_it->second.remove(delete_id);
+        }
       }
     }
   }
@@ -458,6 +637,11 @@ bool TrajectoryCache::insertCartesianTrajectory(
 
     RCLCPP_DEBUG_STREAM(logger_, "Inserting cartesian trajectory:" << insert_reason);
     coll.insert(plan.solution, insert_metadata);
+    if (auto index_it = indexes_.find(indexKey(CARTESIAN_TRAJECTORY_CACHE_DB, cache_namespace));
+        index_it != indexes_.end())
+    {
+      index_it->second.sync(coll);
+    }
     cache_insert_policy.reset();
     return true;
   }
@@ -469,5 +653,193 @@ bool TrajectoryCache::insertCartesianTrajectory(
   }
 }
 
+// =================================================================================================
+// Asynchronous Inserts.
+// =================================================================================================
+
+bool TrajectoryCache::insertTrajectoryAsync(
+    std::shared_ptr<const MoveGroupInterface> move_group, const std::string& cache_namespace,
+    const MotionPlanRequest& plan_request, const MoveGroupInterface::Plan& plan,
+    std::shared_ptr<CacheInsertPolicyInterface<MotionPlanRequest, MoveGroupInterface::Plan, RobotTrajectory>>
+        cache_insert_policy,
+    bool prune_worse_trajectories,
+    std::shared_ptr<const std::vector<std::unique_ptr<FeaturesInterface<MotionPlanRequest>>>> additional_features)
+{
+  std::shared_lock<std::shared_mutex> queue_lock(insert_queue_mutex_);
+  if (!insert_queue_)
+  {
+    RCLCPP_ERROR(logger_, "Skipping asynchronous trajectory insert: The cache was not initialized.");
+    return false;
+  }
+
+  // The writer runs later, when the robot may have moved on. A diff start state is resolved now, so that the entry is
+  // keyed, and coalesced, by the state the plan was made from.
+  MotionPlanRequest resolved_request = plan_request;
+  if (MoveItErrorCode ret = resolveRobotStateDiff(resolved_request.start_state, *move_group); !ret)
+  {
+    RCLCPP_ERROR_STREAM(logger_, "Skipping asynchronous trajectory insert: " << ret.message);
+    return false;
+  }
+
+  std::string key = asyncInsertKey(TRAJECTORY_CACHE_DB, cache_namespace, resolved_request);
+  size_t bytes = key.size() + estimateTrajectoryBytes(plan.trajectory);
+  double execution_time_s = getExecutionTime(plan.trajectory);
+
+  bool queued = insert_queue_->push(
+      key, bytes, /*cost=*/execution_time_s,
+      [this, move_group = std::move(move_group), cache_namespace, plan_request = std::move(resolved_request),
+       plan, cache_insert_policy = std::move(cache_insert_policy), prune_worse_trajectories,
+       additional_features = std::move(additional_features)] {
+        if (additional_features)
+        {
+          insertTrajectory(*move_group, cache_namespace, plan_request, plan, *cache_insert_policy,
+                           prune_worse_trajectories, *additional_features);
+        }
+        else
+        {
+          insertTrajectory(*move_group, cache_namespace, plan_request, plan, *cache_insert_policy,
+                           prune_worse_trajectories);
+        }
+      },
+      options_.async_insert_timeout);
+
+  if (!queued)
+  {
+    RCLCPP_WARN(logger_, "Skipping asynchronous trajectory insert: The insert queue is full.");
+  }
+  return queued;
+}
+
+bool TrajectoryCache::insertCartesianTrajectoryAsync(
+    std::shared_ptr<const MoveGroupInterface> move_group, const std::string& cache_namespace,
+    const GetCartesianPath::Request& plan_request, const GetCartesianPath::Response& plan,
+    std::shared_ptr<CacheInsertPolicyInterface<GetCartesianPath::Request, GetCartesianPath::Response, RobotTrajectory>>
+        cache_insert_policy,
+    bool prune_worse_trajectories,
+    std::shared_ptr<const std::vector<std::unique_ptr<FeaturesInterface<GetCartesianPath::Request>>>>
+        additional_features)
+{
+  std::shared_lock<std::shared_mutex> queue_lock(insert_queue_mutex_);
+  if (!insert_queue_)
+  {
+    RCLCPP_ERROR(logger_, "Skipping asynchronous cartesian trajectory insert: The cache was not initialized.");
+    return false;
+  }
+
+  // The writer runs later, when the robot may have moved on. A diff start state is resolved now, so that the entry is
+  // keyed, and coalesced, by the state the plan was made from.
+  GetCartesianPath::Request resolved_request = plan_request;
+  if (MoveItErrorCode ret = resolveRobotStateDiff(resolved_request.start_state, *move_group); !ret)
+  {
+    RCLCPP_ERROR_STREAM(logger_, "Skipping asynchronous cartesian trajectory insert: " << ret.message);
+    return false;
+  }
+
+  std::string key = asyncInsertKey(CARTESIAN_TRAJECTORY_CACHE_DB, cache_namespace, resolved_request);
+  size_t bytes = key.size() + estimateTrajectoryBytes(plan.solution);
+  double execution_time_s = getExecutionTime(plan.solution);
+
+  bool queued = insert_queue_->push(
+      key, bytes, /*cost=*/execution_time_s,
+      [this, move_group = std::move(move_group), cache_namespace, plan_request = std::move(resolved_request),
+       plan, cache_insert_policy = std::move(cache_insert_policy), prune_worse_trajectories,
+       additional_features = std::move(additional_features)] {
+        if (additional_features)
+        {
+          insertCartesianTrajectory(*move_group, cache_namespace, plan_request, plan, *cache_insert_policy,
+                                    prune_worse_trajectories, *additional_features);
+        }
+        else
+        {
+          insertCartesianTrajectory(*move_group, cache_namespace, plan_request, plan, *cache_insert_policy,
+                                    prune_worse_trajectories);
+        }
+      },
+      options_.async_insert_timeout);
+
+  if (!queued)
+  {
+    RCLCPP_WARN(logger_, "Skipping asynchronous cartesian trajectory insert: The insert queue is full.");
+  }
+  return queued;
+}
+
+void TrajectoryCache::flushAsyncInserts()
+{
+  std::shared_lock<std::shared_mutex> queue_lock(insert_queue_mutex_);
+  if (insert_queue_)
+  {
+    insert_queue_->flush();
+  }
+}
+
+size_t TrajectoryCache::getAsyncInsertQueueBytes() const
+{
+  std::shared_lock<std::shared_mutex> queue_lock(insert_queue_mutex_);
+  return insert_queue_ ? insert_queue_->queuedBytes() : 0;
+}
+
+// =================================================================================================
+// In-Memory Index.
+// =================================================================================================
+
+CacheIndex* TrajectoryCache::getIndex(MessageCollection<RobotTrajectory>& coll, const std::string& db_name,
+                                      const std::string& cache_namespace) const
+{
+  if (!options_.use_in_memory_index)
+  {
+    return nullptr;
+  }
+
+  auto [index_it, inserted] = indexes_.try_emplace(indexKey(db_name, cache_namespace));
+  if (inserted)
+  {
+    size_t loaded = index_it->second.sync(coll);
+    RCLCPP_DEBUG(logger_, "Loaded %zu cache entries into the in-memory index for: %s", loaded,
+                 index_it->first.c_str());
+  }
+  return &index_it->second;
+}
+
+template <typename FeatureSourceT>
+std::vector<MessageWithMetadata<RobotTrajectory>::ConstPtr> TrajectoryCache::fetchAllMatchingFromIndex(
+    MessageCollection<RobotTrajectory>& coll, CacheIndex& index, const MoveGroupInterface& move_group,
+    const FeatureSourceT& source, const std::vector<std::unique_ptr<FeaturesInterface<FeatureSourceT>>>& features,
+    const std::string& sort_by, bool ascending, bool metadata_only) const
+{
+  IndexQuery query;
+  for (const auto& feature : features)
+  {
+    if (MoveItErrorCode ret =
+            feature->appendFeaturesAsFuzzyFetchQuery(query, source, move_group,
+                                                     /*exact_match_precision=*/options_.exact_match_precision);
+        !ret)
+    {
+      RCLCPP_ERROR_STREAM(logger_, "Could not construct index query: " << ret.message);
+      return {};
+    }
+  }
+
+  std::vector<MessageWithMetadata<RobotTrajectory>::ConstPtr> matching = index.query(query, sort_by, ascending);
+  if (metadata_only)
+  {
+    return matching;
+  }
+
+  // Only deserialize the trajectories of matching entries.
+  std::vector<MessageWithMetadata<RobotTrajectory>::ConstPtr> out;
+  out.reserve(matching.size());
+  for (const auto& entry : matching)
+  {
+    Query::Ptr id_query = coll.createQuery();
+    id_query->append("id", entry->lookupInt("id"));
+    for (auto& message : coll.queryList(id_query, /*metadata_only=*/false))
+    {
+      out.push_back(std::move(message));
+    }
+  }
+  return out;
+}
+
 }  // namespace trajectory_cache
 }  // namespace moveit_ros
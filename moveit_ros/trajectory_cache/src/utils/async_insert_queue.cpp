@@ -0,0 +1,149 @@
+// Copyright 2024 Intrinsic Innovation LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file
+ * @brief Implementation of the bounded, coalescing trajectory cache insert queue.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <moveit/trajectory_cache/utils/async_insert_queue.hpp>
+
+namespace moveit_ros
+{
+namespace trajectory_cache
+{
+
+AsyncInsertQueue::AsyncInsertQueue(BatchRunner run_batch, size_t max_queued_bytes, size_t batch_size, bool coalesce)
+  : run_batch_(std::move(run_batch))
+  , max_queued_bytes_(max_queued_bytes)
+  , batch_size_(std::max<size_t>(batch_size, 1))
+  , coalesce_(coalesce)
+  , writer_([this] { writerLoop(); })
+{
+}
+
+AsyncInsertQueue::~AsyncInsertQueue()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_cv_.notify_one();
+  writer_.join();
+}
+
+bool AsyncInsertQueue::push(const std::string& key, size_t bytes, double cost, Insert insert,
+                            std::chrono::milliseconds timeout)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  if (coalesce_)
+  {
+    if (auto it = queued_keys_.find(key); it != queued_keys_.end())
+    {
+      Entry& queued = *it->second;
+      if (cost < queued.cost)
+      {
+        queued_bytes_ = queued_bytes_ - queued.bytes + bytes;
+        queued.bytes = bytes;
+        queued.cost = cost;
+        queued.insert = std::move(insert);
+      }
+      return true;
+    }
+  }
+
+  auto has_room = [this, bytes] { return queued_bytes_ == 0 || queued_bytes_ + bytes <= max_queued_bytes_; };
+  if (!has_room() && !space_cv_.wait_for(lock, timeout, has_room))
+  {
+    return false;
+  }
+
+  queue_.push_back(Entry{ key, bytes, cost, std::move(insert) });
+  if (coalesce_)
+  {
+    queued_keys_[key] = std::prev(queue_.end());
+  }
+  queued_bytes_ += bytes;
+
+  lock.unlock();
+  work_cv_.notify_one();
+  return true;
+}
+
+void AsyncInsertQueue::flush()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  space_cv_.wait(lock, [this] { return queue_.empty() && in_flight_ == 0; });
+}
+
+size_t AsyncInsertQueue::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.size();
+}
+
+size_t AsyncInsertQueue::queuedBytes() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queued_bytes_;
+}
+
+void AsyncInsertQueue::writerLoop()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    work_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty())
+    {
+      return;  // Stopped, and everything queued has been run.
+    }
+
+    std::vector<Insert> batch;
+    batch.reserve(std::min(batch_size_, queue_.size()));
+    size_t batch_bytes = 0;
+    while (!queue_.empty() && batch.size() < batch_size_)
+    {
+      Entry& entry = queue_.front();
+      batch_bytes += entry.bytes;
+      batch.push_back(std::move(entry.insert));
+      if (coalesce_)
+      {
+        queued_keys_.erase(entry.key);
+      }
+      queue_.pop_front();
+    }
+    in_flight_ = batch.size();
+
+    // The batch's bytes stay charged against the budget until it has been run.
+    lock.unlock();
+    run_batch_(batch);
+    lock.lock();
+
+    queued_bytes_ -= batch_bytes;
+    in_flight_ = 0;
+    space_cv_.notify_all();
+  }
+}
+
+}  // namespace trajectory_cache
+}  // namespace moveit_ros
@@ -0,0 +1,471 @@
+// Copyright 2024 Intrinsic Innovation LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file
+ * @brief Implementation of the in-memory trajectory cache index.
+ */
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <moveit_msgs/msg/robot_trajectory.hpp>
+#include <warehouse_ros/message_collection.h>
+
+#include <moveit/trajectory_cache/utils/cache_index.hpp>
+
+namespace moveit_ros
+{
+namespace trajectory_cache
+{
+
+using ::warehouse_ros::MessageCollection;
+using ::warehouse_ros::Query;
+
+using ::moveit_msgs::msg::RobotTrajectory;
+
+namespace
+{
+
+const std::string ID = "id";
+
+/** @brief Reads a metadata field with the given type into numeric or str. Returns false if the type does not match. */
+template <typename MetadataT>
+bool lookupFieldAs(const MetadataT& metadata, const std::string& name, CacheIndex::FieldType type, double& numeric,
+                   std::string& str)
+{
+  // warehouse_ros does not expose field types, and backends throw on mismatched lookups.
+  try
+  {
+    switch (type)
+    {
+      case CacheIndex::FieldType::DOUBLE:
+        numeric = metadata.lookupDouble(name);
+        return true;
+      case CacheIndex::FieldType::INT:
+        numeric = static_cast<double>(metadata.lookupInt(name));
+        return true;
+      case CacheIndex::FieldType::STRING:
+        str = metadata.lookupString(name);
+        return true;
+      case CacheIndex::FieldType::BOOL:
+        numeric = metadata.lookupBool(name) ? 1.0 : 0.0;
+        return true;
+    }
+  }
+  catch (const std::exception&)
+  {
+  }
+  return false;
+}
+
+}  // namespace
+
+// =================================================================================================
+// IndexQuery.
+// =================================================================================================
+
+bool IndexQuery::Interval::contains(double value) const
+{
+  return (lower_inclusive ? value >= lower : value > lower) && (upper_inclusive ? value <= upper : value < upper);
+}
+
+void IndexQuery::Interval::intersect(double other_lower, bool other_lower_inclusive, double other_upper,
+                                     bool other_upper_inclusive)
+{
+  if (other_lower > lower || (other_lower == lower && !other_lower_inclusive))
+  {
+    lower = other_lower;
+    lower_inclusive = other_lower_inclusive;
+  }
+  if (other_upper < upper || (other_upper == upper && !other_upper_inclusive))
+  {
+    upper = other_upper;
+    upper_inclusive = other_upper_inclusive;
+  }
+}
+
+void IndexQuery::append(const std::string& name, const std::string& val)
+{
+  string_matches_[name].push_back(val);
+}
+
+void IndexQuery::append(const std::string& name, const double val)
+{
+  intervals_[name].intersect(val, true, val, true);
+}
+
+void IndexQuery::append(const std::string& name, const int val)
+{
+  append(name, static_cast<double>(val));
+}
+
+void IndexQuery::append(const std::string& name, const bool val)
+{
+  append(name, val ? 1.0 : 0.0);
+}
+
+void IndexQuery::appendLT(const std::string& name, const double val)
+{
+  intervals_[name].intersect(-std::numeric_limits<double>::infinity(), true, val, false);
+}
+
+void IndexQuery::appendLT(const std::string& name, const int val)
+{
+  appendLT(name, static_cast<double>(val));
+}
+
+void IndexQuery::appendLTE(const std::string& name, const double val)
+{
+  intervals_[name].intersect(-std::numeric_limits<double>::infinity(), true, val, true);
+}
+
+void IndexQuery::appendLTE(const std::string& name, const int val)
+{
+  appendLTE(name, static_cast<double>(val));
+}
+
+void IndexQuery::appendGT(const std::string& name, const double val)
+{
+  intervals_[name].intersect(val, false, std::numeric_limits<double>::infinity(), true);
+}
+
+void IndexQuery::appendGT(const std::string& name, const int val)
+{
+  appendGT(name, static_cast<double>(val));
+}
+
+void IndexQuery::appendGTE(const std::string& name, const double val)
+{
+  intervals_[name].intersect(val, true, std::numeric_limits<double>::infinity(), true);
+}
+
+void IndexQuery::appendGTE(const std::string& name, const int val)
+{
+  appendGTE(name, static_cast<double>(val));
+}
+
+void IndexQuery::appendRange(const std::string& name, const double lower, const double upper)
+{
+  intervals_[name].intersect(lower, false, upper, false);
+}
+
+void IndexQuery::appendRange(const std::string& name, const int lower, const int upper)
+{
+  appendRange(name, static_cast<double>(lower), static_cast<double>(upper));
+}
+
+void IndexQuery::appendRangeInclusive(const std::string& name, const double lower, const double upper)
+{
+  intervals_[name].intersect(lower, true, upper, true);
+}
+
+void IndexQuery::appendRangeInclusive(const std::string& name, const int lower, const int upper)
+{
+  appendRangeInclusive(name, static_cast<double>(lower), static_cast<double>(upper));
+}
+
+const std::unordered_map<std::string, IndexQuery::Interval>& IndexQuery::getIntervals() const
+{
+  return intervals_;
+}
+
+const std::unordered_map<std::string, std::vector<std::string>>& IndexQuery::getStringMatches() const
+{
+  return string_matches_;
+}
+
+// =================================================================================================
+// CacheIndex.
+// =================================================================================================
+
+size_t CacheIndex::sync(MessageCollection<RobotTrajectory>& coll)
+{
+  Query::Ptr query = coll.createQuery();
+  if (!entries_.empty())
+  {
+    query->appendGT(ID, max_id_);
+  }
+
+  // Keep the last entry per id, and drop stale copies before appending, so the field indexes stay sorted below.
+  std::vector<std::pair<int, EntryPtr>> pulled;
+  for (const EntryPtr& entry : coll.queryList(query, /*metadata_only=*/true))
+  {
+    if (entry && entry->lookupField(ID))
+    {
+      pulled.emplace_back(entry->lookupInt(ID), entry);
+    }
+  }
+  std::stable_sort(pulled.begin(), pulled.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+  auto last_per_id = std::unique(pulled.rbegin(), pulled.rend(),
+                                 [](const auto& a, const auto& b) { return a.first == b.first; });
+  pulled.erase(pulled.begin(), last_per_id.base());
+  for (const auto& [id, entry] : pulled)
+  {
+    remove(id);
+  }
+
+  // Append all entries, then sort each field index once instead of inserting in order per entry.
+  std::unordered_map<FieldIndex*, size_t> sorted_sizes;
+  for (const auto& [id, entry] : pulled)
+  {
+    index(id, entry, &sorted_sizes);
+  }
+  for (const auto& [field_index, sorted_size] : sorted_sizes)
+  {
+    auto middle = field_index->begin() + static_cast<FieldIndex::difference_type>(sorted_size);
+    std::sort(middle, field_index->end());
+    std::inplace_merge(field_index->begin(), middle, field_index->end());
+  }
+  return pulled.size();
+}
+
+bool CacheIndex::add(const EntryPtr& entry)
+{
+  if (!entry || !entry->lookupField(ID))
+  {
+    return false;
+  }
+  int id = entry->lookupInt(ID);
+  remove(id);
+  index(id, entry, nullptr);
+  return true;
+}
+
+void CacheIndex::index(int id, const EntryPtr& entry, std::unordered_map<FieldIndex*, size_t>* sorted_sizes)
+{
+  Entry indexed;
+  indexed.metadata = entry;
+  for (const std::string& name : entry->lookupFieldNames())
+  {
+    // Fields keep their type across entries, so only probe the types of a field the first time it is seen.
+    double numeric = 0.0;
+    std::string str;
+    auto type_it = field_types_.find(name);
+    if (type_it == field_types_.end() || !lookupFieldAs(*entry, name, type_it->second, numeric, str))
+    {
+      bool found = false;
+      for (FieldType type : { FieldType::DOUBLE, FieldType::INT, FieldType::STRING, FieldType::BOOL })
+      {
+        if (lookupFieldAs(*entry, name, type, numeric, str))
+        {
+          type_it = field_types_.insert_or_assign(name, type).first;
+          found = true;
+          break;
+        }
+      }
+      if (!found)
+      {
+        continue;
+      }
+    }
+
+    if (type_it->second != FieldType::STRING)
+    {
+      indexed.numeric_fields.emplace(name, numeric);
+      FieldIndex& field_index = field_indexes_[name];
+      std::pair<double, int> key(numeric, id);
+      if (sorted_sizes)
+      {
+        sorted_sizes->emplace(&field_index, field_index.size());
+        field_index.push_back(key);
+      }
+      else
+      {
+        field_index.insert(std::upper_bound(field_index.begin(), field_index.end(), key), key);
+      }
+    }
+    else
+    {
+      indexed.string_fields.emplace(name, std::move(str));
+    }
+  }
+
+  entries_.emplace(id, std::move(indexed));
+  max_id_ = std::max(max_id_, id);
+}
+
+void CacheIndex::remove(int id)
+{
+  auto it = entries_.find(id);
+  if (it == entries_.end())
+  {
+    return;
+  }
+
+  for (const auto& [name, value] : it->second.numeric_fields)
+  {
+    auto field_it = field_indexes_.find(name);
+    if (field_it == field_indexes_.end())
+    {
+      continue;
+    }
+    FieldIndex& field_index = field_it->second;
+    auto key_it = std::lower_bound(field_index.begin(), field_index.end(), std::make_pair(value, id));
+    if (key_it != field_index.end() && *key_it == std::make_pair(value, id))
+    {
+      field_index.erase(key_it);
+    }
+    if (field_index.empty())
+    {
+      field_indexes_.erase(field_it);
+    }
+  }
+  entries_.erase(it);
+
+  // Keep `max_id_` tight, since backends may reuse the largest id after it is deleted.
+  auto id_index_it = field_indexes_.find(ID);
+  max_id_ = (id_index_it == field_indexes_.end()) ? std::numeric_limits<int>::min() :
+                                                    static_cast<int>(id_index_it->second.back().first);
+}
+
+void CacheIndex::clear()
+{
+  entries_.clear();
+  field_indexes_.clear();
+  field_types_.clear();
+  max_id_ = std::numeric_limits<int>::min();
+}
+
+size_t CacheIndex::size() const
+{
+  return entries_.size();
+}
+
+std::vector<CacheIndex::EntryPtr> CacheIndex::query(const IndexQuery& query, const std::string& sort_by,
+                                                    bool ascending) const
+{
+  // Shortlist candidates from the most selective numeric field.
+  const FieldIndex* shortlist_index = nullptr;
+  FieldIndex::const_iterator shortlist_begin;
+  FieldIndex::const_iterator shortlist_end;
+  size_t shortlist_size = std::numeric_limits<size_t>::max();
+
+  for (const auto& [name, interval] : query.getIntervals())
+  {
+    auto field_it = field_indexes_.find(name);
+    if (field_it == field_indexes_.end())
+    {
+      return {};  // No entry has this field, so nothing can match.
+    }
+
+    const FieldIndex& field_index = field_it->second;
+    auto begin = interval.lower_inclusive ?
+                     std::lower_bound(field_index.begin(), field_index.end(),
+                                      std::make_pair(interval.lower, std::numeric_limits<int>::min())) :
+                     std::upper_bound(field_index.begin(), field_index.end(),
+                                      std::make_pair(interval.lower, std::numeric_limits<int>::max()));
+    auto end = interval.upper_inclusive ?
+                   std::upper_bound(field_index.begin(), field_index.end(),
+                                    std::make_pair(interval.upper, std::numeric_limits<int>::max())) :
+                   std::lower_bound(field_index.begin(), field_index.end(),
+                                    std::make_pair(interval.upper, std::numeric_limits<int>::min()));
+    if (end <= begin)
+    {
+      return {};
+    }
+
+    if (static_cast<size_t>(end - begin) < shortlist_size)
+    {
+      shortlist_index = &field_index;
+      shortlist_begin = begin;
+      shortlist_end = end;
+      shortlist_size = static_cast<size_t>(end - begin);
+    }
+  }
+
+  std::vector<const Entry*> matching;
+  if (shortlist_index)
+  {
+    matching.reserve(shortlist_size);
+    for (auto it = shortlist_begin; it != shortlist_end; ++it)
+    {
+      const Entry& entry = entries_.at(it->second);
+      if (matches(entry, query))
+      {
+        matching.push_back(&entry);
+      }
+    }
+  }
+  else
+  {
+    matching.reserve(entries_.size());
+    for (const auto& [id, entry] : entries_)
+    {
+      if (matches(entry, query))
+      {
+        matching.push_back(&entry);
+      }
+    }
+  }
+
+  // Sort by the sort feature, with entries missing it last, and ties broken by id for determinism.
+  auto sort_key = [&sort_by](const Entry* entry) {
+    auto it = entry->numeric_fields.find(sort_by);
+    return it == entry->numeric_fields.end() ? std::make_pair(true, 0.0) : std::make_pair(false, it->second);
+  };
+  auto id_of = [](const Entry* entry) { return static_cast<int>(entry->numeric_fields.at(ID)); };
+  std::sort(matching.begin(), matching.end(), [&](const Entry* a, const Entry* b) {
+    if (!sort_by.empty())
+    {
+      auto [a_missing, a_value] = sort_key(a);
+      auto [b_missing, b_value] = sort_key(b);
+      if (a_missing != b_missing)
+      {
+        return b_missing;
+      }
+      if (a_value != b_value)
+      {
+        return ascending ? a_value < b_value : a_value > b_value;
+      }
+    }
+    return id_of(a) < id_of(b);
+  });
+
+  std::vector<EntryPtr> out;
+  out.reserve(matching.size());
+  for (const Entry* entry : matching)
+  {
+    out.push_back(entry->metadata);
+  }
+  return out;
+}
+
+bool CacheIndex::matches(const Entry& entry, const IndexQuery& query) const
+{
+  for (const auto& [name, interval] : query.getIntervals())
+  {
+    auto it = entry.numeric_fields.find(name);
+    if (it == entry.numeric_fields.end() || !interval.contains(it->second))
+    {
+      return false;
+    }
+  }
+  for (const auto& [name, values] : query.getStringMatches())
+  {
+    auto it = entry.string_fields.find(name);
+    if (it == entry.string_fields.end() ||
+        std::any_of(values.begin(), values.end(), [&it](const std::string& value) { return value != it->second; }))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace trajectory_cache
+}  // namespace moveit_ros
@@ -0,0 +1,129 @@
+// Copyright 2024 Intrinsic Innovation LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file
+ * @brief Implementation of utilities for reusing a cached trajectory from a nearby start state.
+ */
+
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include <moveit/planning_scene/planning_scene.hpp>
+#include <moveit/robot_state/robot_state.hpp>
+#include <moveit/robot_trajectory/robot_trajectory.hpp>
+#include <moveit/trajectory_processing/time_parameterization.hpp>
+#include <moveit/utils/moveit_error_code.hpp>
+#include <moveit_msgs/msg/robot_trajectory.hpp>
+
+#include <moveit/trajectory_cache/utils/start_state_adaptation.hpp>
+
+namespace moveit_ros
+{
+namespace trajectory_cache
+{
+
+using ::moveit::core::MoveItErrorCode;
+
+double distanceToTrajectoryStart(const moveit::core::RobotState& start_state, const std::string& group_name,
+                                 const moveit_msgs::msg::RobotTrajectory& trajectory)
+{
+  const trajectory_msgs::msg::JointTrajectory& joint_trajectory = trajectory.joint_trajectory;
+  if (joint_trajectory.points.empty() ||
+      joint_trajectory.points.front().positions.size() != joint_trajectory.joint_names.size())
+  {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  moveit::core::RobotState first_state(start_state);
+  first_state.setVariablePositions(joint_trajectory.joint_names, joint_trajectory.points.front().positions);
+
+  const moveit::core::JointModelGroup* group = start_state.getRobotModel()->getJointModelGroup(group_name);
+  return group ? start_state.distance(first_state, group) : start_state.distance(first_state);
+}
+
+MoveItErrorCode adaptTrajectoryToStartState(const planning_scene::PlanningScene& planning_scene,
+                                            const moveit::core::RobotState& start_state, const std::string& group_name,
+                                            const moveit_msgs::msg::RobotTrajectory& cached_trajectory,
+                                            double max_connector_distance, double connector_resolution,
+                                            const trajectory_processing::TimeParameterization& time_parameterization,
+                                            double max_velocity_scaling_factor, double max_acceleration_scaling_factor,
+                                            moveit_msgs::msg::RobotTrajectory& adapted_trajectory)
+{
+  const moveit::core::RobotModelConstPtr& robot_model = start_state.getRobotModel();
+  const moveit::core::JointModelGroup* group = robot_model->getJointModelGroup(group_name);
+  if (!group)
+  {
+    return MoveItErrorCode(moveit_msgs::msg::MoveItErrorCodes::INVALID_GROUP_NAME,
+                           "Unknown joint model group: " + group_name);
+  }
+
+  robot_trajectory::RobotTrajectory cached(robot_model, group);
+  cached.setRobotTrajectoryMsg(start_state, cached_trajectory);
+  if (cached.empty())
+  {
+    return MoveItErrorCode(moveit_msgs::msg::MoveItErrorCodes::INVALID_MOTION_PLAN, "Cached trajectory is empty.");
+  }
+
+  const moveit::core::RobotState& first_state = cached.getFirstWayPoint();
+  const double distance = start_state.distance(first_state, group);
+  if (distance > max_connector_distance)
+  {
+    std::stringstream ss;
+    ss << "Start state is " << distance << " from the cached trajectory, more than the maximum connector distance of "
+       << max_connector_distance << ".";
+    return MoveItErrorCode(moveit_msgs::msg::MoveItErrorCodes::INVALID_MOTION_PLAN, ss.str());
+  }
+
+  robot_trajectory::RobotTrajectory adapted(robot_model, group);
+
+  // Connector. Its end is the first waypoint of the cached trajectory, so that is not checked here.
+  if (distance > 0.0)
+  {
+    adapted.addSuffixWayPoint(start_state, 0.0);
+
+    const size_t steps =
+        connector_resolution > 0.0 ? static_cast<size_t>(std::ceil(distance / connector_resolution)) : 1;
+    moveit::core::RobotState connector_state(start_state);
+    for (size_t i = 1; i < steps; ++i)
+    {
+      start_state.interpolate(first_state, static_cast<double>(i) / static_cast<double>(steps), connector_state,
+                              group);
+      connector_state.update();
+      if (!planning_scene.isStateValid(connector_state, group_name))
+      {
+        return MoveItErrorCode(moveit_msgs::msg::MoveItErrorCodes::INVALID_MOTION_PLAN,
+                               "Connector to the cached trajectory is invalid.");
+      }
+      adapted.addSuffixWayPoint(connector_state, 0.0);
+    }
+  }
+
+  for (size_t i = 0; i < cached.getWayPointCount(); ++i)
+  {
+    adapted.addSuffixWayPoint(cached.getWayPoint(i), 0.0);
+  }
+
+  if (!time_parameterization.computeTimeStamps(adapted, max_velocity_scaling_factor, max_acceleration_scaling_factor))
+  {
+    return MoveItErrorCode(moveit_msgs::msg::MoveItErrorCodes::FAILURE, "Could not re-time the adapted trajectory.");
+  }
+
+  adapted.getRobotTrajectoryMsg(adapted_trajectory);
+  return MoveItErrorCode::SUCCESS;
+}
+
+}  // namespace trajectory_cache
+}  // namespace moveit_ros
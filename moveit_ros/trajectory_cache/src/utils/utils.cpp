@@ -654,5 +654,31 @@ appendRobotStateJointStateAsInsertMetadata(Metadata& metadata, const moveit_msgs
   return moveit::core::MoveItErrorCode::SUCCESS;
 }
 
+moveit::core::MoveItErrorCode resolveRobotStateDiff(moveit_msgs::msg::RobotState& robot_state,
+                                                    const MoveGroupInterface& move_group)
+{
+  if (!robot_state.is_diff)
+  {
+    return moveit::core::MoveItErrorCode::SUCCESS;
+  }
+
+  moveit::core::RobotStatePtr current_state = move_group.getCurrentState();
+  if (!current_state)
+  {
+    return MoveItErrorCode(MoveItErrorCode::UNABLE_TO_AQUIRE_SENSOR_DATA,
+                           "Could not resolve robot state diff: Could not get robot state.");
+  }
+
+  // The full current joint state, as appendRobotStateJointStateAsInsertMetadata() keys a diff.
+  moveit_msgs::msg::RobotState current_state_msg;
+  robotStateToRobotStateMsg(*current_state, current_state_msg);
+  robot_state.joint_state.name = std::move(current_state_msg.joint_state.name);
+  robot_state.joint_state.position = std::move(current_state_msg.joint_state.position);
+  robot_state.joint_state.velocity.clear();
+  robot_state.joint_state.effort.clear();
+  robot_state.is_diff = false;
+  return moveit::core::MoveItErrorCode::SUCCESS;
+}
+
 }  // namespace trajectory_cache
 }  // namespace moveit_ros
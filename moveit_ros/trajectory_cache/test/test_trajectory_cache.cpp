@@ -1083,6 +1083,16 @@ int main(int argc, char** argv)
 
     testMotionTrajectories(move_group, cache);
     testCartesianTrajectories(move_group, cache);
+
+    // Rerun against a fresh database, answering fetches from the in-memory index.
+    options.use_in_memory_index = true;
+    checkAndEmit(cache->init(options), "init", "Cache init with in-memory index");
+
+    cache->setExactMatchPrecision(1e-4);
+    cache->setNumAdditionalTrajectoriesToPreserveWhenPruningWorse(0);
+
+    testMotionTrajectories(move_group, cache);
+    testCartesianTrajectories(move_group, cache);
   }
 
   running = false;
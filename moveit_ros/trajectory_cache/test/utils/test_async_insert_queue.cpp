@@ -0,0 +1,178 @@
+// Copyright 2024 Intrinsic Innovation LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file
+ * @brief Tests for the asynchronous trajectory cache insert queue.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <moveit/trajectory_cache/utils/async_insert_queue.hpp>
+
+namespace
+{
+
+using ::moveit_ros::trajectory_cache::AsyncInsertQueue;
+
+/** @brief Records the inserts a queue runs, holding the writer on its first batch until released. */
+class GatedRecorder
+{
+public:
+  AsyncInsertQueue::BatchRunner runner()
+  {
+    return [this](std::vector<AsyncInsertQueue::Insert>& batch) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      batch_sizes_.push_back(batch.size());
+      started_ = true;
+      cv_.notify_all();
+      cv_.wait(lock, [this] { return open_; });
+      lock.unlock();
+      for (auto& insert : batch)
+      {
+        insert();
+      }
+    };
+  }
+
+  AsyncInsertQueue::Insert record(const std::string& name)
+  {
+    return [this, name] {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ran_.push_back(name);
+    };
+  }
+
+  void waitUntilStarted()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return started_; });
+  }
+
+  void open()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    open_ = true;
+    cv_.notify_all();
+  }
+
+  std::vector<std::string> ran()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ran_;
+  }
+
+  std::vector<size_t> batchSizes()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return batch_sizes_;
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool started_ = false;
+  bool open_ = false;
+  std::vector<std::string> ran_;
+  std::vector<size_t> batch_sizes_;
+};
+
+TEST(AsyncInsertQueueTest, CoalescesQueuedDuplicatesKeepingLowestCost)
+{
+  GatedRecorder recorder;
+  AsyncInsertQueue queue(recorder.runner(), /*max_queued_bytes=*/1000, /*batch_size=*/16, /*coalesce=*/true);
+
+  ASSERT_TRUE(queue.push("first", 1, 0.0, recorder.record("first")));
+  recorder.waitUntilStarted();
+
+  EXPECT_TRUE(queue.push("key", 10, 3.0, recorder.record("key_3")));
+  EXPECT_TRUE(queue.push("key", 20, 1.0, recorder.record("key_1")));
+  EXPECT_TRUE(queue.push("key", 30, 2.0, recorder.record("key_2")));
+  EXPECT_TRUE(queue.push("other", 5, 9.0, recorder.record("other")));
+  EXPECT_EQ(queue.size(), 2u);
+  EXPECT_EQ(queue.queuedBytes(), 1u + 20u + 5u);
+
+  recorder.open();
+  queue.flush();
+
+  EXPECT_EQ(recorder.ran(), (std::vector<std::string>{ "first", "key_1", "other" }));
+  EXPECT_EQ(queue.queuedBytes(), 0u);
+}
+
+TEST(AsyncInsertQueueTest, AppliesBackpressureAtMemoryBudget)
+{
+  GatedRecorder recorder;
+  AsyncInsertQueue queue(recorder.runner(), /*max_queued_bytes=*/100, /*batch_size=*/16, /*coalesce=*/false);
+
+  // The in-flight batch stays charged against the budget.
+  ASSERT_TRUE(queue.push("a", 60, 0.0, recorder.record("a")));
+  recorder.waitUntilStarted();
+
+  EXPECT_FALSE(queue.push("b", 50, 0.0, recorder.record("b")));
+  EXPECT_TRUE(queue.push("c", 40, 0.0, recorder.record("c")));
+
+  // A blocked push goes through once the writer frees up room.
+  std::thread releaser([&recorder] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    recorder.open();
+  });
+  EXPECT_TRUE(queue.push("d", 50, 0.0, recorder.record("d"), std::chrono::seconds(10)));
+  releaser.join();
+
+  queue.flush();
+  EXPECT_EQ(recorder.ran(), (std::vector<std::string>{ "a", "c", "d" }));
+}
+
+TEST(AsyncInsertQueueTest, AcceptsOversizedInsertIntoEmptyQueue)
+{
+  GatedRecorder recorder;
+  recorder.open();
+  AsyncInsertQueue queue(recorder.runner(), /*max_queued_bytes=*/10, /*batch_size=*/16, /*coalesce=*/false);
+
+  EXPECT_TRUE(queue.push("big", 1000, 0.0, recorder.record("big")));
+  queue.flush();
+  EXPECT_EQ(recorder.ran(), std::vector<std::string>{ "big" });
+}
+
+TEST(AsyncInsertQueueTest, RunsInsertsInBatchesInQueueOrder)
+{
+  GatedRecorder recorder;
+  std::vector<std::string> expected;
+  {
+    AsyncInsertQueue queue(recorder.runner(), /*max_queued_bytes=*/1000, /*batch_size=*/2, /*coalesce=*/false);
+
+    ASSERT_TRUE(queue.push("key", 1, 0.0, recorder.record("0")));
+    recorder.waitUntilStarted();
+    expected.push_back("0");
+
+    for (int i = 1; i <= 5; ++i)
+    {
+      ASSERT_TRUE(queue.push("key", 1, 0.0, recorder.record(std::to_string(i))));
+      expected.push_back(std::to_string(i));
+    }
+    recorder.open();
+    // Destruction runs everything still queued.
+  }
+
+  EXPECT_EQ(recorder.ran(), expected);
+  EXPECT_EQ(recorder.batchSizes(), (std::vector<size_t>{ 1, 2, 2, 1 }));
+}
+
+}  // namespace
@@ -0,0 +1,159 @@
+// Copyright 2024 Intrinsic Innovation LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file
+ * @brief Tests for the in-memory trajectory cache index.
+ */
+
+#include <gtest/gtest.h>
+#include <rclcpp/version.h>
+
+#include <string>
+#include <vector>
+
+#include <moveit/trajectory_cache/utils/cache_index.hpp>
+#include <moveit/trajectory_cache/utils/utils.hpp>
+#include <moveit_msgs/msg/robot_trajectory.hpp>
+
+#include "../fixtures/warehouse_fixture.hpp"
+
+namespace
+{
+
+using ::warehouse_ros::MessageCollection;
+using ::warehouse_ros::Metadata;
+using ::warehouse_ros::Query;
+
+using ::moveit_msgs::msg::RobotTrajectory;
+
+using ::moveit_ros::trajectory_cache::CacheIndex;
+using ::moveit_ros::trajectory_cache::IndexQuery;
+
+void insertEntry(MessageCollection<RobotTrajectory>& coll, double x, double execution_time_s,
+                 const std::string& group)
+{
+  Metadata::Ptr metadata = coll.createMetadata();
+  metadata->append("x", x);
+  metadata->append("execution_time_s", execution_time_s);
+  metadata->append("group", group);
+  coll.insert(RobotTrajectory(), metadata);
+}
+
+std::vector<int> ids(const std::vector<CacheIndex::EntryPtr>& entries)
+{
+  std::vector<int> out;
+  for (const auto& entry : entries)
+  {
+    out.push_back(entry->lookupInt("id"));
+  }
+  return out;
+}
+
+TEST(CacheIndexTest, IndexQueryIntersectsIntervals)
+{
+  IndexQuery query;
+  query.appendGTE("x", 1.0);
+  query.appendLT("x", 5.0);
+  query.appendRangeInclusive("x", 2.0, 10.0);
+
+  const IndexQuery::Interval& interval = query.getIntervals().at("x");
+  EXPECT_EQ(interval.lower, 2.0);
+  EXPECT_TRUE(interval.lower_inclusive);
+  EXPECT_EQ(interval.upper, 5.0);
+  EXPECT_FALSE(interval.upper_inclusive);
+
+  EXPECT_FALSE(interval.contains(1.5));
+  EXPECT_TRUE(interval.contains(2.0));
+  EXPECT_TRUE(interval.contains(4.9));
+  EXPECT_FALSE(interval.contains(5.0));
+}
+
+// Match the guard on the other warehouse-backed utils tests, which throw on Humble.
+#if RCLCPP_VERSION_GTE(28, 3, 3)
+TEST_F(WarehouseFixture, CacheIndexMatchesDatabaseQueries)
+{
+  MessageCollection<RobotTrajectory> coll = db_->openCollection<RobotTrajectory>("test_db", "test_collection");
+  for (int i = 0; i < 10; ++i)
+  {
+    insertEntry(coll, static_cast<double>(i), 10.0 - i, i % 2 ? "odd" : "even");
+  }
+
+  CacheIndex index;
+  EXPECT_EQ(index.sync(coll), 10u);
+  EXPECT_EQ(index.size(), 10u);
+
+  IndexQuery index_query;
+  Query::Ptr db_query = coll.createQuery();
+  for (Query* query : std::vector<Query*>{ &index_query, db_query.get() })
+  {
+    moveit_ros::trajectory_cache::queryAppendCenterWithTolerance(*query, "x", 4.5, 4.0);
+    query->append("group", std::string("even"));
+  }
+
+  std::vector<CacheIndex::EntryPtr> index_hits = index.query(index_query, "execution_time_s", /*ascending=*/true);
+  ASSERT_EQ(index_hits.size(), 2u);
+  EXPECT_EQ(index_hits.at(0)->lookupDouble("x"), 6.0);
+  EXPECT_EQ(index_hits.at(1)->lookupDouble("x"), 4.0);
+  EXPECT_EQ(ids(index_hits), ids(coll.queryList(db_query, /*metadata_only=*/true, "execution_time_s", true)));
+
+  // Unknown fields never match.
+  IndexQuery unknown_query;
+  unknown_query.append("unknown", 1.0);
+  EXPECT_TRUE(index.query(unknown_query, "execution_time_s").empty());
+
+  // An empty query matches everything.
+  EXPECT_EQ(index.query(IndexQuery(), "execution_time_s", /*ascending=*/false).size(), 10u);
+}
+
+TEST_F(WarehouseFixture, CacheIndexStaysInSyncWithInsertsAndRemoves)
+{
+  MessageCollection<RobotTrajectory> coll = db_->openCollection<RobotTrajectory>("test_db", "test_sync_collection");
+  insertEntry(coll, 1.0, 1.0, "a");
+  insertEntry(coll, 2.0, 2.0, "a");
+
+  CacheIndex index;
+  ASSERT_EQ(index.sync(coll), 2u);
+
+  // Remove the newest entry, since some backends reuse its id for the next insert.
+  std::vector<CacheIndex::EntryPtr> all = index.query(IndexQuery(), "");
+  int removed_id = all.back()->lookupInt("id");
+  Query::Ptr delete_query = coll.createQuery();
+  delete_query->append("id", removed_id);
+  coll.removeMessages(delete_query);
+  index.remove(removed_id);
+  EXPECT_EQ(index.size(), 1u);
+
+  insertEntry(coll, 3.0, 3.0, "a");
+  EXPECT_EQ(index.sync(coll), 1u);
+  EXPECT_EQ(index.sync(coll), 0u);
+  ASSERT_EQ(index.size(), 2u);
+
+  IndexQuery query;
+  query.appendGT("x", 2.5);
+  std::vector<CacheIndex::EntryPtr> hits = index.query(query, "execution_time_s");
+  ASSERT_EQ(hits.size(), 1u);
+  EXPECT_EQ(hits.at(0)->lookupDouble("x"), 3.0);
+}
+#endif
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  int result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
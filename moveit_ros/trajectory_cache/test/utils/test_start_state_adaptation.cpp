@@ -0,0 +1,140 @@
+// Copyright 2024 Intrinsic Innovation LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file
+ * @brief Tests for adapting cached trajectories to nearby start states.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <rclcpp/duration.hpp>
+
+#include <moveit/planning_scene/planning_scene.hpp>
+#include <moveit/robot_state/robot_state.hpp>
+#include <moveit/robot_trajectory/robot_trajectory.hpp>
+#include <moveit/trajectory_cache/utils/start_state_adaptation.hpp>
+#include <moveit/trajectory_processing/time_optimal_trajectory_generation.hpp>
+#include <moveit/utils/robot_model_test_utils.hpp>
+
+namespace
+{
+
+using ::moveit_ros::trajectory_cache::adaptTrajectoryToStartState;
+using ::moveit_ros::trajectory_cache::distanceToTrajectoryStart;
+
+const std::string GROUP = "panda_arm";
+
+class StartStateAdaptationTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    robot_model_ = moveit::core::loadTestingRobotModel("panda");
+    planning_scene_ = std::make_shared<planning_scene::PlanningScene>(robot_model_);
+    group_ = robot_model_->getJointModelGroup(GROUP);
+
+    moveit::core::RobotState cached_start(robot_model_);
+    cached_start.setToDefaultValues(group_, "ready");
+    cached_start.update();
+
+    moveit::core::RobotState cached_goal(cached_start);
+    cached_goal.setJointPositions("panda_joint1", { cached_start.getVariablePosition("panda_joint1") + 0.3 });
+    cached_goal.update();
+
+    robot_trajectory::RobotTrajectory cached(robot_model_, group_);
+    cached.addSuffixWayPoint(cached_start, 0.0);
+    cached.addSuffixWayPoint(cached_goal, 0.0);
+    ASSERT_TRUE(totg_.computeTimeStamps(cached));
+    cached.getRobotTrajectoryMsg(cached_trajectory_);
+
+    start_state_ = std::make_shared<moveit::core::RobotState>(cached_start);
+    start_state_->setJointPositions("panda_joint2", { cached_start.getVariablePosition("panda_joint2") + 0.05 });
+    start_state_->update();
+
+    goal_position_ = cached_goal.getVariablePosition("panda_joint1");
+  }
+
+  moveit::core::RobotModelPtr robot_model_;
+  planning_scene::PlanningScenePtr planning_scene_;
+  const moveit::core::JointModelGroup* group_ = nullptr;
+  trajectory_processing::TimeOptimalTrajectoryGeneration totg_;
+
+  moveit_msgs::msg::RobotTrajectory cached_trajectory_;
+  moveit::core::RobotStatePtr start_state_;
+  double goal_position_ = 0.0;
+};
+
+TEST_F(StartStateAdaptationTest, DistanceToTrajectoryStart)
+{
+  EXPECT_NEAR(distanceToTrajectoryStart(*start_state_, GROUP, cached_trajectory_), 0.05, 1e-9);
+  EXPECT_TRUE(std::isinf(distanceToTrajectoryStart(*start_state_, GROUP, moveit_msgs::msg::RobotTrajectory())));
+}
+
+TEST_F(StartStateAdaptationTest, SplicesConnectorAndRetimes)
+{
+  moveit_msgs::msg::RobotTrajectory adapted;
+  ASSERT_TRUE(adaptTrajectoryToStartState(*planning_scene_, *start_state_, GROUP, cached_trajectory_,
+                                          /*max_connector_distance=*/0.1, /*connector_resolution=*/0.01, totg_,
+                                          /*max_velocity_scaling_factor=*/1.0,
+                                          /*max_acceleration_scaling_factor=*/1.0, adapted));
+
+  robot_trajectory::RobotTrajectory result(robot_model_, group_);
+  result.setRobotTrajectoryMsg(*start_state_, adapted);
+  ASSERT_FALSE(result.empty());
+
+  EXPECT_NEAR(result.getFirstWayPoint().distance(*start_state_, group_), 0.0, 1e-6);
+  EXPECT_NEAR(result.getLastWayPoint().getVariablePosition("panda_joint1"), goal_position_, 1e-6);
+
+  const auto& points = adapted.joint_trajectory.points;
+  for (size_t i = 1; i < points.size(); ++i)
+  {
+    EXPECT_GT(rclcpp::Duration(points[i].time_from_start).seconds(),
+              rclcpp::Duration(points[i - 1].time_from_start).seconds());
+  }
+}
+
+TEST_F(StartStateAdaptationTest, RejectsDistantStartState)
+{
+  moveit_msgs::msg::RobotTrajectory adapted;
+  EXPECT_FALSE(adaptTrajectoryToStartState(*planning_scene_, *start_state_, GROUP, cached_trajectory_,
+                                           /*max_connector_distance=*/0.01, /*connector_resolution=*/0.01, totg_,
+                                           /*max_velocity_scaling_factor=*/1.0,
+                                           /*max_acceleration_scaling_factor=*/1.0, adapted));
+  EXPECT_TRUE(adapted.joint_trajectory.points.empty());
+}
+
+TEST_F(StartStateAdaptationTest, RejectsInvalidConnector)
+{
+  // Reject states strictly between the start state and the cached trajectory.
+  const double start_position = start_state_->getVariablePosition("panda_joint2");
+  const double end_position = start_position - 0.05;
+  planning_scene_->setStateFeasibilityPredicate(
+      [start_position, end_position](const moveit::core::RobotState& state, bool /*verbose*/) {
+        const double position = state.getVariablePosition("panda_joint2");
+        return !(position < start_position - 1e-6 && position > end_position + 1e-6);
+      });
+
+  moveit_msgs::msg::RobotTrajectory adapted;
+  EXPECT_FALSE(adaptTrajectoryToStartState(*planning_scene_, *start_state_, GROUP, cached_trajectory_,
+                                           /*max_connector_distance=*/0.1, /*connector_resolution=*/0.01, totg_,
+                                           /*max_velocity_scaling_factor=*/1.0,
+                                           /*max_acceleration_scaling_factor=*/1.0, adapted));
+}
+
+}  // namespace
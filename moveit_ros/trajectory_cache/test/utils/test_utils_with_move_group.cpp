@@ -46,6 +46,25 @@ TEST_F(MoveGroupFixture, GetCartesianPathRequestFrameId)
   EXPECT_EQ(moveit_ros::trajectory_cache::getCartesianPathRequestFrameId(*move_group_, path_request), "test_frame");
 }
 
+TEST_F(MoveGroupFixture, ResolveRobotStateDiff)
+{
+  moveit_msgs::msg::RobotState robot_state;
+  robot_state.joint_state.name = { "panda_joint1" };
+  robot_state.joint_state.position = { 0.1 };
+
+  // Explicit states are left unchanged.
+  moveit_msgs::msg::RobotState resolved = robot_state;
+  ASSERT_TRUE(moveit_ros::trajectory_cache::resolveRobotStateDiff(resolved, *move_group_));
+  EXPECT_EQ(resolved, robot_state);
+
+  // Diffs are replaced by the full current joint state.
+  resolved.is_diff = true;
+  ASSERT_TRUE(moveit_ros::trajectory_cache::resolveRobotStateDiff(resolved, *move_group_));
+  EXPECT_FALSE(resolved.is_diff);
+  EXPECT_FALSE(resolved.joint_state.name.empty());
+  EXPECT_EQ(resolved.joint_state.name.size(), resolved.joint_state.position.size());
+}
+
 }  // namespace
 
 int main(int argc, char** argv)